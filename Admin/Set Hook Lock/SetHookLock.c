@@ -20,12 +20,16 @@
 //**************************************************************
 
 #include "hookapi.h"
+#include "../../Common/BuildProfile.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
 
-#define DONE(x) accept(SBUF("SHL:: Success :: " x), __LINE__)
-#define WARN(x) rollback(SBUF("SHL:: Warning :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("SHL:: Error :: " x), __LINE__)
+#define HOOK_RESULT_ID RC_SETHOOKLOCK
+#define DONE(x) RESULT_ACCEPT("SHL:: Success :: " x)
+#define WARN(x) RESULT_ROLLBACK("SHL:: Warning :: " x)
+#define NOPE(x) RESULT_ROLLBACK("SHL:: Error :: " x)
 
-#define SETHOOK_LOCK_KEY 0x5345544800000000ULL // "SETH"
+#define SETHOOK_LOCK_KEY SKEY_PAD("SETH", 8)
 
 int64_t hook(uint32_t reserved)
 {
@@ -62,26 +66,23 @@ int64_t hook(uint32_t reserved)
         uint8_t lock_param[1];
         if (otxn_param(SBUF(lock_param), "LOCK", 4) == 1)
         {
-            uint8_t sethook_key[8];
-            UINT64_TO_BUF(sethook_key, SETHOOK_LOCK_KEY);
-
             // Read current lock state
             uint8_t lock_state[1];
-            int32_t state_len = state(SBUF(lock_state), SBUF(sethook_key));
+            int32_t state_len = state(SBUF(lock_state), SETHOOK_LOCK_KEY);
 
             uint8_t new_state[1];
             if (state_len == 1 && lock_state[0] == 1)
             {
                 // Lock is enabled, disable it
                 new_state[0] = 0;
-                state_set(SBUF(new_state), SBUF(sethook_key));
+                state_set(SBUF(new_state), SETHOOK_LOCK_KEY);
                 DONE("HOOK_SET Lock disabled");
             }
             else
             {
                 // Lock is disabled or not set, enable it
                 new_state[0] = 1;
-                state_set(SBUF(new_state), SBUF(sethook_key));
+                state_set(SBUF(new_state), SETHOOK_LOCK_KEY);
                 DONE("HOOK_SET Lock enabled");
             }
         }
@@ -91,10 +92,8 @@ int64_t hook(uint32_t reserved)
     }
 
     // Check if SetHook locking is enabled
-    uint8_t sethook_key[8];
-    UINT64_TO_BUF(sethook_key, SETHOOK_LOCK_KEY);
     uint8_t lock_state[1];
-    int32_t state_len = state(SBUF(lock_state), SBUF(sethook_key));
+    int32_t state_len = state(SBUF(lock_state), SETHOOK_LOCK_KEY);
 
     // If lock state not set or set to 0, allow all transactions
     if (state_len != 1 || lock_state[0] == 0)
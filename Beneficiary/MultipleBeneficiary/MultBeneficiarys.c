@@ -20,23 +20,31 @@
 //   'BP3' (4 bytes):  Set Beneficiary Percentage 3 (1-99, as uint32)
 //
 // Usage:
-//   - Hook owner configures beneficiaries via Invoke.
+//   - Hook owner configures beneficiaries via Invoke, one or more BAx / BPx pairs at a time.
 //   - Delegate invokes "SEND" to distribute balance only after threshold exceeded.
 //   - Timer resets on outgoing transactions.
 //
 // Storage Structure:
-//   - Beneficiary accounts: "BA1", "BA2", "BA3" (20 bytes each)
-//   - Percentages:          "BP1", "BP2", "BP3" (4 bytes each, uint32)
-//   - Last outgoing time:   "LASTCHC" (4 bytes, uint32 seconds since epoch)
+//   - Beneficiaries: one record under "HOOKCONF" (Common/ConfigRecord.h), layout 1:
+//     { version:1, set mask:1, BA1..BA3:20 each, BP1..BP3:4 each, uint32 }
+//     Without it the beneficiaries are read from the "BA1".."BP3" keys
+//     used before it, until the owner next sets one and saves the record.
+//   - Last outgoing time: "LASTCHC" (4 bytes, uint32 seconds since epoch)
 //
 //**************************************************************
 
 #include "hookapi.h"
-
-#define DONE(x) accept(SBUF("MBC:: Success :: " x), __LINE__)
-#define WARN(x) rollback(SBUF("MBC:: Warning :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("MBC:: Error :: " x), __LINE__)
-#define COMP(x) rollback(SBUF("MBC:: Complete :: " x), __LINE__)
+#include "../../Common/BuildProfile.h"
+#include "../../Common/ParamDispatch.h"
+#include "../../Common/ConfigRecord.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
+
+#define HOOK_RESULT_ID RC_MULTBENEFICIARYS
+#define DONE(x) RESULT_ACCEPT("MBC:: Success :: " x)
+#define WARN(x) RESULT_ROLLBACK("MBC:: Warning :: " x)
+#define NOPE(x) RESULT_ROLLBACK("MBC:: Error :: " x)
+#define COMP(x) RESULT_ROLLBACK("MBC:: Complete :: " x)
 uint8_t msg_buf[66] = "MBC:: Error :: You must wait 00000000 seconds before triggering.";
 
 #define SET_TIME_MSG(remaining_seconds)                            \
@@ -52,22 +60,31 @@ uint8_t msg_buf[66] = "MBC:: Error :: You must wait 00000000 seconds before trig
         rollback((uint32_t)msg_buf, sizeof(msg_buf), __LINE__);    \
     }
 
-// State keys for beneficiary accounts and percentages
-#define BA1_KEY 0x4241310000000000ULL          // "BA1"
-#define BP1_KEY 0x4250310000000000ULL          // "BP1"
-#define BA2_KEY 0x4241320000000000ULL          // "BA2"
-#define BP2_KEY 0x4250320000000000ULL          // "BP2"
-#define BA3_KEY 0x4241330000000000ULL          // "BA3"
-#define BP3_KEY 0x4250330000000000ULL          // "BP3"
-#define LAST_CHECKIN_KEY 0x4C41535443484543ULL // "LASTCHC"
+// State key for the last outgoing time
+#define LAST_CHECKIN_KEY SKEY_PAD("LASTCHEC", 8)
+
+// Beneficiary record offsets; beneficiary n (0-2) is set when mask bit
+// 2n is, its percentage at 2n + 1
+#define MBC_CFG_VERSION 1
+#define MBC_CFG_MASK 1
+#define MBC_CFG_BA(n) (2 + (n) * 20)
+#define MBC_CFG_BP(n) (62 + (n) * 4)
+#define MBC_CFG_SIZE 74
+#define MBC_SET(cfg, bit) (((cfg)[MBC_CFG_MASK] >> (bit)) & 1U)
+
+// Owner invoke commands, in PARAM_COLLECT table order
+static const uint8_t mbc_commands[][PARAM_NAME_SIZE] = {"BA1", "BP1", "BA2", "BP2", "BA3", "BP3"};
+#define CMD_BA1 0
+#define CMD_BP1 1
+#define CMD_BA2 2
+#define CMD_BP2 3
+#define CMD_BA3 4
+#define CMD_BP3 5
 
 int64_t hook(uint32_t reserved)
 {
     TRACESTR("MBC :: Multi Beneficiary Contract :: Called");
 
-    // Declare key_buf
-    uint8_t key_buf[8];
-
     // Get hook and origin accounts
     uint8_t hook_acc[20];
     uint8_t otxn_acc[20];
@@ -94,21 +111,42 @@ int64_t hook(uint32_t reserved)
         uint32_t current_time = (uint32_t)ledger_last_time();
         uint8_t time_buf[4];
         UINT32_TO_BUF(time_buf, current_time);
-        UINT64_TO_BUF(key_buf, LAST_CHECKIN_KEY);
-        state_set(SBUF(time_buf), SBUF(key_buf));
+        state_set(SBUF(time_buf), LAST_CHECKIN_KEY);
         DONE("Outgoing payment from hook account accepted, timer reset");
     }
 
     // Handle ttINVOKE for configuration or SEND
     if (tt == ttINVOKE)
     {
+        // The record, or while an upgraded install has none, the BA / BP
+        // keys it replaced, named like the commands
+        uint8_t cfg[MBC_CFG_SIZE] = {0};
+        if (!CFG_LOAD(cfg, MBC_CFG_SIZE))
+            for (int i = 0; GUARD(6), i < 6; ++i)
+                if (CFG_LEGACY(cfg + (i & 1 ? MBC_CFG_BP(i / 2) : MBC_CFG_BA(i / 2)), i & 1 ? 4 : 20,
+                               (uint32_t)mbc_commands[i], 8))
+                    cfg[MBC_CFG_MASK] |= 1U << i;
+
         if (BUFFER_EQUAL_20(hook_acc, otxn_acc))
         {
+            // Read every BAx / BPx the invoke carries in one pass; each
+            // complete pair is applied, so all three can be set at once
+            uint8_t* values[PARAM_COMMANDS(mbc_commands)];
+            int lens[PARAM_COMMANDS(mbc_commands)];
+            int rejected;
+            PARAM_COLLECT(mbc_commands, values, lens, rejected);
+            if (rejected)
+                NOPE("Unknown or malformed HookParameter");
+            for (int i = 0; GUARD(6), i < 6; ++i)
+                if (lens[i] >= 0 && lens[i] != (i & 1 ? 4 : 20))
+                    NOPE("BAx takes 20 bytes and BPx 4");
+            int applied = 0;
+
             // Check for BA1 and BP1 parameters
-            uint8_t ba_param[20];
-            uint8_t bp_param[4];
-            int has_ba1 = otxn_param(SBUF(ba_param), "BA1", 3) == 20;
-            int has_bp1 = otxn_param(SBUF(bp_param), "BP1", 3) == 4;
+            uint8_t* ba_param = values[CMD_BA1];
+            uint8_t* bp_param = values[CMD_BP1];
+            int has_ba1 = lens[CMD_BA1] == 20;
+            int has_bp1 = lens[CMD_BP1] == 4;
             if (has_ba1 && has_bp1)
             {
                 // Cap at 100%
@@ -116,13 +154,12 @@ int64_t hook(uint32_t reserved)
                 if (bp1_value > 100)
                     bp1_value = 100;
 
-                // Update buffer
-                UINT32_TO_BUF(bp_param, bp1_value);
-                UINT64_TO_BUF(key_buf, BA1_KEY);
-                state_set(SBUF(ba_param), SBUF(key_buf));
-                UINT64_TO_BUF(key_buf, BP1_KEY);
-                state_set(SBUF(bp_param), SBUF(key_buf));
-                DONE("BA1 and BP1 configured");
+                // Update record
+                ACCOUNT_TO_BUF(cfg + MBC_CFG_BA(0), ba_param);
+                UINT32_TO_BUF(cfg + MBC_CFG_BP(0), bp1_value);
+                cfg[MBC_CFG_MASK] |= 0x03U;
+                TRACESTR("BA1 and BP1 configured");
+                applied++;
             }
             else if (has_ba1 || has_bp1)
             {
@@ -130,38 +167,32 @@ int64_t hook(uint32_t reserved)
             }
 
             // Check for BA2 and BP2 parameters
-            int has_ba2 = otxn_param(SBUF(ba_param), "BA2", 3) == 20;
-            int has_bp2 = otxn_param(SBUF(bp_param), "BP2", 3) == 4;
+            ba_param = values[CMD_BA2];
+            bp_param = values[CMD_BP2];
+            int has_ba2 = lens[CMD_BA2] == 20;
+            int has_bp2 = lens[CMD_BP2] == 4;
             if (has_ba2 && has_bp2)
             {
                 // Check for duplicate with BA1
-                uint8_t existing_ba1[20];
-                UINT64_TO_BUF(key_buf, BA1_KEY);
-                if (state(SBUF(existing_ba1), SBUF(key_buf)) == 20)
-                {
-                    if (BUFFER_EQUAL_20(ba_param, existing_ba1))
-                        WARN("BA2 cannot match BA1");
-                }
+                if (MBC_SET(cfg, CMD_BA1) && BUFFER_EQUAL_20(ba_param, cfg + MBC_CFG_BA(0)))
+                    WARN("BA2 cannot match BA1");
 
                 // Check total with BP1
                 uint32_t bp2_value = UINT32_FROM_BUF(bp_param);
                 if (bp2_value > 100)
                     bp2_value = 100;
                 uint32_t total_percent = bp2_value;
-                uint8_t existing_bp1[4];
-                UINT64_TO_BUF(key_buf, BP1_KEY);
-                if (state(SBUF(existing_bp1), SBUF(key_buf)) == 4)
-                    total_percent += UINT32_FROM_BUF(existing_bp1);
+                if (MBC_SET(cfg, CMD_BP1))
+                    total_percent += UINT32_FROM_BUF(cfg + MBC_CFG_BP(0));
                 if (total_percent > 100)
                     WARN("Total beneficiary percentage cannot exceed 100%");
 
-                // Update buffer
-                UINT32_TO_BUF(bp_param, bp2_value);
-                UINT64_TO_BUF(key_buf, BA2_KEY);
-                state_set(SBUF(ba_param), SBUF(key_buf));
-                UINT64_TO_BUF(key_buf, BP2_KEY);
-                state_set(SBUF(bp_param), SBUF(key_buf));
-                DONE("BA2 and BP2 configured");
+                // Update record
+                ACCOUNT_TO_BUF(cfg + MBC_CFG_BA(1), ba_param);
+                UINT32_TO_BUF(cfg + MBC_CFG_BP(1), bp2_value);
+                cfg[MBC_CFG_MASK] |= 0x0CU;
+                TRACESTR("BA2 and BP2 configured");
+                applied++;
             }
             else if (has_ba2 || has_bp2)
             {
@@ -169,20 +200,16 @@ int64_t hook(uint32_t reserved)
             }
 
             // Check for BA3 and BP3 parameters
-            int has_ba3 = otxn_param(SBUF(ba_param), "BA3", 3) == 20;
-            int has_bp3 = otxn_param(SBUF(bp_param), "BP3", 3) == 4;
+            ba_param = values[CMD_BA3];
+            bp_param = values[CMD_BP3];
+            int has_ba3 = lens[CMD_BA3] == 20;
+            int has_bp3 = lens[CMD_BP3] == 4;
             if (has_ba3 && has_bp3)
             {
                 // Check for duplicates with BA1 and BA2
-                uint8_t existing_ba1[20];
-                uint8_t existing_ba2[20];
-                UINT64_TO_BUF(key_buf, BA1_KEY);
-                int has_existing_ba1 = (state(SBUF(existing_ba1), SBUF(key_buf)) == 20);
-                UINT64_TO_BUF(key_buf, BA2_KEY);
-                int has_existing_ba2 = (state(SBUF(existing_ba2), SBUF(key_buf)) == 20);
-                if (has_existing_ba1 && BUFFER_EQUAL_20(ba_param, existing_ba1))
+                if (MBC_SET(cfg, CMD_BA1) && BUFFER_EQUAL_20(ba_param, cfg + MBC_CFG_BA(0)))
                     WARN("BA3 cannot match BA1");
-                if (has_existing_ba2 && BUFFER_EQUAL_20(ba_param, existing_ba2))
+                if (MBC_SET(cfg, CMD_BA2) && BUFFER_EQUAL_20(ba_param, cfg + MBC_CFG_BA(1)))
                     WARN("BA3 cannot match BA2");
 
                 // Check total with BP1 and BP2
@@ -190,31 +217,30 @@ int64_t hook(uint32_t reserved)
                 if (bp3_value > 100)
                     bp3_value = 100;
                 uint32_t total_percent = bp3_value;
-                uint8_t existing_bp1[4];
-                uint8_t existing_bp2[4];
-                UINT64_TO_BUF(key_buf, BP1_KEY);
-                if (state(SBUF(existing_bp1), SBUF(key_buf)) == 4)
-                    total_percent += UINT32_FROM_BUF(existing_bp1);
-                UINT64_TO_BUF(key_buf, BP2_KEY);
-                if (state(SBUF(existing_bp2), SBUF(key_buf)) == 4)
-                    total_percent += UINT32_FROM_BUF(existing_bp2);
+                if (MBC_SET(cfg, CMD_BP1))
+                    total_percent += UINT32_FROM_BUF(cfg + MBC_CFG_BP(0));
+                if (MBC_SET(cfg, CMD_BP2))
+                    total_percent += UINT32_FROM_BUF(cfg + MBC_CFG_BP(1));
                 if (total_percent > 100)
                     WARN("Total beneficiary percentage cannot exceed 100%");
 
-                // Update buffer
-                UINT32_TO_BUF(bp_param, bp3_value);
-                UINT64_TO_BUF(key_buf, BA3_KEY);
-                state_set(SBUF(ba_param), SBUF(key_buf));
-                UINT64_TO_BUF(key_buf, BP3_KEY);
-                state_set(SBUF(bp_param), SBUF(key_buf));
-                DONE("BA3 and BP3 configured");
+                // Update record
+                ACCOUNT_TO_BUF(cfg + MBC_CFG_BA(2), ba_param);
+                UINT32_TO_BUF(cfg + MBC_CFG_BP(2), bp3_value);
+                cfg[MBC_CFG_MASK] |= 0x30U;
+                TRACESTR("BA3 and BP3 configured");
+                applied++;
             }
             else if (has_ba3 || has_bp3)
             {
                 NOPE("BA3 and BP3 must be submitted together");
             }
 
-            WARN("No valid configuration parameters, submit BAx and BPx pairs");
+            if (!applied)
+                WARN("No valid configuration parameters, submit BAx and BPx pairs");
+            if (CFG_SAVE(cfg, MBC_CFG_SIZE, MBC_CFG_VERSION) < 0)
+                NOPE("Failed to store beneficiaries");
+            DONE("Beneficiaries configured");
         }
 
         // Delegate invokes SEND to distribute balance (only if threshold exceeded)
@@ -224,10 +250,9 @@ int64_t hook(uint32_t reserved)
             if (otxn_param(SBUF(send_param), "SEND", 4) == 1)
             {
                 // Load last outgoing time
-                UINT64_TO_BUF(key_buf, LAST_CHECKIN_KEY);
                 uint8_t last_checkin_buf[4];
                 uint32_t last_checkin = 0;
-                if (state(SBUF(last_checkin_buf), SBUF(key_buf)) == 4)
+                if (state(SBUF(last_checkin_buf), LAST_CHECKIN_KEY) == 4)
                     last_checkin = UINT32_FROM_BUF(last_checkin_buf);
 
                 // Get current time
@@ -241,19 +266,17 @@ int64_t hook(uint32_t reserved)
                     SET_TIME_MSG(remaining);
                 }
 
-                // Load beneficiaries and percentages
+                // Beneficiaries and percentages come from the record
                 uint8_t beneficiary_accounts[3][20];
                 uint32_t beneficiary_percentages[3];
                 int configured_accounts = 0;
 
-                // Load BA1/BP1
-                UINT64_TO_BUF(key_buf, BA1_KEY);
-                if (state(SBUF(beneficiary_accounts[0]), SBUF(key_buf)) == 20)
+                // BA1/BP1
+                if (MBC_SET(cfg, CMD_BA1))
                 {
-                    UINT64_TO_BUF(key_buf, BP1_KEY);
-                    uint8_t bp_data[4];
-                    if (state(SBUF(bp_data), SBUF(key_buf)) == 4)
-                        beneficiary_percentages[0] = UINT32_FROM_BUF(bp_data);
+                    ACCOUNT_TO_BUF(beneficiary_accounts[0], cfg + MBC_CFG_BA(0));
+                    if (MBC_SET(cfg, CMD_BP1))
+                        beneficiary_percentages[0] = UINT32_FROM_BUF(cfg + MBC_CFG_BP(0));
                     else
                         beneficiary_percentages[0] = 100;
                     configured_accounts++;
@@ -262,14 +285,12 @@ int64_t hook(uint32_t reserved)
                     TRACEVAR(beneficiary_percentages[0]);
                 }
 
-                // Load BA2/BP2
-                UINT64_TO_BUF(key_buf, BA2_KEY);
-                if (state(SBUF(beneficiary_accounts[1]), SBUF(key_buf)) == 20)
+                // BA2/BP2
+                if (MBC_SET(cfg, CMD_BA2))
                 {
-                    UINT64_TO_BUF(key_buf, BP2_KEY);
-                    uint8_t bp_data[4];
-                    if (state(SBUF(bp_data), SBUF(key_buf)) == 4)
-                        beneficiary_percentages[1] = UINT32_FROM_BUF(bp_data);
+                    ACCOUNT_TO_BUF(beneficiary_accounts[1], cfg + MBC_CFG_BA(1));
+                    if (MBC_SET(cfg, CMD_BP2))
+                        beneficiary_percentages[1] = UINT32_FROM_BUF(cfg + MBC_CFG_BP(1));
                     else
                         WARN("BP2 missing for multiple accounts");
                     configured_accounts++;
@@ -278,14 +299,12 @@ int64_t hook(uint32_t reserved)
                     TRACEVAR(beneficiary_percentages[1]);
                 }
 
-                // Load BA3/BP3
-                UINT64_TO_BUF(key_buf, BA3_KEY);
-                if (state(SBUF(beneficiary_accounts[2]), SBUF(key_buf)) == 20)
+                // BA3/BP3
+                if (MBC_SET(cfg, CMD_BA3))
                 {
-                    UINT64_TO_BUF(key_buf, BP3_KEY);
-                    uint8_t bp_data[4];
-                    if (state(SBUF(bp_data), SBUF(key_buf)) == 4)
-                        beneficiary_percentages[2] = UINT32_FROM_BUF(bp_data);
+                    ACCOUNT_TO_BUF(beneficiary_accounts[2], cfg + MBC_CFG_BA(2));
+                    if (MBC_SET(cfg, CMD_BP3))
+                        beneficiary_percentages[2] = UINT32_FROM_BUF(cfg + MBC_CFG_BP(2));
                     else
                         WARN("BP3 missing for multiple accounts");
                     configured_accounts++;
@@ -22,11 +22,15 @@
 //**************************************************************
 
 #include "hookapi.h"
-
-#define DONE(x) accept(SBUF("MBTC:: Success :: " x), __LINE__)
-#define WARN(x) rollback(SBUF("MBTC:: Warning :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("MBTC:: Error :: " x), __LINE__)
-#define COMP(x) rollback(SBUF("MBTC:: Complete :: " x), __LINE__)
+#include "../../../Common/BuildProfile.h"
+#include "../../../Common/StateKey.h"
+#include "../../../Common/ResultCode.h"
+
+#define HOOK_RESULT_ID RC_MULTIBENEFICIARYTHRESHOLD
+#define DONE(x) RESULT_ACCEPT("MBTC:: Success :: " x)
+#define WARN(x) RESULT_ROLLBACK("MBTC:: Warning :: " x)
+#define NOPE(x) RESULT_ROLLBACK("MBTC:: Error :: " x)
+#define COMP(x) RESULT_ROLLBACK("MBTC:: Complete :: " x)
 uint8_t msg_buf[67] = "MBTC:: Error :: You must wait 00000000 seconds before triggering.";
 
 #define SET_TIME_MSG(remaining_seconds)                            \
@@ -43,21 +47,18 @@ uint8_t msg_buf[67] = "MBTC:: Error :: You must wait 00000000 seconds before tri
     }
 
 // State keys for beneficiary accounts and percentages
-#define BA1_KEY 0x4241310000000000ULL // "BA1"
-#define BP1_KEY 0x4250310000000000ULL // "BP1"
-#define BA2_KEY 0x4241320000000000ULL // "BA2"
-#define BP2_KEY 0x4250320000000000ULL // "BP2"
-#define BA3_KEY 0x4241330000000000ULL // "BA3"
-#define BP3_KEY 0x4250330000000000ULL // "BP3"
-#define LAST_CHECKIN_KEY 0x4C41535443484543ULL
+#define BA1_KEY SKEY_PAD("BA1", 8)
+#define BP1_KEY SKEY_PAD("BP1", 8)
+#define BA2_KEY SKEY_PAD("BA2", 8)
+#define BP2_KEY SKEY_PAD("BP2", 8)
+#define BA3_KEY SKEY_PAD("BA3", 8)
+#define BP3_KEY SKEY_PAD("BP3", 8)
+#define LAST_CHECKIN_KEY SKEY_PAD("LASTCHEC", 8)
 
 int64_t hook(uint32_t reserved)
 {
     TRACESTR("MBTC :: Multi Beneficiary Threshold Contract :: Called");
 
-    // Declare key_buf
-    uint8_t key_buf[8];
-
     // Get the Hook account
     uint8_t hook_acc[20];
     hook_account(SBUF(hook_acc));
@@ -81,8 +82,7 @@ int64_t hook(uint32_t reserved)
         uint32_t current_time = (uint32_t)ledger_last_time();
         uint8_t time_buf[4];
         UINT32_TO_BUF(time_buf, current_time);
-        UINT64_TO_BUF(key_buf, LAST_CHECKIN_KEY);
-        state_set(SBUF(time_buf), SBUF(key_buf));
+        state_set(SBUF(time_buf), LAST_CHECKIN_KEY);
         DONE("Outgoing payment from hook account accepted, timer reset");
     }
 
@@ -103,10 +103,8 @@ int64_t hook(uint32_t reserved)
             
             // Update buffer
             UINT32_TO_BUF(bp_param, bp1_value);
-            UINT64_TO_BUF(key_buf, BA1_KEY);
-            state_set(SBUF(ba_param), SBUF(key_buf));
-            UINT64_TO_BUF(key_buf, BP1_KEY);
-            state_set(SBUF(bp_param), SBUF(key_buf));
+            state_set(SBUF(ba_param), BA1_KEY);
+            state_set(SBUF(bp_param), BP1_KEY);
             DONE("BA1 and BP1 configured");
         }
         else if (has_ba1 || has_bp1)
@@ -121,8 +119,7 @@ int64_t hook(uint32_t reserved)
         {
             // Check for duplicate with BA1
             uint8_t existing_ba1[20];
-            UINT64_TO_BUF(key_buf, BA1_KEY);
-            if (state(SBUF(existing_ba1), SBUF(key_buf)) == 20)
+            if (state(SBUF(existing_ba1), BA1_KEY) == 20)
             {
                 if (BUFFER_EQUAL_20(ba_param, existing_ba1))
                     WARN("BA2 cannot match BA1");
@@ -133,18 +130,15 @@ int64_t hook(uint32_t reserved)
                 bp2_value = 100;
             uint32_t total_percent = bp2_value;
             uint8_t existing_bp1[4];
-            UINT64_TO_BUF(key_buf, BP1_KEY);
-            if (state(SBUF(existing_bp1), SBUF(key_buf)) == 4)
+            if (state(SBUF(existing_bp1), BP1_KEY) == 4)
                 total_percent += UINT32_FROM_BUF(existing_bp1);
             if (total_percent > 100)
                 WARN("Total beneficiary percentage cannot exceed 100%");
 
             // Update buffer
             UINT32_TO_BUF(bp_param, bp2_value);
-            UINT64_TO_BUF(key_buf, BA2_KEY);
-            state_set(SBUF(ba_param), SBUF(key_buf));
-            UINT64_TO_BUF(key_buf, BP2_KEY);
-            state_set(SBUF(bp_param), SBUF(key_buf));
+            state_set(SBUF(ba_param), BA2_KEY);
+            state_set(SBUF(bp_param), BP2_KEY);
             DONE("BA2 and BP2 configured");
         }
         else if (has_ba2 || has_bp2)
@@ -160,10 +154,8 @@ int64_t hook(uint32_t reserved)
             // Check for duplicates with BA1 and BA2
             uint8_t existing_ba1[20];
             uint8_t existing_ba2[20];
-            UINT64_TO_BUF(key_buf, BA1_KEY);
-            int has_existing_ba1 = (state(SBUF(existing_ba1), SBUF(key_buf)) == 20);
-            UINT64_TO_BUF(key_buf, BA2_KEY);
-            int has_existing_ba2 = (state(SBUF(existing_ba2), SBUF(key_buf)) == 20);
+            int has_existing_ba1 = (state(SBUF(existing_ba1), BA1_KEY) == 20);
+            int has_existing_ba2 = (state(SBUF(existing_ba2), BA2_KEY) == 20);
             if (has_existing_ba1 && BUFFER_EQUAL_20(ba_param, existing_ba1))
                 WARN("BA3 cannot match BA1");
             if (has_existing_ba2 && BUFFER_EQUAL_20(ba_param, existing_ba2))
@@ -176,21 +168,17 @@ int64_t hook(uint32_t reserved)
             uint32_t total_percent = bp3_value;
             uint8_t existing_bp1[4];
             uint8_t existing_bp2[4];
-            UINT64_TO_BUF(key_buf, BP1_KEY);
-            if (state(SBUF(existing_bp1), SBUF(key_buf)) == 4)
+            if (state(SBUF(existing_bp1), BP1_KEY) == 4)
                 total_percent += UINT32_FROM_BUF(existing_bp1);
-            UINT64_TO_BUF(key_buf, BP2_KEY);
-            if (state(SBUF(existing_bp2), SBUF(key_buf)) == 4)
+            if (state(SBUF(existing_bp2), BP2_KEY) == 4)
                 total_percent += UINT32_FROM_BUF(existing_bp2);
             if (total_percent > 100)
                 WARN("Total beneficiary percentage cannot exceed 100%");
 
             // Update buffer
             UINT32_TO_BUF(bp_param, bp3_value);
-            UINT64_TO_BUF(key_buf, BA3_KEY);
-            state_set(SBUF(ba_param), SBUF(key_buf));
-            UINT64_TO_BUF(key_buf, BP3_KEY);
-            state_set(SBUF(bp_param), SBUF(key_buf));
+            state_set(SBUF(ba_param), BA3_KEY);
+            state_set(SBUF(bp_param), BP3_KEY);
             DONE("BA3 and BP3 configured");
         }
         else if (has_ba3 || has_bp3)
@@ -205,10 +193,9 @@ int64_t hook(uint32_t reserved)
     if (tt == ttINVOKE && !BUFFER_EQUAL_20(hook_acc, otxn_acc))
     {
         // Load last outgoing time
-        UINT64_TO_BUF(key_buf, LAST_CHECKIN_KEY);
         uint8_t last_checkin_buf[4];
         uint32_t last_checkin = 0;
-        if (state(SBUF(last_checkin_buf), SBUF(key_buf)) == 4)
+        if (state(SBUF(last_checkin_buf), LAST_CHECKIN_KEY) == 4)
             last_checkin = UINT32_FROM_BUF(last_checkin_buf);
 
         // Get current time
@@ -228,12 +215,10 @@ int64_t hook(uint32_t reserved)
         int configured_accounts = 0;
 
         // Load BA1/BP1
-        UINT64_TO_BUF(key_buf, BA1_KEY);
-        if (state(SBUF(beneficiary_accounts[0]), SBUF(key_buf)) == 20)
+        if (state(SBUF(beneficiary_accounts[0]), BA1_KEY) == 20)
         {
-            UINT64_TO_BUF(key_buf, BP1_KEY);
             uint8_t bp_data[4];
-            if (state(SBUF(bp_data), SBUF(key_buf)) == 4)
+            if (state(SBUF(bp_data), BP1_KEY) == 4)
                 beneficiary_percentages[0] = UINT32_FROM_BUF(bp_data);
             else
                 beneficiary_percentages[0] = 100;
@@ -244,12 +229,10 @@ int64_t hook(uint32_t reserved)
         }
 
         // Load BA2/BP2
-        UINT64_TO_BUF(key_buf, BA2_KEY);
-        if (state(SBUF(beneficiary_accounts[1]), SBUF(key_buf)) == 20)
+        if (state(SBUF(beneficiary_accounts[1]), BA2_KEY) == 20)
         {
-            UINT64_TO_BUF(key_buf, BP2_KEY);
             uint8_t bp_data[4];
-            if (state(SBUF(bp_data), SBUF(key_buf)) == 4)
+            if (state(SBUF(bp_data), BP2_KEY) == 4)
                 beneficiary_percentages[1] = UINT32_FROM_BUF(bp_data);
             else
                 WARN("BP2 missing for multiple accounts");
@@ -260,12 +243,10 @@ int64_t hook(uint32_t reserved)
         }
 
         // Load BA3/BP3
-        UINT64_TO_BUF(key_buf, BA3_KEY);
-        if (state(SBUF(beneficiary_accounts[2]), SBUF(key_buf)) == 20)
+        if (state(SBUF(beneficiary_accounts[2]), BA3_KEY) == 20)
         {
-            UINT64_TO_BUF(key_buf, BP3_KEY);
             uint8_t bp_data[4];
-            if (state(SBUF(bp_data), SBUF(key_buf)) == 4)
+            if (state(SBUF(bp_data), BP3_KEY) == 4)
                 beneficiary_percentages[2] = UINT32_FROM_BUF(bp_data);
             }
             else
@@ -16,11 +16,14 @@
 //**************************************************************
 
 #include "hookapi.h"
-
-#define DONE(x) accept(SBUF("SBDC:: Success :: " x), __LINE__)
-#define WARN(x) rollback(SBUF("SBDC:: Warning :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("SBDC:: Error :: " x), __LINE__)
-#define COMP(x) rollback(SBUF("SBDC:: Complete :: " x), __LINE__)
+#include "../../../Common/BuildProfile.h"
+#include "../../../Common/ResultCode.h"
+
+#define HOOK_RESULT_ID RC_SINGLEBENEFICIARYDELEGATE
+#define DONE(x) RESULT_ACCEPT("SBDC:: Success :: " x)
+#define WARN(x) RESULT_ROLLBACK("SBDC:: Warning :: " x)
+#define NOPE(x) RESULT_ROLLBACK("SBDC:: Error :: " x)
+#define COMP(x) RESULT_ROLLBACK("SBDC:: Complete :: " x)
 
 int64_t hook(uint32_t reserved)
 {
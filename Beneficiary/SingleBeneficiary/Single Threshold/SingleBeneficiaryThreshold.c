@@ -14,11 +14,15 @@
 //**************************************************************
 
 #include "hookapi.h"
-
-#define DONE(x) accept(SBUF("SBTC:: Success :: " x), __LINE__)
-#define WARN(x) rollback(SBUF("SBTC:: Warning :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("SBTC:: Error :: " x), __LINE__)
-#define COMP(x) rollback(SBUF("SBTC:: Complete :: " x), __LINE__)
+#include "../../../Common/BuildProfile.h"
+#include "../../../Common/StateKey.h"
+#include "../../../Common/ResultCode.h"
+
+#define HOOK_RESULT_ID RC_SINGLEBENEFICIARYTHRESHOLD
+#define DONE(x) RESULT_ACCEPT("SBTC:: Success :: " x)
+#define WARN(x) RESULT_ROLLBACK("SBTC:: Warning :: " x)
+#define NOPE(x) RESULT_ROLLBACK("SBTC:: Error :: " x)
+#define COMP(x) RESULT_ROLLBACK("SBTC:: Complete :: " x)
 uint8_t msg_buf[68] = "SBTC:: Error :: You must wait 00000000  seconds before triggering.";
 
 #define SET_TIME_MSG(remaining_seconds)                            \
@@ -34,7 +38,7 @@ uint8_t msg_buf[68] = "SBTC:: Error :: You must wait 00000000  seconds before tr
         rollback((uint32_t)msg_buf, sizeof(msg_buf), __LINE__);    \
     }
 
-#define LAST_CHECKIN_KEY 0x4C41535443484543ULL
+#define LAST_CHECKIN_KEY SKEY_PAD("LASTCHEC", 8)
 
 int64_t hook(uint32_t reserved)
 {
@@ -69,9 +73,7 @@ int64_t hook(uint32_t reserved)
         uint32_t current_time = (uint32_t)ledger_last_time();
         uint8_t time_buf[4];
         UINT32_TO_BUF(time_buf, current_time);
-        uint8_t key_buf[8];
-        UINT64_TO_BUF(key_buf, LAST_CHECKIN_KEY);
-        state_set(SBUF(time_buf), SBUF(key_buf));
+        state_set(SBUF(time_buf), LAST_CHECKIN_KEY);
         DONE("Outgoing payment from hook account accepted, timer reset");
     }
 
@@ -79,11 +81,9 @@ int64_t hook(uint32_t reserved)
     if ((tt == ttPAYMENT || tt == ttINVOKE) && !BUFFER_EQUAL_20(hook_acc, otxn_acc))
     {
         // Load last outgoing time
-        uint8_t key_buf[8];
-        UINT64_TO_BUF(key_buf, LAST_CHECKIN_KEY);
         uint8_t last_checkin_buf[4];
         uint32_t last_checkin = 0;
-        if (state(SBUF(last_checkin_buf), SBUF(key_buf)) == 4)
+        if (state(SBUF(last_checkin_buf), LAST_CHECKIN_KEY) == 4)
             last_checkin = UINT32_FROM_BUF(last_checkin_buf);
 
         // Get current time
@@ -18,6 +18,8 @@
 //   'ADD_BLACKLIST' (20 bytes): Add account ID to blacklist
 //   'REMOVE_BLACKLIST' (20 bytes): Remove account ID from blacklist
 //   'CHECK_BLACKLIST' (20 bytes): Query blacklist status of account
+//   One invoke may carry several; they are applied in order. An unknown
+//   parameter or a value of the wrong size rejects the whole invoke.
 //
 // Integration:
 //   Other hooks can check blacklist status by calling:
@@ -32,22 +34,25 @@
 //**************************************************************
 
 #include "hookapi.h"
-
-#define DONE(x) accept(SBUF("BPH:: Success :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("BPH:: Error :: " x), __LINE__)
+#include "../../Common/BuildProfile.h"
+#include "../../Common/ParamDispatch.h"
+#include "../../Common/UserRecord.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
+
+#define HOOK_RESULT_ID RC_BLACKLISTPROVIDER
+#define DONE(x) RESULT_ACCEPT("BPH:: Success :: " x)
+#define NOPE(x) RESULT_ROLLBACK("BPH:: Error :: " x)
 #define GUARD(maxiter) _g(__LINE__, (maxiter) + 1)
 
-#define UINT64_TO_BUF(buf, i)         \
-    {                                 \
-        (buf)[0] = (i >> 56) & 0xFFU; \
-        (buf)[1] = (i >> 48) & 0xFFU; \
-        (buf)[2] = (i >> 40) & 0xFFU; \
-        (buf)[3] = (i >> 32) & 0xFFU; \
-        (buf)[4] = (i >> 24) & 0xFFU; \
-        (buf)[5] = (i >> 16) & 0xFFU; \
-        (buf)[6] = (i >> 8) & 0xFFU;  \
-        (buf)[7] = i & 0xFFU;         \
-    }
+// Admin commands, in PARAM_NEXT table order
+static const uint8_t bph_commands[][PARAM_NAME_SIZE] = {"ADD_BLACKLIST", "REMOVE_BLACKLIST", "CHECK_BLACKLIST"};
+#define CMD_ADD_BLACKLIST 0
+#define CMD_REMOVE_BLACKLIST 1
+#define CMD_CHECK_BLACKLIST 2
+
+// Per-account blacklist flag, stored under a 32-byte key in the account's namespace
+#define BLACKLIST_KEY SKEY_PTR("BLACKLISTED")
 
 int64_t hook(uint32_t reserved)
 {
@@ -71,88 +76,62 @@ int64_t hook(uint32_t reserved)
         if (!BUFFER_EQUAL_20(otxn_acc, hook_acc))
             NOPE("Only hook owner can manage blacklist settings");
 
-        // Add account to blacklist
-        uint8_t add_blacklist_param[20];
-        uint8_t add_blacklist_key[13] = {'A', 'D', 'D', '_', 'B', 'L', 'A', 'C', 'K', 'L', 'I', 'S', 'T'};
-        int8_t is_add_blacklist = otxn_param(SBUF(add_blacklist_param), add_blacklist_key, 13);
-        if (is_add_blacklist == 20)
+        // One pass over the invoke's HookParameters: every ADD, REMOVE and
+        // CHECK it carries is applied in the order given
+        int applied = 0;
+        int checked = -1;
+        PARAM_LOAD(params, params_len);
+        if (params_len < 0)
+            NOPE("HookParameters could not be read");
+        uint8_t* cursor = params;
+        for (int i = 0; GUARD(PARAM_MAX), i < PARAM_MAX && cursor < params + params_len; ++i)
         {
-            // Generate account-specific namespace from the account ID
-            uint8_t account_namespace[32];
-            for (int i = 0; GUARD(20), i < 20; ++i)
-                account_namespace[i] = add_blacklist_param[i];
-            for (int i = 20; GUARD(32), i < 32; ++i)
-                account_namespace[i] = 0;
-
-            // Simple state key for blacklist data
-            uint8_t blacklist_key_data[32] = "BLACKLISTED";
-            for (int i = 11; GUARD(32), i < 32; ++i)
-                blacklist_key_data[i] = 0;
-
-            // Set blacklisted flag (1 byte = 0x01)
-            uint8_t blacklisted_flag[1] = {0x01};
-            if (state_foreign_set(SBUF(blacklisted_flag), SBUF(blacklist_key_data),
-                                  SBUF(account_namespace), SBUF(hook_acc)) != 1)
-                NOPE("Failed to add account to blacklist");
-
-            DONE("Account added to blacklist successfully");
-        }
+            int cmd;
+            uint8_t* value;
+            int value_len;
+            PARAM_NEXT(cursor, params + params_len, bph_commands, cmd, value, value_len);
+            if (cmd < 0)
+                NOPE("Unknown or malformed HookParameter");
+            if (value_len != 20)
+                NOPE("Account ID must be 20 bytes");
 
-        // Remove account from blacklist
-        uint8_t remove_blacklist_param[20];
-        uint8_t remove_blacklist_key[16] = {'R', 'E', 'M', 'O', 'V', 'E', '_', 'B', 'L', 'A', 'C', 'K', 'L', 'I', 'S', 'T'};
-        int8_t is_remove_blacklist = otxn_param(SBUF(remove_blacklist_param), remove_blacklist_key, 16);
-        if (is_remove_blacklist == 20)
-        {
             // Generate account-specific namespace from the account ID
-            uint8_t account_namespace[32];
-            for (int i = 0; GUARD(20), i < 20; ++i)
-                account_namespace[i] = remove_blacklist_param[i];
-            for (int i = 20; GUARD(32), i < 32; ++i)
-                account_namespace[i] = 0;
-
-            // Simple state key for blacklist data
-            uint8_t blacklist_key_data[32] = "BLACKLISTED";
-            for (int i = 11; GUARD(32), i < 32; ++i)
-                blacklist_key_data[i] = 0;
-
-            // Remove blacklisted flag by setting empty state
-            if (state_foreign_set(0, 0, SBUF(blacklist_key_data),
-                                  SBUF(account_namespace), SBUF(hook_acc)) < 0)
-                NOPE("Failed to remove account from blacklist");
-
-            DONE("Account removed from blacklist successfully");
-        }
+            uint8_t account_namespace[USER_NS_SIZE];
+            USER_NAMESPACE(account_namespace, value);
 
-        // Check blacklist status (query command)
-        uint8_t check_blacklist_param[20];
-        uint8_t check_blacklist_key[15] = {'C', 'H', 'E', 'C', 'K', '_', 'B', 'L', 'A', 'C', 'K', 'L', 'I', 'S', 'T'};
-        int8_t is_check_blacklist = otxn_param(SBUF(check_blacklist_param), check_blacklist_key, 15);
-        if (is_check_blacklist == 20)
-        {
-            // Generate account-specific namespace from the account ID
-            uint8_t account_namespace[32];
-            for (int i = 0; GUARD(20), i < 20; ++i)
-                account_namespace[i] = check_blacklist_param[i];
-            for (int i = 20; GUARD(32), i < 32; ++i)
-                account_namespace[i] = 0;
-
-            // Simple state key for blacklist data
-            uint8_t blacklist_key_data[32] = "BLACKLISTED";
-            for (int i = 11; GUARD(32), i < 32; ++i)
-                blacklist_key_data[i] = 0;
-
-            // Check if account is blacklisted
-            uint8_t blacklist_status[1];
-            int64_t blacklist_result = state_foreign(SBUF(blacklist_status), SBUF(blacklist_key_data),
-                                                     SBUF(account_namespace), SBUF(hook_acc));
-
-            if (blacklist_result == 1 && blacklist_status[0] == 0x01)
-                DONE("Account is blacklisted");
+            // Blacklisted flag (1 byte = 0x01)
+            uint8_t blacklisted_flag[1] = {0x01};
+            if (cmd == CMD_ADD_BLACKLIST)
+            {
+                if (USER_FLUSH(blacklisted_flag, 1, BLACKLIST_KEY, 32,
+                               account_namespace, hook_acc, 1) != 1)
+                    NOPE("Failed to add account to blacklist");
+                applied++;
+            }
+            else if (cmd == CMD_REMOVE_BLACKLIST)
+            {
+                // Remove blacklisted flag by setting empty state
+                if (USER_FLUSH(blacklisted_flag, 0, BLACKLIST_KEY, 32,
+                               account_namespace, hook_acc, 1) < 0)
+                    NOPE("Failed to remove account from blacklist");
+                applied++;
+            }
             else
-                DONE("Account is not blacklisted");
+            {
+                // Check if account is blacklisted; the last CHECK is reported
+                uint8_t blacklist_status[1];
+                int64_t blacklist_result = USER_LOAD(blacklist_status, BLACKLIST_KEY, 32,
+                                                     account_namespace, hook_acc);
+                checked = blacklist_result == 1 && blacklist_status[0] == 0x01;
+            }
         }
 
+        if (checked == 1)
+            DONE("Account is blacklisted");
+        if (checked == 0)
+            DONE("Account is not blacklisted");
+        if (applied)
+            DONE("Blacklist updated successfully");
         DONE("No valid blacklist parameters provided");
     }
 
@@ -160,21 +139,13 @@ int64_t hook(uint32_t reserved)
     if (tt == ttPAYMENT)
     {
         // Generate account-specific namespace from the otxn account ID
-        uint8_t account_namespace[32];
-        for (int i = 0; GUARD(20), i < 20; ++i)
-            account_namespace[i] = otxn_acc[i];
-        for (int i = 20; GUARD(32), i < 32; ++i)
-            account_namespace[i] = 0;
-
-        // Simple state key for blacklist data
-        uint8_t blacklist_key_data[32] = "BLACKLISTED";
-        for (int i = 11; GUARD(32), i < 32; ++i)
-            blacklist_key_data[i] = 0;
+        uint8_t account_namespace[USER_NS_SIZE];
+        USER_NAMESPACE(account_namespace, otxn_acc);
 
         // Check if account is blacklisted
         uint8_t blacklist_status[1];
-        int64_t blacklist_result = state_foreign(SBUF(blacklist_status), SBUF(blacklist_key_data),
-                                                 SBUF(account_namespace), SBUF(hook_acc));
+        int64_t blacklist_result = USER_LOAD(blacklist_status, BLACKLIST_KEY, 32,
+                                             account_namespace, hook_acc);
 
         if (blacklist_result == 1 && blacklist_status[0] == 0x01)
             NOPE("Transaction rejected: Account is blacklisted");
@@ -25,33 +25,37 @@
 // Storage Structure:
 //   - Blacklist flag: Stored with key "BLKLST" (0=off, 1=on)
 //   - Provider account: Stored with key "PROVIDER" (20 bytes)
+//   - Accrued service fee: Stored with key "FEEACCRU" (12 bytes)
 //
 // Service Fee:
-//   - A service fee of 0.05 XAH is charged per processed transaction
+//   - A service fee of 0.05 XAH is charged per processed transaction,
+//     accrued in state and paid out in one payment per settlement
+//   - Hook parameters FEE_SETTLE / FEE_LEDGERS set when it settles
 //**************************************************************
 
 #include "hookapi.h"
-
-#define DONE(x) accept(SBUF("BTH:: Success :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("BTH:: Error :: " x), __LINE__)
+#include "../../Common/BuildProfile.h"
+#include "../../Common/FeeAccrual.h"
+#include "../../Common/UserRecord.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
+
+#define HOOK_RESULT_ID RC_BLACKLISTTRUSTEE
+#define DONE(x) RESULT_ACCEPT("BTH:: Success :: " x)
+#define NOPE(x) RESULT_ROLLBACK("BTH:: Error :: " x)
 #define GUARD(maxiter) _g(__LINE__, (maxiter) + 1)
 
-#define UINT64_TO_BUF(buf, i)         \
-    {                                 \
-        (buf)[0] = (i >> 56) & 0xFFU; \
-        (buf)[1] = (i >> 48) & 0xFFU; \
-        (buf)[2] = (i >> 40) & 0xFFU; \
-        (buf)[3] = (i >> 32) & 0xFFU; \
-        (buf)[4] = (i >> 24) & 0xFFU; \
-        (buf)[5] = (i >> 16) & 0xFFU; \
-        (buf)[6] = (i >> 8) & 0xFFU;  \
-        (buf)[7] = i & 0xFFU;         \
-    }
-
 // provider service fee account
 static uint8_t service_fee_acc[20] = {0xA6U, 0xFEU, 0xA2U, 0x10U, 0xA7U, 0x4AU, 0xFFU, 0xA8U, 0x77U, 0xA8U, 0xB5U, 0x53U, 0x8AU, 0xFAU, 0xC4U, 0x89U, 0x61U, 0xF6U, 0xFCU, 0x86U};
 #define SERVICE_FEE_DROPS 50000
 
+// Configuration keys: the blacklist on/off flag and the provider account
+#define BLACKLIST_FLAG_KEY SKEY_PAD("\0BLKLST", 8)
+#define PROVIDER_KEY SKEY_PAD("PROVIDER", 8)
+
+// Per-account blacklist flag, stored under a 32-byte key in the account's namespace
+#define BLACKLIST_KEY SKEY_PTR("BLACKLISTED")
+
 int64_t hook(uint32_t reserved)
 {
     TRACESTR("BTH:: Blacklist Trustee Hook :: Called.");
@@ -67,15 +71,6 @@ int64_t hook(uint32_t reserved)
 
     int64_t tt = otxn_type();
 
-    // State keys for configuration
-    uint64_t blacklist_num = 0x00424C4B4C535400; // 'BLKLST' (flag)
-    uint8_t blacklist_buf[8];
-    UINT64_TO_BUF(blacklist_buf, blacklist_num);
-
-    uint64_t provider_num = 0x50524F5649444552; // 'PROVIDER'
-    uint8_t provider_buf[8];
-    UINT64_TO_BUF(provider_buf, provider_num);
-
     // Process ttINVOKE transactions for configuration
     if (tt == 99)
     {
@@ -85,13 +80,12 @@ int64_t hook(uint32_t reserved)
 
         // BLACKLIST on/off toggle
         uint8_t blacklist_param[1];
-        uint8_t blacklist_key[9] = {'B', 'L', 'A', 'C', 'K', 'L', 'I', 'S', 'T'};
-        int8_t is_blacklist = otxn_param(SBUF(blacklist_param), blacklist_key, 9);
+        int8_t is_blacklist = otxn_param(SBUF(blacklist_param), "BLACKLIST", 9);
         if (is_blacklist > 0)
         {
             if (blacklist_param[0] > 1)
                 NOPE("BLACKLIST must be 0 or 1");
-            if (state_set(SBUF(blacklist_param), SBUF(blacklist_buf)) < 0)
+            if (state_set(SBUF(blacklist_param), BLACKLIST_FLAG_KEY) < 0)
                 NOPE("Failed to set BLACKLIST state");
             TRACEVAR(blacklist_param[0]);
             DONE("BLACKLIST state toggled successfully");
@@ -99,11 +93,10 @@ int64_t hook(uint32_t reserved)
 
         // Set blacklist provider account
         uint8_t provider_param[20];
-        uint8_t provider_key[12] = {'P', 'R', 'O', 'V', 'I', 'D', 'E', 'R', '_', 'A', 'C', 'C'};
-        int8_t is_provider = otxn_param(SBUF(provider_param), provider_key, 12);
+        int8_t is_provider = otxn_param(SBUF(provider_param), "PROVIDER_ACC", 12);
         if (is_provider == 20)
         {
-            if (state_set(SBUF(provider_param), SBUF(provider_buf)) != 20)
+            if (state_set(SBUF(provider_param), PROVIDER_KEY) != 20)
                 NOPE("Failed to set provider account");
             DONE("Blacklist provider account configured successfully");
         }
@@ -124,7 +117,7 @@ int64_t hook(uint32_t reserved)
 
         // Load blacklist flag
         uint8_t blacklist_flag;
-        int64_t flag_result = state(SBUF(&blacklist_flag), SBUF(blacklist_buf));
+        int64_t flag_result = state(SBUF(&blacklist_flag), BLACKLIST_FLAG_KEY);
         TRACEVAR(flag_result);
 
         if (flag_result < 0)
@@ -140,32 +133,22 @@ int64_t hook(uint32_t reserved)
 
             // Load provider account
             uint8_t provider_acc[20];
-            int64_t provider_result = state(SBUF(provider_acc), SBUF(provider_buf));
+            int64_t provider_result = state(SBUF(provider_acc), PROVIDER_KEY);
             TRACEVAR(provider_result);
 
             if (provider_result != 20)
                 NOPE("Blacklist provider account not configured - use PROVIDER_ACC parameter");
 
             // Generate account-specific namespace from the otxn account ID
-            uint8_t account_namespace[32];
-            for (int i = 0; GUARD(20), i < 20; ++i)
-                account_namespace[i] = otxn_acc[i];
-            for (int i = 20; GUARD(32), i < 32; ++i)
-                account_namespace[i] = 0;
-
-            // State key for blacklist data on provider
-            uint8_t blacklist_key_data[32] = "BLACKLISTED";
-            for (int i = 11; GUARD(32), i < 32; ++i)
-                blacklist_key_data[i] = 0;
+            uint8_t account_namespace[USER_NS_SIZE];
+            USER_NAMESPACE(account_namespace, otxn_acc);
 
             TRACESTR("Querying blacklist status from provider");
 
             // Query blacklist status from provider hook using state_foreign
             uint8_t blacklist_status[1] = {0};
-            int64_t blacklist_result = state_foreign(SBUF(blacklist_status),
-                                                     SBUF(blacklist_key_data),
-                                                     SBUF(account_namespace),
-                                                     SBUF(provider_acc));
+            int64_t blacklist_result = USER_LOAD(blacklist_status, BLACKLIST_KEY, 32,
+                                                 account_namespace, provider_acc);
 
             TRACEVAR(blacklist_result);
 
@@ -200,25 +183,17 @@ int64_t hook(uint32_t reserved)
             TRACESTR("Blacklist checking disabled - proceeding without check");
         }
 
-        // Only emit service fee if we have sufficient balance to avoid emission errors
-        // Reserve emission slot for service fee
-        etxn_reserve(1);
-
-        // Prepare and emit service fee payment
-        uint8_t fee_txn[PREPARE_PAYMENT_SIMPLE_SIZE];
-        PREPARE_PAYMENT_SIMPLE(fee_txn, SERVICE_FEE_DROPS, service_fee_acc, 0, 0);
-
-        uint8_t fee_emithash[32];
-        int64_t emit_result = emit(SBUF(fee_emithash), SBUF(fee_txn));
-        if (emit_result != 32)
-        {
-            TRACEVAR(emit_result);
-            TRACESTR("Blacklist Trustee :: Warning :: Failed to emit service fee payment - insufficient balance or other error.");
-        }
-        else
-        {
-            TRACESTR("Service fee payment emitted successfully");
-        }
+        // Accrue the service fee; it is paid out in one payment once enough
+        // has built up (see Common/FeeAccrual.h)
+        uint8_t fee_rec[FEE_ACCRUAL_SIZE];
+        int64_t fee_settle;
+        FEE_ACCRUE(fee_rec, SERVICE_FEE_DROPS, fee_settle);
+        if (fee_settle)
+            etxn_reserve(1);
+        int64_t fee_stored;
+        FEE_SETTLE(fee_rec, fee_settle, service_fee_acc, fee_stored);
+        if (fee_stored != FEE_ACCRUAL_SIZE)
+            NOPE("Failed to store accrued fees.");
 
         DONE("Payment transaction processed successfully");
     }
@@ -0,0 +1,42 @@
+//**************************************************************
+// Build Profile - Xahau HandyHook Collection
+// Author: @Handy_4ndy
+//
+// Description:
+//   Selects the debug or production build of a hook. Trace calls cost
+//   instructions on every path that reaches them and their names and
+//   messages are uploaded with every SetHook, while only a developer
+//   watching the node log ever reads them.
+//
+//     production   (default) TRACESTR, TRACEVAR, TRACEHEX and TRACEXFL
+//                  expand to nothing: no call, no string literal
+//     debug        built with -DHOOK_DEBUG, the hookapi definitions
+//                  are kept and every trace is emitted
+//
+//   A hook built from source with no flags, as the manifest installs
+//   it, is the production build. Trace arguments are not evaluated in
+//   production, so they must not have side effects.
+//
+//   Include right after hookapi.h; macros from the other Common
+//   headers that trace (FEE_SETTLE) follow the same profile.
+//
+// Usage:
+//   #include "hookapi.h"
+//   #include "../Common/BuildProfile.h"
+//**************************************************************
+
+#ifndef HANDYHOOKS_BUILDPROFILE_H
+#define HANDYHOOKS_BUILDPROFILE_H 1
+
+#ifndef HOOK_DEBUG
+#undef TRACEVAR
+#undef TRACEHEX
+#undef TRACEXFL
+#undef TRACESTR
+#define TRACEVAR(v)
+#define TRACEHEX(v)
+#define TRACEXFL(v)
+#define TRACESTR(v)
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+//**************************************************************
+// Packed Configuration Record - Xahau HandyHook Collection
+// Author: @Handy_4ndy
+//
+// Description:
+//   Keeps a hook's whole configuration in one fixed-layout state entry
+//   instead of one entry per setting. A payment loads it with a single
+//   state call, an invoke edits it in memory and writes it back once,
+//   and only when something changed. One entry also means one owner
+//   reserve rather than one per setting.
+//
+// Storage Structure:
+//   - Key "HOOKCONF": { layout version:1, fields defined by the hook }
+//
+// Versioning:
+//   The hook defines its fields as byte offsets and a layout version.
+//   Fields are only ever appended: a new field bumps the version and
+//   the size, and a record written by an older layout loads with the
+//   new fields zero, so zero must read as "not set" for every field.
+//   A field that is dropped stays in the layout as padding.
+//   A record from a newer, longer layout than the hook's does not load.
+//
+// Upgrading:
+//   A hook that kept each setting under its own key reads those keys
+//   with CFG_LEGACY whenever CFG_LOAD finds no record, so an upgraded
+//   install keeps its settings. The next invoke that changes a setting
+//   saves them all in the record, and from then on the old entries are
+//   not read.
+//
+// Usage:
+//   #include "hookapi.h"
+//   #include "../Common/ConfigRecord.h"
+//   #include "../Common/StateKey.h"
+//
+//   #define CFG_VERSION 1
+//   #define CFG_LIMIT 1        // 8 bytes
+//   #define CFG_SIZE 9
+//
+//   uint8_t cfg[CFG_SIZE] = {0};
+//   int cfg_dirty = 0;
+//   if (!CFG_LOAD(cfg, CFG_SIZE))
+//       CFG_LEGACY(cfg + CFG_LIMIT, 8, SKEY_PAD("LIMIT", 8));
+//   ... read with UINT64_FROM_BUF(cfg + CFG_LIMIT), edit and set cfg_dirty ...
+//   if (cfg_dirty && CFG_SAVE(cfg, CFG_SIZE, CFG_VERSION) < 0)
+//       NOPE("Failed to store configuration");
+//**************************************************************
+
+#ifndef HANDYHOOKS_CONFIGRECORD_H
+#define HANDYHOOKS_CONFIGRECORD_H 1
+
+#define CFG_HEAD_SIZE 1U           // the layout version byte
+
+// Load the record into `rec`, which the caller zero-initialises. An
+// absent record, or one from an older and shorter layout, leaves the
+// rest of `rec` zero. Evaluates to the stored layout version, 0 if none.
+#define CFG_LOAD(rec, size) \
+    (state((rec), (size), "HOOKCONF", 8) >= (int64_t)CFG_HEAD_SIZE ? (rec)[0] : 0)
+
+// Copy the legacy entry under `key` (a pointer and a length, as from
+// SKEY_PAD) into the `len` bytes at `field`. Evaluates to 1 when the
+// entry held exactly `len` bytes; `field` is left alone otherwise.
+#define CFG_LEGACY(field, len, ...) \
+    (state((uint32_t)(field), (len), __VA_ARGS__) == (int64_t)(len))
+
+// Stamp the current layout version and store the record; evaluates to
+// state_set's result
+#define CFG_SAVE(rec, size, version) \
+    ((rec)[0] = (version), state_set((rec), (size), "HOOKCONF", 8))
+
+#endif
@@ -0,0 +1,167 @@
+//**************************************************************
+// Emitted Transaction Templates - Xahau HandyHook Collection
+// Author: @Handy_4ndy
+//
+// Description:
+//   Shared Payment and Remit templates for hooks that emit. Every field
+//   offset is computed from the field sizes at compile time, so a hook
+//   no longer keeps its own copy of the table, and the fields that change
+//   per emission are written in place with word stores.
+//
+//   IOU Payment (278 bytes)           Remit (229 bytes + Amounts)
+//       0  TransactionType                0  TransactionType
+//       3  Flags                          3  Flags
+//       8  Sequence                       8  Sequence
+//      13  FirstLedgerSequence           13  FirstLedgerSequence
+//      19  LastLedgerSequence            19  LastLedgerSequence
+//      25  Amount (49)                   25  Fee
+//      74  Fee                           34  SigningPubKey
+//      83  SigningPubKey                 69  Account
+//     118  Account                       91  Destination
+//     140  Destination                  113  EmitDetails (116)
+//     162  EmitDetails (116)            229  Amounts, built by the hook
+//
+//   The *_OUT offsets point at a field's value, past its type bytes.
+//   A Remit carries any mix of XAH and IOU amounts to its one
+//   Destination; see ETXN_AMOUNTS_BEGIN.
+//
+// Usage:
+//   #include "hookapi.h"
+//   #include "../../Common/EmitTxn.h"
+//
+//   uint8_t txn[ETXN_PAYMENT_IOU_SIZE] = { ETXN_PAYMENT_IOU_INIT };
+//
+//   hook_account(txn + ETXN_PAYMENT_IOU_ACC_OUT, 20);
+//   ACCOUNT_TO_BUF(txn + ETXN_PAYMENT_IOU_DEST_OUT, dest);
+//   float_sto(txn + ETXN_PAYMENT_IOU_AMOUNT_OUT, 49, ...);
+//   etxn_reserve(1);
+//   ETXN_SET_LEDGERS(txn, ledger_seq());
+//   etxn_details(txn + ETXN_PAYMENT_IOU_DETAILS_OUT, ETXN_DETAILS_SIZE);
+//   ETXN_SET_FEE(txn + ETXN_PAYMENT_IOU_FEE_OUT, etxn_fee_base(SBUF(txn)));
+//   emit(SBUF(emithash), SBUF(txn));
+//**************************************************************
+
+#ifndef HANDYHOOKS_EMITTXN_H
+#define HANDYHOOKS_EMITTXN_H 1
+
+// Field sizes, type bytes included
+#define ETXN_TT_SIZE 3U
+#define ETXN_FLAGS_SIZE 5U
+#define ETXN_SEQUENCE_SIZE 5U
+#define ETXN_LEDGER_SIZE 6U
+#define ETXN_IOU_SIZE 49U
+#define ETXN_DROPS_SIZE 9U
+#define ETXN_PUBKEY_SIZE 35U
+#define ETXN_ACCOUNT_SIZE 22U
+#define ETXN_DETAILS_SIZE 116U     // etxn_details for a hook without cbak
+
+// TransactionType .. LastLedgerSequence, the same for every template
+#define ETXN_FLS_OUT (ETXN_TT_SIZE + ETXN_FLAGS_SIZE + ETXN_SEQUENCE_SIZE + 2U)
+#define ETXN_LLS_OUT (ETXN_FLS_OUT + ETXN_LEDGER_SIZE)
+#define ETXN_HEAD_SIZE (ETXN_LLS_OUT + 4U)
+
+// The rest, given the bytes of the fields between the head and Fee
+#define ETXN_FEE_AT(pre) (ETXN_HEAD_SIZE + (pre) + 1U)
+#define ETXN_ACC_AT(pre) (ETXN_FEE_AT(pre) + ETXN_DROPS_SIZE - 1U + ETXN_PUBKEY_SIZE + 2U)
+#define ETXN_DEST_AT(pre) (ETXN_ACC_AT(pre) + ETXN_ACCOUNT_SIZE)
+#define ETXN_DETAILS_AT(pre) (ETXN_DEST_AT(pre) + ETXN_ACCOUNT_SIZE - 2U)
+#define ETXN_SIZE_OF(pre) (ETXN_DETAILS_AT(pre) + ETXN_DETAILS_SIZE)
+
+// IOU Payment: Amount sits between the head and Fee
+#define ETXN_PAYMENT_IOU_AMOUNT_OUT ETXN_HEAD_SIZE
+#define ETXN_PAYMENT_IOU_FEE_OUT ETXN_FEE_AT(ETXN_IOU_SIZE)
+#define ETXN_PAYMENT_IOU_ACC_OUT ETXN_ACC_AT(ETXN_IOU_SIZE)
+#define ETXN_PAYMENT_IOU_DEST_OUT ETXN_DEST_AT(ETXN_IOU_SIZE)
+#define ETXN_PAYMENT_IOU_DETAILS_OUT ETXN_DETAILS_AT(ETXN_IOU_SIZE)
+#define ETXN_PAYMENT_IOU_SIZE ETXN_SIZE_OF(ETXN_IOU_SIZE)
+
+// Remit: Fee follows the head, Amounts are appended after EmitDetails
+#define ETXN_REMIT_FEE_OUT ETXN_FEE_AT(0U)
+#define ETXN_REMIT_ACC_OUT ETXN_ACC_AT(0U)
+#define ETXN_REMIT_DEST_OUT ETXN_DEST_AT(0U)
+#define ETXN_REMIT_DETAILS_OUT ETXN_DETAILS_AT(0U)
+#define ETXN_REMIT_BASE_SIZE ETXN_SIZE_OF(0U)
+#define ETXN_REMIT_AMOUNTS_OUT ETXN_REMIT_BASE_SIZE
+
+// Remit Amounts: an sfAmounts array of AmountEntry objects, each an
+// object marker, one Amount and an end marker
+#ifndef sfAmountEntry
+#define sfAmountEntry ((14U << 16U) + 91U)  // 0xE0 0x5B
+#endif
+#ifndef sfAmounts
+#define sfAmounts ((15U << 16U) + 92U)      // 0xF0 0x5C
+#endif
+#define ETXN_IOU_ENTRY_SIZE (ETXN_IOU_SIZE + 3U)
+#define ETXN_DROPS_ENTRY_SIZE (ETXN_DROPS_SIZE + 3U)
+#define ETXN_AMOUNTS_SIZE(ious, drops) \
+    (3U + (ious) * ETXN_IOU_ENTRY_SIZE + (drops) * ETXN_DROPS_ENTRY_SIZE)
+
+_Static_assert(ETXN_PAYMENT_IOU_SIZE == 278U, "IOU Payment template is 278 bytes");
+_Static_assert(ETXN_REMIT_BASE_SIZE == 229U, "Remit template is 229 bytes before its Amounts");
+
+// Designated initialisers for the fixed bytes; everything the hook fills
+// in per emission starts as zero.
+#define ETXN_INIT(tt, flags, pre)                                                       \
+    [0] = 0x12U, [1] = ((tt) >> 8U) & 0xFFU, [2] = (tt) & 0xFFU,                        \
+    [3] = 0x22U, [4] = ((flags) >> 24U) & 0xFFU, [5] = ((flags) >> 16U) & 0xFFU,        \
+    [6] = ((flags) >> 8U) & 0xFFU, [7] = (flags) & 0xFFU,                               \
+    [8] = 0x24U,                                                                        \
+    [ETXN_FLS_OUT - 2U] = 0x20U, [ETXN_FLS_OUT - 1U] = 0x1AU,                           \
+    [ETXN_LLS_OUT - 2U] = 0x20U, [ETXN_LLS_OUT - 1U] = 0x1BU,                           \
+    [ETXN_FEE_AT(pre) - 1U] = 0x68U, [ETXN_FEE_AT(pre)] = 0x40U,                        \
+    [ETXN_FEE_AT(pre) + 8U] = 0x73U, [ETXN_FEE_AT(pre) + 9U] = 0x21U,                   \
+    [ETXN_ACC_AT(pre) - 2U] = 0x81U, [ETXN_ACC_AT(pre) - 1U] = 0x14U,                   \
+    [ETXN_DEST_AT(pre) - 2U] = 0x83U, [ETXN_DEST_AT(pre) - 1U] = 0x14U
+
+#define ETXN_PAYMENT_IOU_INIT ETXN_INIT(ttPAYMENT, 0U, ETXN_IOU_SIZE)
+#define ETXN_REMIT_INIT ETXN_INIT(ttREMIT, tfCANONICAL, 0U)
+
+// FirstLedgerSequence = seq + 1, LastLedgerSequence = seq + 5
+#define ETXN_SET_LEDGERS(txn, seq)                                                      \
+    {                                                                                   \
+        uint32_t fls = (uint32_t)(seq) + 1U;                                            \
+        *(uint32_t*)((txn) + ETXN_FLS_OUT) = __builtin_bswap32(fls);                   \
+        *(uint32_t*)((txn) + ETXN_LLS_OUT) = __builtin_bswap32(fls + 4U);              \
+    }
+
+// One Remit pays its Destination every amount in its Amounts array, XAH
+// and IOUs alike, for one emission and one fee. The array is written in
+// place after the template: ETXN_AMOUNTS_BEGIN, an ETXN_AMOUNTS_ADD_*
+// per amount, then ETXN_AMOUNTS_END. `out` is left past what was
+// written, so ETXN_REMIT_SIZE(txn, out) is the size to emit. Size the
+// buffer with ETXN_REMIT_BASE_SIZE + ETXN_AMOUNTS_SIZE(ious, drops).
+#define ETXN_AMOUNTS_BEGIN(out, txn)                                                    \
+    {                                                                                   \
+        (out) = (txn) + ETXN_REMIT_AMOUNTS_OUT;                                         \
+        *(out)++ = 0xF0U;                                                               \
+        *(out)++ = 0x5CU;                                                               \
+    }
+
+// len receives float_sto's result, negative when the amount is invalid
+#define ETXN_AMOUNTS_ADD_IOU(out, len, currency, issuer, xfl)                           \
+    {                                                                                   \
+        *(out)++ = 0xE0U;                                                               \
+        *(out)++ = 0x5BU;                                                               \
+        (len) = float_sto((out), ETXN_IOU_SIZE, (currency), 20, (issuer), 20, (xfl), sfAmount); \
+        (out) += ETXN_IOU_SIZE;                                                         \
+        *(out)++ = 0xE1U;                                                               \
+    }
+
+#define ETXN_AMOUNTS_ADD_DROPS(out, drops)                                              \
+    {                                                                                   \
+        *(out)++ = 0xE0U;                                                               \
+        *(out)++ = 0x5BU;                                                               \
+        ENCODE_DROPS((out), (drops), amAMOUNT);                                         \
+        *(out)++ = 0xE1U;                                                               \
+    }
+
+#define ETXN_AMOUNTS_END(out) (*(out)++ = 0xF1U)
+
+#define ETXN_REMIT_SIZE(txn, out) ((uint32_t)((out) - (txn)))
+
+// A drops amount with the positive-native bit, as one 8-byte store
+#define ETXN_SET_FEE(fee_out, fee)                                                      \
+    (*(uint64_t*)(fee_out) =                                                            \
+         __builtin_bswap64(((uint64_t)(fee) & 0x3FFFFFFFFFFFFFFFULL) | 0x4000000000000000ULL))
+
+#endif
@@ -0,0 +1,93 @@
+//**************************************************************
+// Deferred Service Fee - Xahau HandyHook Collection
+// Author: @Handy_4ndy
+//
+// Description:
+//   Hooks that charge a service fee per processed transaction used to
+//   emit a separate XAH payment to the fee account every time. Instead,
+//   the fee is added to a counter in the hook's own state and paid out
+//   as one aggregated payment once the counter reaches a threshold or
+//   enough ledgers have passed since the last payout.
+//
+// Hook Parameters (optional, set at install):
+//   'FEE_SETTLE' (8 bytes): pay out once this many drops have accrued
+//   'FEE_LEDGERS' (4 bytes): pay out once this many ledgers have passed
+//   Either trigger settles; FEE_LEDGERS = 0 disables the ledger trigger.
+//
+// Storage Structure:
+//   - Key "FEEACCRU": { accrued drops:8, last payout ledger:4 }
+//   A failed payout keeps its drops accrued for the next settlement. A
+//   failed write rolls the transaction back: the record would otherwise
+//   pay out the same drops again, or lose this execution's fee.
+//
+// Usage:
+//   #include "hookapi.h"
+//   #include "../Common/FeeAccrual.h"
+//
+//   uint8_t fee_rec[FEE_ACCRUAL_SIZE];
+//   int64_t fee_settle;
+//   FEE_ACCRUE(fee_rec, SERVICE_FEE_DROPS, fee_settle);
+//   etxn_reserve(1 + fee_settle);
+//   ... emit the hook's own transactions ...
+//   int64_t fee_stored;
+//   FEE_SETTLE(fee_rec, fee_settle, service_fee_acc, fee_stored);
+//   if (fee_stored != FEE_ACCRUAL_SIZE)
+//       NOPE("Failed to store accrued fees");
+//**************************************************************
+
+#ifndef HANDYHOOKS_FEEACCRUAL_H
+#define HANDYHOOKS_FEEACCRUAL_H 1
+
+#define FEE_ACCRUAL_SIZE 12U
+#define FEE_ACCRUAL_SETTLE_DROPS 1000000ULL   // 1 XAH: twenty 0.05 XAH fees
+#define FEE_ACCRUAL_SETTLE_LEDGERS 17280U     // about a day of ledgers
+
+// Load the record, add `drops` and set `settle` to 1 when this execution
+// pays out, 0 otherwise. Nothing is written until FEE_SETTLE.
+#define FEE_ACCRUE(rec, drops, settle)                                                  \
+    {                                                                                   \
+        uint32_t fee_now = (uint32_t)ledger_seq();                                      \
+        uint64_t fee_accrued = 0;                                                       \
+        uint32_t fee_last = fee_now;                                                    \
+        if (state(rec, FEE_ACCRUAL_SIZE, "FEEACCRU", 8) == FEE_ACCRUAL_SIZE)            \
+        {                                                                               \
+            fee_accrued = UINT64_FROM_BUF(rec);                                         \
+            fee_last = UINT32_FROM_BUF((rec) + 8);                                      \
+        }                                                                               \
+        fee_accrued += (drops);                                                         \
+        uint64_t fee_threshold = FEE_ACCRUAL_SETTLE_DROPS;                              \
+        uint32_t fee_interval = FEE_ACCRUAL_SETTLE_LEDGERS;                             \
+        uint8_t fee_param[8];                                                           \
+        if (hook_param(fee_param, 8, "FEE_SETTLE", 10) == 8)                            \
+            fee_threshold = UINT64_FROM_BUF(fee_param);                                 \
+        if (hook_param(fee_param, 4, "FEE_LEDGERS", 11) == 4)                           \
+            fee_interval = UINT32_FROM_BUF(fee_param);                                  \
+        (settle) = fee_accrued >= fee_threshold ||                                      \
+                   (fee_interval > 0 && fee_now - fee_last >= fee_interval);            \
+        UINT64_TO_BUF(rec, fee_accrued);                                                \
+        UINT32_TO_BUF((rec) + 8, fee_last);                                             \
+    }
+
+// Pay out the accrued drops to `fee_acc` when `settle` is set, then store
+// the record; `stored` is state_set's result, which the caller checks is
+// FEE_ACCRUAL_SIZE. Needs the etxn_reserve slot FEE_ACCRUE asked for.
+#define FEE_SETTLE(rec, settle, fee_acc, stored)                                        \
+    {                                                                                   \
+        if (settle)                                                                     \
+        {                                                                               \
+            uint8_t fee_txn[PREPARE_PAYMENT_SIMPLE_SIZE];                               \
+            uint64_t fee_payout = UINT64_FROM_BUF(rec);                                 \
+            PREPARE_PAYMENT_SIMPLE(fee_txn, fee_payout, fee_acc, 0, 0);                 \
+            uint8_t fee_emithash[32];                                                   \
+            if (emit(SBUF(fee_emithash), SBUF(fee_txn)) == 32)                          \
+            {                                                                           \
+                UINT64_TO_BUF(rec, (uint64_t)0);                                        \
+                UINT32_TO_BUF((rec) + 8, ledger_seq());                                 \
+            }                                                                           \
+            else                                                                        \
+                TRACESTR("Service fee payout failed, kept accrued.");                   \
+        }                                                                               \
+        (stored) = state_set(rec, FEE_ACCRUAL_SIZE, "FEEACCRU", 8);                     \
+    }
+
+#endif
@@ -0,0 +1,175 @@
+//**************************************************************
+// Invoke Parameter Dispatch - Xahau HandyHook Collection
+// Author: @Handy_4ndy
+//
+// Description:
+//   Reads the invoking transaction's sfHookParameters once and walks
+//   it entry by entry, instead of one otxn_param call per command the
+//   hook understands. Each entry's name is looked up in the hook's own
+//   command table, so a hook can act on every command an invoke
+//   carries rather than only the first one it checks for.
+//
+//   The table is a list of up to PARAM_TABLE_MAX names, each
+//   zero-padded to PARAM_NAME_SIZE; its position is the command's
+//   number. Names are loaded and matched as four 8-byte words, so no
+//   byte loop runs per entry. Entries not in the table have command -1.
+//
+// Policy:
+//   An invoke is applied whole or not at all. A hook rolls it back when
+//   any entry is malformed, names no command in its table, or carries a
+//   value of the wrong size for its command; it never skips one and
+//   applies the rest. PARAM_NEXT gives the first two command -1, and
+//   PARAM_COLLECT counts them in `rejected`. An array PARAM_LOAD cannot
+//   read, one larger than its buffer, is rejected as well; only a
+//   transaction without sfHookParameters has none.
+//
+// Usage:
+//   #include "hookapi.h"
+//   #include "../Common/ParamDispatch.h"
+//
+//   static const uint8_t commands[][PARAM_NAME_SIZE] = {"MIN", "MAX"};
+//   #define CMD_MIN 0
+//   #define CMD_MAX 1
+//
+//   PARAM_LOAD(params, params_len);
+//   if (params_len < 0)
+//       NOPE("HookParameters could not be read");
+//   uint8_t* cursor = params;
+//   for (int i = 0; GUARD(PARAM_MAX), i < PARAM_MAX && cursor < params + params_len; ++i)
+//   {
+//       int cmd;
+//       uint8_t* value;
+//       int value_len;
+//       PARAM_NEXT(cursor, params + params_len, commands, cmd, value, value_len);
+//       if (cmd < 0)
+//           NOPE("Unknown or malformed HookParameter");
+//       if (value_len != 8)
+//           NOPE("MIN and MAX take 8 bytes");
+//       if (cmd == CMD_MIN) ...
+//   }
+//
+//   or, to see every command before acting on any:
+//
+//   uint8_t* values[PARAM_COMMANDS(commands)];
+//   int lens[PARAM_COMMANDS(commands)];
+//   int rejected;
+//   PARAM_COLLECT(commands, values, lens, rejected);
+//   if (rejected)
+//       NOPE("Unknown or malformed HookParameter");
+//   if (lens[CMD_MIN] == 8) ...
+//**************************************************************
+
+#ifndef HANDYHOOKS_PARAMDISPATCH_H
+#define HANDYHOOKS_PARAMDISPATCH_H 1
+
+#define PARAM_MAX 16U              // HookParameters per transaction
+#define PARAM_NAME_SIZE 32U        // longest HookParameterName
+#define PARAM_ARRAY_SIZE 2048U     // 16 entries with 64-byte values fit
+#define PARAM_TABLE_MAX 16U        // commands per table, for the guard bounds
+
+#define PARAM_COMMANDS(table) (sizeof(table) / sizeof((table)[0]))
+
+// Copy sfHookParameters into a new buffer `buf`; `len` is its length,
+// 0 when the transaction carries none, and negative when they could not
+// be read, such as more than fit: the caller rolls back then. The buffer
+// has room past the array for PARAM_NEXT's word loads.
+#define PARAM_LOAD(buf, len)                                                            \
+    uint8_t buf[PARAM_ARRAY_SIZE + PARAM_NAME_SIZE] = {0};                              \
+    int64_t len = otxn_field(buf, PARAM_ARRAY_SIZE, sfHookParameters);                  \
+    if (len == DOESNT_EXIST)                                                            \
+        len = 0;
+
+// VL length prefix of up to 12480 bytes; `p` is left past the prefix
+#define PARAM_VL(p, n)                                                                  \
+    {                                                                                   \
+        (n) = *(p)++;                                                                   \
+        if ((n) > 192)                                                                  \
+            (n) = 193 + (((n) - 193) << 8) + *(p)++;                                    \
+    }
+
+// Low n bytes of a little-endian word, as WASM loads them
+#define PARAM_MASK(n) ((n) >= 8 ? ~0ULL : (n) <= 0 ? 0ULL : (1ULL << ((n) * 8)) - 1ULL)
+
+// Parse the sfHookParameter at `cursor` and advance past it. `cmd` is
+// its index in `table` or -1, `value` / `value_len` its value (length 0
+// when it has none). A malformed entry sets value_len to -1 and moves
+// `cursor` to `end`.
+#define PARAM_NEXT(cursor, end, table, cmd, value, value_len)                          \
+    {                                                                                   \
+        uint64_t param_name[4] = {0};                                                   \
+        int param_name_len = 0;                                                         \
+        (cmd) = -1;                                                                     \
+        (value) = 0;                                                                    \
+        (value_len) = -1;                                                               \
+        uint8_t* p = (cursor);                                                          \
+        if (p[0] == 0xE0U && p[1] == 0x17U && p[2] == 0x70U && p[3] == 0x18U)           \
+        {                                                                               \
+            p += 4;                                                                     \
+            PARAM_VL(p, param_name_len);                                                \
+            if (param_name_len > 0 && param_name_len <= PARAM_NAME_SIZE &&              \
+                p + param_name_len < (end))                                             \
+            {                                                                           \
+                param_name[0] = *(uint64_t*)(p) & PARAM_MASK(param_name_len);           \
+                param_name[1] = *(uint64_t*)(p + 8) & PARAM_MASK(param_name_len - 8);   \
+                param_name[2] = *(uint64_t*)(p + 16) & PARAM_MASK(param_name_len - 16); \
+                param_name[3] = *(uint64_t*)(p + 24) & PARAM_MASK(param_name_len - 24); \
+                p += param_name_len;                                                    \
+                (value_len) = 0;                                                        \
+                if (p[0] == 0x70U && p[1] == 0x19U)                                     \
+                {                                                                       \
+                    p += 2;                                                             \
+                    PARAM_VL(p, value_len);                                             \
+                    (value) = p;                                                        \
+                    p += (value_len);                                                   \
+                }                                                                       \
+                if (p >= (end) || *p++ != 0xE1U)                                        \
+                    (value_len) = -1;                                                   \
+            }                                                                           \
+        }                                                                               \
+        if ((value_len) < 0)                                                            \
+            p = (end);                                                                  \
+        (cursor) = p;                                                                   \
+        for (int k = 0; GUARDM(PARAM_MAX * PARAM_TABLE_MAX, 2),                         \
+                 (value_len) >= 0 && k < (int)PARAM_COMMANDS(table); ++k)               \
+        {                                                                               \
+            const uint64_t* b = (const uint64_t*)(table)[k];                            \
+            if (param_name[0] == b[0] && param_name[1] == b[1] &&                       \
+                param_name[2] == b[2] && param_name[3] == b[3])                         \
+            {                                                                           \
+                (cmd) = k;                                                              \
+                break;                                                                  \
+            }                                                                           \
+        }                                                                               \
+    }
+
+// One pass that files each command's value by its index in `table`:
+// values[cmd] / lens[cmd], with lens[cmd] = -1 for commands the invoke
+// does not carry, and `rejected` the number of entries that are
+// malformed or not in the table, or 1 when the array could not be read. For hooks that act on commands in an
+// order of their own, or need two of them together. The values point into a buffer
+// declared in the caller's scope, so it can be used once per scope.
+#define PARAM_COLLECT(table, values, lens, rejected)                                    \
+    PARAM_LOAD(param_array, param_array_len);                                           \
+    (rejected) = param_array_len < 0;                                                   \
+    {                                                                                   \
+        for (int c = 0; GUARDM(PARAM_TABLE_MAX, 3), c < (int)PARAM_COMMANDS(table); ++c) \
+            (lens)[c] = -1;                                                             \
+        uint8_t* cursor = param_array;                                                  \
+        uint8_t* end = param_array + ((rejected) ? 0 : param_array_len);                \
+        for (int i = 0; GUARDM(PARAM_MAX, 4), i < (int)PARAM_MAX && cursor < end; ++i)  \
+        {                                                                               \
+            int cmd;                                                                    \
+            uint8_t* value;                                                             \
+            int value_len;                                                              \
+            PARAM_NEXT(cursor, end, table, cmd, value, value_len);                      \
+            if (cmd >= 0)                                                               \
+            {                                                                           \
+                (values)[cmd] = value;                                                  \
+                (lens)[cmd] = value_len;                                                \
+            }                                                                           \
+            else                                                                        \
+                (rejected)++;                                                           \
+        }                                                                               \
+    }
+
+#endif
@@ -0,0 +1,83 @@
+//**************************************************************
+// Compact Result Codes - Xahau HandyHook Collection
+// Author: @Handy_4ndy
+//
+// Description:
+//   Every accept and rollback in the collection carries a readable
+//   message. Those strings make up much of a hook's data section, are
+//   paid for in every SetHook, and leave indexers matching text. Built
+//   with -DHOOK_RESULT_CODES, a hook returns a result code instead:
+//
+//     exit code      (hook id << 16) | source line
+//     return string  "<hook id>:<line>"
+//
+//   Without the flag nothing changes: the message is returned and the
+//   exit code is the source line, as before.
+//
+//   The harness target result-codes writes result_codes.tsv, mapping
+//   each code back to its hook, line, kind and message. Regenerate it
+//   from the same sources the deployed hook was built from, since the
+//   codes follow source lines.
+//
+// Hook IDs:
+//   One per hook below, never reused. Exit codes under 65536 are plain
+//   line numbers from a result that formats its message at runtime.
+//
+// Usage:
+//   #include "hookapi.h"
+//   #include "../Common/ResultCode.h"
+//
+//   #define HOOK_RESULT_ID RC_NOTEHOOK
+//   #define DONE(x) RESULT_ACCEPT("NTH :: Success :: " x)
+//   #define NOPE(x) RESULT_ROLLBACK("NTH :: Error :: " x)
+//**************************************************************
+
+#ifndef HANDYHOOKS_RESULTCODE_H
+#define HANDYHOOKS_RESULTCODE_H 1
+
+#define RC_SETHOOKLOCK 1
+#define RC_MULTBENEFICIARYS 2
+#define RC_MULTIBENEFICIARYDELEGATE 3
+#define RC_MULTIBENEFICIARYTHRESHOLD 4
+#define RC_SINGLEBENEFICIARY 5
+#define RC_SINGLEBENEFICIARYDELEGATE 6
+#define RC_SINGLEBENEFICIARYTHRESHOLD 7
+#define RC_BLACKLISTPROVIDER 8
+#define RC_BLACKLISTTRUSTEE 9
+#define RC_ADMINISSUANCE 10
+#define RC_BRIDGERESERVE 11
+#define RC_DAILYREWARDS 12
+#define RC_NATIVEISSUE 13
+#define RC_IDOMULTI 14
+#define RC_REWARDS 15
+#define RC_ROUTER 16
+#define RC_IDOMASTER 17
+#define RC_REWARDSMASTER 18
+#define RC_ROUTERMASTER 19
+#define RC_NOTEHOOK 20
+#define RC_SAFEGUARD 21
+#define RC_SAVINGSHOOK 22
+#define RC_SAVINGSMANAGER 23
+#define RC_BIRTHDAYCARDHOOK 24
+
+#define RESULT_STR_(x) #x
+#define RESULT_STR(x) RESULT_STR_(x)
+
+// Result kinds, as listed in result_codes.tsv
+#define RESULT_KIND_ACCEPT 1
+#define RESULT_KIND_ROLLBACK 2
+
+#if defined(HOOK_RESULT_CATALOG)
+// Preprocessor-only mode for the table generator; not meant to compile
+#define RESULT_ACCEPT(msg) __hook_result(RESULT_KIND_ACCEPT, HOOK_RESULT_ID, __LINE__, msg)
+#define RESULT_ROLLBACK(msg) __hook_result(RESULT_KIND_ROLLBACK, HOOK_RESULT_ID, __LINE__, msg)
+#elif defined(HOOK_RESULT_CODES)
+#define RESULT_CODE (((int64_t)(HOOK_RESULT_ID) << 16) | __LINE__)
+#define RESULT_ACCEPT(msg) accept(SBUF(RESULT_STR(HOOK_RESULT_ID) ":" RESULT_STR(__LINE__)), RESULT_CODE)
+#define RESULT_ROLLBACK(msg) rollback(SBUF(RESULT_STR(HOOK_RESULT_ID) ":" RESULT_STR(__LINE__)), RESULT_CODE)
+#else
+#define RESULT_ACCEPT(msg) accept(SBUF(msg), __LINE__)
+#define RESULT_ROLLBACK(msg) rollback(SBUF(msg), __LINE__)
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+//**************************************************************
+// State Key Literals - Xahau HandyHook Collection
+// Author: @Handy_4ndy
+//
+// Description:
+//   State keys are fixed strings, so they belong in the hook's
+//   read-only data rather than being assembled on the stack by
+//   UINT64_TO_BUF or an initialised array on every run, including the
+//   runs that never touch them. A key named here costs nothing until a
+//   state call uses it, and then only a pointer and a length.
+//
+// Keys:
+//   Shorter keys are padded with zeros up to the length they are
+//   stored under, so "SETH" as an 8-byte key reads the same entry as
+//   UINT64_TO_BUF(key, 0x5345544800000000ULL) did. Up to SKEY_MAX
+//   bytes; a longer string is cut at the length given.
+//
+// Usage:
+//   #include "hookapi.h"
+//   #include "../Common/StateKey.h"
+//
+//   #define LOCKED_KEY "LOCKED"
+//   state(SBUF(buf), SKEY_PAD(LOCKED_KEY, 8));        // "LOCKED\0\0"
+//   state(SBUF(buf), SKEY("XAH"));                    // exactly "XAH"
+//   USER_LOAD(rec, SKEY_PTR("BLACKLISTED"), 32, ns, hook_acc);
+//**************************************************************
+
+#ifndef HANDYHOOKS_STATEKEY_H
+#define HANDYHOOKS_STATEKEY_H 1
+
+#define SKEY_MAX 32U
+
+#define SKEY_ZEROS "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0"
+
+// Pointer to the key string `s`, followed by at least SKEY_MAX zeros
+#define SKEY_PTR(s) (uint32_t)(s SKEY_ZEROS)
+
+// `s` as an `n`-byte key (pointer, length), zero padded
+#define SKEY_PAD(s, n) SKEY_PTR(s), (n)
+
+// `s` as a key of its own length (pointer, length)
+#define SKEY(s) (uint32_t)(s), (sizeof(s) - 1)
+
+#endif
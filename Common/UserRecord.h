@@ -0,0 +1,60 @@
+//**************************************************************
+// Per-Account Records - Xahau HandyHook Collection
+// Author: @Handy_4ndy
+//
+// Description:
+//   Hooks that track something per user keep it on the hook account in
+//   a namespace derived from the user's account ID. This builds that
+//   namespace with word copies instead of two byte loops, loads the
+//   user's record with one state_foreign call, and writes it back with
+//   one state_foreign_set at the end, skipped when nothing changed.
+//
+// Storage Structure:
+//   - Namespace: { account ID:20, zero:12 }
+//   - Key and record layout are the hook's own.
+//
+// Usage:
+//   #include "hookapi.h"
+//   #include "../Common/UserRecord.h"
+//
+//   uint8_t user_ns[USER_NS_SIZE];
+//   USER_NAMESPACE(user_ns, otxn_acc);
+//   uint8_t user_rec[16] = {0};
+//   int64_t user_len = USER_LOAD(user_rec, key, key_len, user_ns, hook_acc);
+//   int user_dirty = 0;
+//   ... read and edit user_rec, set user_dirty ...
+//   if (USER_FLUSH(user_rec, 16, key, key_len, user_ns, hook_acc, user_dirty) < 0)
+//       NOPE("Failed to update user record");
+//**************************************************************
+
+#ifndef HANDYHOOKS_USERRECORD_H
+#define HANDYHOOKS_USERRECORD_H 1
+
+#define USER_NS_SIZE 32U
+
+// `ns` (32 bytes) becomes the namespace of the 20-byte account `acc`
+#define USER_NAMESPACE(ns, acc)                                                         \
+    {                                                                                   \
+        *(uint64_t*)(ns) = *(uint64_t*)(acc);                                           \
+        *(uint64_t*)((ns) + 8) = *(uint64_t*)((acc) + 8);                               \
+        *(uint32_t*)((ns) + 16) = *(uint32_t*)((acc) + 16);                             \
+        *(uint32_t*)((ns) + 20) = 0;                                                    \
+        *(uint64_t*)((ns) + 24) = 0;                                                    \
+    }
+
+// Read the record under `key` in namespace `ns` of account `owner`,
+// normally the hook account, into the array `rec`. Evaluates to the
+// stored length, negative when there is none; `rec` is then left as it
+// was, so zero-initialise it for defaults.
+#define USER_LOAD(rec, key, key_len, ns, owner) \
+    state_foreign(SBUF(rec), (key), (key_len), (ns), USER_NS_SIZE, (owner), 20)
+
+// Store `len` bytes of `rec` under `key` (len 0 deletes it) when `dirty`
+// is set. Evaluates to state_foreign_set's result, or `len` when there
+// was nothing to write.
+#define USER_FLUSH(rec, len, key, key_len, ns, owner, dirty)                             \
+    ((dirty) ? state_foreign_set((len) ? (rec) : 0, (len), (key), (key_len), (ns),      \
+                                 USER_NS_SIZE, (owner), 20)                             \
+             : (int64_t)(len))
+
+#endif
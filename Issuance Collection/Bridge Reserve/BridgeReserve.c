@@ -25,52 +25,24 @@
 //
 // Development Contribution:
 //   - A development contribution of 0.05 XAH is charged per successful bridge operation, sent to a predefined account.
+//   - Contributions accrue in state (Common/FeeAccrual.h) and are sent in one payment per
+//     settlement; optional hook parameters FEE_SETTLE and FEE_LEDGERS set when.
 //**************************************************************
 
 #include "hookapi.h"
-
-#define FLIP_ENDIAN(n) ((uint32_t) (((n & 0xFFU) << 24U) | \
-                                   ((n & 0xFF00U) << 8U) | \
-                                 ((n & 0xFF0000U) >> 8U) | \
-                                ((n & 0xFF000000U) >> 24U)))
-
-#define DONE(x) accept(SBUF("BRH :: Success :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("BRH :: Error :: " x), __LINE__)
+#include "../../Common/BuildProfile.h"
+#include "../../Common/EmitTxn.h"
+#include "../../Common/FeeAccrual.h"
+#include "../../Common/ResultCode.h"
+
+#define HOOK_RESULT_ID RC_BRIDGERESERVE
+#define DONE(x) RESULT_ACCEPT("BRH :: Success :: " x)
+#define NOPE(x) RESULT_ROLLBACK("BRH :: Error :: " x)
 #define GUARD(maxiter) _g(__LINE__, (maxiter) + 1)
 
-#ifndef FLIP_ENDIAN
-#  define FLIP_ENDIAN(x) __builtin_bswap32(x)
-#endif
+// IOU reserve Payment; field offsets come from EmitTxn.h
+uint8_t txn[ETXN_PAYMENT_IOU_SIZE] = { ETXN_PAYMENT_IOU_INIT };
 
-uint8_t txn[278] =
-{
-    /* size,upto */
-    /* 3,  0, tt = Payment           */   0x12U, 0x00U, 0x00U,
-    /* 5,  3, flags                  */   0x22U, 0x00U, 0x00U, 0x00U, 0x00U,
-    /* 5,  8, sequence               */   0x24U, 0x00U, 0x00U, 0x00U, 0x00U,
-    /* 6,  13, firstledgersequence   */   0x20U, 0x1AU, 0x00U, 0x00U, 0x00U, 0x00U,
-    /* 6,  19, lastledgersequence    */   0x20U, 0x1BU, 0x00U, 0x00U, 0x00U, 0x00U,
-    /* 49, 25  amount               */    0x61U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U,                         
-                                          0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U,
-                                          0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U,
-                                          0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U,
-                                          0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U,
-                                          0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99U, 0x99,
-    /* 9,   74,  fee                 */   0x68U, 0x40U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U,
-    /* 35,  83, signingpubkey        */   0x73U, 0x21U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    /* 22,  118, account             */   0x81U, 0x14U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    /* 22,  140, destination         */   0x83U, 0x14U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    /* 116, 162  emit details        */ 
-    /* 0,   278                      */ 
-};
-
-#define FLS_OUT    (txn + 15U) 
-#define LLS_OUT    (txn + 21U) 
-#define FEE_OUT    (txn + 75U) 
-#define AMOUNT_OUT (txn + 25U)
-#define HOOK_ACC   (txn + 120U)
-#define RESERVE_ACC (txn + 142U)
-#define EMIT_OUT   (txn + 162U)
 #define CURRENCY_OFFSET 8U
 
 static uint8_t dev_contribution_acc[20] = {0xCCU, 0x41U, 0x96U, 0xC1U, 0xF2U, 0x34U, 0xDBU, 0xAAU, 0x06U, 0x13U, 0x0FU, 0xAAU, 0xF5U, 0xD2U, 0x8CU, 0x53U, 0x77U, 0xA6U, 0xFBU, 0xCAU};
@@ -132,43 +104,29 @@ int64_t hook(uint32_t reserved)
 
     int64_t amount_xfl = slot_float(amt_slot);
 
-    hook_account(HOOK_ACC, 20);
+    hook_account(txn + ETXN_PAYMENT_IOU_ACC_OUT, 20);
+    ACCOUNT_TO_BUF(txn + ETXN_PAYMENT_IOU_DEST_OUT, reserve_acc);
 
-    for (int i = 0; GUARD(20), i < 20; ++i)
-        RESERVE_ACC[i] = reserve_acc[i];
-
-    if (float_sto(AMOUNT_OUT, 49, currency, 20, HOOK_ACC, 20, amount_xfl, sfAmount) < 0)
+    if (float_sto(txn + ETXN_PAYMENT_IOU_AMOUNT_OUT, 49, currency, 20, txn + ETXN_PAYMENT_IOU_ACC_OUT, 20, amount_xfl, sfAmount) < 0)
         NOPE("Failed to serialize reserve amount.");
 
-    etxn_reserve(2);
-    uint32_t fls = (uint32_t)ledger_seq() + 1;
-    *((uint32_t *)(FLS_OUT)) = FLIP_ENDIAN(fls);
-    uint32_t lls = fls + 4;
-    *((uint32_t *)(LLS_OUT)) = FLIP_ENDIAN(lls);
-    etxn_details(EMIT_OUT, 116U);
-    {
-        int64_t fee = etxn_fee_base(SBUF(txn));
-        uint8_t *b = FEE_OUT;
-        *b++ = 0b01000000 + ((fee >> 56) & 0b00111111);
-        *b++ = (fee >> 48) & 0xFFU;
-        *b++ = (fee >> 40) & 0xFFU;
-        *b++ = (fee >> 32) & 0xFFU;
-        *b++ = (fee >> 24) & 0xFFU;
-        *b++ = (fee >> 16) & 0xFFU;
-        *b++ = (fee >> 8) & 0xFFU;
-        *b++ = (fee >> 0) & 0xFFU;
-    }
+    uint8_t fee_rec[FEE_ACCRUAL_SIZE];
+    int64_t fee_settle;
+    FEE_ACCRUE(fee_rec, DEV_CONTRIBUTION_DROPS, fee_settle);
+
+    etxn_reserve(1 + fee_settle);
+    ETXN_SET_LEDGERS(txn, ledger_seq());
+    etxn_details(txn + ETXN_PAYMENT_IOU_DETAILS_OUT, ETXN_DETAILS_SIZE);
+    ETXN_SET_FEE(txn + ETXN_PAYMENT_IOU_FEE_OUT, etxn_fee_base(SBUF(txn)));
 
     uint8_t emithash[32];
     if (emit(SBUF(emithash), SBUF(txn)) != 32)
         NOPE("Failed to emit reserve transaction.");
 
-    uint8_t contribution_txn[PREPARE_PAYMENT_SIMPLE_SIZE];
-    PREPARE_PAYMENT_SIMPLE(contribution_txn, DEV_CONTRIBUTION_DROPS, dev_contribution_acc, 0, 0);
-    
-    uint8_t contribution_emithash[32];
-    if (emit(SBUF(contribution_emithash), SBUF(contribution_txn)) != 32)
-        TRACESTR("BRH :: Warning :: Failed to emit development contribution payment.");
+    int64_t fee_stored;
+    FEE_SETTLE(fee_rec, fee_settle, dev_contribution_acc, fee_stored);
+    if (fee_stored != FEE_ACCRUAL_SIZE)
+        NOPE("Failed to store accrued contributions.");
 
     DONE("Tokens burned and reserve minted successfully.");
     _g(1,1);
@@ -27,9 +27,12 @@
 
 
 #include "hookapi.h"
+#include "../../Common/BuildProfile.h"
+#include "../../Common/ResultCode.h"
 
-#define DONE(x) accept(SBUF("NIC:: Success :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("NIC:: Error :: " x), __LINE__)
+#define HOOK_RESULT_ID RC_NATIVEISSUE
+#define DONE(x) RESULT_ACCEPT("NIC:: Success :: " x)
+#define NOPE(x) RESULT_ROLLBACK("NIC:: Error :: " x)
 #define GUARD(maxiter) _g(__LINE__, (maxiter) + 1)
 
 
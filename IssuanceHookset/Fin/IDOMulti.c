@@ -1,46 +1,30 @@
 #include "hookapi.h"
+#include "../../Common/BuildProfile.h"
+#include "../../Common/EmitTxn.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
 
 #ifndef NULL
 #define NULL 0
 #endif
-#define sfAmountEntry ((14U << 16U) + 91U)
-#define sfAmounts ((15U << 16U) + 92U)
-#define DONE(x) accept(SBUF("IDOM :: Success :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("IDOM :: Error :: " x), __LINE__)
-#define REJECT(x) rollback(SBUF("IDOM :: Rejected :: " x), __LINE__)
-#define UNWIND(x) rollback(SBUF("IDOM :: Unwind :: " x), __LINE__)
-#define FAIL(x) rollback(SBUF("IDOM :: " x), __LINE__)
+#define HOOK_RESULT_ID RC_IDOMULTI
+#define DONE(x) RESULT_ACCEPT("IDOM :: Success :: " x)
+#define NOPE(x) RESULT_ROLLBACK("IDOM :: Error :: " x)
+#define REJECT(x) RESULT_ROLLBACK("IDOM :: Rejected :: " x)
+#define UNWIND(x) RESULT_ROLLBACK("IDOM :: Unwind :: " x)
+#define FAIL(x) RESULT_ROLLBACK("IDOM :: " x)
 #define GUARD(maxiter) _g(__LINE__, (maxiter) + 1)
 #define UINT64_FROM_BUF(buf) \
     (((uint64_t)(buf)[0] << 56) + ((uint64_t)(buf)[1] << 48) + \
      ((uint64_t)(buf)[2] << 40) + ((uint64_t)(buf)[3] << 32) + \
      ((uint64_t)(buf)[4] << 24) + ((uint64_t)(buf)[5] << 16) + \
      ((uint64_t)(buf)[6] << 8) + (uint64_t)(buf)[7])
-uint8_t txn[350] =
-{
-/* size,upto */
-/*   3,   0 */   0x12U, 0x00U, 0x5FU,                                           /* ttREMIT */
-/*   5,   3 */   0x22U, 0x80U, 0x00U, 0x00U, 0x00U,                            /* Flags */
-/*   5,   8 */   0x24U, 0x00U, 0x00U, 0x00U, 0x00U,                            /* Sequence */
-/*   6,  13 */   0x20U, 0x1AU, 0x00U, 0x00U, 0x00U, 0x00U,                     /* FirstLedgerSequence */
-/*   6,  19 */   0x20U, 0x1BU, 0x00U, 0x00U, 0x00U, 0x00U,                     /* LastLedgerSequence */
-/*   9,  25 */   0x68U, 0x40U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, /* Fee */
-/*  35,  34 */   0x73U, 0x21U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* SigningPubKey */
-/*  22,  69 */   0x81U, 0x14U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,        /* Account */
-/*  22,  91 */   0x83U, 0x14U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,        /* Destination */
-/* 116, 113 */   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* EmitDetails */
-                 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-                 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-/*   0, 229 */   /* Amounts array appended here */
-};
-#define BASE_SIZE 229U
-#define FLS_OUT (txn + 15U)
-#define LLS_OUT (txn + 21U)
-#define FEE_OUT (txn + 26U)
-#define HOOK_ACC (txn + 71U)
-#define DEST_ACC (txn + 93U)
-#define EMIT_OUT (txn + 113U)
-#define AMOUNTS_OUT (txn + 229U)
+
+uint8_t PHASE_MULTIPLIER[4] = {100, 75, 50, 25};
+
+// Remit with one IOU AmountEntry; field offsets come from EmitTxn.h
+uint8_t txn[ETXN_REMIT_BASE_SIZE + ETXN_AMOUNTS_SIZE(1, 0)] = { ETXN_REMIT_INIT };
+
 int64_t hook(uint32_t reserved) {
     TRACESTR("IDOM :: Initial Dex Offering :: Called");
     uint8_t hook_acc[20];
@@ -58,9 +42,8 @@ int64_t hook(uint32_t reserved) {
             if (!BUFFER_EQUAL_20(otxn_acc, admin_acc))
                 NOPE("Unauthorized invoke.");
         }
-        uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
         uint8_t existing_start_buf[4];
-        if (state(SBUF(existing_start_buf), SBUF(start_key)) == 4) {
+        if (state(SBUF(existing_start_buf), SKEY("START")) == 4) {
             uint32_t existing_start = UINT32_FROM_BUF(existing_start_buf);
             int64_t current_ledger = ledger_seq();
             if ((uint32_t)current_ledger >= existing_start)
@@ -70,13 +53,12 @@ int64_t hook(uint32_t reserved) {
         int64_t wp_len = hook_param(SBUF(wp_buf), "WP_LNK", 6);
         if (wp_len < 1)
             NOPE("WP_LNK parameter not set.");
-        uint8_t interval_key[8] = {'I','N','T','E','R','V','A','L'};
         uint8_t interval_buf[4];
-        if (hook_param(SBUF(interval_buf), SBUF(interval_key)) != 4)
+        if (hook_param(SBUF(interval_buf), SKEY("INTERVAL")) != 4)
             NOPE("INTERVAL not set on install.");
         uint32_t interval_offset = UINT32_FROM_BUF(interval_buf);
         uint8_t start_buf[4];
-        int64_t start_len = otxn_param(SBUF(start_buf), SBUF(start_key));
+        int64_t start_len = otxn_param(SBUF(start_buf), SKEY("START"));
         if (start_len != 4)
             NOPE("Invalid START parameter.");
         uint32_t start_offset = UINT32_FROM_BUF(start_buf);
@@ -90,26 +72,25 @@ int64_t hook(uint32_t reserved) {
         TRACEVAR(interval_offset);
         TRACEVAR(start_ledger);
         TRACEVAR(end_ledger);
-        uint8_t wp_lnk_key[6] = {'W', 'P', '_', 'L', 'N', 'K'};
-        if (state_set(wp_buf, wp_len, wp_lnk_key, 6) < 0)
+        if (state_set(wp_buf, wp_len, SKEY("WP_LNK")) < 0)
             NOPE("Failed to store WP_LNK in state.");
         uint8_t start_state[4];
         UINT32_TO_BUF(start_state, start_ledger);
         uint8_t end_state[4];
         UINT32_TO_BUF(end_state, end_ledger);
-        uint8_t end_key[3] = {'E', 'N', 'D'};
-        if (state_set(start_state, 4, start_key, 5) < 0 ||
-            state_set(interval_buf, 4, interval_key, 8) < 0 ||
-            state_set(end_state, 4, end_key, 3) < 0)
+        if (state_set(start_state, 4, SKEY("START")) < 0 ||
+            state_set(interval_buf, 4, SKEY("INTERVAL")) < 0 ||
+            state_set(end_state, 4, SKEY("END")) < 0)
             NOPE("Failed to set state.");
         uint8_t soft_cap_buf[8];
         if (hook_param(SBUF(soft_cap_buf), "SOFT_CAP", 8) != 8)
             NOPE("SOFT_CAP parameter not set.");
-        uint8_t soft_cap_key[8] = {'S', 'O', 'F', 'T', '_', 'C', 'A', 'P'};
-        if (state_set(SBUF(soft_cap_buf), soft_cap_key, 8) < 0)
+        if (state_set(SBUF(soft_cap_buf), SKEY("SOFT_CAP")) < 0)
             NOPE("Failed to store SOFT_CAP in state.");
         DONE("Window set.");
     }
+    if (tt != ttPAYMENT)
+        DONE("Passed :: Not a payment.");
     uint8_t otxn_acc[20];
     if (otxn_field(SBUF(otxn_acc), sfAccount) != 20)
         NOPE("Failed to get origin account.");
@@ -128,26 +109,22 @@ int64_t hook(uint32_t reserved) {
             int64_t balance_xfl = slot_float(1);
             int64_t balance_drops = float_int(balance_xfl, 6, 0);
             int64_t outgoing_drops = AMOUNT_TO_DROPS(amount_buffer);
-            uint8_t xah_key[3] = {'X', 'A', 'H'};
             uint8_t xah_buf[8];
             uint64_t total_xah = 0;
-            if (state(SBUF(xah_buf), SBUF(xah_key)) == 8)
+            if (state(SBUF(xah_buf), SKEY("XAH")) == 8)
                 total_xah = UINT64_FROM_BUF(xah_buf);
-            uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
-            uint8_t interval_key[8] = {'I','N','T','E','R','V','A','L'};
             uint8_t start_buf[4];
             uint8_t interval_buf[4];
-            if (state(SBUF(start_buf), SBUF(start_key)) == 4 &&
-                state(SBUF(interval_buf), SBUF(interval_key)) == 4) {
+            if (state(SBUF(start_buf), SKEY("START")) == 4 &&
+                state(SBUF(interval_buf), SKEY("INTERVAL")) == 4) {
                 uint32_t start_ledger = UINT32_FROM_BUF(start_buf);
                 uint32_t interval_offset = UINT32_FROM_BUF(interval_buf);
                 uint32_t phase4_end = start_ledger + (4 * interval_offset);
                 int64_t current_ledger = ledger_seq();
                 uint32_t current_ledger_u = (uint32_t)current_ledger;
                 if (current_ledger_u >= phase4_end) {
-                    uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
                     uint8_t refund_flag[1];
-                    int64_t refund_check = state(SBUF(refund_flag), SBUF(refund_key));
+                    int64_t refund_check = state(SBUF(refund_flag), SKEY("REFUND"));
                     if (refund_check < 0) {
                         // Evaluate soft cap
                         uint8_t soft_cap_buf[8];
@@ -155,29 +132,26 @@ int64_t hook(uint32_t reserved) {
                             uint64_t soft_cap_xah = UINT64_FROM_BUF(soft_cap_buf);
                             uint8_t total_xah_buf[8];
                             uint64_t total_xah_eval = 0;
-                            if (state(SBUF(total_xah_buf), SBUF(xah_key)) == 8)
+                            if (state(SBUF(total_xah_buf), SKEY("XAH")) == 8)
                                 total_xah_eval = UINT64_FROM_BUF(total_xah_buf);
                             if (total_xah_eval >= soft_cap_xah) {
                                 uint8_t refund_inactive[1] = {0};
-                                state_set(SBUF(refund_inactive), SBUF(refund_key));
-                                uint8_t total_raised_key[12] = {'T', 'O', 'T', 'A', 'L', '_', 'R', 'A', 'I', 'S', 'E', 'D'};
-                                state_set(SBUF(total_xah_buf), SBUF(total_raised_key));
+                                state_set(SBUF(refund_inactive), SKEY("REFUND"));
+                                state_set(SBUF(total_xah_buf), SKEY("TOTAL_RAISED"));
                             } else {
                                 uint8_t refund_active[1] = {1};
-                                state_set(SBUF(refund_active), SBUF(refund_key));
+                                state_set(SBUF(refund_active), SKEY("REFUND"));
                             }
                         }
                     }
                 }
             }
             uint64_t locked_drops = total_xah * 1000000ULL;
-            uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
             uint8_t refund_flag[1];
-            int64_t refund_mode = state(SBUF(refund_flag), SBUF(refund_key));
-            uint8_t end_key[3] = {'E', 'N', 'D'};
+            int64_t refund_mode = state(SBUF(refund_flag), SKEY("REFUND"));
             uint8_t end_buf[4];
             int sale_over = 0;
-            if (state(SBUF(end_buf), SBUF(end_key)) == 4) {
+            if (state(SBUF(end_buf), SKEY("END")) == 4) {
                 uint32_t end_ledger = UINT32_FROM_BUF(end_buf);
                 int64_t current_ledger = ledger_seq();
                 uint32_t current_ledger_u = (uint32_t)current_ledger;
@@ -188,7 +162,7 @@ int64_t hook(uint32_t reserved) {
                 locked_drops = 0;
                 if (total_xah != 0) {
                     uint8_t zero_buf[8] = {0};
-                    state_set(SBUF(zero_buf), SBUF(xah_key));
+                    state_set(SBUF(zero_buf), SKEY("XAH"));
                 }
             }
             if (balance_drops - locked_drops >= outgoing_drops) {
@@ -211,58 +185,51 @@ int64_t hook(uint32_t reserved) {
             user_namespace[i] = otxn_acc[i];
         for (int i = 20; GUARD(32), i < 32; ++i)
             user_namespace[i] = 0;
-        uint8_t ido_data_key[8] = {'I', 'D', 'O', '_', 'D', 'A', 'T', 'A'};
         uint8_t user_data[16];
-        state_foreign(SBUF(user_data), ido_data_key, 8, user_namespace, 32, hook_acc, 20);
+        state_foreign(SBUF(user_data), SKEY("IDO_DATA"), user_namespace, 32, hook_acc, 20);
         uint64_t user_total_xah = UINT64_FROM_BUF(user_data);
         uint64_t user_total_iou = UINT64_FROM_BUF(user_data + 8);
         TRACEVAR(user_total_xah);
         TRACEVAR(user_total_iou);
-        uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
-        uint8_t interval_key[8] = {'I','N','T','E','R','V','A','L'};
         uint8_t start_buf[4];
         uint8_t interval_buf[4];
-        if (state(SBUF(start_buf), SBUF(start_key)) == 4 &&
-            state(SBUF(interval_buf), SBUF(interval_key)) == 4) {
+        if (state(SBUF(start_buf), SKEY("START")) == 4 &&
+            state(SBUF(interval_buf), SKEY("INTERVAL")) == 4) {
             uint32_t start_ledger = UINT32_FROM_BUF(start_buf);
             uint32_t interval_offset = UINT32_FROM_BUF(interval_buf);
             uint32_t phase4_end = start_ledger + (4 * interval_offset);
             int64_t current_ledger = ledger_seq();
             uint32_t current_ledger_u = (uint32_t)current_ledger;
             if (current_ledger_u >= phase4_end) {
-                uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
                 uint8_t refund_flag[1];
-                int64_t refund_check = state(SBUF(refund_flag), SBUF(refund_key));
+                int64_t refund_check = state(SBUF(refund_flag), SKEY("REFUND"));
                 if (refund_check < 0) {
                     uint8_t soft_cap_buf[8];
                     if (hook_param(SBUF(soft_cap_buf), "SOFT_CAP", 8) == 8) {
                         uint64_t soft_cap_xah = UINT64_FROM_BUF(soft_cap_buf);
-                        uint8_t xah_key[3] = {'X', 'A', 'H'};
                         uint8_t total_xah_buf[8];
                         uint64_t total_xah = 0;
-                        if (state(SBUF(total_xah_buf), SBUF(xah_key)) == 8)
+                        if (state(SBUF(total_xah_buf), SKEY("XAH")) == 8)
                             total_xah = UINT64_FROM_BUF(total_xah_buf);
                         TRACEVAR(total_xah);
                         TRACEVAR(soft_cap_xah);
                         if (total_xah < soft_cap_xah) {
                             uint8_t refund_active[1] = {1};
-                            state_set(SBUF(refund_active), SBUF(refund_key));
+                            state_set(SBUF(refund_active), SKEY("REFUND"));
                             TRACESTR("IDOM :: Soft cap NOT met. Phase 5 is now REFUND period.");
                         } else {
                             uint8_t refund_inactive[1] = {0};
-                            state_set(SBUF(refund_inactive), SBUF(refund_key));
+                            state_set(SBUF(refund_inactive), SKEY("REFUND"));
                            TRACESTR("IDOM :: Soft cap MET. Sale successful!");
-                            uint8_t total_raised_key[12] = {'T', 'O', 'T', 'A', 'L', '_', 'R', 'A', 'I', 'S', 'E', 'D'};
-                            state_set(SBUF(total_xah_buf), SBUF(total_raised_key));
+                            state_set(SBUF(total_xah_buf), SKEY("TOTAL_RAISED"));
                             TRACESTR("IDOM :: Soft cap met. Funds will unlock after cooldown period.");
                         }
                     }
                 }
             }
         }
-        uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
         uint8_t refund_flag[1];
-        int64_t refund_mode = state(SBUF(refund_flag), SBUF(refund_key));
+        int64_t refund_mode = state(SBUF(refund_flag), SKEY("REFUND"));
         int is_refund_active = (refund_mode == 1 && refund_flag[0] == 1);
 
         if (is_refund_active) {
@@ -270,9 +237,8 @@ int64_t hook(uint32_t reserved) {
         } else {
             if (iou_amount != user_total_iou)
                 UNWIND("Amount not exact to total IOU.");
-            uint8_t end_key[3] = {'E', 'N', 'D'};
             uint8_t end_buf[4];
-            if (state(SBUF(end_buf), SBUF(end_key)) == 4) {
+            if (state(SBUF(end_buf), SKEY("END")) == 4) {
                 uint32_t end_ledger = UINT32_FROM_BUF(end_buf);
                 int64_t current_ledger = ledger_seq();
                 uint32_t current_ledger_u = (uint32_t)current_ledger;
@@ -288,35 +254,31 @@ int64_t hook(uint32_t reserved) {
         uint8_t emithash[32];
         if (emit(SBUF(emithash), SBUF(pay_txn)) < 0)
             UNWIND("Emit failed.");
-        uint8_t exec_key[4] = {'E', 'X', 'E', 'C'};
-        uint8_t xah_key[3] = {'X', 'A', 'H'};
-        uint8_t iou_key[3] = {'I', 'O', 'U'};
         uint8_t exec_buf[8];
-        if (state(SBUF(exec_buf), SBUF(exec_key)) == 8) {
+        if (state(SBUF(exec_buf), SKEY("EXEC")) == 8) {
             uint64_t executions = UINT64_FROM_BUF(exec_buf) - 1;
             UINT64_TO_BUF(exec_buf, executions);
-            state_set(SBUF(exec_buf), SBUF(exec_key));
+            state_set(SBUF(exec_buf), SKEY("EXEC"));
         }
         uint8_t xah_buf[8];
-        if (state(SBUF(xah_buf), SBUF(xah_key)) == 8) {
+        if (state(SBUF(xah_buf), SKEY("XAH")) == 8) {
             uint64_t total_xah = UINT64_FROM_BUF(xah_buf) - user_total_xah;
             UINT64_TO_BUF(xah_buf, total_xah);
-            state_set(SBUF(xah_buf), SBUF(xah_key));
+            state_set(SBUF(xah_buf), SKEY("XAH"));
         }
         uint8_t iou_buf[8];
-        if (state(SBUF(iou_buf), SBUF(iou_key)) == 8) {
+        if (state(SBUF(iou_buf), SKEY("IOU")) == 8) {
             uint64_t total_iou = UINT64_FROM_BUF(iou_buf) - user_total_iou;
             UINT64_TO_BUF(iou_buf, total_iou);
-            state_set(SBUF(iou_buf), SBUF(iou_key));
+            state_set(SBUF(iou_buf), SKEY("IOU"));
         }
-        state_foreign_set(0, 0, ido_data_key, 8, user_namespace, 32, hook_acc, 20);
+        state_foreign_set(0, 0, SKEY("IDO_DATA"), user_namespace, 32, hook_acc, 20);
         DONE("Unwind :: XAH returned.");
     }
     uint8_t otxn_wp_buf[256];
     int64_t otxn_wp_len = otxn_param(SBUF(otxn_wp_buf), "WP_LNK", 6);
-    uint8_t wp_lnk_key[6] = {'W', 'P', '_', 'L', 'N', 'K'};
     uint8_t stored_wp_buf[256];
-    int64_t stored_wp_len = state(SBUF(stored_wp_buf), SBUF(wp_lnk_key));
+    int64_t stored_wp_len = state(SBUF(stored_wp_buf), SKEY("WP_LNK"));
     if (stored_wp_len < 1)
         NOPE("WP_LNK not found in state, awaiting issuer initialization.");
     if (otxn_wp_len != stored_wp_len)
@@ -326,17 +288,14 @@ int64_t hook(uint32_t reserved) {
             REJECT("WP_LNK parameter does not match. Verify whitepaper link.");
     }
     TRACESTR("IDOM :: WP_LNK validated - user acknowledged documentation.");
-    uint8_t interval_key[8] = {'I','N','T','E','R','V','A','L'};
     uint8_t interval_param_buf[4];
-    if (hook_param(SBUF(interval_param_buf), SBUF(interval_key)) != 4)
+    if (hook_param(SBUF(interval_param_buf), SKEY("INTERVAL")) != 4)
         NOPE("INTERVAL not set.");
     uint32_t interval_offset = UINT32_FROM_BUF(interval_param_buf);
-    uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
-    uint8_t end_key[3] = {'E', 'N', 'D'};
     uint8_t start_buf[4];
     uint8_t end_buf[4];
-    if (state(SBUF(start_buf), SBUF(start_key)) != 4 ||
-        state(SBUF(end_buf), SBUF(end_key)) != 4)
+    if (state(SBUF(start_buf), SKEY("START")) != 4 ||
+        state(SBUF(end_buf), SKEY("END")) != 4)
         NOPE("Window not set.");
     uint32_t start_ledger = UINT32_FROM_BUF(start_buf);
     uint32_t end_ledger = UINT32_FROM_BUF(end_buf);
@@ -344,38 +303,34 @@ int64_t hook(uint32_t reserved) {
     uint32_t current_ledger_u = (uint32_t)current_ledger;
     uint32_t phase4_end = start_ledger + (4 * interval_offset);
     if (current_ledger_u >= phase4_end) {
-        uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
         uint8_t refund_flag[1];
-        int64_t refund_check = state(SBUF(refund_flag), SBUF(refund_key));
+        int64_t refund_check = state(SBUF(refund_flag), SKEY("REFUND"));
         if (refund_check < 0) {
             uint8_t soft_cap_buf[8];
             if (hook_param(SBUF(soft_cap_buf), "SOFT_CAP", 8) != 8)
                 NOPE("SOFT_CAP parameter not set.");
             uint64_t soft_cap_xah = UINT64_FROM_BUF(soft_cap_buf);
-            uint8_t xah_key[3] = {'X', 'A', 'H'};
             uint8_t total_xah_buf[8];
             uint64_t total_xah = 0;
-            if (state(SBUF(total_xah_buf), SBUF(xah_key)) == 8)
+            if (state(SBUF(total_xah_buf), SKEY("XAH")) == 8)
                 total_xah = UINT64_FROM_BUF(total_xah_buf);
             TRACEVAR(total_xah);
             TRACEVAR(soft_cap_xah);
             if (total_xah < soft_cap_xah) {
                 uint8_t refund_active[1] = {1};
-                state_set(SBUF(refund_active), SBUF(refund_key));
+                state_set(SBUF(refund_active), SKEY("REFUND"));
                 TRACESTR("IDOM :: Soft cap NOT met. Phase 5 is now REFUND period.");
             } else {
                 uint8_t refund_inactive[1] = {0};
-                state_set(SBUF(refund_inactive), SBUF(refund_key));
+                state_set(SBUF(refund_inactive), SKEY("REFUND"));
                 TRACESTR("IDOM :: Soft cap MET. Sale successful!");
-                uint8_t total_raised_key[12] = {'T', 'O', 'T', 'A', 'L', '_', 'R', 'A', 'I', 'S', 'E', 'D'};
-                state_set(SBUF(total_xah_buf), SBUF(total_raised_key));
+                state_set(SBUF(total_xah_buf), SKEY("TOTAL_RAISED"));
             }
         }
     }
     if (current_ledger_u >= end_ledger) {
-        uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
         uint8_t refund_flag[1];
-        int64_t refund_mode = state(SBUF(refund_flag), SBUF(refund_key));
+        int64_t refund_mode = state(SBUF(refund_flag), SKEY("REFUND"));
         
         if (refund_mode == 1 && refund_flag[0] == 1)
             REJECT("Window ended. Soft cap not met. Send IOU to unwind for refund.");
@@ -386,55 +341,42 @@ int64_t hook(uint32_t reserved) {
     TRACEVAR(received_xah);
     uint32_t elapsed = current_ledger_u - start_ledger;
     uint32_t phase = (elapsed / interval_offset) + 1;
-    int64_t multiplier = 0;
-    if (phase == 1) {
-        multiplier = 100;
-        TRACESTR("IDOM :: Phase 1 active, 100x multiplyer is in effect.");
-    } else if (phase == 2) {
-        multiplier = 75;
-        TRACESTR("IDOM :: Phase 2 active, 75x multiplyer is in effect.");
-    } else if (phase == 3) {
-        multiplier = 50;
-        TRACESTR("IDOM :: Phase 3 active, 50x multiplyer is in effect.");
-    } else if (phase == 4) {
-        multiplier = 25;
-        TRACESTR("IDOM :: Phase 4 active, 25x multiplyer is in effect.");
-    } else if (phase == 5) {
+    if (phase == 5) {
         TRACESTR("IDOM :: Phase 5 active, Cooldown period enabled.");
         REJECT("Phase 5 is for unwinding only, no new deposits.");
-    } else {
+    } else if (phase > 4) {
         REJECT("Invalid phase.");
     }
+    int64_t multiplier = PHASE_MULTIPLIER[phase - 1];
+    TRACEVAR(phase);
+    TRACEVAR(multiplier);
     int64_t issued_amount = received_xah * multiplier;
     if (issued_amount == 0)
         FAIL("Issued amount is zero.");
     TRACEVAR(issued_amount);
-    uint8_t exec_key[4] = {'E', 'X', 'E', 'C'};
-    uint8_t xah_key[3] = {'X', 'A', 'H'};
-    uint8_t iou_key[3] = {'I', 'O', 'U'};
     uint8_t exec_buf[8] = {0};
     uint64_t executions = 0;
-    if (state(SBUF(exec_buf), SBUF(exec_key)) == 8)
+    if (state(SBUF(exec_buf), SKEY("EXEC")) == 8)
         executions = UINT64_FROM_BUF(exec_buf);
     executions++;
     UINT64_TO_BUF(exec_buf, executions);
-    if (state_set(SBUF(exec_buf), SBUF(exec_key)) < 0)
+    if (state_set(SBUF(exec_buf), SKEY("EXEC")) < 0)
         FAIL("Failed to update executions counter.");
     uint8_t xah_buf[8] = {0};
     uint64_t total_xah = 0;
-    if (state(SBUF(xah_buf), SBUF(xah_key)) == 8)
+    if (state(SBUF(xah_buf), SKEY("XAH")) == 8)
         total_xah = UINT64_FROM_BUF(xah_buf);
     total_xah += received_xah;
     UINT64_TO_BUF(xah_buf, total_xah);
-    if (state_set(SBUF(xah_buf), SBUF(xah_key)) < 0)
+    if (state_set(SBUF(xah_buf), SKEY("XAH")) < 0)
         FAIL("Failed to update XAH total.");
     uint8_t iou_buf[8] = {0};
     uint64_t total_iou = 0;
-    if (state(SBUF(iou_buf), SBUF(iou_key)) == 8)
+    if (state(SBUF(iou_buf), SKEY("IOU")) == 8)
         total_iou = UINT64_FROM_BUF(iou_buf);
     total_iou += issued_amount;
     UINT64_TO_BUF(iou_buf, total_iou);
-    if (state_set(SBUF(iou_buf), SBUF(iou_key)) < 0)
+    if (state_set(SBUF(iou_buf), SKEY("IOU")) < 0)
         FAIL("Failed to update IOU total.");
     uint8_t phase_key[6];
     phase_key[0] = 'P';
@@ -456,69 +398,37 @@ int64_t hook(uint32_t reserved) {
         user_namespace[i] = otxn_acc[i];
     for (int i = 20; GUARD(32), i < 32; ++i)
         user_namespace[i] = 0;
-    uint8_t ido_data_key[8] = {'I', 'D', 'O', '_', 'D', 'A', 'T', 'A'};
     uint8_t user_data[16] = {0};
-    state_foreign(SBUF(user_data), ido_data_key, 8, user_namespace, 32, hook_acc, 20);
+    state_foreign(SBUF(user_data), SKEY("IDO_DATA"), user_namespace, 32, hook_acc, 20);
     uint64_t user_total_xah = UINT64_FROM_BUF(user_data);
     uint64_t user_total_iou = UINT64_FROM_BUF(user_data + 8);
     user_total_xah += received_xah;
     user_total_iou += issued_amount;
     UINT64_TO_BUF(user_data, user_total_xah);
     UINT64_TO_BUF(user_data + 8, user_total_iou);
-    if (state_foreign_set(user_data, 16, ido_data_key, 8, user_namespace, 32, hook_acc, 20) < 0)
+    if (state_foreign_set(user_data, 16, SKEY("IDO_DATA"), user_namespace, 32, hook_acc, 20) < 0)
         FAIL("Failed to update user data.");
-    uint8_t* amounts_ptr = AMOUNTS_OUT;
-    *amounts_ptr++ = 0xF0U;
-    *amounts_ptr++ = 0x5CU;
-    *amounts_ptr++ = 0xE0U;
-    *amounts_ptr++ = 0x5BU;
     uint8_t currency[20];
     if (hook_param(SBUF(currency), "CURRENCY", 8) != 20)
         NOPE("CURRENCY parameter not set.");
     int64_t amount_xfl = float_set(0, issued_amount);
-    int32_t amount_len_remit = float_sto(
-        amounts_ptr, 49,
-        currency, 20,
-        hook_acc, 20,
-        amount_xfl,
-        sfAmount
-    );
+    uint8_t* amounts_ptr;
+    int32_t amount_len_remit;
+    ETXN_AMOUNTS_BEGIN(amounts_ptr, txn);
+    ETXN_AMOUNTS_ADD_IOU(amounts_ptr, amount_len_remit, currency, hook_acc, amount_xfl);
     if (amount_len_remit < 0)
         FAIL("Failed to serialize amount.");
-    amounts_ptr += amount_len_remit;
-    *amounts_ptr++ = 0xE1U;
-    *amounts_ptr++ = 0xF1U;
-    int32_t amounts_len = amounts_ptr - AMOUNTS_OUT;
-    hook_account(HOOK_ACC, 20);
-    for (int i = 0; GUARD(20), i < 20; ++i)
-        DEST_ACC[i] = otxn_acc[i];
+    ETXN_AMOUNTS_END(amounts_ptr);
+    hook_account(txn + ETXN_REMIT_ACC_OUT, 20);
+    ACCOUNT_TO_BUF(txn + ETXN_REMIT_DEST_OUT, otxn_acc);
     etxn_reserve(1);
-    int32_t total_size = BASE_SIZE + amounts_len;
-    etxn_details(EMIT_OUT, 116U);
-    int64_t seq = ledger_seq() + 1;
-    txn[15] = (seq >> 24U) & 0xFFU;
-    txn[16] = (seq >> 16U) & 0xFFU;
-    txn[17] = (seq >>  8U) & 0xFFU;
-    txn[18] = seq & 0xFFU;
-    seq += 4;
-    txn[21] = (seq >> 24U) & 0xFFU;
-    txn[22] = (seq >> 16U) & 0xFFU;
-    txn[23] = (seq >>  8U) & 0xFFU;
-    txn[24] = seq & 0xFFU;
+    int32_t total_size = ETXN_REMIT_SIZE(txn, amounts_ptr);
+    etxn_details(txn + ETXN_REMIT_DETAILS_OUT, ETXN_DETAILS_SIZE);
+    ETXN_SET_LEDGERS(txn, ledger_seq());
     int64_t fee = etxn_fee_base(txn, total_size);
     if (fee < 0)
         FAIL("Fee calculation failed.");
-    uint64_t fee_tmp = fee;
-    uint8_t* fee_ptr = (uint8_t*)&fee;
-    *fee_ptr++ = 0b01000000 + ((fee_tmp >> 56) & 0b00111111);
-    *fee_ptr++ = (fee_tmp >> 48) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >> 40) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >> 32) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >> 24) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >> 16) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >>  8) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >>  0) & 0xFFU;
-    *((uint64_t*)(txn + 26)) = fee;
+    ETXN_SET_FEE(txn + ETXN_REMIT_FEE_OUT, fee);
     uint8_t emithash[32];
     int64_t emit_result = emit(SBUF(emithash), txn, total_size);
     if (emit_result < 0)
@@ -1,4 +1,7 @@
 #include "hookapi.h"
+#include "../../Common/BuildProfile.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
 #define UINT32_FROM_BUF(buf) \
     (((uint32_t)(buf)[0] << 24) + ((uint32_t)(buf)[1] << 16) + \
      ((uint32_t)(buf)[2] << 8) + (uint32_t)(buf)[3])
@@ -7,8 +10,9 @@ uint8_t IDO_HOOK_HASH[32] = {0x33,0x09,0x61,0xA6,0x81,0x1A,0x03,0x13,0x1B,0x59,0
 uint8_t REWARDS_HOOK_HASH[32] = {0x8C,0xFC,0x9A,0xA6,0xAA,0x4A,0x85,0x8D,0xEF,0x04,0xD3,0x04,0x9D,0x4E,0x7D,0x22,0xA3,0x7F,0x96,0x8D,0x05,0x06,0x34,0x24,0x4E,0xC5,0xDA,0xCE,0xCC,0xE6,0x16,0x0D};
 uint8_t IDO_NAMESPACE[32] = {0x51,0x6B,0xA7,0x92,0x15,0x00,0x22,0x76,0xEF,0x4C,0x38,0x1B,0x90,0x19,0x55,0xC5,0x3A,0x04,0x57,0x55,0x89,0x60,0x7E,0x7D,0xBA,0x20,0x46,0x8D,0xD3,0x43,0xDD,0x72};
 
-#define DONE(msg)   accept(SBUF(msg), __LINE__)
-#define NOPE(msg)   rollback(SBUF(msg), __LINE__)
+#define HOOK_RESULT_ID RC_ROUTER
+#define DONE(msg)   RESULT_ACCEPT(msg)
+#define NOPE(msg)   RESULT_ROLLBACK(msg)
 #define SKIP()      { \
     int64_t r = hook_skip(IDO_HOOK_HASH, 32, 0); \
     if (r < 0) NOPE("Router: Skip failed"); \
@@ -69,13 +73,13 @@ int64_t hook(int32_t reserved) {
         SKIP();
         NOPE("Router: Invoke without START or rewards params → invalid");
     }
+    if (ttype != ttPAYMENT)
+        DONE("Router: Not a payment → pass");
     int64_t current_ledger = ledger_seq();
-    uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
-    uint8_t end_key[3] = {'E', 'N', 'D'};
     uint8_t start_buf[4];
     uint8_t end_buf[4];
-    int64_t start_len = state_foreign(SBUF(start_buf), SBUF(start_key), SBUF(IDO_NAMESPACE), SBUF(hookacc));
-    int64_t end_len = state_foreign(SBUF(end_buf), SBUF(end_key), SBUF(IDO_NAMESPACE), SBUF(hookacc));
+    int64_t start_len = state_foreign(SBUF(start_buf), SKEY("START"), SBUF(IDO_NAMESPACE), SBUF(hookacc));
+    int64_t end_len = state_foreign(SBUF(end_buf), SKEY("END"), SBUF(IDO_NAMESPACE), SBUF(hookacc));
     int window_set = (start_len == 4 && end_len == 4);
     int window_active = 0;
     if (window_set) {
@@ -86,9 +90,8 @@ int64_t hook(int32_t reserved) {
             window_active = 1;
         }
     }
-    uint8_t refund_key[6] = {'R','E','F','U','N','D'};
     uint8_t refund_flag = 0;
-    int64_t refund_len = state_foreign(&refund_flag, 1, SBUF(refund_key), SBUF(IDO_NAMESPACE), SBUF(hookacc));
+    int64_t refund_len = state_foreign(&refund_flag, 1, SKEY("REFUND"), SBUF(IDO_NAMESPACE), SBUF(hookacc));
     int refund_mode = (refund_len == 1 && refund_flag == 1);
     if (refund_mode) {
         if (ttype == 99) {
@@ -124,9 +127,8 @@ int64_t hook(int32_t reserved) {
             SKIP_REWARDS();
             DONE("Router: XAH + WP_LNK → run IDO");
         }
-        uint8_t xah_key[3] = {'X','A','H'};
         uint8_t dummy_buf[8];
-        if (state(SBUF(dummy_buf), SBUF(xah_key)) == 8) {
+        if (state(SBUF(dummy_buf), SKEY("XAH")) == 8) {
             SKIP_REWARDS();
             DONE("Router: XAH + raised exists → run IDO");
         }
@@ -137,9 +139,8 @@ int64_t hook(int32_t reserved) {
     for (i = 0; GUARD(20), i < 20; ++i) {
         ns[i] = sender[i];
     }
-    uint8_t user_key[8] = {'I','D','O','_','D','A','T','A'};
     uint8_t user_data[16];
-    int64_t has_part = state_foreign(SBUF(user_data), SBUF(user_key), SBUF(ns), SBUF(hookacc));
+    int64_t has_part = state_foreign(SBUF(user_data), SKEY("IDO_DATA"), SBUF(ns), SBUF(hookacc));
     if (has_part == 16) {
         SKIP_REWARDS();
         DONE("Router: IOU + participation → run IDO");
@@ -15,47 +15,209 @@
 //   'INTERVAL' (4 bytes): Ledger interval per phase (big-endian uint32).
 //   'SOFT_CAP' (8 bytes): Soft cap in XAH (big-endian uint64).
 //   'WP_LNK' (variable): Whitepaper/documentation link for validation.
+//   'SCHEDULE' (optional, 12 bytes per phase, up to 8 phases): the sale phases in
+//   order, each { multiplier:4, IOU cap:8 } big-endian; a cap of 0 leaves the phase
+//   uncapped. Without it the sale runs the four phases listed under Phases.
 //
 // Admin Configuration Parameters (via invoke):
 //   'START' (4 bytes): Ledger offset to start the IDO window (big-endian uint32).
-//   'WP_LNK' (variable): Whitepaper link to store in state.
+//   START stores the hash of the WP_LNK hook parameter.
+//   'REFUND_SWEEP' (any value): Once the sale is refunding, repay the next
+//   SWEEP_BATCH participants in the index and advance its cursor. Invoke again
+//   until the sweep reports complete. A sale past its close that is not yet
+//   finalized is settled first.
+//
+// Finalization (via invoke, any account):
+//   'FINALIZE' (any value): Once the last sale phase is over, settle the sale
+//   against the soft cap. Otherwise the first payment after it settles it.
 //
 // User Actions:
 //   - Deposit XAH during active phases to receive IOU tokens.
-//   - Provide 'WP_LNK' parameter matching stored link for validation.
+//   - Provide 'WP_LNK' parameter, the whitepaper link or its 32-byte SHA-512Half,
+//     matching the stored hash for validation.
 //   - Unwind IOU tokens for XAH refunds during eligible periods.
 //
-// Phases:
+// Phases (default schedule):
 //   Phase 1: 100x multiplier
 //   Phase 2: 75x multiplier
 //   Phase 3: 50x multiplier
 //   Phase 4: 25x multiplier
-//   Phase 5: Cooldown/unwind period
+//   Then one INTERVAL of cooldown/unwind period. A SCHEDULE of N phases ends its
+//   sale after N intervals and its cooldown after N + 1.
 //
 // Usage:
 //   - Admin installs hook with parameters and invokes with 'START' to begin IDO.
 //   - Users send XAH payments with 'WP_LNK' during active window.
 //   - Hook issues IOU tokens via Remit transactions and tracks participation.
-//   - After window ends, evaluates soft cap; enables refunds if not met.
+//   - After the last sale phase, the sale is settled once against the soft cap and
+//     the result is final: refunds if it was not met, funds unlock after the
+//     cooldown if it was.
 //   - Users can unwind by sending exact IOU amount back for proportional XAH refund.
+//   - A failed sale can instead be repaid by the admin with REFUND_SWEEP invokes.
+//     Swept participants keep their IOU, but their records are cleared and
+//     marked repaid, so the IOU neither unwinds nor earns RewardsMaster
+//     rewards. A refund-mode unwind marks the record the same way.
+//
+// Storage Structure:
+//   - Sale record, key "IDO_SALE", read by RouterMaster as well:
+//     { version:1, status:1, start:4, end:4, interval:4, soft cap:8, XAH:8,
+//       IOU:8, executions:8, total raised:8, close:4, phase count:1,
+//       per phase { multiplier:4, IOU cap:8, IOU issued:8, deposits:4 } }
+//     START copies the schedule in; a payment loads the record once and
+//     writes it back at most once. A phase's issued IOU counts toward its cap
+//     and is not returned by unwinds.
+//     An install from before the record keeps its sale under one key per
+//     field ("START", "END", "INTERVAL", "REFUND", "XAH", "IOU", "EXEC",
+//     "TOTAL_RAISED", "PHASE1".."PHASE4"); until the sale next changes and
+//     the record is written, it is built from them on each run.
+//   - SHA-512Half of the whitepaper link, key "WP_HASH" (32 bytes). A sale
+//     started before it has the link itself under "WP_LNK"; the first
+//     deposit hashes that and stores "WP_HASH".
+//   - Per user, key "IDO_DATA" in the user's namespace, shared with RewardsMaster:
+//     { XAH deposited:8, IOU received:8, last claim ledger:4, total claims:4 }
+//     The claim fields belong to RewardsMaster and are kept across deposits;
+//     a repaid record has total claims 0xFFFFFFFF.
+//   - Participant index, append-only: key "IDX\0" + bucket:4 holds up to 12
+//     account IDs, and key "IDO_INDEX" holds { count:4, sweep cursor:4 }. A
+//     deposit that finds no XAH on the user's record appends the account, so
+//     an account that unwinds and deposits again is listed twice; the sweep
+//     skips records already empty. Accounts whose deposits all predate the
+//     index are not listed; REFUND_SWEEP does not reach them, and they
+//     unwind their IOU as before.
 //******
 
 #include "hookapi.h"
+#include "../../Common/BuildProfile.h"
+#include "../../Common/EmitTxn.h"
+#include "../../Common/UserRecord.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
 
 // Define NULL if not already defined
 #ifndef NULL
 #define NULL 0
 #endif
 
-// Field codes for Remit transaction Amounts array
-#define sfAmountEntry ((14U << 16U) + 91U)  // 0xE0 0x5B
-#define sfAmounts ((15U << 16U) + 92U)      // 0xF0 0x5C
-
 // Utility macros
-#define DONE(x) accept(SBUF(x), __LINE__)
-#define NOPE(x) rollback(SBUF(x), __LINE__)
+#define HOOK_RESULT_ID RC_IDOMASTER
+#define DONE(x) RESULT_ACCEPT(x)
+#define NOPE(x) RESULT_ROLLBACK(x)
 #define GUARD(maxiter) _g(__LINE__, (maxiter) + 1)
 
+// Per-user IDO_DATA record, laid out as in RewardsMaster
+#define USER_XAH 0
+#define USER_IOU 8
+#define USER_LAST_CLAIM 16
+#define USER_CLAIMS 20
+#define USER_DATA_SIZE 24
+// USER_CLAIMS of a record the failed sale has repaid; RewardsMaster pays
+// it no further rewards
+#define USER_REFUNDED 0xFFFFFFFFU
+#define IDO_DATA_KEY SKEY_PTR("IDO_DATA")          // 8 bytes
+
+// Sale record, all fields big-endian. RouterMaster reads the window,
+// close, status and XAH total at the same offsets.
+#define SALE_VERSION 2
+#define SALE_STATUS 1
+#define SALE_START 2
+#define SALE_END 6
+#define SALE_INTERVAL 10
+#define SALE_SOFT_CAP 14
+#define SALE_XAH 22
+#define SALE_IOU 30
+#define SALE_EXEC 38
+#define SALE_RAISED 46
+#define SALE_CLOSE 54                               // end of the last sale phase
+#define SALE_COUNT 58                               // phases in the schedule
+#define SALE_PHASES 59                              // SALE_COUNT x PHASE_SIZE
+#define SALE_MAX_PHASES 8
+#define SALE_SIZE(count) (SALE_PHASES + PHASE_SIZE * (count))
+#define SALE_MAX_SIZE SALE_SIZE(SALE_MAX_PHASES)
+#define SALE_KEY SKEY("IDO_SALE")
+
+// One phase of the sale record; its first 12 bytes are the SCHEDULE entry
+#define PHASE_MULT 0
+#define PHASE_CAP 4
+#define PHASE_ISSUED 12
+#define PHASE_DEPOSITS 20
+#define PHASE_SIZE 24
+#define SCHEDULE_ENTRY 12
+
+// Participant index: header, and buckets of account IDs keyed "IDX\0" + bucket
+#define INDEX_KEY SKEY("IDO_INDEX")
+#define INDEX_COUNT 0
+#define INDEX_CURSOR 4
+#define INDEX_SIZE 8
+#define INDEX_BUCKET_ACCOUNTS 12
+#define INDEX_BUCKET_SIZE (20 * INDEX_BUCKET_ACCOUNTS)
+#define INDEX_BUCKET_KEY(key, bucket)            \
+    {                                            \
+        uint32_t bucket_no = (bucket);           \
+        *(uint32_t*)(key) = *(uint32_t*)"IDX";   \
+        UINT32_TO_BUF((key) + 4, bucket_no);     \
+    }
+
+// Index entries one REFUND_SWEEP covers. Each emitted fee is the base fee
+// times etxn_reserve(), which counts only the records in the batch that
+// are still owed, so N refunds burn N * N base fees: at a 10-drop base
+// a batch of 48 burns 23,040 drops (480 a refund, bench/fees.txt), where
+// the 255 a hook may reserve would burn 650,250 (2,550 a refund). 48 is
+// also four whole index buckets.
+#define SWEEP_BATCH 48
+
+// Sale status: open until the close, then settled against the soft cap
+#define SALE_OPEN 0
+#define SALE_REFUND 1
+#define SALE_MET 2
+
+// Settle an open sale past its close. Runs once: FINALIZE or the first
+// payment after the close stores the status, and nothing changes it.
+#define SALE_FINALIZE(sale)                                                               \
+    {                                                                                     \
+        if (UINT64_FROM_BUF((sale) + SALE_XAH) < UINT64_FROM_BUF((sale) + SALE_SOFT_CAP)) \
+            (sale)[SALE_STATUS] = SALE_REFUND;                                            \
+        else {                                                                            \
+            (sale)[SALE_STATUS] = SALE_MET;                                               \
+            *(uint64_t*)((sale) + SALE_RAISED) = *(uint64_t*)((sale) + SALE_XAH);         \
+        }                                                                                 \
+    }
+
+// Load the sale record into `sale`, which the caller zero-initialises,
+// and set `set` when there is a sale. An install upgraded from one key
+// per field has no record: it is built from those keys instead, with the
+// four default phases they ran, and written by the first path that
+// changes the sale. From then on the old keys are not read.
+#define SALE_LOAD(sale, set)                                                                  \
+    {                                                                                         \
+        (set) = state(SBUF(sale), SALE_KEY) > 0;                                              \
+        if (!(set) && state((uint32_t)((sale) + SALE_START), 4, SKEY("START")) == 4 &&         \
+            state((uint32_t)((sale) + SALE_END), 4, SKEY("END")) == 4 &&                      \
+            state((uint32_t)((sale) + SALE_INTERVAL), 4, SKEY("INTERVAL")) == 4) {             \
+            (set) = 1;                                                                        \
+            (sale)[0] = SALE_VERSION;                                                         \
+            hook_param((uint32_t)((sale) + SALE_SOFT_CAP), 8, "SOFT_CAP", 8);                  \
+            state((uint32_t)((sale) + SALE_XAH), 8, SKEY("XAH"));                              \
+            state((uint32_t)((sale) + SALE_IOU), 8, SKEY("IOU"));                              \
+            state((uint32_t)((sale) + SALE_EXEC), 8, SKEY("EXEC"));                            \
+            state((uint32_t)((sale) + SALE_RAISED), 8, SKEY("TOTAL_RAISED"));                  \
+            uint8_t refund_flag;                                                              \
+            if (state((uint32_t)&refund_flag, 1, SKEY("REFUND")) == 1)                        \
+                (sale)[SALE_STATUS] = refund_flag ? SALE_REFUND : SALE_MET;                   \
+            uint32_t legacy_close = UINT32_FROM_BUF((sale) + SALE_START) +                    \
+                                    4 * UINT32_FROM_BUF((sale) + SALE_INTERVAL);              \
+            UINT32_TO_BUF((sale) + SALE_CLOSE, legacy_close);                                 \
+            (sale)[SALE_COUNT] = 4;                                                           \
+            for (int p = 0; GUARD(4), p < 4; ++p) {                                           \
+                uint8_t* legacy_phase = (sale) + SALE_PHASES + PHASE_SIZE * p;                \
+                *(uint32_t*)(legacy_phase + PHASE_MULT) =                                     \
+                    *(uint32_t*)(DEFAULT_SCHEDULE + SCHEDULE_ENTRY * p);                      \
+                uint8_t deposits[8];                                                          \
+                if (state(SBUF(deposits), (uint32_t)LEGACY_PHASE_KEYS[p], 6) == 8)            \
+                    *(uint32_t*)(legacy_phase + PHASE_DEPOSITS) = *(uint32_t*)(deposits + 4); \
+            }                                                                                 \
+        }                                                                                     \
+    }
+
 // Convert 8-byte buffer to uint64 (big-endian)
 #define UINT64_FROM_BUF(buf) \
     (((uint64_t)(buf)[0] << 56) + ((uint64_t)(buf)[1] << 48) + \
@@ -63,35 +225,19 @@
      ((uint64_t)(buf)[4] << 24) + ((uint64_t)(buf)[5] << 16) + \
      ((uint64_t)(buf)[6] << 8) + (uint64_t)(buf)[7])
 
-// Base Remit transaction template (229 bytes)
-// clang-format off
-uint8_t txn[350] =
-{
-/* size,upto */
-/*   3,   0 */   0x12U, 0x00U, 0x5FU,                                           /* ttREMIT */
-/*   5,   3 */   0x22U, 0x80U, 0x00U, 0x00U, 0x00U,                            /* Flags */
-/*   5,   8 */   0x24U, 0x00U, 0x00U, 0x00U, 0x00U,                            /* Sequence */
-/*   6,  13 */   0x20U, 0x1AU, 0x00U, 0x00U, 0x00U, 0x00U,                     /* FirstLedgerSequence */
-/*   6,  19 */   0x20U, 0x1BU, 0x00U, 0x00U, 0x00U, 0x00U,                     /* LastLedgerSequence */
-/*   9,  25 */   0x68U, 0x40U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, /* Fee */
-/*  35,  34 */   0x73U, 0x21U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* SigningPubKey */
-/*  22,  69 */   0x81U, 0x14U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,        /* Account */
-/*  22,  91 */   0x83U, 0x14U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,        /* Destination */
-/* 116, 113 */   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* EmitDetails */
-                 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-                 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-/*   0, 229 */   /* Amounts array appended here */
+// Sale phases when SCHEDULE is not installed: 100x, 75x, 50x, 25x, uncapped
+uint8_t DEFAULT_SCHEDULE[4 * SCHEDULE_ENTRY] = {
+    0, 0, 0, 100, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 75,  0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 50,  0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 25,  0, 0, 0, 0, 0, 0, 0, 0,
 };
-// clang-format on
 
-#define BASE_SIZE 229U
-#define FLS_OUT (txn + 15U)
-#define LLS_OUT (txn + 21U)
-#define FEE_OUT (txn + 26U)
-#define HOOK_ACC (txn + 71U)
-#define DEST_ACC (txn + 93U)
-#define EMIT_OUT (txn + 113U)
-#define AMOUNTS_OUT (txn + 229U)
+// Per-phase deposit counters of the one-key-per-field layout, 8 bytes each
+static const uint8_t LEGACY_PHASE_KEYS[][6] = {"PHASE1", "PHASE2", "PHASE3", "PHASE4"};
+
+// Remit with one IOU AmountEntry; field offsets come from EmitTxn.h
+uint8_t txn[ETXN_REMIT_BASE_SIZE + ETXN_AMOUNTS_SIZE(1, 0)] = { ETXN_REMIT_INIT };
 
 int64_t hook(uint32_t reserved) {
 
@@ -100,66 +246,199 @@ int64_t hook(uint32_t reserved) {
     // Get hook account (always needed)
     uint8_t hook_acc[20];
     if (hook_account(SBUF(hook_acc)) != 20)
-        rollback(SBUF("IDO :: Error :: Failed to get hook account."), __LINE__);
+        NOPE("IDO :: Error :: Failed to get hook account.");
 
     // Get transaction type immediately for fast branching
     int64_t tt = otxn_type();
 
     // ========================================================================
-    // INVOKE PATH: Set the sale window
+    // INVOKE PATH: Set the sale window, or finalize it
     // ========================================================================
     if (tt == ttINVOKE) {
         // Get originating account
         uint8_t otxn_acc[20];
         if (otxn_field(SBUF(otxn_acc), sfAccount) != 20)
-            rollback(SBUF("IDO :: Error :: Failed to get origin account."), __LINE__);
+            NOPE("IDO :: Error :: Failed to get origin account.");
+
+        // FINALIZE is open to anyone: the outcome is fixed by the totals
+        uint8_t flag_buf[32];
+        if (otxn_param(SBUF(flag_buf), SKEY("FINALIZE")) != DOESNT_EXIST) {
+            uint8_t sale[SALE_MAX_SIZE] = {0};
+            int sale_set;
+            SALE_LOAD(sale, sale_set);
+            if (!sale_set)
+                NOPE("IDO :: Error :: Window not set.");
+            if (sale[SALE_STATUS] != SALE_OPEN)
+                DONE("IDO :: Success :: Sale already finalized.");
+            if ((uint32_t)ledger_seq() < UINT32_FROM_BUF(sale + SALE_CLOSE))
+                NOPE("IDO :: Error :: Sale phases have not ended, cannot finalize.");
+            SALE_FINALIZE(sale);
+            if (state_set(sale, SALE_SIZE(sale[SALE_COUNT]), SALE_KEY) < 0)
+                NOPE("IDO :: Error :: Failed to update sale state.");
+            if (sale[SALE_STATUS] == SALE_REFUND)
+                DONE("IDO :: Success :: Finalized, soft cap not met. Refunds open.");
+            DONE("IDO :: Success :: Finalized, soft cap met.");
+        }
 
         // Check authorization (load admin only when needed)
         if (!BUFFER_EQUAL_20(otxn_acc, hook_acc)) {
             uint8_t admin_acc[20];
             if (hook_param(SBUF(admin_acc), "ADMIN", 5) != 20)
-                rollback(SBUF("IDO :: Error :: ADMIN parameter not set."), __LINE__);
+                NOPE("IDO :: Error :: ADMIN parameter not set.");
             if (!BUFFER_EQUAL_20(otxn_acc, admin_acc))
-                rollback(SBUF("IDO :: Error :: Unauthorized invoke."), __LINE__);
+                NOPE("IDO :: Error :: Unauthorized invoke.");
+        }
+
+        // Load the sale record for a sweep or the restart check
+        uint8_t sale[SALE_MAX_SIZE] = {0};
+        int sale_set;
+        SALE_LOAD(sale, sale_set);
+
+        // REFUND_SWEEP: repay the next participants of a failed sale
+        if (otxn_param(SBUF(flag_buf), SKEY("REFUND_SWEEP")) != DOESNT_EXIST) {
+            if (!sale_set)
+                NOPE("IDO :: Error :: Window not set.");
+
+            // A sale past its close that nothing has finalized settles here,
+            // as it would on the next payment
+            int finalized = sale[SALE_STATUS] == SALE_OPEN &&
+                            (uint32_t)ledger_seq() >= UINT32_FROM_BUF(sale + SALE_CLOSE);
+            if (finalized)
+                SALE_FINALIZE(sale);
+            if (sale[SALE_STATUS] != SALE_REFUND)
+                NOPE("IDO :: Error :: Sale is not refunding, nothing to sweep.");
+
+            uint8_t index[INDEX_SIZE] = {0};
+            state(SBUF(index), INDEX_KEY);
+            uint32_t count = UINT32_FROM_BUF(index + INDEX_COUNT);
+            uint32_t cursor = UINT32_FROM_BUF(index + INDEX_CURSOR);
+            if (cursor >= count) {
+                if (finalized && state_set(sale, SALE_SIZE(sale[SALE_COUNT]), SALE_KEY) < 0)
+                    NOPE("IDO :: Error :: Failed to update sale state.");
+                DONE("IDO :: Success :: Refund sweep complete.");
+            }
+            uint32_t stop = count - cursor > SWEEP_BATCH ? cursor + SWEEP_BATCH : count;
+
+            // Clear the batch's records first and note who is owed what, so
+            // the reserve covers only the refunds emitted. A record listed
+            // twice is empty the second time and is skipped.
+            uint64_t total_xah = UINT64_FROM_BUF(sale + SALE_XAH);
+            uint64_t total_iou = UINT64_FROM_BUF(sale + SALE_IOU);
+            uint64_t executions = UINT64_FROM_BUF(sale + SALE_EXEC);
+            uint8_t payees[20 * SWEEP_BATCH];
+            uint64_t payee_xah[SWEEP_BATCH];
+            uint32_t payable = 0;
+            uint8_t bucket_key[8];
+            uint8_t bucket[INDEX_BUCKET_SIZE];
+            for (uint32_t i = cursor; GUARD(SWEEP_BATCH), i < stop; ++i) {
+                uint32_t slot = i % INDEX_BUCKET_ACCOUNTS;
+                if (i == cursor || slot == 0) {
+                    INDEX_BUCKET_KEY(bucket_key, i / INDEX_BUCKET_ACCOUNTS);
+                    if (state(SBUF(bucket), SBUF(bucket_key)) < 20 * (slot + 1))
+                        NOPE("IDO :: Error :: Participant index is incomplete.");
+                }
+                uint8_t* participant = bucket + 20 * slot;
+
+                uint8_t user_namespace[USER_NS_SIZE];
+                USER_NAMESPACE(user_namespace, participant);
+                uint8_t user_data[USER_DATA_SIZE] = {0};
+                USER_LOAD(user_data, IDO_DATA_KEY, 8, user_namespace, hook_acc);
+                uint64_t user_total_xah = UINT64_FROM_BUF(user_data + USER_XAH);
+                if (user_total_xah == 0)
+                    continue;
+
+                // Take the participant out of the totals and clear the record
+                total_xah -= user_total_xah;
+                total_iou -= UINT64_FROM_BUF(user_data + USER_IOU);
+                if (executions)
+                    executions--;
+                *(uint64_t*)(user_data + USER_XAH) = 0;
+                *(uint64_t*)(user_data + USER_IOU) = 0;
+                *(uint32_t*)(user_data + USER_CLAIMS) = USER_REFUNDED;
+                if (USER_FLUSH(user_data, USER_DATA_SIZE, IDO_DATA_KEY, 8, user_namespace, hook_acc, 1) != USER_DATA_SIZE)
+                    NOPE("IDO :: Error :: Failed to update user data.");
+
+                ACCOUNT_TO_BUF(payees + 20 * payable, participant);
+                payee_xah[payable++] = user_total_xah;
+            }
+
+            // Then emit one refund per record cleared
+            if (payable)
+                etxn_reserve(payable);
+            for (uint32_t k = 0; GUARD(SWEEP_BATCH), k < payable; ++k) {
+                uint8_t pay_txn[PREPARE_PAYMENT_SIMPLE_SIZE];
+                uint64_t xah_drops = payee_xah[k] * 1000000;
+                PREPARE_PAYMENT_SIMPLE(pay_txn, xah_drops, payees + 20 * k, 0, 0);
+                uint8_t emithash[32];
+                if (emit(SBUF(emithash), SBUF(pay_txn)) < 0)
+                    NOPE("IDO :: Error :: Refund emit failed.");
+            }
+
+            UINT64_TO_BUF(sale + SALE_XAH, total_xah);
+            UINT64_TO_BUF(sale + SALE_IOU, total_iou);
+            UINT64_TO_BUF(sale + SALE_EXEC, executions);
+            if (state_set(sale, SALE_SIZE(sale[SALE_COUNT]), SALE_KEY) < 0)
+                NOPE("IDO :: Error :: Failed to update sale state.");
+            UINT32_TO_BUF(index + INDEX_CURSOR, stop);
+            if (state_set(SBUF(index), INDEX_KEY) < 0)
+                NOPE("IDO :: Error :: Failed to update participant index.");
+            if (stop == count)
+                DONE("IDO :: Success :: Refund sweep complete.");
+            DONE("IDO :: Success :: Refund sweep advanced.");
         }
 
         // Check if window already started (one-shot)
-        uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
-        uint8_t existing_start_buf[4];
-        if (state(SBUF(existing_start_buf), SBUF(start_key)) == 4) {
-            uint32_t existing_start = UINT32_FROM_BUF(existing_start_buf);
+        if (sale_set) {
+            uint32_t existing_start = UINT32_FROM_BUF(sale + SALE_START);
             int64_t current_ledger = ledger_seq();
             if ((uint32_t)current_ledger >= existing_start)
-                rollback(SBUF("IDO :: Error :: Window has already started, cannot restart."), __LINE__);
+                NOPE("IDO :: Error :: Window has already started, cannot restart.");
         }
 
         // Validate WP_LNK parameter exists
         uint8_t wp_buf[256];
         int64_t wp_len = hook_param(SBUF(wp_buf), "WP_LNK", 6);
         if (wp_len < 1)
-            rollback(SBUF("IDO :: Error :: WP_LNK parameter not set."), __LINE__);
+            NOPE("IDO :: Error :: WP_LNK parameter not set.");
 
         // Validate INTERVAL parameter
-        uint8_t interval_key[8] = {'I','N','T','E','R','V','A','L'};
         uint8_t interval_buf[4];
-        if (hook_param(SBUF(interval_buf), SBUF(interval_key)) != 4)
-            rollback(SBUF("IDO :: Error :: INTERVAL not set on install."), __LINE__);
+        if (hook_param(SBUF(interval_buf), SKEY("INTERVAL")) != 4)
+            NOPE("IDO :: Error :: INTERVAL not set on install.");
         uint32_t interval_offset = UINT32_FROM_BUF(interval_buf);
 
         // Validate START parameter
         uint8_t start_buf[4];
-        int64_t start_len = otxn_param(SBUF(start_buf), SBUF(start_key));
+        int64_t start_len = otxn_param(SBUF(start_buf), SKEY("START"));
         if (start_len != 4)
-            rollback(SBUF("IDO :: Error :: Invalid START parameter."), __LINE__);
+            NOPE("IDO :: Error :: Invalid START parameter.");
         uint32_t start_offset = UINT32_FROM_BUF(start_buf);
 
+        // Validate SOFT_CAP parameter
+        uint8_t soft_cap_buf[8];
+        if (hook_param(SBUF(soft_cap_buf), "SOFT_CAP", 8) != 8)
+            NOPE("IDO :: Error :: SOFT_CAP parameter not set.");
+
+        // Validate SCHEDULE parameter, or fall back to the default phases
+        uint8_t schedule_buf[SALE_MAX_PHASES * SCHEDULE_ENTRY];
+        uint8_t* schedule = schedule_buf;
+        int64_t schedule_len = hook_param(SBUF(schedule_buf), SKEY("SCHEDULE"));
+        if (schedule_len == DOESNT_EXIST) {
+            schedule = DEFAULT_SCHEDULE;
+            schedule_len = sizeof(DEFAULT_SCHEDULE);
+        }
+        if (schedule_len < SCHEDULE_ENTRY || schedule_len % SCHEDULE_ENTRY != 0)
+            NOPE("IDO :: Error :: Invalid SCHEDULE parameter.");
+        uint32_t phase_count = schedule_len / SCHEDULE_ENTRY;
+
         // Calculate window ledgers
         int64_t current_ledger = ledger_seq();
         uint32_t current_ledger_u = (uint32_t)current_ledger;
         // TRACE_num(SBUF("Current ledger at invoke = "), (uint64_t)current_ledger_u);
 
         uint32_t start_ledger = current_ledger_u + start_offset;
-        uint32_t end_ledger = start_ledger + 5 * interval_offset;
+        uint32_t close_ledger = start_ledger + phase_count * interval_offset;
+        uint32_t end_ledger = close_ledger + interval_offset;
 
         // TRACESTR("IDO :: Setting window");
         // TRACE_num(SBUF("START offset = "), (uint64_t)start_offset);
@@ -167,149 +446,115 @@ int64_t hook(uint32_t reserved) {
         // TRACE_num(SBUF("Calculated start ledger = "), (uint64_t)start_ledger);
         // TRACE_num(SBUF("Calculated end ledger = "), (uint64_t)end_ledger);
 
-        // Store WP_LNK
-        uint8_t wp_lnk_key[6] = {'W', 'P', '_', 'L', 'N', 'K'};
-        if (state_set(wp_buf, wp_len, wp_lnk_key, 6) < 0)
-            rollback(SBUF("IDO :: Error :: Failed to store WP_LNK in state."), __LINE__);
-
-        // Store window ledgers
-        uint8_t start_state[4];
-        UINT32_TO_BUF(start_state, start_ledger);
-        uint8_t end_state[4];
-        UINT32_TO_BUF(end_state, end_ledger);
-        uint8_t end_key[3] = {'E', 'N', 'D'};
-        if (state_set(start_state, 4, start_key, 5) < 0 ||
-            state_set(interval_buf, 4, interval_key, 8) < 0 ||
-            state_set(end_state, 4, end_key, 3) < 0)
-            rollback(SBUF("IDO :: Error :: Failed to set state."), __LINE__);
-
-        // Store soft cap
-        uint8_t soft_cap_buf[8];
-        if (hook_param(SBUF(soft_cap_buf), "SOFT_CAP", 8) != 8)
-            rollback(SBUF("IDO :: Error :: SOFT_CAP parameter not set."), __LINE__);
-        uint8_t soft_cap_key[8] = {'S', 'O', 'F', 'T', '_', 'C', 'A', 'P'};
-        if (state_set(SBUF(soft_cap_buf), soft_cap_key, 8) < 0)
-            rollback(SBUF("IDO :: Error :: Failed to store SOFT_CAP in state."), __LINE__);
+        // Store the link's hash; deposits are checked against it
+        uint8_t wp_hash[32];
+        if (util_sha512h(SBUF(wp_hash), wp_buf, wp_len) != 32)
+            NOPE("IDO :: Error :: Failed to hash WP_LNK.");
+        if (state_set(SBUF(wp_hash), SKEY("WP_HASH")) < 0)
+            NOPE("IDO :: Error :: Failed to store WP_LNK in state.");
+
+        // Store the window, soft cap and schedule in the sale record
+        sale[0] = SALE_VERSION;
+        UINT32_TO_BUF(sale + SALE_START, start_ledger);
+        UINT32_TO_BUF(sale + SALE_END, end_ledger);
+        *(uint32_t*)(sale + SALE_INTERVAL) = *(uint32_t*)interval_buf;
+        *(uint64_t*)(sale + SALE_SOFT_CAP) = *(uint64_t*)soft_cap_buf;
+        UINT32_TO_BUF(sale + SALE_CLOSE, close_ledger);
+        sale[SALE_COUNT] = phase_count;
+        for (uint32_t p = 0; GUARD(SALE_MAX_PHASES), p < phase_count; ++p) {
+            uint8_t* entry = schedule + SCHEDULE_ENTRY * p;
+            uint8_t* phase = sale + SALE_PHASES + PHASE_SIZE * p;
+            if (UINT32_FROM_BUF(entry) == 0)
+                NOPE("IDO :: Error :: SCHEDULE multiplier is zero.");
+            *(uint32_t*)(phase + PHASE_MULT) = *(uint32_t*)entry;
+            *(uint64_t*)(phase + PHASE_CAP) = *(uint64_t*)(entry + PHASE_CAP);
+        }
+        if (state_set(sale, SALE_SIZE(phase_count), SALE_KEY) < 0)
+            NOPE("IDO :: Error :: Failed to set state.");
 
-        accept(SBUF("IDO :: Success :: Window set."), __LINE__);
+        DONE("IDO :: Success :: Window set.");
     }
 
     // ========================================================================
     // PAYMENT PATH: Handle deposits and unwinds
     // ========================================================================
-    
+
+    // Anything else passes through; HookOn keeps it from reaching here
+    if (tt != ttPAYMENT)
+        DONE("IDO :: Passed :: Not a payment.");
+
     // Get origin account
     uint8_t otxn_acc[20];
     if (otxn_field(SBUF(otxn_acc), sfAccount) != 20)
-        rollback(SBUF("IDO :: Error :: Failed to get origin account."), __LINE__);
+        NOPE("IDO :: Error :: Failed to get origin account.");
 
     // Read amount field ONCE to determine payment type
     uint8_t amount_buffer[48];
     int64_t amount_len = otxn_field(SBUF(amount_buffer), sfAmount);
 
-    // Handle outgoing payments from hook
-    if (BUFFER_EQUAL_20(hook_acc, otxn_acc)) {
-        if (amount_len == 48) {
-            // Outgoing IOU payment - accept
-            accept(SBUF("IDO :: Accepted :: Outgoing IOU payment."), __LINE__);
-        } else if (amount_len == 8) {
-            // Outgoing XAH payment - check balance protection
-            // Get account balance
-            uint8_t acct_kl[34];
-            util_keylet(SBUF(acct_kl), KEYLET_ACCOUNT, SBUF(hook_acc), 0, 0, 0, 0);
-            if (slot_set(SBUF(acct_kl), 1) != 1)
-                rollback(SBUF("IDO :: Error :: Could not load account keylet."), __LINE__);
-            if (slot_subfield(1, sfBalance, 1) != 1)
-                rollback(SBUF("IDO :: Error :: Could not load sfBalance."), __LINE__);
-            int64_t balance_xfl = slot_float(1);
-            int64_t balance_drops = float_int(balance_xfl, 6, 0);
-
-            // Get outgoing amount
-            int64_t outgoing_drops = AMOUNT_TO_DROPS(amount_buffer);
-
-            // Get locked balance
-            uint8_t xah_key[3] = {'X', 'A', 'H'};
-            uint8_t xah_buf[8];
-            uint64_t total_xah = 0;
-            if (state(SBUF(xah_buf), SBUF(xah_key)) == 8)
-                total_xah = UINT64_FROM_BUF(xah_buf);
-
-            // Check if we need to evaluate soft cap (in case no deposit/unwind triggered it)
-            uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
-            uint8_t interval_key[8] = {'I','N','T','E','R','V','A','L'};
-            uint8_t start_buf[4];
-            uint8_t interval_buf[4];
-            if (state(SBUF(start_buf), SBUF(start_key)) == 4 &&
-                state(SBUF(interval_buf), SBUF(interval_key)) == 4) {
-                uint32_t start_ledger = UINT32_FROM_BUF(start_buf);
-                uint32_t interval_offset = UINT32_FROM_BUF(interval_buf);
-                uint32_t phase4_end = start_ledger + (4 * interval_offset);
-                int64_t current_ledger = ledger_seq();
-                uint32_t current_ledger_u = (uint32_t)current_ledger;
-                if (current_ledger_u >= phase4_end) {
-                    uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
-                    uint8_t refund_flag[1];
-                    int64_t refund_check = state(SBUF(refund_flag), SBUF(refund_key));
-                    if (refund_check < 0) {
-                        // Evaluate soft cap
-                        uint8_t soft_cap_buf[8];
-                        if (hook_param(SBUF(soft_cap_buf), "SOFT_CAP", 8) == 8) {
-                            uint64_t soft_cap_xah = UINT64_FROM_BUF(soft_cap_buf);
-                            uint8_t total_xah_buf[8];
-                            uint64_t total_xah_eval = 0;
-                            if (state(SBUF(total_xah_buf), SBUF(xah_key)) == 8)
-                                total_xah_eval = UINT64_FROM_BUF(total_xah_buf);
-                            if (total_xah_eval >= soft_cap_xah) {
-                                uint8_t refund_inactive[1] = {0};
-                                state_set(SBUF(refund_inactive), SBUF(refund_key));
-                                uint8_t total_raised_key[12] = {'T', 'O', 'T', 'A', 'L', '_', 'R', 'A', 'I', 'S', 'E', 'D'};
-                                state_set(SBUF(total_xah_buf), SBUF(total_raised_key));
-                            } else {
-                                uint8_t refund_active[1] = {1};
-                                state_set(SBUF(refund_active), SBUF(refund_key));
-                            }
-                        }
-                    }
-                }
-            }
+    // Outgoing payments other than XAH need no sale state
+    int outgoing = BUFFER_EQUAL_20(hook_acc, otxn_acc);
+    if (outgoing && amount_len == 48)
+        DONE("IDO :: Accepted :: Outgoing IOU payment.");
+    if (outgoing && amount_len != 8)
+        DONE("IDO :: Accepted :: Outgoing payment.");
+
+    // Load the sale record once; the path that changes it writes it back once
+    uint8_t sale[SALE_MAX_SIZE] = {0};
+    int sale_set;
+    SALE_LOAD(sale, sale_set);
+    int32_t sale_len = SALE_SIZE(sale[SALE_COUNT]);
+    int sale_dirty = 0;
+    uint32_t start_ledger = UINT32_FROM_BUF(sale + SALE_START);
+    uint32_t end_ledger = UINT32_FROM_BUF(sale + SALE_END);
+    uint32_t interval_offset = UINT32_FROM_BUF(sale + SALE_INTERVAL);
+    uint64_t total_xah = UINT64_FROM_BUF(sale + SALE_XAH);
+    int64_t current_ledger = ledger_seq();
+    uint32_t current_ledger_u = (uint32_t)current_ledger;
 
-            uint64_t locked_drops = total_xah * 1000000ULL;
-
-            // Check if sale is over and soft cap met (locked balance should be zero)
-            uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
-            uint8_t refund_flag[1];
-            int64_t refund_mode = state(SBUF(refund_flag), SBUF(refund_key));
-            // refund_mode == 1 && refund_flag[0] == 0 means sale successful, not refund mode
-            uint8_t end_key[3] = {'E', 'N', 'D'};
-            uint8_t end_buf[4];
-            int sale_over = 0;
-            if (state(SBUF(end_buf), SBUF(end_key)) == 4) {
-                uint32_t end_ledger = UINT32_FROM_BUF(end_buf);
-                int64_t current_ledger = ledger_seq();
-                uint32_t current_ledger_u = (uint32_t)current_ledger;
-                if (current_ledger_u >= end_ledger)
-                    sale_over = 1;
-            }
+    // The first payment after the close finalizes the sale if FINALIZE has not;
+    // from then on the stored status is all that is checked
+    if (sale_set && sale[SALE_STATUS] == SALE_OPEN && current_ledger_u >= UINT32_FROM_BUF(sale + SALE_CLOSE)) {
+        SALE_FINALIZE(sale);
+        sale_dirty = 1;
+    }
 
-            if (sale_over && refund_mode == 1 && refund_flag[0] == 0) {
-                // Sale successful, all funds unlocked
-                locked_drops = 0;
-                // Ensure XAH state is set to zero for future checks
-                if (total_xah != 0) {
-                    uint8_t zero_buf[8] = {0};
-                    state_set(SBUF(zero_buf), SBUF(xah_key));
-                }
+    // Handle outgoing XAH payments from hook - check balance protection
+    if (outgoing) {
+        // Get account balance
+        uint8_t acct_kl[34];
+        util_keylet(SBUF(acct_kl), KEYLET_ACCOUNT, SBUF(hook_acc), 0, 0, 0, 0);
+        if (slot_set(SBUF(acct_kl), 1) != 1)
+            NOPE("IDO :: Error :: Could not load account keylet.");
+        if (slot_subfield(1, sfBalance, 1) != 1)
+            NOPE("IDO :: Error :: Could not load sfBalance.");
+        int64_t balance_xfl = slot_float(1);
+        int64_t balance_drops = float_int(balance_xfl, 6, 0);
+
+        // Get outgoing amount
+        int64_t outgoing_drops = AMOUNT_TO_DROPS(amount_buffer);
+
+        // Get locked balance
+        uint64_t locked_drops = total_xah * 1000000ULL;
+
+        // Sale over with the soft cap met: all funds unlocked
+        if (sale_set && current_ledger_u >= end_ledger && sale[SALE_STATUS] == SALE_MET) {
+            locked_drops = 0;
+            // Ensure XAH is set to zero for future checks
+            if (total_xah != 0) {
+                *(uint64_t*)(sale + SALE_XAH) = 0;
+                sale_dirty = 1;
             }
+        }
 
-            // Check if sufficient unlocked balance
-            if (balance_drops - locked_drops >= outgoing_drops) {
-                accept(SBUF("IDO :: Accepted :: Outgoing XAH payment."), __LINE__);
-            } else {
-                rollback(SBUF("IDO :: Rejected :: Insufficient unlocked balance."), __LINE__);
-            }
+        if (sale_dirty && state_set(sale, sale_len, SALE_KEY) < 0)
+            NOPE("IDO :: Error :: Failed to update sale state.");
+
+        // Check if sufficient unlocked balance
+        if (balance_drops - locked_drops >= outgoing_drops) {
+            DONE("IDO :: Accepted :: Outgoing XAH payment.");
         } else {
-            // Other amount types - accept
-            accept(SBUF("IDO :: Accepted :: Outgoing payment."), __LINE__);
+            NOPE("IDO :: Rejected :: Insufficient unlocked balance.");
         }
     }
 
@@ -321,7 +566,7 @@ int64_t hook(uint32_t reserved) {
 
         // Validate issuer (offset 28 in amount)
         if (!BUFFER_EQUAL_20(amount_buffer + 28, hook_acc))
-            rollback(SBUF("IDO :: Unwind :: Wrong issuer."), __LINE__);
+            NOPE("IDO :: Unwind :: Wrong issuer.");
 
         // Get IOU amount
         int64_t iou_xfl = -INT64_FROM_BUF(amount_buffer);
@@ -329,93 +574,59 @@ int64_t hook(uint32_t reserved) {
         // TRACEVAR(iou_amount);
 
         // Get user namespace
-        uint8_t user_namespace[32];
-        for (int i = 0; GUARD(20), i < 20; ++i)
-            user_namespace[i] = otxn_acc[i];
-        for (int i = 20; GUARD(32), i < 32; ++i)
-            user_namespace[i] = 0;
+        uint8_t user_namespace[USER_NS_SIZE];
+        USER_NAMESPACE(user_namespace, otxn_acc);
 
         // Get user participation data
-        uint8_t ido_data_key[8] = {'I', 'D', 'O', '_', 'D', 'A', 'T', 'A'};
-        uint8_t user_data[16];
-        state_foreign(SBUF(user_data), ido_data_key, 8, user_namespace, 32, hook_acc, 20);
+        uint8_t user_data[USER_DATA_SIZE] = {0};
+        USER_LOAD(user_data, IDO_DATA_KEY, 8, user_namespace, hook_acc);
 
-        uint64_t user_total_xah = UINT64_FROM_BUF(user_data);
-        uint64_t user_total_iou = UINT64_FROM_BUF(user_data + 8);
+        uint64_t user_total_xah = UINT64_FROM_BUF(user_data + USER_XAH);
+        uint64_t user_total_iou = UINT64_FROM_BUF(user_data + USER_IOU);
         // TRACEVAR(user_total_xah);
         // TRACEVAR(user_total_iou);
 
-        // Ensure soft cap evaluation has occurred
-        uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
-        uint8_t interval_key[8] = {'I','N','T','E','R','V','A','L'};
-        uint8_t start_buf[4];
-        uint8_t interval_buf[4];
-        if (state(SBUF(start_buf), SBUF(start_key)) == 4 &&
-            state(SBUF(interval_buf), SBUF(interval_key)) == 4) {
-            uint32_t start_ledger = UINT32_FROM_BUF(start_buf);
-            uint32_t interval_offset = UINT32_FROM_BUF(interval_buf);
-            uint32_t phase4_end = start_ledger + (4 * interval_offset);
-            int64_t current_ledger = ledger_seq();
-            uint32_t current_ledger_u = (uint32_t)current_ledger;
-            if (current_ledger_u >= phase4_end) {
-                uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
-                uint8_t refund_flag[1];
-                int64_t refund_check = state(SBUF(refund_flag), SBUF(refund_key));
-                if (refund_check < 0) {
-                    // Evaluate soft cap
-                    uint8_t soft_cap_buf[8];
-                    if (hook_param(SBUF(soft_cap_buf), "SOFT_CAP", 8) == 8) {
-                        uint64_t soft_cap_xah = UINT64_FROM_BUF(soft_cap_buf);
-                        uint8_t xah_key[3] = {'X', 'A', 'H'};
-                        uint8_t total_xah_buf[8];
-                        uint64_t total_xah = 0;
-                        if (state(SBUF(total_xah_buf), SBUF(xah_key)) == 8)
-                            total_xah = UINT64_FROM_BUF(total_xah_buf);
-                        // TRACEVAR(total_xah);
-                        // TRACEVAR(soft_cap_xah);
-                        if (total_xah < soft_cap_xah) {
-                            uint8_t refund_active[1] = {1};
-                            state_set(SBUF(refund_active), SBUF(refund_key));
-                            // TRACESTR("IDO :: Soft cap NOT met. Phase 5 is now REFUND period.");
-                        } else {
-                            uint8_t refund_inactive[1] = {0};
-                            state_set(SBUF(refund_inactive), SBUF(refund_key));
-                            // TRACESTR("IDO :: Soft cap MET. Sale successful!");
-                            // Preserve total raised for records (funds unlock after cooldown period)
-                            uint8_t total_raised_key[12] = {'T', 'O', 'T', 'A', 'L', '_', 'R', 'A', 'I', 'S', 'E', 'D'};
-                            state_set(SBUF(total_xah_buf), SBUF(total_raised_key));
-                            // TRACESTR("IDO :: Soft cap met. Funds will unlock after cooldown period.");
-                        }
-                    }
-                }
-            }
-        }
-
         // Check refund mode
-        uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
-        uint8_t refund_flag[1];
-        int64_t refund_mode = state(SBUF(refund_flag), SBUF(refund_key));
-        int is_refund_active = (refund_mode == 1 && refund_flag[0] == 1);
+        int is_refund_active = sale[SALE_STATUS] == SALE_REFUND;
 
         if (is_refund_active) {
             // TRACESTR("IDO :: Refund mode - accepting any IOU amount for proportional refund.");
+            if (user_total_xah == 0)
+                NOPE("IDO :: Unwind :: Nothing to refund, already repaid.");
         } else {
             // Normal mode requires exact amount
             if (iou_amount != user_total_iou)
-                rollback(SBUF("IDO :: Unwind :: Amount not exact to total IOU."), __LINE__);
+                NOPE("IDO :: Unwind :: Amount not exact to total IOU.");
             // Check if window has ended (successful IDO, no more unwinds)
-            uint8_t end_key[3] = {'E', 'N', 'D'};
-            uint8_t end_buf[4];
-            if (state(SBUF(end_buf), SBUF(end_key)) == 4) {
-                uint32_t end_ledger = UINT32_FROM_BUF(end_buf);
-                int64_t current_ledger = ledger_seq();
-                uint32_t current_ledger_u = (uint32_t)current_ledger;
-                if (current_ledger_u >= end_ledger) {
-                    rollback(SBUF("IDO :: Unwind :: Sale successful and cooldown period has ended, unwind's are no longer possible."), __LINE__);
-                }
+            if (sale_set && current_ledger_u >= end_ledger) {
+                NOPE("IDO :: Unwind :: Sale successful and cooldown period has ended, unwind's are no longer possible.");
             }
         }
 
+        // Update global counters
+        if (sale_set) {
+            uint64_t executions = UINT64_FROM_BUF(sale + SALE_EXEC);
+            if (executions)
+                executions--;
+            UINT64_TO_BUF(sale + SALE_EXEC, executions);
+            total_xah -= user_total_xah;
+            UINT64_TO_BUF(sale + SALE_XAH, total_xah);
+            uint64_t total_iou = UINT64_FROM_BUF(sale + SALE_IOU) - user_total_iou;
+            UINT64_TO_BUF(sale + SALE_IOU, total_iou);
+            if (state_set(sale, sale_len, SALE_KEY) < 0)
+                NOPE("IDO :: Unwind :: Failed to update sale state.");
+        }
+
+        // Clear the participation. A refund keeps the record, marked repaid,
+        // as the IOU may not all have come back; otherwise the record goes
+        // unless it carries claims
+        *(uint64_t*)(user_data + USER_XAH) = 0;
+        *(uint64_t*)(user_data + USER_IOU) = 0;
+        if (is_refund_active)
+            *(uint32_t*)(user_data + USER_CLAIMS) = USER_REFUNDED;
+        int keep = is_refund_active || *(uint64_t*)(user_data + USER_LAST_CLAIM) != 0;
+        USER_FLUSH(user_data, keep ? USER_DATA_SIZE : 0, IDO_DATA_KEY, 8, user_namespace, hook_acc, 1);
+
         // Build and emit XAH payment to user
         etxn_reserve(1);
 
@@ -425,38 +636,9 @@ int64_t hook(uint32_t reserved) {
 
         uint8_t emithash[32];
         if (emit(SBUF(emithash), SBUF(pay_txn)) < 0)
-            rollback(SBUF("IDO :: Unwind :: Emit failed."), __LINE__);
-
-        // Update global counters
-        uint8_t exec_key[4] = {'E', 'X', 'E', 'C'};
-        uint8_t xah_key[3] = {'X', 'A', 'H'};
-        uint8_t iou_key[3] = {'I', 'O', 'U'};
-        
-        uint8_t exec_buf[8];
-        if (state(SBUF(exec_buf), SBUF(exec_key)) == 8) {
-            uint64_t executions = UINT64_FROM_BUF(exec_buf) - 1;
-            UINT64_TO_BUF(exec_buf, executions);
-            state_set(SBUF(exec_buf), SBUF(exec_key));
-        }
-
-        uint8_t xah_buf[8];
-        if (state(SBUF(xah_buf), SBUF(xah_key)) == 8) {
-            uint64_t total_xah = UINT64_FROM_BUF(xah_buf) - user_total_xah;
-            UINT64_TO_BUF(xah_buf, total_xah);
-            state_set(SBUF(xah_buf), SBUF(xah_key));
-        }
-
-        uint8_t iou_buf[8];
-        if (state(SBUF(iou_buf), SBUF(iou_key)) == 8) {
-            uint64_t total_iou = UINT64_FROM_BUF(iou_buf) - user_total_iou;
-            UINT64_TO_BUF(iou_buf, total_iou);
-            state_set(SBUF(iou_buf), SBUF(iou_key));
-        }
-
-        // Remove user data
-        state_foreign_set(0, 0, ido_data_key, 8, user_namespace, 32, hook_acc, 20);
+            NOPE("IDO :: Unwind :: Emit failed.");
 
-        accept(SBUF("IDO :: Unwind :: XAH returned."), __LINE__);
+        DONE("IDO :: Unwind :: XAH returned.");
     }
 
     // ========================================================================
@@ -465,98 +647,40 @@ int64_t hook(uint32_t reserved) {
     
     // TRACESTR("IDO :: Checking XAH deposit");
 
-    // Validate WP_LNK parameter
+    // Get the stored hash of WP_LNK. A sale started before the hash was
+    // kept stored the link itself: hash that and keep the hash instead.
+    uint8_t stored_wp_hash[32];
+    if (state(SBUF(stored_wp_hash), SKEY("WP_HASH")) != 32) {
+        uint8_t stored_wp_buf[256];
+        int64_t stored_wp_len = state(SBUF(stored_wp_buf), SKEY("WP_LNK"));
+        if (stored_wp_len < 1 || util_sha512h(SBUF(stored_wp_hash), stored_wp_buf, stored_wp_len) != 32)
+            NOPE("IDO :: Error :: WP_LNK not found in state, awaiting issuer initialization.");
+        if (state_set(SBUF(stored_wp_hash), SKEY("WP_HASH")) < 0)
+            NOPE("IDO :: Error :: Failed to store WP_LNK in state.");
+    }
+
+    // WP_LNK carries the link's hash, compared as is, or the link, hashed first
     uint8_t otxn_wp_buf[256];
     int64_t otxn_wp_len = otxn_param(SBUF(otxn_wp_buf), "WP_LNK", 6);
-
-    // Get and validate stored WP_LNK
-    uint8_t wp_lnk_key[6] = {'W', 'P', '_', 'L', 'N', 'K'};
-    uint8_t stored_wp_buf[256];
-    int64_t stored_wp_len = state(SBUF(stored_wp_buf), SBUF(wp_lnk_key));
-    if (stored_wp_len < 1)
-        rollback(SBUF("IDO :: Error :: WP_LNK not found in state, awaiting issuer initialization."), __LINE__);
-
-    // WP_LNK must match exactly
-    if (otxn_wp_len != stored_wp_len)
-        rollback(SBUF("IDO :: Rejected :: WP_LNK parameter does not match. Verify whitepaper link."), __LINE__);
-
-    for (int i = 0; GUARD(256), i < otxn_wp_len; i++) {
-        if (otxn_wp_buf[i] != stored_wp_buf[i])
-            rollback(SBUF("IDO :: Rejected :: WP_LNK parameter does not match. Verify whitepaper link."), __LINE__);
+    if (otxn_wp_len < 1)
+        NOPE("IDO :: Rejected :: WP_LNK parameter does not match. Verify whitepaper link.");
+    if (otxn_wp_len != 32 || !BUFFER_EQUAL_32(otxn_wp_buf, stored_wp_hash)) {
+        uint8_t otxn_wp_hash[32];
+        util_sha512h(SBUF(otxn_wp_hash), otxn_wp_buf, otxn_wp_len);
+        if (!BUFFER_EQUAL_32(otxn_wp_hash, stored_wp_hash))
+            NOPE("IDO :: Rejected :: WP_LNK parameter does not match. Verify whitepaper link.");
     }
     
     // TRACESTR("IDO :: WP_LNK validated - user acknowledged documentation.");
 
-    // Get INTERVAL offset (only read hook param once)
-    uint8_t interval_key[8] = {'I','N','T','E','R','V','A','L'};
-    uint8_t interval_param_buf[4];
-    if (hook_param(SBUF(interval_param_buf), SBUF(interval_key)) != 4)
-        rollback(SBUF("IDO :: Error :: INTERVAL not set."), __LINE__);
-    uint32_t interval_offset = UINT32_FROM_BUF(interval_param_buf);
-
-    // Read window state
-    uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
-    uint8_t end_key[3] = {'E', 'N', 'D'};
-    uint8_t start_buf[4];
-    uint8_t end_buf[4];
-    if (state(SBUF(start_buf), SBUF(start_key)) != 4 ||
-        state(SBUF(end_buf), SBUF(end_key)) != 4)
-        rollback(SBUF("IDO :: Error :: Window not set."), __LINE__);
-
-    uint32_t start_ledger = UINT32_FROM_BUF(start_buf);
-    uint32_t end_ledger = UINT32_FROM_BUF(end_buf);
-    int64_t current_ledger = ledger_seq();
-    uint32_t current_ledger_u = (uint32_t)current_ledger;
-
-    // Check if we're past Phase 4 (soft cap evaluation time)
-    uint32_t phase4_end = start_ledger + (4 * interval_offset);
-    
-    if (current_ledger_u >= phase4_end) {
-        uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
-        uint8_t refund_flag[1];
-        int64_t refund_check = state(SBUF(refund_flag), SBUF(refund_key));
-        
-        // First time past Phase 4 - evaluate soft cap
-        if (refund_check < 0) {
-            uint8_t soft_cap_buf[8];
-            if (hook_param(SBUF(soft_cap_buf), "SOFT_CAP", 8) != 8)
-                rollback(SBUF("IDO :: Error :: SOFT_CAP parameter not set."), __LINE__);
-            uint64_t soft_cap_xah = UINT64_FROM_BUF(soft_cap_buf);
-            
-            uint8_t xah_key[3] = {'X', 'A', 'H'};
-            uint8_t total_xah_buf[8];
-            uint64_t total_xah = 0;
-            if (state(SBUF(total_xah_buf), SBUF(xah_key)) == 8)
-                total_xah = UINT64_FROM_BUF(total_xah_buf);
-            
-            // TRACEVAR(total_xah);
-            // TRACEVAR(soft_cap_xah);
-            
-            if (total_xah < soft_cap_xah) {
-                uint8_t refund_active[1] = {1};
-                state_set(SBUF(refund_active), SBUF(refund_key));
-                // TRACESTR("IDO :: Soft cap NOT met. Phase 5 is now REFUND period.");
-            } else {
-                uint8_t refund_inactive[1] = {0};
-                state_set(SBUF(refund_inactive), SBUF(refund_key));
-                // TRACESTR("IDO :: Soft cap MET. Sale successful!");
-                // Preserve total raised for records (funds unlock after cooldown period)
-                uint8_t total_raised_key[11] = {'T', 'O', 'T', 'A', 'L', '_', 'R', 'A', 'I', 'S', 'E', 'D'};
-                state_set(SBUF(total_xah_buf), SBUF(total_raised_key));
-                // TRACESTR("IDO :: Soft cap met. Funds will unlock after cooldown period.");
-            }
-        }
-    }
+    if (!sale_set)
+        NOPE("IDO :: Error :: Window not set.");
 
     // Check if window has ended
     if (current_ledger_u >= end_ledger) {
-        uint8_t refund_key[6] = {'R', 'E', 'F', 'U', 'N', 'D'};
-        uint8_t refund_flag[1];
-        int64_t refund_mode = state(SBUF(refund_flag), SBUF(refund_key));
-        
-        if (refund_mode == 1 && refund_flag[0] == 1)
-            rollback(SBUF("IDO :: Rejected :: Window ended. Soft cap not met. Send IOU to unwind for refund."), __LINE__);
-        rollback(SBUF("IDO :: Rejected :: Window has ended."), __LINE__);
+        if (sale[SALE_STATUS] == SALE_REFUND)
+            NOPE("IDO :: Rejected :: Window ended. Soft cap not met. Send IOU to unwind for refund.");
+        NOPE("IDO :: Rejected :: Window has ended.");
     }
 
     // TRACE_num(SBUF("Current ledger = "), (uint64_t)current_ledger_u);
@@ -569,202 +693,125 @@ int64_t hook(uint32_t reserved) {
     // TRACEVAR(received_drops);
     // TRACEVAR(received_xah);
 
-    // Calculate phase and multiplier
-    uint32_t elapsed = current_ledger_u - start_ledger;
-    uint32_t phase = (elapsed / interval_offset) + 1;
-    int64_t multiplier = 0;
-
-    if (phase == 1) {
-        multiplier = 100;
-        // TRACESTR("IDO :: Phase 1 active.");
-    } else if (phase == 2) {
-        multiplier = 75;
-        // TRACESTR("IDO :: Phase 2 active.");
-    } else if (phase == 3) {
-        multiplier = 50;
-        // TRACESTR("IDO :: Phase 3 active.");
-    } else if (phase == 4) {
-        multiplier = 25;
-        // TRACESTR("IDO :: Phase 4 active.");
-    } else if (phase == 5) {
-        // Phase 5: Unwinding only
-        // TRACESTR("IDO :: Phase 5 active (unwinding only).");
-        rollback(SBUF("IDO :: Rejected :: Phase 5 is unwinding only, no new deposits."), __LINE__);
-    } else {
-        rollback(SBUF("IDO :: Rejected :: Invalid phase."), __LINE__);
-    }
+    // Resolve the phase with one division and index its schedule entry
+    if (current_ledger_u < start_ledger)
+        NOPE("IDO :: Rejected :: Window has not started.");
+    uint32_t phase = (current_ledger_u - start_ledger) / interval_offset;
+    if (phase >= sale[SALE_COUNT])
+        NOPE("IDO :: Rejected :: Cooldown is unwinding only, no new deposits.");
+    uint8_t* phase_entry = sale + SALE_PHASES + PHASE_SIZE * phase;
+    int64_t multiplier = UINT32_FROM_BUF(phase_entry + PHASE_MULT);
 
     // TRACEVAR(phase);
 
     int64_t issued_amount = received_xah * multiplier;
     if (issued_amount == 0)
-        rollback(SBUF("IDO :: Issued amount is zero."), __LINE__);
+        NOPE("IDO :: Issued amount is zero.");
     // TRACEVAR(issued_amount);
 
-    // Update global counters
-    uint8_t exec_key[4] = {'E', 'X', 'E', 'C'};
-    uint8_t xah_key[3] = {'X', 'A', 'H'};
-    uint8_t iou_key[3] = {'I', 'O', 'U'};
-    
-    uint8_t exec_buf[8] = {0};
-    uint64_t executions = 0;
-    if (state(SBUF(exec_buf), SBUF(exec_key)) == 8)
-        executions = UINT64_FROM_BUF(exec_buf);
-    executions++;
-    UINT64_TO_BUF(exec_buf, executions);
-    if (state_set(SBUF(exec_buf), SBUF(exec_key)) < 0)
-        rollback(SBUF("IDO :: Failed to update executions counter."), __LINE__);
-
-    uint8_t xah_buf[8] = {0};
-    uint64_t total_xah = 0;
-    if (state(SBUF(xah_buf), SBUF(xah_key)) == 8)
-        total_xah = UINT64_FROM_BUF(xah_buf);
+    // The phase's cap bounds everything it issues
+    uint64_t phase_issued = UINT64_FROM_BUF(phase_entry + PHASE_ISSUED) + issued_amount;
+    uint64_t phase_cap = UINT64_FROM_BUF(phase_entry + PHASE_CAP);
+    if (phase_cap && phase_issued > phase_cap)
+        NOPE("IDO :: Rejected :: Phase cap reached.");
+
+    // Update global counters and the phase's issued IOU and deposit count
+    uint64_t executions = UINT64_FROM_BUF(sale + SALE_EXEC) + 1;
+    UINT64_TO_BUF(sale + SALE_EXEC, executions);
     total_xah += received_xah;
-    UINT64_TO_BUF(xah_buf, total_xah);
-    if (state_set(SBUF(xah_buf), SBUF(xah_key)) < 0)
-        rollback(SBUF("IDO :: Failed to update XAH total."), __LINE__);
-
-    uint8_t iou_buf[8] = {0};
-    uint64_t total_iou = 0;
-    if (state(SBUF(iou_buf), SBUF(iou_key)) == 8)
-        total_iou = UINT64_FROM_BUF(iou_buf);
-    total_iou += issued_amount;
-    UINT64_TO_BUF(iou_buf, total_iou);
-    if (state_set(SBUF(iou_buf), SBUF(iou_key)) < 0)
-        rollback(SBUF("IDO :: Failed to update IOU total."), __LINE__);
-
-    // TRACEVAR(executions);
-    // TRACEVAR(total_xah);
-    // TRACEVAR(total_iou);
-
-    // Update phase-specific counter
-    uint8_t phase_key[6];
-    phase_key[0] = 'P';
-    phase_key[1] = 'H';
-    phase_key[2] = 'A';
-    phase_key[3] = 'S';
-    phase_key[4] = 'E';
-    phase_key[5] = '0' + (uint8_t)phase;
-    
-    uint8_t phase_buf[8] = {0};
-    uint64_t phase_exec = 0;
-    if (state(SBUF(phase_buf), phase_key, 6) == 8)
-        phase_exec = UINT64_FROM_BUF(phase_buf);
-    phase_exec++;
-    UINT64_TO_BUF(phase_buf, phase_exec);
-    if (state_set(SBUF(phase_buf), phase_key, 6) < 0)
-        rollback(SBUF("IDO :: Failed to update phase executions counter."), __LINE__);
-    // TRACEVAR(phase_exec);
+    UINT64_TO_BUF(sale + SALE_XAH, total_xah);
+    uint64_t total_iou = UINT64_FROM_BUF(sale + SALE_IOU) + issued_amount;
+    UINT64_TO_BUF(sale + SALE_IOU, total_iou);
+    UINT64_TO_BUF(phase_entry + PHASE_ISSUED, phase_issued);
+    uint32_t phase_exec = UINT32_FROM_BUF(phase_entry + PHASE_DEPOSITS) + 1;
+    UINT32_TO_BUF(phase_entry + PHASE_DEPOSITS, phase_exec);
+    if (state_set(sale, sale_len, SALE_KEY) < 0)
+        NOPE("IDO :: Failed to update sale state.");
 
     // Record user participation data
-    uint8_t user_namespace[32];
-    for (int i = 0; GUARD(20), i < 20; ++i)
-        user_namespace[i] = otxn_acc[i];
-    for (int i = 20; GUARD(32), i < 32; ++i)
-        user_namespace[i] = 0;
-
-    uint8_t ido_data_key[8] = {'I', 'D', 'O', '_', 'D', 'A', 'T', 'A'};
-    uint8_t user_data[16] = {0};
-    state_foreign(SBUF(user_data), ido_data_key, 8, user_namespace, 32, hook_acc, 20);
-
-    uint64_t user_total_xah = UINT64_FROM_BUF(user_data);
-    uint64_t user_total_iou = UINT64_FROM_BUF(user_data + 8);
+    uint8_t user_namespace[USER_NS_SIZE];
+    USER_NAMESPACE(user_namespace, otxn_acc);
+
+    uint8_t user_data[USER_DATA_SIZE] = {0};
+    USER_LOAD(user_data, IDO_DATA_KEY, 8, user_namespace, hook_acc);
+
+    uint64_t user_total_xah = UINT64_FROM_BUF(user_data + USER_XAH);
+    uint64_t user_total_iou = UINT64_FROM_BUF(user_data + USER_IOU);
+
+    // A first deposit appends the account to the participant index
+    if (user_total_xah == 0) {
+        uint8_t index[INDEX_SIZE] = {0};
+        state(SBUF(index), INDEX_KEY);
+        uint32_t count = UINT32_FROM_BUF(index + INDEX_COUNT);
+        uint32_t slot = count % INDEX_BUCKET_ACCOUNTS;
+        uint8_t bucket_key[8];
+        INDEX_BUCKET_KEY(bucket_key, count / INDEX_BUCKET_ACCOUNTS);
+        uint8_t bucket[INDEX_BUCKET_SIZE];
+        if (slot && state(SBUF(bucket), SBUF(bucket_key)) < 20 * slot)
+            NOPE("IDO :: Error :: Participant index is incomplete.");
+        ACCOUNT_TO_BUF(bucket + 20 * slot, otxn_acc);
+        if (state_set(bucket, 20 * (slot + 1), SBUF(bucket_key)) < 0)
+            NOPE("IDO :: Failed to update participant index.");
+        count++;
+        UINT32_TO_BUF(index + INDEX_COUNT, count);
+        if (state_set(SBUF(index), INDEX_KEY) < 0)
+            NOPE("IDO :: Failed to update participant index.");
+    }
 
     user_total_xah += received_xah;
     user_total_iou += issued_amount;
 
-    UINT64_TO_BUF(user_data, user_total_xah);
-    UINT64_TO_BUF(user_data + 8, user_total_iou);
+    UINT64_TO_BUF(user_data + USER_XAH, user_total_xah);
+    UINT64_TO_BUF(user_data + USER_IOU, user_total_iou);
 
-    if (state_foreign_set(user_data, 16, ido_data_key, 8, user_namespace, 32, hook_acc, 20) < 0)
-        rollback(SBUF("IDO :: Failed to update user data."), __LINE__);
+    if (USER_FLUSH(user_data, USER_DATA_SIZE, IDO_DATA_KEY, 8, user_namespace, hook_acc, 1) < 0)
+        NOPE("IDO :: Failed to update user data.");
 
-    // Build Amounts array for Remit transaction
-    uint8_t* amounts_ptr = AMOUNTS_OUT;
-    
-    *amounts_ptr++ = 0xF0U;  // sfAmounts array start
-    *amounts_ptr++ = 0x5CU;
-    
-    *amounts_ptr++ = 0xE0U;  // sfAmountEntry object start
-    *amounts_ptr++ = 0x5BU;
-    
     // Load currency only when needed
     uint8_t currency[20];
     if (hook_param(SBUF(currency), "CURRENCY", 8) != 20)
-        rollback(SBUF("IDO :: Error :: CURRENCY parameter not set."), __LINE__);
-    
+        NOPE("IDO :: Error :: CURRENCY parameter not set.");
+
+    // Build Amounts array for Remit transaction
+    uint8_t* amounts_ptr;
+    int32_t amount_len_remit;
     int64_t amount_xfl = float_set(0, issued_amount);
-    int32_t amount_len_remit = float_sto(
-        amounts_ptr, 49,
-        currency, 20,
-        hook_acc, 20,
-        amount_xfl,
-        sfAmount
-    );
-    
+
+    ETXN_AMOUNTS_BEGIN(amounts_ptr, txn);
+    ETXN_AMOUNTS_ADD_IOU(amounts_ptr, amount_len_remit, currency, hook_acc, amount_xfl);
     if (amount_len_remit < 0)
-        rollback(SBUF("IDO :: Failed to serialize amount."), __LINE__);
-    
-    amounts_ptr += amount_len_remit;
-    
-    *amounts_ptr++ = 0xE1U;  // End AmountEntry
-    *amounts_ptr++ = 0xF1U;  // End Amounts array
-    
-    int32_t amounts_len = amounts_ptr - AMOUNTS_OUT;
+        NOPE("IDO :: Failed to serialize amount.");
+    ETXN_AMOUNTS_END(amounts_ptr);
 
     // Fill transaction fields
-    hook_account(HOOK_ACC, 20);
-    
-    for (int i = 0; GUARD(20), i < 20; ++i)
-        DEST_ACC[i] = otxn_acc[i];
+    hook_account(txn + ETXN_REMIT_ACC_OUT, 20);
+    ACCOUNT_TO_BUF(txn + ETXN_REMIT_DEST_OUT, otxn_acc);
 
     // Prepare for emission
     etxn_reserve(1);
     
-    int32_t total_size = BASE_SIZE + amounts_len;
+    int32_t total_size = ETXN_REMIT_SIZE(txn, amounts_ptr);
     
-    etxn_details(EMIT_OUT, 116U);
+    etxn_details(txn + ETXN_REMIT_DETAILS_OUT, ETXN_DETAILS_SIZE);
     
-    // Encode ledger sequences
-    int64_t seq = ledger_seq() + 1;
-    txn[15] = (seq >> 24U) & 0xFFU;
-    txn[16] = (seq >> 16U) & 0xFFU;
-    txn[17] = (seq >>  8U) & 0xFFU;
-    txn[18] = seq & 0xFFU;
-    
-    seq += 4;
-    txn[21] = (seq >> 24U) & 0xFFU;
-    txn[22] = (seq >> 16U) & 0xFFU;
-    txn[23] = (seq >>  8U) & 0xFFU;
-    txn[24] = seq & 0xFFU;
+    ETXN_SET_LEDGERS(txn, ledger_seq());
     
     // Calculate and encode fee
     int64_t fee = etxn_fee_base(txn, total_size);
     
     if (fee < 0)
-        rollback(SBUF("IDO :: Fee calculation failed."), __LINE__);
-    
-    uint64_t fee_tmp = fee;
-    uint8_t* fee_ptr = (uint8_t*)&fee;
-    *fee_ptr++ = 0b01000000 + ((fee_tmp >> 56) & 0b00111111);
-    *fee_ptr++ = (fee_tmp >> 48) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >> 40) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >> 32) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >> 24) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >> 16) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >>  8) & 0xFFU;
-    *fee_ptr++ = (fee_tmp >>  0) & 0xFFU;
+        NOPE("IDO :: Fee calculation failed.");
     
-    *((uint64_t*)(txn + 26)) = fee;
+    ETXN_SET_FEE(txn + ETXN_REMIT_FEE_OUT, fee);
     
     // Emit transaction
     uint8_t emithash[32];
     int64_t emit_result = emit(SBUF(emithash), txn, total_size);
     
     if (emit_result < 0)
-        rollback(SBUF("IDO :: Emit failed."), __LINE__);
+        NOPE("IDO :: Emit failed.");
 
-    accept(SBUF("IDO :: Accepted :: Incoming payment during active phase."), __LINE__);
+    DONE("IDO :: Accepted :: Incoming payment during active phase.");
 
     _g(1,1); // Guard
     return 0;
@@ -11,12 +11,14 @@
 // Hook Parameters:
 //   'CURRENCY' (20 bytes): Currency code to be distributed as daily rewards.
 //   'ADMIN' (20 bytes): Admin account ID for configuration.
-//   'INT_RATE' (4 bytes): Set daily interest rate (big-endian uint32, e.g., 1000 = 10%).
+//   'INT_RATE' (4 or 8 bytes): Set daily interest rate (big-endian, e.g., 1000 = 10%).
 //   'SET_INTERVAL' (4 bytes): Set claim interval in ledgers (big-endian uint32).
 //   'SET_MAX_CLAIMS' (4 bytes): Set lifetime claim limit per user (big-endian uint32). (Optional)
+//   Each is copied to state while that setting has none, so it is the
+//   starting value and an invoke that changes the setting replaces it.
 //
 // Admin Configuration Parameters (can be set at install or via invoke):
-//   'INT_RATE' (4 bytes): Set daily interest rate (big-endian uint32, e.g., 1000 = 10%).
+//   'INT_RATE' (4 or 8 bytes): Set daily interest rate (big-endian uint32 or uint64, e.g., 1000 = 10%).
 //   'SET_INTERVAL' (4 bytes): Set claim interval in ledgers (big-endian uint32).
 //   'SET_MAX_CLAIMS' (4 bytes): Set lifetime claim limit per user (big-endian uint32).
 //
@@ -25,25 +27,49 @@
 // 
 // Usage:
 //   - Admin configures interest rate with 'INT_RATE', intervals, and limits at install or via invoke transactions.
-   - After issuance completion, IOU holders send invoke transactions with 'R_CLAIM' to claim rewards.
-   - Hook validates issuance status, timing constraints, trustlines, and calculates rewards based on holdings.
+//   - After issuance completion, IOU holders send invoke transactions with 'R_CLAIM' to claim rewards.
+//   - Hook validates issuance status, timing constraints, trustlines, and calculates rewards based on holdings.
 //   - User state tracked in hierarchical namespaces for unlimited scalability.
+//
+// Storage Structure:
+//   - Per user, key "IDO_DATA" in the user's namespace, shared with IDOMaster:
+//     { XAH deposited:8, IOU received:8, last claim ledger:4, total claims:4 }
+//     Records from before the claim fields were added are 16 bytes; their
+//     claim state is still read once from the old "CLAIM_DATA" key, as it
+//     is whenever the last claim ledger is zero.
+//     A record IDOMaster has marked repaid (total claims 0xFFFFFFFF) after
+//     a failed sale claims nothing.
+//   - Accounts with no IDO_DATA record keep { last claim ledger:4,
+//     total claims:4 } under "CLAIM_DATA" in the same namespace.
 //**************************************************************
 
 #include "hookapi.h"
+#include "../../Common/BuildProfile.h"
+#include "../../Common/EmitTxn.h"
+#include "../../Common/UserRecord.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
 
-// Field codes for Remit transaction Amounts array
-#define sfAmountEntry ((14U << 16U) + 91U)  // 0xE0 0x5B
-#define sfAmounts ((15U << 16U) + 92U)      // 0xF0 0x5C
+#define HOOK_RESULT_ID RC_REWARDSMASTER
+#define DONE(x) RESULT_ACCEPT("IRH :: Success :: " x)
+#define NOPE(x) RESULT_ROLLBACK("IRH :: Error :: " x)
+#define GUARD(maxiter) _g(__LINE__, (maxiter) + 1)
 
-#define FLIP_ENDIAN(n) ((uint32_t) (((n & 0xFFU) << 24U) | \
-                                   ((n & 0xFF00U) << 8U) | \
-                                 ((n & 0xFF0000U) >> 8U) | \
-                                ((n & 0xFF000000U) >> 24U)))
+// Per-user IDO_DATA record, laid out as in IDOMaster
+#define USER_XAH 0
+#define USER_IOU 8
+#define USER_LAST_CLAIM 16
+#define USER_CLAIMS 20
+#define USER_DATA_SIZE 24
+#define USER_REFUNDED 0xFFFFFFFFU                  // USER_CLAIMS once the sale repaid it
+#define IDO_DATA_KEY SKEY_PTR("IDO_DATA")          // 8 bytes
+#define CLAIM_KEY SKEY_PTR("CLAIM_DATA")           // 32 bytes, legacy claim state
 
-#define DONE(x) accept(SBUF("IRH :: Success :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("IRH :: Error :: " x), __LINE__)
-#define GUARD(maxiter) _g(__LINE__, (maxiter) + 1)
+// Configuration keys. The claim interval has always been stored under
+// the first eight bytes of "CLAIM_INT".
+#define INT_RATE_KEY SKEY_PAD("INT_RATE", 8)
+#define CLAIM_INT_KEY SKEY_PAD("CLAIM_IN", 8)
+#define MAX_CLAIMS_KEY SKEY_PAD("MAX_CLM", 8)
 
 #define UINT64_FROM_BUF(buf) \
     (((uint64_t)(buf)[0] << 56) + ((uint64_t)(buf)[1] << 48) + \
@@ -51,36 +77,8 @@
      ((uint64_t)(buf)[4] << 24) + ((uint64_t)(buf)[5] << 16) + \
      ((uint64_t)(buf)[6] << 8) + (uint64_t)(buf)[7])
 
-     
-// Base Remit transaction template (229 bytes)
-// clang-format off
-uint8_t txn[350] =
-{
-/* size,upto */
-/*   3,   0 */   0x12U, 0x00U, 0x5FU,                                           /* ttREMIT */
-/*   5,   3 */   0x22U, 0x80U, 0x00U, 0x00U, 0x00U,                            /* Flags */
-/*   5,   8 */   0x24U, 0x00U, 0x00U, 0x00U, 0x00U,                            /* Sequence */
-/*   6,  13 */   0x20U, 0x1AU, 0x00U, 0x00U, 0x00U, 0x00U,                     /* FirstLedgerSequence */
-/*   6,  19 */   0x20U, 0x1BU, 0x00U, 0x00U, 0x00U, 0x00U,                     /* LastLedgerSequence */
-/*   9,  25 */   0x68U, 0x40U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, /* Fee */
-/*  35,  34 */   0x73U, 0x21U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* SigningPubKey */
-/*  22,  69 */   0x81U, 0x14U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,        /* Account */
-/*  22,  91 */   0x83U, 0x14U, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,        /* Destination */
-/* 116, 113 */   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* EmitDetails */
-                 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-                 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-/*   0, 229 */   /* Amounts array appended here */
-};
-// clang-format on
-
-#define BASE_SIZE 229U
-#define FLS_OUT (txn + 15U)
-#define LLS_OUT (txn + 21U)
-#define FEE_OUT (txn + 26U)
-#define HOOK_ACC (txn + 71U)
-#define DEST_ACC (txn + 93U)
-#define EMIT_OUT (txn + 113U)
-#define AMOUNTS_OUT (txn + 229U)
+// Remit with one IOU AmountEntry; field offsets come from EmitTxn.h
+uint8_t txn[ETXN_REMIT_BASE_SIZE + ETXN_AMOUNTS_SIZE(1, 0)] = { ETXN_REMIT_INIT };
 
 int64_t hook(uint32_t reserved) {
 
@@ -111,27 +109,27 @@ int64_t hook(uint32_t reserved) {
     if(hook_param(SBUF(invoke_acc), "ADMIN", 5) != 20)
         NOPE("Misconfigured. ADMIN not set as Hook Parameter.");    
 
-    // State keys for configuration
-    uint8_t interest_rate_key[8] = "INT_RATE";
-    uint8_t interval_key[8] = "CLAIM_INT";
-    uint8_t max_claims_key[8] = "MAX_CLM\0";
-
-    // Optional install-time configuration parameters
-    uint8_t install_int_rate[4];
-    if(hook_param(SBUF(install_int_rate), "INT_RATE", 8) == 4) {
-        if(state_set(SBUF(install_int_rate), SBUF(interest_rate_key)) != 4)
+    // Optional install-time configuration parameters, copied only while
+    // their key is unset so that a value the admin invokes stays in place
+    uint8_t install_int_rate[8];
+    if(state(SBUF(install_int_rate), INT_RATE_KEY) == DOESNT_EXIST) {
+        int64_t install_int_rate_len = hook_param(SBUF(install_int_rate), "INT_RATE", 8);
+        if((install_int_rate_len == 4 || install_int_rate_len == 8) &&
+           state_set(install_int_rate, install_int_rate_len, INT_RATE_KEY) != install_int_rate_len)
             NOPE("Failed to set install-time interest rate.");
     }
 
     uint8_t install_interval[4];
-    if(hook_param(SBUF(install_interval), "SET_INTERVAL", 12) == 4) {
-        if(state_set(SBUF(install_interval), SBUF(interval_key)) != 4)
+    if(state(SBUF(install_interval), CLAIM_INT_KEY) == DOESNT_EXIST &&
+       hook_param(SBUF(install_interval), "SET_INTERVAL", 12) == 4) {
+        if(state_set(SBUF(install_interval), CLAIM_INT_KEY) != 4)
             NOPE("Failed to set install-time claim interval.");
     }
 
     uint8_t install_max_claims[4];
-    if(hook_param(SBUF(install_max_claims), "SET_MAX_CLAIMS", 14) == 4) {
-        if(state_set(SBUF(install_max_claims), SBUF(max_claims_key)) != 4)
+    if(state(SBUF(install_max_claims), MAX_CLAIMS_KEY) == DOESNT_EXIST &&
+       hook_param(SBUF(install_max_claims), "SET_MAX_CLAIMS", 14) == 4) {
+        if(state_set(SBUF(install_max_claims), MAX_CLAIMS_KEY) != 4)
             NOPE("Failed to set install-time max claims.");
     }
 
@@ -140,10 +138,11 @@ int64_t hook(uint32_t reserved) {
         // ADMIN COMMANDS - from whitelisted account only
         
         // Check for configuration commands first
-        uint8_t set_interest_param[4];
-        if(otxn_param(SBUF(set_interest_param), "INT_RATE", 8) == 4) {
-            // Set daily interest rate
-            if(state_set(SBUF(set_interest_param), SBUF(interest_rate_key)) != 4)
+        uint8_t set_interest_param[8];
+        int64_t set_interest_len = otxn_param(SBUF(set_interest_param), "INT_RATE", 8);
+        if(set_interest_len == 4 || set_interest_len == 8) {
+            // Set daily interest rate, at the width it was sent
+            if(state_set(set_interest_param, set_interest_len, INT_RATE_KEY) != set_interest_len)
                 NOPE("Failed to set interest rate.");
             DONE("Interest rate configured successfully.");
         }
@@ -151,7 +150,7 @@ int64_t hook(uint32_t reserved) {
         uint8_t set_interval_param[4];
         if(otxn_param(SBUF(set_interval_param), "SET_INTERVAL", 12) == 4) {
             // Set claim interval
-            if(state_set(SBUF(set_interval_param), SBUF(interval_key)) != 4)
+            if(state_set(SBUF(set_interval_param), CLAIM_INT_KEY) != 4)
                 NOPE("Failed to set claim interval.");
             DONE("Claim interval configured successfully.");
         }
@@ -159,7 +158,7 @@ int64_t hook(uint32_t reserved) {
         uint8_t set_max_claims_param[4];
         if(otxn_param(SBUF(set_max_claims_param), "SET_MAX_CLAIMS", 14) == 4) {
             // Set max claims limit
-            if(state_set(SBUF(set_max_claims_param), SBUF(max_claims_key)) != 4)
+            if(state_set(SBUF(set_max_claims_param), MAX_CLAIMS_KEY) != 4)
                 NOPE("Failed to set max claims limit.");
             DONE("Max claims limit configured successfully.");
         }
@@ -173,18 +172,23 @@ int64_t hook(uint32_t reserved) {
         if(otxn_param(SBUF(claim_param), "R_CLAIM", 7) == 20) {
             // DAILY CLAIM PATH - from any non-whitelisted account
             
-            // Load daily interest rate configuration from state
+            // Load daily interest rate configuration from state, 4 or 8
+            // bytes as the hook parameter or the last invoke gave it
             uint8_t interest_rate_buf[8];
-            if(state(SBUF(interest_rate_buf), SBUF(interest_rate_key)) != 8)
+            int64_t interest_rate_len = state(SBUF(interest_rate_buf), INT_RATE_KEY);
+            uint64_t interest_rate;
+            if (interest_rate_len == 8)
+                interest_rate = UINT64_FROM_BUF(interest_rate_buf);
+            else if (interest_rate_len == 4)
+                interest_rate = UINT32_FROM_BUF(interest_rate_buf);
+            else
                 NOPE("INT_RATE not configured - admin must use SET_INTEREST_RATE first.");
-            
-            uint64_t interest_rate = UINT64_FROM_BUF(interest_rate_buf);
             if (interest_rate == 0)
                 NOPE("Invalid interest rate - must be positive.");
 
             // Load claim interval (required configuration)
             uint8_t interval_buf[4];
-            if(state(SBUF(interval_buf), SBUF(interval_key)) != 4)
+            if(state(SBUF(interval_buf), CLAIM_INT_KEY) != 4)
                 NOPE("SET_INTERVAL not configured - admin must set claim interval first.");
             
             uint32_t claim_interval = (uint32_t)((interval_buf[0] << 24) | (interval_buf[1] << 16) | 
@@ -193,7 +197,7 @@ int64_t hook(uint32_t reserved) {
             // Load max claims limit (default unlimited if not set)
             uint32_t max_claims = 0; // Default unlimited
             uint8_t max_claims_buf[4];
-            if(state(SBUF(max_claims_buf), SBUF(max_claims_key)) == 4) {
+            if(state(SBUF(max_claims_buf), MAX_CLAIMS_KEY) == 4) {
                 max_claims = (uint32_t)((max_claims_buf[0] << 24) | (max_claims_buf[1] << 16) | 
                                        (max_claims_buf[2] << 8) | max_claims_buf[3]);
             }
@@ -228,53 +232,43 @@ int64_t hook(uint32_t reserved) {
                 NOPE("Invalid claim amount calculation.");
             
             // Generate user-specific namespace from their account ID
-            uint8_t user_namespace[32];
-            // Copy user account ID to first 20 bytes
-            for (int i = 0; GUARD(20), i < 20; ++i)
-                user_namespace[i] = otxn_acc[i];
-            // Pad remaining 12 bytes with zeros
-            for (int i = 20; GUARD(32), i < 32; ++i)
-                user_namespace[i] = 0;
+            uint8_t user_namespace[USER_NS_SIZE];
+            USER_NAMESPACE(user_namespace, otxn_acc);
             
+            // One record holds the user's participation and claim state
+            uint8_t user_data[USER_DATA_SIZE] = {0};
+            int64_t user_len = USER_LOAD(user_data, IDO_DATA_KEY, 8, user_namespace, hook_acc);
+
+            // A failed sale repaid this account's XAH; the IOU it kept earns nothing
+            if (user_len == USER_DATA_SIZE && *(uint32_t*)(user_data + USER_CLAIMS) == USER_REFUNDED)
+                NOPE("Deposit refunded by the failed sale, no rewards to claim.");
+
+            // Claim state kept under the old key: accounts that never took
+            // part in the issuance, and records from before the claim fields,
+            // including 16-byte ones IDOMaster has since widened with zeros
+            uint8_t legacy_state[8] = {0};
+            int64_t legacy_len = -1;
+            if (UINT32_FROM_BUF(user_data + USER_LAST_CLAIM) == 0) {
+                legacy_len = USER_LOAD(legacy_state, CLAIM_KEY, 32, user_namespace, hook_acc);
+                if (legacy_len == 8)
+                    *(uint64_t*)(user_data + USER_LAST_CLAIM) = *(uint64_t*)legacy_state;
+            }
+
             // Check for issuance participation bonus
-            uint8_t ido_data_key[8] = {'I', 'D', 'O', '_', 'D', 'A', 'T', 'A'};
-            uint8_t ido_user_data[16] = {0};
-            int64_t ido_result = state_foreign(SBUF(ido_user_data), SBUF(ido_data_key), SBUF(user_namespace), SBUF(hook_acc));
-            if (ido_result == 16) {
-                uint64_t user_total_iou = UINT64_FROM_BUF(ido_user_data + 8);
-                if (user_total_iou > 0) {
-                    // Issuance participant bonus: recalculate with +5% interest
-                    uint64_t bonus_rate = interest_rate + 500;
-                    int64_t bonus_rate_xfl = float_set(0, bonus_rate);
-                    int64_t bonus_rate_fraction = float_divide(bonus_rate_xfl, percent_xfl);
-                    if (bonus_rate_fraction >= 0) {
-                        claim_amount_xfl = float_multiply(balance_xfl, bonus_rate_fraction);
-                    }
+            uint64_t user_total_iou = UINT64_FROM_BUF(user_data + USER_IOU);
+            if (user_total_iou > 0) {
+                // Issuance participant bonus: recalculate with +5% interest
+                uint64_t bonus_rate = interest_rate + 500;
+                int64_t bonus_rate_xfl = float_set(0, bonus_rate);
+                int64_t bonus_rate_fraction = float_divide(bonus_rate_xfl, percent_xfl);
+                if (bonus_rate_fraction >= 0) {
+                    claim_amount_xfl = float_multiply(balance_xfl, bonus_rate_fraction);
                 }
             }
             
-            // Simple state key for claim data
-            uint8_t claim_key[32] = "CLAIM_DATA";
-            // Pad remainder with zeros  
-            for (int i = 10; GUARD(32), i < 32; ++i)
-                claim_key[i] = 0;
-            
-            // Load user claim state from user-specific namespace on hook account
-            uint8_t user_state[8] = {0}; // {last_claim_ledger:4, total_claims:4}
-            int64_t state_result = state_foreign(SBUF(user_state), SBUF(claim_key), 
-                                                SBUF(user_namespace), SBUF(hook_acc));
-            
             uint32_t current_ledger = (uint32_t)ledger_seq();
-            uint32_t last_claim_ledger = 0;
-            uint32_t total_claims = 0;
-            
-            if (state_result == 8) {
-                // Existing user - parse state
-                last_claim_ledger = (uint32_t)((user_state[0] << 24) | (user_state[1] << 16) | 
-                                              (user_state[2] << 8) | user_state[3]);
-                total_claims = (uint32_t)((user_state[4] << 24) | (user_state[5] << 16) | 
-                                         (user_state[6] << 8) | user_state[7]);
-            }
+            uint32_t last_claim_ledger = UINT32_FROM_BUF(user_data + USER_LAST_CLAIM);
+            uint32_t total_claims = UINT32_FROM_BUF(user_data + USER_CLAIMS);
             
             // Check timing constraint
             if (last_claim_ledger > 0) {
@@ -289,88 +283,45 @@ int64_t hook(uint32_t reserved) {
                 NOPE("Maximum lifetime claims reached.");
             
             // Set hook account and claimant as destination
-            hook_account(HOOK_ACC, 20);
-            for (int i = 0; GUARD(20), i < 20; ++i)
-                DEST_ACC[i] = otxn_acc[i];
+            hook_account(txn + ETXN_REMIT_ACC_OUT, 20);
+            ACCOUNT_TO_BUF(txn + ETXN_REMIT_DEST_OUT, otxn_acc);
             
             // Build main claim transaction
             // Build Amounts array for Remit transaction
-            uint8_t* amounts_ptr = AMOUNTS_OUT;
-            
-            *amounts_ptr++ = 0xF0U;  // sfAmounts array start
-            *amounts_ptr++ = 0x5CU;
-            
-            *amounts_ptr++ = 0xE0U;  // sfAmountEntry object start
-            *amounts_ptr++ = 0x5BU;
-            
-            int32_t amount_len = float_sto(
-                amounts_ptr, 49,
-                currency, 20,
-                HOOK_ACC, 20,
-                claim_amount_xfl,
-                sfAmount
-            );
-            
+            uint8_t* amounts_ptr;
+            int32_t amount_len;
+            ETXN_AMOUNTS_BEGIN(amounts_ptr, txn);
+            ETXN_AMOUNTS_ADD_IOU(amounts_ptr, amount_len, currency, txn + ETXN_REMIT_ACC_OUT, claim_amount_xfl);
             if (amount_len < 0)
                 NOPE("Failed to serialize claim amount.");
-            
-            amounts_ptr += amount_len;
-            
-            *amounts_ptr++ = 0xE1U;  // End AmountEntry
-            *amounts_ptr++ = 0xF1U;  // End Amounts array
-            
-            int32_t amounts_len = amounts_ptr - AMOUNTS_OUT;
-                
+            ETXN_AMOUNTS_END(amounts_ptr);
+
             etxn_reserve(1); // Reserve space for claim
-            int32_t total_size = BASE_SIZE + amounts_len;
-            
-            // Encode ledger sequences
-            int64_t seq = current_ledger + 1;
-            txn[15] = (seq >> 24U) & 0xFFU;
-            txn[16] = (seq >> 16U) & 0xFFU;
-            txn[17] = (seq >>  8U) & 0xFFU;
-            txn[18] = seq & 0xFFU;
+            int32_t total_size = ETXN_REMIT_SIZE(txn, amounts_ptr);
             
-            seq += 4;
-            txn[21] = (seq >> 24U) & 0xFFU;
-            txn[22] = (seq >> 16U) & 0xFFU;
-            txn[23] = (seq >>  8U) & 0xFFU;
-            txn[24] = seq & 0xFFU;
+            ETXN_SET_LEDGERS(txn, current_ledger);
             
-            etxn_details(EMIT_OUT, 116U);
+            etxn_details(txn + ETXN_REMIT_DETAILS_OUT, ETXN_DETAILS_SIZE);
             int64_t fee = etxn_fee_base(txn, total_size);
-            {
-                uint8_t *b = FEE_OUT;
-                *b++ = 0b01000000 + ((fee >> 56) & 0b00111111);
-                *b++ = (fee >> 48) & 0xFFU;
-                *b++ = (fee >> 40) & 0xFFU;
-                *b++ = (fee >> 32) & 0xFFU;
-                *b++ = (fee >> 24) & 0xFFU;
-                *b++ = (fee >> 16) & 0xFFU;
-                *b++ = (fee >> 8) & 0xFFU;
-                *b++ = (fee >> 0) & 0xFFU;
-            }
+            ETXN_SET_FEE(txn + ETXN_REMIT_FEE_OUT, fee);
             
             // Emit main claim transaction
             uint8_t claim_emithash[32]; 
             if(emit(SBUF(claim_emithash), txn, total_size) < 0)
                 NOPE("Failed to emit claim transaction.");
             
-            // Update user state
-            uint8_t new_state[8];
-            new_state[0] = (current_ledger >> 24) & 0xFF;
-            new_state[1] = (current_ledger >> 16) & 0xFF;
-            new_state[2] = (current_ledger >> 8) & 0xFF;
-            new_state[3] = current_ledger & 0xFF;
-            
-            uint32_t new_total_claims = total_claims + 1;
-            new_state[4] = (new_total_claims >> 24) & 0xFF;
-            new_state[5] = (new_total_claims >> 16) & 0xFF;
-            new_state[6] = (new_total_claims >> 8) & 0xFF;
-            new_state[7] = new_total_claims & 0xFF;
-            
-            if(state_foreign_set(SBUF(new_state), SBUF(claim_key), 
-                                 SBUF(user_namespace), SBUF(hook_acc)) != 8)
+            // Update user state. A participant's claim state moves into its
+            // IDO_DATA record and a migrated CLAIM_DATA entry is dropped; any
+            // other account keeps it under CLAIM_DATA, so that claiming never
+            // creates an IDO_DATA record (RouterMaster reads one as taking part)
+            UINT32_TO_BUF(user_data + USER_LAST_CLAIM, current_ledger);
+            UINT32_TO_BUF(user_data + USER_CLAIMS, total_claims + 1);
+            if (user_len > 0) {
+                if(USER_FLUSH(user_data, USER_DATA_SIZE, IDO_DATA_KEY, 8, user_namespace, hook_acc, 1) != USER_DATA_SIZE)
+                    NOPE("Failed to update user state.");
+                if(USER_FLUSH(legacy_state, 0, CLAIM_KEY, 32, user_namespace, hook_acc, legacy_len == 8) < 0)
+                    NOPE("Failed to remove old claim state.");
+            } else if(USER_FLUSH(user_data + USER_LAST_CLAIM, 8, CLAIM_KEY, 32, user_namespace, hook_acc, 1) != 8)
                 NOPE("Failed to update user state.");
             
             // Note: User state stored in hierarchical namespace derived from account ID
@@ -21,13 +21,13 @@
 // Usage:
 //   - Install as the first hook in a chain with IDO and rewards hooks.
 //   - For outgoing transactions: Routes based on payment type (XAH skips rewards, IOU skips IDO).
-//   - For incoming invokes: Allows START param (runs IDO), rewards admin params (runs rewards), or R_CLAIM (runs rewards).
+//   - For incoming invokes: Allows START, FINALIZE or REFUND_SWEEP param (runs IDO), rewards admin params (runs rewards), or R_CLAIM (runs rewards).
 //   - For incoming payments: Checks IDO window, refund mode, XAH/IOU type, and participation to decide execution.
 //   - Skips hooks appropriately to ensure only relevant logic runs.
 //
 // Accepts:
 //   - Outgoing payments and invokes.
-//   - Incoming invokes with START, rewards params, or R_CLAIM.
+//   - Incoming invokes with START, FINALIZE, REFUND_SWEEP, rewards params, or R_CLAIM.
 //   - Incoming XAH payments with WP_LNK or raised funds during active IDO.
 //   - Incoming IOU payments from participants during active IDO or refund mode.
 //   - Incoming IOU payments for unwinding during any phase.
@@ -40,11 +40,28 @@
 //**************************************************************
 
 #include "hookapi.h"
+#include "../../Common/BuildProfile.h"
+#include "../../Common/UserRecord.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
 
 #define UINT32_FROM_BUF(buf) \
     (((uint32_t)(buf)[0] << 24) + ((uint32_t)(buf)[1] << 16) + \
      ((uint32_t)(buf)[2] << 8) + (uint32_t)(buf)[3])
 
+// IDOMaster's sale record ("IDO_SALE"), at the offsets IDOMaster writes
+#define SALE_STATUS 1
+#define SALE_START 2
+#define SALE_END 6
+#define SALE_INTERVAL 10
+#define SALE_SOFT_CAP 14
+#define SALE_XAH 22
+#define SALE_CLOSE 54
+#define SALE_MAX_SIZE 251                           // with 8 schedule phases
+#define SALE_OPEN 0
+#define SALE_REFUND 1
+#define SALE_MET 2
+
 // IDO hook hash
 uint8_t IDO_HOOK_HASH[32] = {0x33,0x09,0x61,0xA6,0x81,0x1A,0x03,0x13,0x1B,0x59,0x0D,0x0C,0x69,0x21,0x14,0x47,0xE7,0x8D,0xF7,0x20,0x88,0x98,0xA4,0x4F,0x8C,0xC1,0xE1,0x3C,0x62,0x9F,0x2D,0x2D};
 
@@ -55,8 +72,9 @@ uint8_t REWARDS_HOOK_HASH[32] = {0x8C,0xFC,0x9A,0xA6,0xAA,0x4A,0x85,0x8D,0xEF,0x
 uint8_t IDO_NAMESPACE[32] = {0x51,0x6B,0xA7,0x92,0x15,0x00,0x22,0x76,0xEF,0x4C,0x38,0x1B,0x90,0x19,0x55,0xC5,0x3A,0x04,0x57,0x55,0x89,0x60,0x7E,0x7D,0xBA,0x20,0x46,0x8D,0xD3,0x43,0xDD,0x72};
 
 
-#define DONE(msg)   accept(SBUF(msg), __LINE__)
-#define NOPE(msg)   rollback(SBUF(msg), __LINE__)
+#define HOOK_RESULT_ID RC_ROUTERMASTER
+#define DONE(msg)   RESULT_ACCEPT(msg)
+#define NOPE(msg)   RESULT_ROLLBACK(msg)
 
 #define SKIP()      { \
     int64_t r = hook_skip(IDO_HOOK_HASH, 32, 0); \
@@ -115,8 +133,17 @@ int64_t hook(int32_t reserved) {
             SKIP_REWARDS();
             DONE("Router: START param → run IDO, skip rewards");
         }
+        if (otxn_param(SBUF(dummy), "FINALIZE", 8) != DOESNT_EXIST) {
+            SKIP_REWARDS();
+            DONE("Router: FINALIZE param → run IDO, skip rewards");
+        }
+        if (otxn_param(SBUF(dummy), "REFUND_SWEEP", 12) != DOESNT_EXIST) {
+            SKIP_REWARDS();
+            DONE("Router: REFUND_SWEEP param → run IDO, skip rewards");
+        }
         // Check for rewards admin params - skip IDO for these
-        if (otxn_param(SBUF(dummy), "INT_RATE", 8) == 8 ||
+        int64_t rate_len = otxn_param(SBUF(dummy), "INT_RATE", 8);
+        if (rate_len == 4 || rate_len == 8 ||
             otxn_param(SBUF(dummy), "SET_INTERVAL", 12) == 4 ||
             otxn_param(SBUF(dummy), "SET_MAX_CLAIMS", 14) == 4) {
             SKIP();
@@ -131,34 +158,48 @@ int64_t hook(int32_t reserved) {
         NOPE("Router: Invoke without START or rewards params → invalid");
     }
 
+    // Anything else passes through; HookOn keeps it from reaching here
+    if (ttype != ttPAYMENT)
+        DONE("Router: Not a payment → pass");
+
     // Incoming Payment
 
     // Get current ledger
     int64_t current_ledger = ledger_seq();
 
-    // Query IDO window state
-    uint8_t start_key[5] = {'S', 'T', 'A', 'R', 'T'};
-    uint8_t end_key[3] = {'E', 'N', 'D'};
-    uint8_t start_buf[4];
-    uint8_t end_buf[4];
-    int64_t start_len = state_foreign(SBUF(start_buf), SBUF(start_key), SBUF(IDO_NAMESPACE), SBUF(hookacc));
-    int64_t end_len = state_foreign(SBUF(end_buf), SBUF(end_key), SBUF(IDO_NAMESPACE), SBUF(hookacc));
-    int window_set = (start_len == 4 && end_len == 4);
+    // Query IDO window state and refund mode (post-phase-4) in one read
+    uint8_t sale[SALE_MAX_SIZE] = {0};
+    int window_set = state_foreign(SBUF(sale), SKEY("IDO_SALE"), SBUF(IDO_NAMESPACE), SBUF(hookacc)) > 0;
+
+    // An IDOMaster upgraded in place keeps one key per field until its sale
+    // next changes; read the fields routing needs from those, as it does
+    if (!window_set &&
+        state_foreign((uint32_t)(sale + SALE_START), 4, SKEY("START"), SBUF(IDO_NAMESPACE), SBUF(hookacc)) == 4 &&
+        state_foreign((uint32_t)(sale + SALE_END), 4, SKEY("END"), SBUF(IDO_NAMESPACE), SBUF(hookacc)) == 4 &&
+        state_foreign((uint32_t)(sale + SALE_INTERVAL), 4, SKEY("INTERVAL"), SBUF(IDO_NAMESPACE), SBUF(hookacc)) == 4) {
+        window_set = 1;
+        state_foreign((uint32_t)(sale + SALE_SOFT_CAP), 8, SKEY("SOFT_CAP"), SBUF(IDO_NAMESPACE), SBUF(hookacc));
+        state_foreign((uint32_t)(sale + SALE_XAH), 8, SKEY("XAH"), SBUF(IDO_NAMESPACE), SBUF(hookacc));
+        uint8_t refund_flag;
+        if (state_foreign((uint32_t)&refund_flag, 1, SKEY("REFUND"), SBUF(IDO_NAMESPACE), SBUF(hookacc)) == 1)
+            sale[SALE_STATUS] = refund_flag ? SALE_REFUND : SALE_MET;
+        uint32_t legacy_close = UINT32_FROM_BUF(sale + SALE_START) + 4 * UINT32_FROM_BUF(sale + SALE_INTERVAL);
+        UINT32_TO_BUF(sale + SALE_CLOSE, legacy_close);
+    }
+    uint32_t start_ledger = UINT32_FROM_BUF(sale + SALE_START);
+    uint32_t end_ledger = UINT32_FROM_BUF(sale + SALE_END);
+    uint32_t curr = (uint32_t)current_ledger;
     int window_active = 0;
-    if (window_set) {
-        uint32_t start_ledger = UINT32_FROM_BUF(start_buf);
-        uint32_t end_ledger = UINT32_FROM_BUF(end_buf);
-        uint32_t curr = (uint32_t)current_ledger;
-        if (curr >= start_ledger && curr < end_ledger) {
-            window_active = 1;
-        }
+    if (window_set && curr >= start_ledger && curr < end_ledger) {
+        window_active = 1;
     }
 
-    // REFUND flag (post-phase-4)
-    uint8_t refund_key[6] = {'R','E','F','U','N','D'};
-    uint8_t refund_flag = 0;
-    int64_t refund_len = state_foreign(&refund_flag, 1, SBUF(refund_key), SBUF(IDO_NAMESPACE), SBUF(hookacc));
-    int refund_mode = (refund_len == 1 && refund_flag == 1);
+    // A sale past its close that nothing has finalized yet is routed as
+    // IDOMaster will settle it, so the route never depends on whether it has
+    uint8_t status = sale[SALE_STATUS];
+    if (window_set && status == SALE_OPEN && curr >= UINT32_FROM_BUF(sale + SALE_CLOSE))
+        status = UINT64_FROM_BUF(sale + SALE_XAH) < UINT64_FROM_BUF(sale + SALE_SOFT_CAP) ? SALE_REFUND : SALE_MET;
+    int refund_mode = status == SALE_REFUND;
 
     // If refund mode active, only allow incoming IOU payments
     if (refund_mode) {
@@ -179,7 +220,7 @@ int64_t hook(int32_t reserved) {
     }
 
     // Skip if IDO has ended
-    if (window_set && (uint32_t)current_ledger > UINT32_FROM_BUF(end_buf)) {
+    if (window_set && curr > end_ledger) {
         SKIP();
         DONE("Router: IDO ended → skip IDO");
     }
@@ -196,18 +237,15 @@ int64_t hook(int32_t reserved) {
     int is_xah = (alen == 8);
 
     if (is_xah) {
-        uint8_t wp_dummy[256];
-        int64_t has_wp = otxn_param(SBUF(wp_dummy), "WP_LNK", 6);
-
-        if (has_wp >= 0) {
+        // Only whether WP_LNK is there matters; IDOMaster checks it
+        uint8_t wp_dummy[1];
+        if (otxn_param(SBUF(wp_dummy), "WP_LNK", 6) != DOESNT_EXIST) {
             SKIP_REWARDS();
             DONE("Router: XAH + WP_LNK → run IDO");
         }
 
         // Permissive: if raised XAH exists
-        uint8_t xah_key[3] = {'X','A','H'};
-        uint8_t dummy_buf[8];
-        if (state(SBUF(dummy_buf), SBUF(xah_key)) == 8) {
+        if (*(uint64_t*)(sale + SALE_XAH) != 0) {
             SKIP_REWARDS();
             DONE("Router: XAH + raised exists → run IDO");
         }
@@ -217,16 +255,16 @@ int64_t hook(int32_t reserved) {
     }
 
     // IOU unwind
-    uint8_t ns[32] = {0};
-    for (i = 0; GUARD(20), i < 20; ++i) {
-        ns[i] = sender[i];
-    }
+    uint8_t ns[USER_NS_SIZE];
+    USER_NAMESPACE(ns, sender);
 
-    uint8_t user_key[8] = {'I','D','O','_','D','A','T','A'};
-    uint8_t user_data[16];
-    int64_t has_part = state_foreign(SBUF(user_data), SBUF(user_key), SBUF(ns), SBUF(hookacc));
+    // IDO_DATA is 24 bytes; 16-byte records predate the merged claim fields.
+    // A record with no XAH left is claim state only (fully unwound, or
+    // written by an earlier RewardsMaster claim) and is not participation.
+    uint8_t user_data[24];
+    int64_t has_part = USER_LOAD(user_data, SKEY_PTR("IDO_DATA"), 8, ns, hookacc);
 
-    if (has_part == 16) {
+    if (has_part >= 16 && *(uint64_t*)user_data != 0) {
         SKIP_REWARDS();
         DONE("Router: IOU + participation → run IDO");
     }
@@ -17,10 +17,14 @@
 //
 //**************************************************************
 #include "hookapi.h"
+#include "../Common/BuildProfile.h"
+#include "../Common/StateKey.h"
+#include "../Common/ResultCode.h"
 #include <stdint.h>
 
-#define DONE(x) accept(SBUF("NTH :: Success :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("NTH :: Error :: " x), __LINE__)
+#define HOOK_RESULT_ID RC_NOTEHOOK
+#define DONE(x) RESULT_ACCEPT("NTH :: Success :: " x)
+#define NOPE(x) RESULT_ROLLBACK("NTH :: Error :: " x)
 
 
 #define GUARD(maxiter) _g(__LINE__, (maxiter)+1)
@@ -46,17 +50,14 @@ int64_t hook(uint32_t reserved) {
     }
 
     uint8_t note_buf[1024];
-    uint8_t note_key[3] = {'N', 'O', 'T'}; 
-    int64_t note_len = otxn_param(SBUF(note_buf), SBUF(note_key));
+    int64_t note_len = otxn_param(SBUF(note_buf), SKEY("NOT"));
 
     uint8_t del_buf[8]; 
-    uint8_t del_key[3] = {'D', 'E', 'L'}; 
-    int64_t del_len = otxn_param(SBUF(del_buf), SBUF(del_key));
+    int64_t del_len = otxn_param(SBUF(del_buf), SKEY("DEL"));
 
     uint8_t count_buf[8];
-    uint8_t count_key[3] = {'C', 'N', 'T'};
     uint64_t count = 0;
-    if (state(SBUF(count_buf), SBUF(count_key)) >= 0) {
+    if (state(SBUF(count_buf), SKEY("CNT")) >= 0) {
         count = UINT64_FROM_BUF(count_buf);
     }
 
@@ -70,7 +71,7 @@ int64_t hook(uint32_t reserved) {
 
         count++;
         UINT64_TO_BUF(count_buf, count);
-        if (state_set(SBUF(count_buf), SBUF(count_key)) < 0) {
+        if (state_set(SBUF(count_buf), SKEY("CNT")) < 0) {
             NOPE("Error: Could not update count state");
         }
 
@@ -85,7 +86,7 @@ int64_t hook(uint32_t reserved) {
 
         count--;
         UINT64_TO_BUF(count_buf, count);
-        if (state_set(SBUF(count_buf), SBUF(count_key)) < 0) {
+        if (state_set(SBUF(count_buf), SKEY("CNT")) < 0) {
             NOPE("Error: Could not update count state");
         }
 
@@ -5,11 +5,13 @@
 // Description:
 //   Provides min/max/cap/blacklist controls for payments.
 //   Allows dynamic configuration via INVOKE transactions.
-//   Emits a developer contribution on each processed transaction.
+//   Accrues a developer contribution on each processed transaction.
 //
 // Development Contribution:
 //   This hook includes a hardcoded development contribution of **0.05 XAH** that is
-//   automatically charged for each successful payment transaction.
+//   automatically charged for each successful payment transaction. Contributions
+//   accrue in state under "FEEACCRU" and are paid out together once FEE_SETTLE drops
+//   have built up or FEE_LEDGERS ledgers have passed (hook parameters, optional).
 //   This contribution is used to fund ongoing development and maintenance of the HandyHooks collection.
 //
 // Parameters:
@@ -24,15 +26,32 @@
 //
 // Usage:
 //   - To set any flag or value, send an Invoke transaction with the parameter(s).
-//   - Multiple parameters can be set in a single transaction.
+//   - Multiple parameters can be set in a single transaction; all of them are applied.
+//   - An unknown parameter or a value of the wrong size rejects the whole invoke.
 //   - Only the hook owner can change settings or manage the blacklist.
 //
+// Storage Structure:
+//   - Settings: one record under "HOOKCONF" (Common/ConfigRecord.h), layout 1:
+//     { version:1, flags:1, MINAMT:8, MAXAMT:8 }
+//     Without it the settings are read from the keys used before it (the
+//     MIN, MAX, CAP and BLKLST flags, MINAMT, MAXAMT) until an invoke
+//     changes one and saves them all in the record.
+//   - Blacklist: "BLACKLISTED" in a namespace per account ID (1 byte, 0x01)
+//
 //**************************************************************
 
 #include "hookapi.h"
-
-#define DONE(x) accept(SBUF("SGH :: Success :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("SGH :: Error :: " x), __LINE__)
+#include "../Common/BuildProfile.h"
+#include "../Common/FeeAccrual.h"
+#include "../Common/ConfigRecord.h"
+#include "../Common/ParamDispatch.h"
+#include "../Common/UserRecord.h"
+#include "../Common/StateKey.h"
+#include "../Common/ResultCode.h"
+
+#define HOOK_RESULT_ID RC_SAFEGUARD
+#define DONE(x) RESULT_ACCEPT("SGH :: Success :: " x)
+#define NOPE(x) RESULT_ROLLBACK("SGH :: Error :: " x)
 #define GUARD(maxiter) _g(__LINE__, (maxiter)+1)
 
 #define UINT64_TO_BUF(buf, i) \
@@ -53,9 +72,45 @@
      ((uint64_t)(buf)[4] << 24) + ((uint64_t)(buf)[5] << 16) + \
      ((uint64_t)(buf)[6] << 8) + (uint64_t)(buf)[7])
 
+// Invoke commands, in PARAM_NEXT table order, and their sizes
+static const uint8_t sgh_commands[][PARAM_NAME_SIZE] = {
+    "MIN", "MINAMT", "MAX", "MAXAMT", "CAP", "BLACKLIST", "ADD_BLACKLIST", "REMOVE_BLACKLIST"};
+static const int sgh_command_sizes[] = {1, 8, 1, 8, 1, 1, 20, 20};
+#define CMD_MIN 0
+#define CMD_MINAMT 1
+#define CMD_MAX 2
+#define CMD_MAXAMT 3
+#define CMD_CAP 4
+#define CMD_BLACKLIST 5
+#define CMD_ADD_BLACKLIST 6
+#define CMD_REMOVE_BLACKLIST 7
+
 #define MIN_AMOUNT_VALUE 1
 #define MAX_AMOUNT_VALUE 1000000
 
+// Settings record offsets; MINAMT / MAXAMT count only once their flag is set
+#define SGH_CFG_VERSION 1
+#define SGH_CFG_FLAGS 1
+#define SGH_CFG_MINAMT 2
+#define SGH_CFG_MAXAMT 10
+#define SGH_CFG_SIZE 18
+
+#define SGH_FLAG_MIN 0x01U
+#define SGH_FLAG_MAX 0x02U
+#define SGH_FLAG_CAP 0x04U
+#define SGH_FLAG_BLACKLIST 0x08U
+#define SGH_FLAG_MINAMT 0x10U
+#define SGH_FLAG_MAXAMT 0x20U
+
+// Per-setting keys from before the record: the MIN, MAX, CAP and BLKLST
+// flags (1 byte, in SGH_FLAG_* bit order), then MINAMT and MAXAMT
+static const uint8_t sgh_legacy_keys[][8] = {
+    "\0\0\0\0\x0FMIN", "\0\0\0\0\x0FMAX", "\0\0\0\0\x0F" "CAP", "\0BLKLST",
+    "\x04\xD4\x94\xE4\x14\xD5\x45\x44", "\x04\xD4\x15\x84\x14\xD5\x45\x44"};
+
+// Per-account blacklist flag, stored under a 32-byte key in the account's namespace
+#define BLACKLIST_KEY SKEY_PTR("BLACKLISTED")
+
 static uint8_t dev_contrib_acc[20] = {0xCC, 0x41, 0x96, 0xC1, 0xF2, 0x34, 0xDB, 0xAA, 0x06, 0x13, 0x0F, 0xAA, 0xF5, 0xD2, 0x8C, 0x53, 0x77, 0xA6, 0xFB, 0xCA};
 #define DEV_CONTRIB_DROPS 50000
 
@@ -70,31 +125,21 @@ int64_t hook(uint32_t reserved) {
 
     int64_t tt = otxn_type();
 
-    uint64_t min_num = 0x000000000F4D494E; // 'MIN' (flag)
-    uint8_t min_buf[8];
-    UINT64_TO_BUF(min_buf, min_num);
-
-    uint64_t min_amt_num = 0x4D494E414D54544; // 'MINAMT' (min amount)
-    uint8_t min_amt_buf[8];
-    UINT64_TO_BUF(min_amt_buf, min_amt_num);
-
-    uint64_t max_num = 0x000000000F4D4158; // 'MAX' (flag)
-    uint8_t max_buf[8];
-    UINT64_TO_BUF(max_buf, max_num);
-
-    uint64_t max_amt_num = 0x4D4158414D54544; // 'MAXAMT' (max amount)
-    uint8_t max_amt_buf[8];
-    UINT64_TO_BUF(max_amt_buf, max_amt_num);
-
-    // CAP flag state key
-    uint64_t cap_num = 0x000000000F434150; // 'CAP' (flag)
-    uint8_t cap_buf[8];
-    UINT64_TO_BUF(cap_buf, cap_num);
-
-    // BLACKLIST flag state key
-    uint64_t blacklist_num = 0x00424C4B4C535400; // 'BLKLST' (flag)
-    uint8_t blacklist_buf[8];
-    UINT64_TO_BUF(blacklist_buf, blacklist_num);
+    // Every setting comes from one state read, or from the per-setting
+    // keys while an upgraded install has no record yet
+    uint8_t cfg[SGH_CFG_SIZE] = {0};
+    if (!CFG_LOAD(cfg, SGH_CFG_SIZE)) {
+        for (int i = 0; GUARD(4), i < 4; ++i) {
+            uint8_t on = 0;
+            if (CFG_LEGACY(&on, 1, (uint32_t)sgh_legacy_keys[i], 8) && on)
+                cfg[SGH_CFG_FLAGS] |= 1U << i;
+        }
+        if (CFG_LEGACY(cfg + SGH_CFG_MINAMT, 8, (uint32_t)sgh_legacy_keys[4], 8))
+            cfg[SGH_CFG_FLAGS] |= SGH_FLAG_MINAMT;
+        if (CFG_LEGACY(cfg + SGH_CFG_MAXAMT, 8, (uint32_t)sgh_legacy_keys[5], 8))
+            cfg[SGH_CFG_FLAGS] |= SGH_FLAG_MAXAMT;
+    }
+    uint8_t flags = cfg[SGH_CFG_FLAGS];
 
     // Process INVOKE transactions
     if (tt == 99) {
@@ -104,173 +149,97 @@ int64_t hook(uint32_t reserved) {
         if (!equal)
             NOPE("Only hook owner can change settings");
 
-        // Get and set MIN parameter
-        uint8_t min_param[1];
-        uint8_t min_key[3] = {'M','I','N'};
-        int8_t is_min = otxn_param(SBUF(min_param), SBUF(min_key));
-
-        if (is_min > 0) {
-            if (min_param[0] > 1)
-                NOPE("MIN must be 0 or 1");
-            if (state_set(SBUF(min_param), SBUF(min_buf)) < 0)
-                NOPE("Failed to set MIN state");
-            TRACEVAR(min_param[0]);
-            DONE("MIN state set successfully");
-        }
-
-        // Get and set MINAMT parameter
-        uint8_t min_amt_param[8];
-        uint8_t min_amt_key[6] = {'M','I','N','A','M','T'};
-        int8_t is_min_amt = otxn_param(SBUF(min_amt_param), min_amt_key, 6);
-
-        if (is_min_amt == 8) {
-            if (state_set(SBUF(min_amt_param), SBUF(min_amt_buf)) < 0)
-                NOPE("Failed to set MINAMT state");
-            TRACEVAR(UINT64_FROM_BUF(min_amt_param));
-            DONE("MINAMT value set successfully");
-        }
-
-        // Get and set MAX parameter
-        uint8_t max_param[1];
-        uint8_t max_key[3] = {'M','A','X'};
-        int8_t is_max = otxn_param(SBUF(max_param), SBUF(max_key));
-        
-        if (is_max > 0) {
-            if (max_param[0] > 1)
-            NOPE("MAX must be 0 or 1");
-            if (state_set(SBUF(max_param), SBUF(max_buf)) < 0)
-            NOPE("Failed to set MAX state");
-            TRACEVAR(max_param[0]);
-            DONE("MAX state set successfully");
-        }
-
-        // Get and set MAXAMT parameter
-        uint8_t max_amt_param[8];
-        uint8_t max_amt_key[6] = {'M','A','X','A','M','T'};
-        int8_t is_max_amt = otxn_param(SBUF(max_amt_param), max_amt_key, 6);
-        if (is_max_amt == 8) {
-            if (state_set(SBUF(max_amt_param), SBUF(max_amt_buf)) < 0)
-                NOPE("Failed to set MAXAMT state");
-            TRACEVAR(UINT64_FROM_BUF(max_amt_param));
-            DONE("MAXAMT value set successfully");
-        }
-
-        // CAP on/off switch logic
-        uint8_t cap_param[1];
-        uint8_t cap_key[3] = {'C','A','P'};
-        int8_t is_cap = otxn_param(SBUF(cap_param), SBUF(cap_key));
-        if (is_cap > 0) {
-            if (cap_param[0] > 1)
-                NOPE("CAP must be 0 or 1");
-                if (state_set(SBUF(cap_param), SBUF(cap_buf)) < 0)
-                    NOPE("Failed to set CAP state");
-                TRACEVAR(cap_param[0]);
-                DONE("CAP state set successfully");
+        // Apply every command the invoke carries in one pass over its
+        // HookParameters; any unknown parameter or invalid value rolls
+        // the whole invoke back
+        int applied = 0;
+        int cfg_dirty = 0;
+        PARAM_LOAD(params, params_len);
+        if (params_len < 0)
+            NOPE("HookParameters could not be read");
+        uint8_t* cursor = params;
+        for (int i = 0; GUARD(PARAM_MAX), i < PARAM_MAX && cursor < params + params_len; ++i) {
+            int cmd;
+            uint8_t* value;
+            int value_len;
+            PARAM_NEXT(cursor, params + params_len, sgh_commands, cmd, value, value_len);
+            if (cmd < 0)
+                NOPE("Unknown or malformed HookParameter");
+            if (value_len != sgh_command_sizes[cmd])
+                NOPE("HookParameter has the wrong size");
+
+            // MIN, MAX, CAP and BLACKLIST flags
+            uint8_t flag = 0;
+            if (cmd == CMD_MIN)
+                flag = SGH_FLAG_MIN;
+            else if (cmd == CMD_MAX)
+                flag = SGH_FLAG_MAX;
+            else if (cmd == CMD_CAP)
+                flag = SGH_FLAG_CAP;
+            else if (cmd == CMD_BLACKLIST)
+                flag = SGH_FLAG_BLACKLIST;
+
+            if (flag) {
+                if (value[0] > 1)
+                    NOPE("MIN, MAX, CAP and BLACKLIST must be 0 or 1");
+                flags = value[0] ? flags | flag : flags & ~flag;
+                TRACEVAR(value[0]);
+                cfg_dirty = 1;
+                applied++;
+            }
+
+            // MINAMT and MAXAMT values
+            if (cmd == CMD_MINAMT || cmd == CMD_MAXAMT) {
+                int at = cmd == CMD_MINAMT ? SGH_CFG_MINAMT : SGH_CFG_MAXAMT;
+                *(uint64_t*)(cfg + at) = *(uint64_t*)value;
+                flags |= cmd == CMD_MINAMT ? SGH_FLAG_MINAMT : SGH_FLAG_MAXAMT;
+                TRACEVAR(UINT64_FROM_BUF(value));
+                cfg_dirty = 1;
+                applied++;
+            }
+
+            // Add or remove an account on the blacklist
+            if (cmd == CMD_ADD_BLACKLIST || cmd == CMD_REMOVE_BLACKLIST) {
+                // Generate account-specific namespace from the account ID
+                uint8_t account_namespace[USER_NS_SIZE];
+                USER_NAMESPACE(account_namespace, value);
+
+                // Blacklisted flag (1 byte = 0x01), removed by setting empty state
+                uint8_t blacklisted_flag[1] = {0x01};
+                if (USER_FLUSH(blacklisted_flag, cmd == CMD_ADD_BLACKLIST ? 1 : 0,
+                               BLACKLIST_KEY, 32, account_namespace, hook_acc, 1) < 0)
+                    NOPE("Failed to update blacklist");
+                applied++;
+            }
         }
 
-        // BLACKLIST on/off switch logic
-        uint8_t blacklist_param[1];
-        uint8_t blacklist_key[9] = {'B','L','A','C','K','L','I','S','T'};
-        int8_t is_blacklist = otxn_param(SBUF(blacklist_param), blacklist_key, 9);
-        if (is_blacklist > 0) {
-            if (blacklist_param[0] > 1)
-                NOPE("BLACKLIST must be 0 or 1");
-            if (state_set(SBUF(blacklist_param), SBUF(blacklist_buf)) < 0)
-                NOPE("Failed to set BLACKLIST state");
-            TRACEVAR(blacklist_param[0]);
-            DONE("BLACKLIST state set successfully");
-        }
-
-        // Add account to blacklist
-        uint8_t add_blacklist_param[20];
-        uint8_t add_blacklist_key[13] = {'A','D','D','_','B','L','A','C','K','L','I','S','T'};
-        int8_t is_add_blacklist = otxn_param(SBUF(add_blacklist_param), add_blacklist_key, 13);
-        
-        // Generate account-specific namespace from the account ID
-        if (is_add_blacklist == 20) {
-            uint8_t account_namespace[32];
-            for (int i = 0; GUARD(20), i < 20; ++i)
-                account_namespace[i] = add_blacklist_param[i];
-            for (int i = 20; GUARD(32), i < 32; ++i)
-                account_namespace[i] = 0;
-            
-            // Simple state key for blacklist data
-            uint8_t blacklist_key_data[32] = "BLACKLISTED";
-            for (int i = 11; GUARD(32), i < 32; ++i)
-                blacklist_key_data[i] = 0;
-            
-            // Set blacklisted flag (1 byte = 0x01)
-            uint8_t blacklisted_flag[1] = {0x01};
-            if (state_foreign_set(SBUF(blacklisted_flag), SBUF(blacklist_key_data), 
-                                  SBUF(account_namespace), SBUF(hook_acc)) != 1)
-                NOPE("Failed to add account to blacklist");
-            
-            DONE("Account added to blacklist successfully");
-        }
-
-        // Remove account from blacklist
-        uint8_t remove_blacklist_param[20];
-        uint8_t remove_blacklist_key[16] = {'R','E','M','O','V','E','_','B','L','A','C','K','L','I','S','T'};
-        int8_t is_remove_blacklist = otxn_param(SBUF(remove_blacklist_param), remove_blacklist_key, 16);
-        if (is_remove_blacklist == 20) {
-            // Generate account-specific namespace from the account ID
-            uint8_t account_namespace[32];
-            for (int i = 0; GUARD(20), i < 20; ++i)
-                account_namespace[i] = remove_blacklist_param[i];
-            for (int i = 20; GUARD(32), i < 32; ++i)
-                account_namespace[i] = 0;
-            
-            // Simple state key for blacklist data
-            uint8_t blacklist_key_data[32] = "BLACKLISTED";
-            for (int i = 11; GUARD(32), i < 32; ++i)
-                blacklist_key_data[i] = 0;
-            
-            // Remove blacklisted flag by setting empty state
-            if (state_foreign_set(0, 0, SBUF(blacklist_key_data), 
-                                  SBUF(account_namespace), SBUF(hook_acc)) < 0)
-                NOPE("Failed to remove account from blacklist");
-            
-            DONE("Account removed from blacklist successfully");
-        }
-
-    DONE("No valid parameters provided for invoke Skipping.");
+        if (!applied)
+            DONE("No valid parameters provided for invoke Skipping.");
+        cfg[SGH_CFG_FLAGS] = flags;
+        if (cfg_dirty && CFG_SAVE(cfg, SGH_CFG_SIZE, SGH_CFG_VERSION) < 0)
+            NOPE("Failed to store settings");
+        TRACEVAR(applied);
+        DONE("Settings applied successfully");
     }
 
     // Process PAYMENT transactions
     if (tt == ttPAYMENT) {
 
-        uint8_t min_flag;
-        uint8_t max_flag;
-        uint8_t cap_flag;
-        uint8_t blacklist_flag;
-
-        if (state(SBUF(&min_flag), SBUF(min_buf)) < 0)
-            min_flag = 0;
-        if (state(SBUF(&max_flag), SBUF(max_buf)) < 0)
-            max_flag = 0;
-        if (state(SBUF(&cap_flag), SBUF(cap_buf)) < 0)
-            cap_flag = 0;
-        if (state(SBUF(&blacklist_flag), SBUF(blacklist_buf)) < 0)
-            blacklist_flag = 0;
+        uint8_t min_flag = (flags & SGH_FLAG_MIN) != 0;
+        uint8_t max_flag = (flags & SGH_FLAG_MAX) != 0;
+        uint8_t cap_flag = (flags & SGH_FLAG_CAP) != 0;
+        uint8_t blacklist_flag = (flags & SGH_FLAG_BLACKLIST) != 0;
 
         // Check blacklist if enabled
         if (blacklist_flag) {
             // Generate account-specific namespace from the otxn account ID
-            uint8_t account_namespace[32];
-            for (int i = 0; GUARD(20), i < 20; ++i)
-                account_namespace[i] = otxn_acc[i];
-            for (int i = 20; GUARD(32), i < 32; ++i)
-                account_namespace[i] = 0;
-            
-            // Simple state key for blacklist data
-            uint8_t blacklist_key_data[32] = "BLACKLISTED";
-            for (int i = 11; GUARD(32), i < 32; ++i)
-                blacklist_key_data[i] = 0;
-            
+            uint8_t account_namespace[USER_NS_SIZE];
+            USER_NAMESPACE(account_namespace, otxn_acc);
+
             // Check if account is blacklisted
             uint8_t blacklist_status[1];
-            int64_t blacklist_result = state_foreign(SBUF(blacklist_status), SBUF(blacklist_key_data), 
-                                                    SBUF(account_namespace), SBUF(hook_acc));
+            int64_t blacklist_result = USER_LOAD(blacklist_status, BLACKLIST_KEY, 32,
+                                                 account_namespace, hook_acc);
             
             if (blacklist_result == 1 && blacklist_status[0] == 0x01)
                 NOPE("Transaction rejected: Account is blacklisted");
@@ -290,20 +259,18 @@ int64_t hook(uint32_t reserved) {
 
         // Enforce minimum for incoming
         if (!is_outgoing && min_flag) {
-            uint8_t min_amt_val[8];
             double min_amt = 1.0;
-            if (state(SBUF(min_amt_val), SBUF(min_amt_buf)) == 8)
-                min_amt = (double)UINT64_FROM_BUF(min_amt_val) / 1000000.0;
+            if (flags & SGH_FLAG_MINAMT)
+                min_amt = (double)UINT64_FROM_BUF(cfg + SGH_CFG_MINAMT) / 1000000.0;
             if (xah_amount < min_amt)
                 NOPE("Payment below minimum amount.");
         }
 
         // Enforce maximum for outgoing
         if (is_outgoing && max_flag) {
-            uint8_t max_amt_val[8];
             double max_amt = 1000000.0;
-            if (state(SBUF(max_amt_val), SBUF(max_amt_buf)) == 8)
-                max_amt = (double)UINT64_FROM_BUF(max_amt_val) / 1000000.0;
+            if (flags & SGH_FLAG_MAXAMT)
+                max_amt = (double)UINT64_FROM_BUF(cfg + SGH_CFG_MAXAMT) / 1000000.0;
             if (xah_amount > max_amt)
                 NOPE("Payment above maximum amount.");
         }
@@ -342,19 +309,19 @@ int64_t hook(uint32_t reserved) {
                 NOPE("Payment exceeds 80% of account balance.");
         }
 
-        // Reserve emission slot
-        etxn_reserve(1);
-        
-        // Prepare the payment
-        uint8_t dev_contrib_txn[PREPARE_PAYMENT_SIMPLE_SIZE];
-        PREPARE_PAYMENT_SIMPLE(dev_contrib_txn, DEV_CONTRIB_DROPS, dev_contrib_acc, 0, 0);
-
-        // Emit the service fee payment
-        uint8_t dev_contrib_emithash[32];
-        if (emit(SBUF(dev_contrib_emithash), SBUF(dev_contrib_txn)) != 32)
-            TRACESTR("Safeguard :: Warning :: Failed to emit developer contribution payment.");
-
-    DONE("Payment accepted and developer contribution emitted.");
+        // Accrue the developer contribution; it is paid out in one payment
+        // per settlement rather than one per transaction
+        uint8_t fee_rec[FEE_ACCRUAL_SIZE];
+        int64_t fee_settle;
+        FEE_ACCRUE(fee_rec, DEV_CONTRIB_DROPS, fee_settle);
+        if (fee_settle)
+            etxn_reserve(1);
+        int64_t fee_stored;
+        FEE_SETTLE(fee_rec, fee_settle, dev_contrib_acc, fee_stored);
+        if (fee_stored != FEE_ACCRUAL_SIZE)
+            NOPE("Failed to store accrued contribution");
+
+    DONE("Payment accepted and developer contribution accrued.");
     }
 
     NOPE("Unsupported transaction type, check HookOn Triggers!");
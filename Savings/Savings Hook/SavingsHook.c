@@ -23,28 +23,43 @@
 //   'SP3' (4 bytes):  Set Savings Percentage 3 (1-99, as uint32)
 //
 // Usage:
-//   - To set any account or percentage, send an Invoke transaction with the parameter(s).
+//   - To set any account or percentage, send an Invoke transaction with the parameter(s);
+//     one invoke can carry all six. An unknown parameter or a value of
+//     the wrong size rejects the whole invoke.
 //   - Only the hook owner can change savings configuration.
 //
 // Storage Structure:
-//   - Savings accounts: "SA1", "SA2", "SA3" (20 bytes each)
-//   - Percentages:      "SP1", "SP2", "SP3" (4 bytes each, uint32)
+//   - One record under "HOOKCONF" (Common/ConfigRecord.h), layout 1:
+//     { version:1, set mask:1, SA1..SA3:20 each, SP1..SP3:4 each, uint32 }
+//     Bit n of the mask marks command n of ips_commands as set.
+//     Without it the settings are read from the "SA1".."SP3" keys used
+//     before it, until the next configuration invoke saves the record.
 //
 //**************************************************************
 
 #include "hookapi.h"
-
-#define DONE(x) accept(SBUF("IPS:: Success :: " x), __LINE__)
-#define WARN(x) rollback(SBUF("IPS:: Misconfigured :: " x), __LINE__)
-#define NOPE(x) rollback(SBUF("IPS:: Error :: " x), __LINE__)
-
-// State keys for savings accounts and percentages
-#define SA1_KEY 0x5341310000000000ULL // "SA1"
-#define SP1_KEY 0x5350310000000000ULL // "SP1"
-#define SA2_KEY 0x5341320000000000ULL // "SA2"
-#define SP2_KEY 0x5350320000000000ULL // "SP2"
-#define SA3_KEY 0x5341330000000000ULL // "SA3"
-#define SP3_KEY 0x5350330000000000ULL // "SP3"
+#include "../../Common/BuildProfile.h"
+#include "../../Common/ParamDispatch.h"
+#include "../../Common/ConfigRecord.h"
+#include "../../Common/ResultCode.h"
+
+#define HOOK_RESULT_ID RC_SAVINGSHOOK
+#define DONE(x) RESULT_ACCEPT("IPS:: Success :: " x)
+#define WARN(x) RESULT_ROLLBACK("IPS:: Misconfigured :: " x)
+#define NOPE(x) RESULT_ROLLBACK("IPS:: Error :: " x)
+
+// Configuration record offsets
+#define IPS_CFG_VERSION 1
+#define IPS_CFG_MASK 1
+#define IPS_CFG_SA 2        // 3 x 20 bytes
+#define IPS_CFG_SP 62       // 3 x 4 bytes
+#define IPS_CFG_SIZE 74
+
+// Invoke commands, in PARAM_NEXT table order, and where each is stored
+static const uint8_t ips_commands[][PARAM_NAME_SIZE] = {"SA1", "SA2", "SA3", "SP1", "SP2", "SP3"};
+static const uint8_t ips_offsets[] = {
+    IPS_CFG_SA, IPS_CFG_SA + 20, IPS_CFG_SA + 40, IPS_CFG_SP, IPS_CFG_SP + 4, IPS_CFG_SP + 8};
+#define IPS_SET(cfg, cmd) (((cfg)[IPS_CFG_MASK] >> (cmd)) & 1U)
 
 int64_t hook(uint32_t reserved)
 {
@@ -58,105 +73,89 @@ int64_t hook(uint32_t reserved)
 
     int64_t tt = otxn_type();
 
+    // The record, or while an upgraded install has none, the SA / SP keys
+    // it replaced, named like the commands
+    uint8_t cfg[IPS_CFG_SIZE] = {0};
+    if (!CFG_LOAD(cfg, IPS_CFG_SIZE))
+        for (int i = 0; GUARD(6), i < 6; ++i)
+            if (CFG_LEGACY(cfg + ips_offsets[i], i < 3 ? 20 : 4, (uint32_t)ips_commands[i], 8))
+                cfg[IPS_CFG_MASK] |= 1U << i;
+
     // Handle ttINVOKE for configuration FIRST (before checking outgoing)
     if (tt == ttINVOKE)
     {
         if (!BUFFER_EQUAL_20(hook_acc, otxn_acc))
             NOPE("Only hook owner can configure");
 
-        // Check for SA1 parameter
-        uint8_t sa_param[20];
-        if (otxn_param(SBUF(sa_param), "SA1", 3) == 20)
-        {
-            uint8_t key_buf[8];
-            UINT64_TO_BUF(key_buf, SA1_KEY);
-            state_set(SBUF(sa_param), SBUF(key_buf));
-            DONE("SA1 configured");
-        }
-
-        // Check for SP1 parameter
-        uint8_t sp_param[4];
-        if (otxn_param(SBUF(sp_param), "SP1", 3) == 4)
+        // One pass over the invoke's HookParameters; every SAn / SPn it
+        // carries is stored, so all three accounts can be set at once
+        int applied = 0;
+        PARAM_LOAD(params, params_len);
+        if (params_len < 0)
+            NOPE("Parameters could not be read");
+        uint8_t* cursor = params;
+        for (int i = 0; GUARD(PARAM_MAX), i < PARAM_MAX && cursor < params + params_len; ++i)
         {
-            uint8_t key_buf[8];
-            UINT64_TO_BUF(key_buf, SP1_KEY);
-            state_set(SBUF(sp_param), SBUF(key_buf));
-            DONE("SP1 configured");
-        }
-
-        // Check for SA2 parameter
-        if (otxn_param(SBUF(sa_param), "SA2", 3) == 20)
-        {
-            uint8_t key_buf[8];
-            UINT64_TO_BUF(key_buf, SA2_KEY);
-            state_set(SBUF(sa_param), SBUF(key_buf));
-            DONE("SA2 configured");
-        }
-
-        // Check for SP2 parameter
-        if (otxn_param(SBUF(sp_param), "SP2", 3) == 4)
-        {
-            uint8_t key_buf[8];
-            UINT64_TO_BUF(key_buf, SP2_KEY);
-            state_set(SBUF(sp_param), SBUF(key_buf));
-            DONE("SP2 configured");
-        }
-
-        // Check for SA3 parameter
-        if (otxn_param(SBUF(sa_param), "SA3", 3) == 20)
-        {
-            uint8_t key_buf[8];
-            UINT64_TO_BUF(key_buf, SA3_KEY);
-            state_set(SBUF(sa_param), SBUF(key_buf));
-            DONE("SA3 configured");
-        }
-
-        // Check for SP3 parameter
-        if (otxn_param(SBUF(sp_param), "SP3", 3) == 4)
-        {
-            uint8_t key_buf[8];
-            UINT64_TO_BUF(key_buf, SP3_KEY);
-            state_set(SBUF(sp_param), SBUF(key_buf));
-            DONE("SP3 configured");
+            int cmd;
+            uint8_t* value;
+            int value_len;
+            PARAM_NEXT(cursor, params + params_len, ips_commands, cmd, value, value_len);
+
+            // Accounts take 20 bytes, percentages 4; anything else rolls
+            // the whole invoke back
+            if (cmd < 0)
+                NOPE("Unknown or malformed parameter");
+            if (value_len != (cmd < 3 ? 20 : 4))
+                NOPE("SAn takes 20 bytes and SPn 4");
+
+            uint8_t* field = cfg + ips_offsets[cmd];
+            if (cmd < 3)
+            {
+                ACCOUNT_TO_BUF(field, value);
+            }
+            else
+                *(uint32_t*)field = *(uint32_t*)value;
+            cfg[IPS_CFG_MASK] |= 1U << cmd;
+            applied++;
         }
 
-        NOPE("No valid parameters");
+        if (!applied)
+            NOPE("No valid parameters");
+        if (CFG_SAVE(cfg, IPS_CFG_SIZE, IPS_CFG_VERSION) < 0)
+            NOPE("Failed to store configuration");
+        DONE("Savings configured");
     }
 
     // Accept outgoing transactions (but NOT ttINVOKE since we handled that above)
     if (BUFFER_EQUAL_20(hook_acc, otxn_acc))
         DONE("Outgoing transaction");
 
-    // Handle ttPayment (type 96)
-    if (tt == ttPayment)
+    // Handle ttPAYMENT (type 0)
+    if (tt == ttPAYMENT)
     {
         // Get Genesis Mint amount
         uint8_t amount[8];
         if (otxn_field(SBUF(amount), sfAmount) != 8)
             DONE("Non-XAH Payment, Skipping..");
 
-        // Load savings accounts and percentages
-        uint8_t savings_accounts[3][20];
+        // Savings accounts and percentages, from the record loaded above
+        uint8_t* savings_accounts[3] = {
+            cfg + IPS_CFG_SA, cfg + IPS_CFG_SA + 20, cfg + IPS_CFG_SA + 40};
         uint32_t savings_percentages[3];
         int configured_accounts = 0;
 
-        // Load SA1/SP1
-        uint8_t key_buf[8];
-        UINT64_TO_BUF(key_buf, SA1_KEY);
-        if (state(SBUF(savings_accounts[0]), SBUF(key_buf)) == 20)
+        // SA1/SP1
+        if (IPS_SET(cfg, 0))
         {
-            UINT64_TO_BUF(key_buf, SP1_KEY);
-            uint8_t sp_data[4];
-            if (state(SBUF(sp_data), SBUF(key_buf)) == 4)
-                savings_percentages[0] = UINT32_FROM_BUF(sp_data);
+            if (IPS_SET(cfg, 3))
+                savings_percentages[0] = UINT32_FROM_BUF(cfg + IPS_CFG_SP);
             else
                 savings_percentages[0] = 99; // Default to 99% for single account
             configured_accounts++;
         }
 
-        // Load SA2/SP2
-        UINT64_TO_BUF(key_buf, SA2_KEY);
-        if (state(SBUF(savings_accounts[1]), SBUF(key_buf)) == 20)
+        // SA2/SP2
+        if (IPS_SET(cfg, 1))
         {
             // Check for duplicate with SA1
             if (BUFFER_EQUAL_20(savings_accounts[1], savings_accounts[0]))
@@ -166,18 +165,15 @@ int64_t hook(uint32_t reserved)
                 WARN("SA2 cannot match SA1");
             }
 
-            UINT64_TO_BUF(key_buf, SP2_KEY);
-            uint8_t sp_data[4];
-            if (state(SBUF(sp_data), SBUF(key_buf)) == 4)
-                savings_percentages[1] = UINT32_FROM_BUF(sp_data);
+            if (IPS_SET(cfg, 4))
+                savings_percentages[1] = UINT32_FROM_BUF(cfg + IPS_CFG_SP + 4);
             else
                 WARN("SP2 missing for multiple accounts");
             configured_accounts++;
         }
 
-        // Load SA3/SP3
-        UINT64_TO_BUF(key_buf, SA3_KEY);
-        if (state(SBUF(savings_accounts[2]), SBUF(key_buf)) == 20)
+        // SA3/SP3
+        if (IPS_SET(cfg, 2))
         {
             // Check for duplicates with SA1 and SA2
             if (BUFFER_EQUAL_20(savings_accounts[2], savings_accounts[0]) ||
@@ -189,10 +185,8 @@ int64_t hook(uint32_t reserved)
                 WARN("SA3 cannot match SA1 or SA2");
             }
 
-            UINT64_TO_BUF(key_buf, SP3_KEY);
-            uint8_t sp_data[4];
-            if (state(SBUF(sp_data), SBUF(key_buf)) == 4)
-                savings_percentages[2] = UINT32_FROM_BUF(sp_data);
+            if (IPS_SET(cfg, 5))
+                savings_percentages[2] = UINT32_FROM_BUF(cfg + IPS_CFG_SP + 8);
             else
                 WARN("SP3 missing for multiple accounts");
             configured_accounts++;
@@ -18,7 +18,9 @@
 //   'AUTO_RELEASE' (4 bytes): Automatic release percentage per interval (0-100%).
 //   'RELEASE' (4 bytes): Manual release percentage for milestones (1-100%).
 //   'STATUS' (1 byte): Query current locked, available, and spent balances.
-//   'UNLOCK' (4 bytes): Emergency unlock code (0xDEADBEEF) - all funds available.
+//   'UNLOCK' (1 byte): Toggle emergency unlock - all funds available.
+//   One invoke may carry several of these; all of them are applied. An
+//   unknown parameter or a value of the wrong size rejects the invoke.
 //
 // Core Functionality:
 //   - All incoming payments automatically locked in escrow (cannot be disabled)
@@ -40,12 +42,26 @@
 //   4. Parent releases funds via intervals or manual milestones
 //   5. Child can only spend released (available) balance
 //
+// Storage Structure:
+//   - Settings: one record under "HOOKCONF" (Common/ConfigRecord.h), layout 1:
+//     { version:1, flags:1, interval:4, auto-release percent:4 }
+//     Without it the settings are read from the "AUTOLOCK", "INTERVAL"
+//     and "UNLOCK" keys used before it, until an invoke changes one.
+//   - Balances: "LOCKED", "AVAIL", "SPENT" (8 bytes each, drops)
+//   - Last release: "LASTRELE" (4 bytes, ledger sequence)
+//
 //**************************************************************
 
 #include "hookapi.h"
+#include "../../Common/BuildProfile.h"
+#include "../../Common/ParamDispatch.h"
+#include "../../Common/ConfigRecord.h"
+#include "../../Common/StateKey.h"
+#include "../../Common/ResultCode.h"
 
-#define DONE(x) accept(SBUF(x), __LINE__)
-#define NOPE(x) rollback(SBUF(x), __LINE__)
+#define HOOK_RESULT_ID RC_SAVINGSMANAGER
+#define DONE(x) RESULT_ACCEPT(x)
+#define NOPE(x) RESULT_ROLLBACK(x)
 
 // Macro to convert XRP Amount buffer to drops (for native XAH)
 #define AMOUNT_TO_DROPS(buf) \
@@ -63,14 +79,36 @@
     })
 
 // State keys
-#define ADMIN_KEY       0x41444D494E000000ULL  // "ADMIN"
-#define LOCKED_KEY      0x4C4F434B45440000ULL  // "LOCKED"  
-#define AVAILABLE_KEY   0x415641494C000000ULL  // "AVAIL"
-#define AUTO_LOCK_KEY   0x4155544F4C4F434BULL  // "AUTOLCK"
-#define INTERVAL_KEY    0x494E54455256414CULL  // "INTERVAL"
-#define LAST_RELEASE_KEY 0x4C41535452454C45ULL // "LASTRELE"
-#define SPENT_KEY       0x5350454E54000000ULL  // "SPENT"
-#define UNLOCK_KEY      0x554E4C4F434B0000ULL  // "UNLOCK" (correct: 8 bytes)
+#define ADMIN_KEY       SKEY_PAD("ADMIN", 8)
+#define LOCKED_KEY      SKEY_PAD("LOCKED", 8)
+#define AVAILABLE_KEY   SKEY_PAD("AVAIL", 8)
+#define LAST_RELEASE_KEY SKEY_PAD("LASTRELE", 8)
+#define SPENT_KEY       SKEY_PAD("SPENT", 8)
+
+// Settings record offsets; the interval counts only once its flag is set
+#define SM_CFG_VERSION 1
+#define SM_CFG_FLAGS 1
+#define SM_CFG_INTERVAL 2
+#define SM_CFG_AUTO_RELEASE 6
+#define SM_CFG_SIZE 10
+
+#define SM_FLAG_INTERVAL 0x01U
+#define SM_FLAG_UNLOCKED 0x02U
+
+// Release interval in ledgers, 17280 (about 24 hours) until one is set
+#define SM_INTERVAL(cfg) \
+    (((cfg)[SM_CFG_FLAGS] & SM_FLAG_INTERVAL) ? UINT32_FROM_BUF((cfg) + SM_CFG_INTERVAL) : 17280U)
+
+// Invoke commands, in PARAM_COLLECT table order, and their sizes
+static const uint8_t sm_commands[][PARAM_NAME_SIZE] = {
+    "LOCK", "AUTO_RELEASE", "SET_INTERVAL", "RELEASE", "STATUS", "UNLOCK"};
+static const int sm_command_sizes[] = {1, 4, 4, 4, 1, 1};
+#define CMD_LOCK 0
+#define CMD_AUTO_RELEASE 1
+#define CMD_SET_INTERVAL 2
+#define CMD_RELEASE 3
+#define CMD_STATUS 4
+#define CMD_UNLOCK 5
 
 int64_t hook(uint32_t reserved)
 {
@@ -83,12 +121,37 @@ int64_t hook(uint32_t reserved)
 
     int64_t tt = otxn_type();
 
+    // The record, or while an upgraded install has none, the keys it
+    // replaced: AUTOLOCK and INTERVAL (4 bytes), UNLOCK (1 byte)
+    uint8_t cfg[SM_CFG_SIZE] = {0};
+    if (!CFG_LOAD(cfg, SM_CFG_SIZE)) {
+        CFG_LEGACY(cfg + SM_CFG_AUTO_RELEASE, 4, SKEY_PAD("AUTOLOCK", 8));
+        if (CFG_LEGACY(cfg + SM_CFG_INTERVAL, 4, SKEY_PAD("INTERVAL", 8)))
+            cfg[SM_CFG_FLAGS] |= SM_FLAG_INTERVAL;
+        uint8_t unlocked = 0;
+        if (CFG_LEGACY(&unlocked, 1, SKEY_PAD("UNLOCK", 8)) && unlocked == 1)
+            cfg[SM_CFG_FLAGS] |= SM_FLAG_UNLOCKED;
+    }
+    int cfg_dirty = 0;
+
     // Handle ttINVOKE for admin configuration
     if (tt == ttINVOKE)
     {
+        // Read every command the invoke carries in one pass; they are
+        // applied below in this order, several per invoke if need be
+        uint8_t* sm_values[PARAM_COMMANDS(sm_commands)];
+        int sm_lens[PARAM_COMMANDS(sm_commands)];
+        int rejected;
+        PARAM_COLLECT(sm_commands, sm_values, sm_lens, rejected);
+        if (rejected)
+            NOPE("Unknown or malformed HookParameter");
+        for (int c = 0; GUARD(6), c < 6; ++c)
+            if (sm_lens[c] >= 0 && sm_lens[c] != sm_command_sizes[c])
+                NOPE("HookParameter has the wrong size");
+        int applied = 0;
+
          // LOCK toggle - From Admin Hook Locker, pass through without processing
-        uint8_t lock_param[1];
-        if (otxn_param(SBUF(lock_param), "LOCK", 4) == 1)
+        if (sm_lens[CMD_LOCK] == 1)
         {
             // Early exit: If LOCK param exists, it's for the Admin Hook Locker (first hook)
             // Pass it through without processing - Savings Manager doesn't use LOCK toggle
@@ -105,52 +168,44 @@ int64_t hook(uint32_t reserved)
             NOPE("Only admin can configure");
 
         // Set AUTO_RELEASE percentage for interval releases
-        uint8_t auto_release_param[4];
-        if (otxn_param(SBUF(auto_release_param), "AUTO_RELEASE", 12) == 4)
+        if (sm_lens[CMD_AUTO_RELEASE] == 4)
         {
+            uint8_t* auto_release_param = sm_values[CMD_AUTO_RELEASE];
             uint32_t auto_percent = UINT32_FROM_BUF(auto_release_param);
             if (auto_percent > 100)
                 NOPE("AUTO_RELEASE percentage must be 0-100");
-            
-            uint8_t auto_lock_key_buf[8];
-            UINT64_TO_BUF(auto_lock_key_buf, AUTO_LOCK_KEY);
-            state_set(SBUF(auto_release_param), SBUF(auto_lock_key_buf));
-            DONE("Auto-release percentage configured");
+
+            UINT32_TO_BUF(cfg + SM_CFG_AUTO_RELEASE, auto_percent);
+            cfg_dirty = 1;
+            TRACESTR("Auto-release percentage configured");
+            applied++;
         }
 
         // Set release interval
-        uint8_t interval_param[4];
-        if (otxn_param(SBUF(interval_param), "SET_INTERVAL", 12) == 4)
+        if (sm_lens[CMD_SET_INTERVAL] == 4)
         {
-            uint8_t interval_key_buf[8];
-            UINT64_TO_BUF(interval_key_buf, INTERVAL_KEY);
-            state_set(SBUF(interval_param), SBUF(interval_key_buf));
-            DONE("Release interval configured");
+            uint32_t interval = UINT32_FROM_BUF(sm_values[CMD_SET_INTERVAL]);
+            UINT32_TO_BUF(cfg + SM_CFG_INTERVAL, interval);
+            cfg[SM_CFG_FLAGS] |= SM_FLAG_INTERVAL;
+            cfg_dirty = 1;
+            TRACESTR("Release interval configured");
+            applied++;
         }
 
         // Manual RELEASE parameter (percentage to release)
-        uint8_t release_param[4];
-        if (otxn_param(SBUF(release_param), "RELEASE", 7) == 4)
+        if (sm_lens[CMD_RELEASE] == 4)
         {
-            uint32_t release_percent = UINT32_FROM_BUF(release_param);
+            uint32_t release_percent = UINT32_FROM_BUF(sm_values[CMD_RELEASE]);
             if (release_percent == 0 || release_percent > 100)
                 NOPE("Release percentage must be 1-100");
 
             // Check release interval timing (prevent spam)
             uint32_t current_ledger = (uint32_t)ledger_seq();
-            uint32_t release_interval = 17280; // Default 24 hours
-            
-            uint8_t interval_key_buf[8];
-            UINT64_TO_BUF(interval_key_buf, INTERVAL_KEY);
-            uint8_t interval_data[4];
-            if (state(SBUF(interval_data), SBUF(interval_key_buf)) == 4)
-                release_interval = UINT32_FROM_BUF(interval_data);
-
-            uint8_t last_release_key_buf[8];
-            UINT64_TO_BUF(last_release_key_buf, LAST_RELEASE_KEY);
+            uint32_t release_interval = SM_INTERVAL(cfg);
+
             uint8_t last_release_data[4];
             uint32_t last_release_ledger = 0;
-            if (state(SBUF(last_release_data), SBUF(last_release_key_buf)) == 4)
+            if (state(SBUF(last_release_data), LAST_RELEASE_KEY) == 4)
                 last_release_ledger = UINT32_FROM_BUF(last_release_data);
 
             if (last_release_ledger > 0)
@@ -161,11 +216,9 @@ int64_t hook(uint32_t reserved)
             }
 
             // Get current locked amount
-            uint8_t locked_key_buf[8];
-            UINT64_TO_BUF(locked_key_buf, LOCKED_KEY);
             uint8_t locked_data[8];
             uint64_t locked_amount = 0;
-            if (state(SBUF(locked_data), SBUF(locked_key_buf)) == 8)
+            if (state(SBUF(locked_data), LOCKED_KEY) == 8)
                 locked_amount = UINT64_FROM_BUF(locked_data);
 
             if (locked_amount == 0)
@@ -177,47 +230,41 @@ int64_t hook(uint32_t reserved)
 
             // Update locked amount
             UINT64_TO_BUF(locked_data, new_locked);
-            state_set(SBUF(locked_data), SBUF(locked_key_buf));
+            state_set(SBUF(locked_data), LOCKED_KEY);
 
             // Get current available amount
-            uint8_t avail_key_buf[8];
-            UINT64_TO_BUF(avail_key_buf, AVAILABLE_KEY);
             uint8_t avail_data[8];
             uint64_t available_amount = 0;
-            if (state(SBUF(avail_data), SBUF(avail_key_buf)) == 8)
+            if (state(SBUF(avail_data), AVAILABLE_KEY) == 8)
                 available_amount = UINT64_FROM_BUF(avail_data);
 
             // Add to available amount
             available_amount += release_amount;
             UINT64_TO_BUF(avail_data, available_amount);
-            state_set(SBUF(avail_data), SBUF(avail_key_buf));
+            state_set(SBUF(avail_data), AVAILABLE_KEY);
 
             // Update last release time
             UINT64_TO_BUF(last_release_data, current_ledger);
-            state_set(SBUF(last_release_data), SBUF(last_release_key_buf));
+            state_set(SBUF(last_release_data), LAST_RELEASE_KEY);
 
             // Convert drops to XAH for display (amounts are stored as drops)
             int64_t release_xah = release_amount / 1000000;
             TRACEVAR(release_percent);
             TRACEVAR(release_xah);
-            DONE("Funds released to available balance");
+            TRACESTR("Funds released to available balance");
+            applied++;
         }
 
         // STATUS query - return account balance information
-        uint8_t status_param[1];
-        if (otxn_param(SBUF(status_param), "STATUS", 6) == 1)
+        if (sm_lens[CMD_STATUS] == 1)
         {
             // Get current balances
-            uint8_t locked_key_buf[8], avail_key_buf[8];
-            UINT64_TO_BUF(locked_key_buf, LOCKED_KEY);
-            UINT64_TO_BUF(avail_key_buf, AVAILABLE_KEY);
-
             uint8_t locked_data[8], avail_data[8];
             uint64_t locked_amount = 0, available_amount = 0;
             
-            if (state(SBUF(locked_data), SBUF(locked_key_buf)) == 8)
+            if (state(SBUF(locked_data), LOCKED_KEY) == 8)
                 locked_amount = UINT64_FROM_BUF(locked_data);
-            if (state(SBUF(avail_data), SBUF(avail_key_buf)) == 8)
+            if (state(SBUF(avail_data), AVAILABLE_KEY) == 8)
                 available_amount = UINT64_FROM_BUF(avail_data);
 
             // Convert drops to XAH for display (amounts are stored as drops)
@@ -228,70 +275,61 @@ int64_t hook(uint32_t reserved)
             TRACEVAR(locked_xah);
             TRACEVAR(available_xah);
             TRACEVAR(total_xah);
-            DONE("Status query completed");
+            TRACESTR("Status query completed");
+            applied++;
         }
 
         // UNLOCK toggle - permanently changes escrow behavior
-        uint8_t unlock_param[1];
-        if (otxn_param(SBUF(unlock_param), "UNLOCK", 6) == 1)
+        if (sm_lens[CMD_UNLOCK] == 1)
         {
-            uint8_t unlock_key_buf[8];
-            UINT64_TO_BUF(unlock_key_buf, UNLOCK_KEY);
-            
-            // Read current unlock state
-            uint8_t unlock_state[1];
-            int32_t state_len = state(SBUF(unlock_state), SBUF(unlock_key_buf));
-            
-            uint8_t new_state[1];
-            if (state_len == 1 && unlock_state[0] == 1)
+            cfg_dirty = 1;
+            if (cfg[SM_CFG_FLAGS] & SM_FLAG_UNLOCKED)
             {
                 // Unlock is ON, toggle it OFF
-                new_state[0] = 0;
-                state_set(SBUF(new_state), SBUF(unlock_key_buf));
-                DONE("Lock re-enabled - incoming funds will be locked again");
+                cfg[SM_CFG_FLAGS] &= ~SM_FLAG_UNLOCKED;
+                TRACESTR("Lock re-enabled - incoming funds will be locked again");
             }
             else
             {
                 // Unlock is OFF, toggle it ON - move all locked to available
-                new_state[0] = 1;
-                state_set(SBUF(new_state), SBUF(unlock_key_buf));
+                cfg[SM_CFG_FLAGS] |= SM_FLAG_UNLOCKED;
                 
                 // Move all locked funds to available
-                uint8_t locked_key_buf[8];
-                uint8_t avail_key_buf[8];
-                UINT64_TO_BUF(locked_key_buf, LOCKED_KEY);
-                UINT64_TO_BUF(avail_key_buf, AVAILABLE_KEY);
-                
                 uint8_t locked_data[8];
                 uint64_t locked_amount = 0;
-                if (state(SBUF(locked_data), SBUF(locked_key_buf)) == 8)
+                if (state(SBUF(locked_data), LOCKED_KEY) == 8)
                     locked_amount = UINT64_FROM_BUF(locked_data);
                 
                 if (locked_amount > 0)
                 {
                     uint8_t avail_data[8];
                     uint64_t available_amount = 0;
-                    if (state(SBUF(avail_data), SBUF(avail_key_buf)) == 8)
+                    if (state(SBUF(avail_data), AVAILABLE_KEY) == 8)
                         available_amount = UINT64_FROM_BUF(avail_data);
                     
                     // Move all locked to available
                     available_amount += locked_amount;
                     UINT64_TO_BUF(avail_data, available_amount);
-                    state_set(SBUF(avail_data), SBUF(avail_key_buf));
+                    state_set(SBUF(avail_data), AVAILABLE_KEY);
                     
                     // Clear locked amount
                     UINT64_TO_BUF(locked_data, 0);
-                    state_set(SBUF(locked_data), SBUF(locked_key_buf));
+                    state_set(SBUF(locked_data), LOCKED_KEY);
                     
                     int64_t unlocked_xah = locked_amount / 1000000;
                     TRACEVAR(unlocked_xah);
                 }
 
-                DONE("Lock disabled - all funds unlocked and available for spending");
+                TRACESTR("Lock disabled - all funds unlocked and available for spending");
             }
+            applied++;
         }
 
-        NOPE("No valid parameters");
+        if (!applied)
+            NOPE("No valid parameters");
+        if (cfg_dirty && CFG_SAVE(cfg, SM_CFG_SIZE, SM_CFG_VERSION) < 0)
+            NOPE("Failed to store settings");
+        DONE("Admin invoke applied");
     }
 
     // Control outgoing transactions from hook account (child spending)
@@ -307,50 +345,33 @@ int64_t hook(uint32_t reserved)
                 int64_t payment_drops = AMOUNT_TO_DROPS(amount);
                 
                 // Get current available balance
-                uint8_t avail_key_buf[8];
-                UINT64_TO_BUF(avail_key_buf, AVAILABLE_KEY);
                 uint8_t avail_data[8];
                 uint64_t available_amount = 0;
-                if (state(SBUF(avail_data), SBUF(avail_key_buf)) == 8)
+                if (state(SBUF(avail_data), AVAILABLE_KEY) == 8)
                     available_amount = UINT64_FROM_BUF(avail_data);
                 
                 // CHECK FOR AUTO-RELEASE FIRST (before payment validation)
                 uint32_t current_ledger = (uint32_t)ledger_seq();
-                uint32_t release_interval = 17280; // Default 24 hours
-                
-                // Get configured release interval
-                uint8_t interval_key_buf[8];
-                UINT64_TO_BUF(interval_key_buf, INTERVAL_KEY);
-                uint8_t interval_data[4];
-                if (state(SBUF(interval_data), SBUF(interval_key_buf)) == 4)
-                    release_interval = UINT32_FROM_BUF(interval_data);
+                uint32_t release_interval = SM_INTERVAL(cfg);
 
                 // Get last release timestamp
-                uint8_t last_release_key_buf[8];
-                UINT64_TO_BUF(last_release_key_buf, LAST_RELEASE_KEY);
                 uint8_t last_release_data[4];
                 uint32_t last_release_ledger = 0;
-                if (state(SBUF(last_release_data), SBUF(last_release_key_buf)) == 4)
+                if (state(SBUF(last_release_data), LAST_RELEASE_KEY) == 4)
                     last_release_ledger = UINT32_FROM_BUF(last_release_data);
 
                 // Auto-release if interval has passed and auto-release percentage is set
                 if (release_interval > 0 && (current_ledger - last_release_ledger) >= release_interval)
                 {
-                    // Get auto-release percentage
-                    uint8_t auto_lock_key_buf[8];
-                    UINT64_TO_BUF(auto_lock_key_buf, AUTO_LOCK_KEY);
-                    uint8_t auto_release_data[4];
-                    if (state(SBUF(auto_release_data), SBUF(auto_lock_key_buf)) == 4)
+                    // Auto-release percentage, 0 until one is set
                     {
-                        uint32_t auto_percent = UINT32_FROM_BUF(auto_release_data);
+                        uint32_t auto_percent = UINT32_FROM_BUF(cfg + SM_CFG_AUTO_RELEASE);
                         if (auto_percent > 0)
                         {
                             // Get current locked amount
-                            uint8_t locked_key_buf[8];
-                            UINT64_TO_BUF(locked_key_buf, LOCKED_KEY);
                             uint8_t locked_data[8];
                             uint64_t locked_amount = 0;
-                            if (state(SBUF(locked_data), SBUF(locked_key_buf)) == 8)
+                            if (state(SBUF(locked_data), LOCKED_KEY) == 8)
                                 locked_amount = UINT64_FROM_BUF(locked_data);
                             
                             if (locked_amount > 0)
@@ -361,16 +382,16 @@ int64_t hook(uint32_t reserved)
                                 // Move from locked to available
                                 locked_amount -= auto_release_amount;
                                 UINT64_TO_BUF(locked_data, locked_amount);
-                                state_set(SBUF(locked_data), SBUF(locked_key_buf));
+                                state_set(SBUF(locked_data), LOCKED_KEY);
                                 
                                 // Update available balance
                                 available_amount += auto_release_amount;
                                 UINT64_TO_BUF(avail_data, available_amount);
-                                state_set(SBUF(avail_data), SBUF(avail_key_buf));
+                                state_set(SBUF(avail_data), AVAILABLE_KEY);
                                 
                                 // Update last release timestamp
                                 UINT32_TO_BUF(last_release_data, current_ledger);
-                                state_set(SBUF(last_release_data), SBUF(last_release_key_buf));
+                                state_set(SBUF(last_release_data), LAST_RELEASE_KEY);
                                 
                                 // Convert drops to XAH for display
                                 int64_t released_xah = auto_release_amount / 1000000;
@@ -395,19 +416,17 @@ int64_t hook(uint32_t reserved)
                 // Payment approved - deduct from available balance
                 available_amount -= payment_drops;
                 UINT64_TO_BUF(avail_data, available_amount);
-                state_set(SBUF(avail_data), SBUF(avail_key_buf));
+                state_set(SBUF(avail_data), AVAILABLE_KEY);
                 
                 // Update total spent tracking
-                uint8_t spent_key_buf[8];
-                UINT64_TO_BUF(spent_key_buf, SPENT_KEY);
                 uint8_t spent_data[8];
                 uint64_t total_spent = 0;
-                if (state(SBUF(spent_data), SBUF(spent_key_buf)) == 8)
+                if (state(SBUF(spent_data), SPENT_KEY) == 8)
                     total_spent = UINT64_FROM_BUF(spent_data);
                 
                 total_spent += payment_drops;
                 UINT64_TO_BUF(spent_data, total_spent);
-                state_set(SBUF(spent_data), SBUF(spent_key_buf));
+                state_set(SBUF(spent_data), SPENT_KEY);
                 
                 int64_t payment_xah = payment_drops / 1000000;
                 int64_t available_xah = available_amount / 1000000;
@@ -426,12 +445,7 @@ int64_t hook(uint32_t reserved)
             DONE("Non-native currency");
 
         // Check if escrow is disabled via UNLOCK toggle
-        uint8_t unlock_key_buf[8];
-        UINT64_TO_BUF(unlock_key_buf, UNLOCK_KEY);
-        uint8_t unlock_state[1];
-        int32_t unlock_len = state(SBUF(unlock_state), SBUF(unlock_key_buf));
-        
-        int32_t escrow_disabled = (unlock_len == 1 && unlock_state[0] == 1);
+        int32_t escrow_disabled = (cfg[SM_CFG_FLAGS] & SM_FLAG_UNLOCKED) != 0;
         
         // Convert XAH amount to drops using proper macro
         int64_t incoming_drops = AMOUNT_TO_DROPS(amount);
@@ -442,16 +456,14 @@ int64_t hook(uint32_t reserved)
         if (escrow_disabled)
         {
             // Escrow OFF: Move directly to available (no locking)
-            uint8_t avail_key_buf[8];
-            UINT64_TO_BUF(avail_key_buf, AVAILABLE_KEY);
             uint8_t avail_data[8];
             uint64_t available_amount = 0;
-            if (state(SBUF(avail_data), SBUF(avail_key_buf)) == 8)
+            if (state(SBUF(avail_data), AVAILABLE_KEY) == 8)
                 available_amount = UINT64_FROM_BUF(avail_data);
             
             available_amount += incoming_drops;
             UINT64_TO_BUF(avail_data, available_amount);
-            state_set(SBUF(avail_data), SBUF(avail_key_buf));
+            state_set(SBUF(avail_data), AVAILABLE_KEY);
             
             DONE("Payment accepted directly to available balance (Lock disabled)");
         }
@@ -459,43 +471,29 @@ int64_t hook(uint32_t reserved)
         {
             // Escrow ON: Lock all incoming (original behavior)
             // Always lock incoming payments - core escrow functionality
-            uint8_t locked_key_buf[8];
-            UINT64_TO_BUF(locked_key_buf, LOCKED_KEY);
             uint8_t locked_data[8];
             uint64_t locked_amount = 0;
-            if (state(SBUF(locked_data), SBUF(locked_key_buf)) == 8)
+            if (state(SBUF(locked_data), LOCKED_KEY) == 8)
                 locked_amount = UINT64_FROM_BUF(locked_data);
 
             locked_amount += incoming_drops;
             UINT64_TO_BUF(locked_data, locked_amount);
-            state_set(SBUF(locked_data), SBUF(locked_key_buf));
+            state_set(SBUF(locked_data), LOCKED_KEY);
 
             // Check for automatic interval-based release
             uint32_t current_ledger = (uint32_t)ledger_seq();
-            uint32_t release_interval = 17280; // Default 24 hours
-            
-            uint8_t interval_key_buf[8];
-            UINT64_TO_BUF(interval_key_buf, INTERVAL_KEY);
-            uint8_t interval_data[4];
-            if (state(SBUF(interval_data), SBUF(interval_key_buf)) == 4)
-                release_interval = UINT32_FROM_BUF(interval_data);
-
-            uint8_t last_release_key_buf[8];
-            UINT64_TO_BUF(last_release_key_buf, LAST_RELEASE_KEY);
+            uint32_t release_interval = SM_INTERVAL(cfg);
+
             uint8_t last_release_data[4];
             uint32_t last_release_ledger = 0;
-            if (state(SBUF(last_release_data), SBUF(last_release_key_buf)) == 4)
+            if (state(SBUF(last_release_data), LAST_RELEASE_KEY) == 4)
                 last_release_ledger = UINT32_FROM_BUF(last_release_data);
 
             // Auto-release if interval has passed and auto-release percentage is set
             if (release_interval > 0 && (current_ledger - last_release_ledger) >= release_interval)
             {
-                uint8_t auto_lock_key_buf[8];
-                UINT64_TO_BUF(auto_lock_key_buf, AUTO_LOCK_KEY);
-                uint8_t auto_release_data[4];
-                if (state(SBUF(auto_release_data), SBUF(auto_lock_key_buf)) == 4)
                 {
-                    uint32_t auto_percent = UINT32_FROM_BUF(auto_release_data);
+                    uint32_t auto_percent = UINT32_FROM_BUF(cfg + SM_CFG_AUTO_RELEASE);
                     if (auto_percent > 0)
                     {
                         // Calculate auto-release amount
@@ -504,22 +502,20 @@ int64_t hook(uint32_t reserved)
                         // Move from locked to available
                         locked_amount -= auto_release_amount;
                         UINT64_TO_BUF(locked_data, locked_amount);
-                        state_set(SBUF(locked_data), SBUF(locked_key_buf));
+                        state_set(SBUF(locked_data), LOCKED_KEY);
                         
-                        uint8_t avail_key_buf[8];
-                        UINT64_TO_BUF(avail_key_buf, AVAILABLE_KEY);
                         uint8_t avail_data[8];
                         uint64_t available_amount = 0;
-                        if (state(SBUF(avail_data), SBUF(avail_key_buf)) == 8)
+                        if (state(SBUF(avail_data), AVAILABLE_KEY) == 8)
                             available_amount = UINT64_FROM_BUF(avail_data);
                         
                         available_amount += auto_release_amount;
                         UINT64_TO_BUF(avail_data, available_amount);
-                        state_set(SBUF(avail_data), SBUF(avail_key_buf));
+                        state_set(SBUF(avail_data), AVAILABLE_KEY);
                         
                         // Update last release timestamp
                         UINT32_TO_BUF(last_release_data, current_ledger);
-                        state_set(SBUF(last_release_data), SBUF(last_release_key_buf));
+                        state_set(SBUF(last_release_data), LAST_RELEASE_KEY);
                         
                         // Convert drops to XAH for display (amounts are stored as drops)
                         int64_t released_xah = auto_release_amount / 1000000;
@@ -0,0 +1,359 @@
+//**************************************************************
+// Hook API helper macros - HandyHooks native harness
+//
+// Buffer, trace, transaction-type and serialisation helpers with the
+// names and sizes of the hooks-c SDK. Emitted-txn templates built here
+// assume a hook without a cbak export, so etxn_details writes 116 bytes.
+//**************************************************************
+
+#ifndef HOOKMACROS_INCLUDED
+#define HOOKMACROS_INCLUDED 1
+
+#define SBUF(str) (uint32_t)(str), sizeof(str)
+
+#define GUARD(maxiter) _g((1ULL << 31U) + __LINE__, (maxiter)+1)
+#define GUARDM(maxiter, n) _g(((1ULL << 31U) + (__LINE__ << 16) + n), (maxiter)+1)
+
+#define TRACEVAR(v) trace_num((uint32_t)(#v), (uint32_t)(sizeof(#v) - 1), (int64_t)v);
+#define TRACEHEX(v) trace((uint32_t)(#v), (uint32_t)(sizeof(#v) - 1), (uint32_t)(v), (uint32_t)(sizeof(v)), 1);
+#define TRACEXFL(v) trace_float((uint32_t)(#v), (uint32_t)(sizeof(#v) - 1), (int64_t)v);
+#define TRACESTR(v) trace((uint32_t)(#v), (uint32_t)(sizeof(#v) - 1), (uint32_t)(v), sizeof(v), 0);
+
+#define CLEARBUF(b)                                 \
+    {                                               \
+        for (int x = 0; GUARD(sizeof(b)), x < sizeof(b); ++x) \
+            b[x] = 0;                               \
+    }
+
+#define BUFFER_EQUAL_20(buf1, buf2)                                     \
+    (*(((uint64_t*)(buf1)) + 0) == *(((uint64_t*)(buf2)) + 0) &&        \
+     *(((uint64_t*)(buf1)) + 1) == *(((uint64_t*)(buf2)) + 1) &&        \
+     *(((uint32_t*)(buf1)) + 4) == *(((uint32_t*)(buf2)) + 4))
+
+#define BUFFER_EQUAL_32(buf1, buf2)                                     \
+    (*(((uint64_t*)(buf1)) + 0) == *(((uint64_t*)(buf2)) + 0) &&        \
+     *(((uint64_t*)(buf1)) + 1) == *(((uint64_t*)(buf2)) + 1) &&        \
+     *(((uint64_t*)(buf1)) + 2) == *(((uint64_t*)(buf2)) + 2) &&        \
+     *(((uint64_t*)(buf1)) + 3) == *(((uint64_t*)(buf2)) + 3))
+
+// output = 1 if the first compare_len bytes match, 0 otherwise
+#define BUFFER_EQUAL(output, buf1, buf2, compare_len)                   \
+    {                                                                   \
+        output = ((compare_len) != 0);                                  \
+        for (int x = 0; GUARD(compare_len), output && x < (compare_len); ++x) \
+            output = (buf1)[x] == (buf2)[x];                            \
+    }
+
+#define BUFFER_SWAP(x, y) \
+    {                     \
+        uint8_t* z = x;   \
+        x = y;            \
+        y = z;            \
+    }
+
+#define ACCOUNT_TO_BUF(buf_raw, i)                          \
+    {                                                       \
+        unsigned char* buf = (unsigned char*)buf_raw;       \
+        *(uint64_t*)(buf + 0) = *(uint64_t*)(i + 0);        \
+        *(uint64_t*)(buf + 8) = *(uint64_t*)(i + 8);        \
+        *(uint32_t*)(buf + 16) = *(uint32_t*)(i + 16);      \
+    }
+
+#define UINT16_TO_BUF(buf_raw, i)                           \
+    {                                                       \
+        unsigned char* buf = (unsigned char*)buf_raw;       \
+        buf[0] = (((uint64_t)i) >> 8) & 0xFFUL;             \
+        buf[1] = (((uint64_t)i) >> 0) & 0xFFUL;             \
+    }
+
+#define UINT16_FROM_BUF(buf) \
+    (((uint64_t)((buf)[0]) << 8) + ((uint64_t)((buf)[1]) << 0))
+
+#define UINT32_TO_BUF(buf_raw, i)                           \
+    {                                                       \
+        unsigned char* buf = (unsigned char*)buf_raw;       \
+        buf[0] = (((uint64_t)i) >> 24) & 0xFFUL;            \
+        buf[1] = (((uint64_t)i) >> 16) & 0xFFUL;            \
+        buf[2] = (((uint64_t)i) >> 8) & 0xFFUL;             \
+        buf[3] = (((uint64_t)i) >> 0) & 0xFFUL;             \
+    }
+
+#define UINT32_FROM_BUF(buf)                                \
+    (((uint64_t)((buf)[0]) << 24) + ((uint64_t)((buf)[1]) << 16) + \
+     ((uint64_t)((buf)[2]) << 8) + ((uint64_t)((buf)[3]) << 0))
+
+#define UINT64_TO_BUF(buf_raw, i)                           \
+    {                                                       \
+        unsigned char* buf = (unsigned char*)buf_raw;       \
+        buf[0] = (((uint64_t)i) >> 56) & 0xFFUL;            \
+        buf[1] = (((uint64_t)i) >> 48) & 0xFFUL;            \
+        buf[2] = (((uint64_t)i) >> 40) & 0xFFUL;            \
+        buf[3] = (((uint64_t)i) >> 32) & 0xFFUL;            \
+        buf[4] = (((uint64_t)i) >> 24) & 0xFFUL;            \
+        buf[5] = (((uint64_t)i) >> 16) & 0xFFUL;            \
+        buf[6] = (((uint64_t)i) >> 8) & 0xFFUL;             \
+        buf[7] = (((uint64_t)i) >> 0) & 0xFFUL;             \
+    }
+
+#define UINT64_FROM_BUF(buf)                                \
+    (((uint64_t)((buf)[0]) << 56) + ((uint64_t)((buf)[1]) << 48) + \
+     ((uint64_t)((buf)[2]) << 40) + ((uint64_t)((buf)[3]) << 32) + \
+     ((uint64_t)((buf)[4]) << 24) + ((uint64_t)((buf)[5]) << 16) + \
+     ((uint64_t)((buf)[6]) << 8) + ((uint64_t)((buf)[7]) << 0))
+
+// sign-magnitude: the top bit of the buffer is the sign
+#define INT64_FROM_BUF(buf)                                 \
+    ((((uint64_t)((buf)[0] & 0x7FU) << 56) + ((uint64_t)((buf)[1]) << 48) + \
+      ((uint64_t)((buf)[2]) << 40) + ((uint64_t)((buf)[3]) << 32) + \
+      ((uint64_t)((buf)[4]) << 24) + ((uint64_t)((buf)[5]) << 16) + \
+      ((uint64_t)((buf)[6]) << 8) + ((uint64_t)((buf)[7]) << 0)) * \
+     (((buf)[0] & 0x80U) ? -1 : 1))
+
+#define INT64_TO_BUF(buf_raw, i)                            \
+    {                                                       \
+        unsigned char* buf = (unsigned char*)buf_raw;       \
+        uint64_t ui = (i) < 0 ? -(i) : (i);                 \
+        UINT64_TO_BUF(buf, ui);                             \
+        if ((i) < 0)                                        \
+            buf[0] |= 0x80U;                                \
+    }
+
+// Native amount (8 bytes) to drops, -2 for an IOU amount
+#define AMOUNT_TO_DROPS(amount_buffer)                      \
+    (((amount_buffer)[0] >> 7) ? -2 :                       \
+     ((((uint64_t)((amount_buffer)[0]) & 0x3FU) << 56) +    \
+      (((uint64_t)((amount_buffer)[1])) << 48) +            \
+      (((uint64_t)((amount_buffer)[2])) << 40) +            \
+      (((uint64_t)((amount_buffer)[3])) << 32) +            \
+      (((uint64_t)((amount_buffer)[4])) << 24) +            \
+      (((uint64_t)((amount_buffer)[5])) << 16) +            \
+      (((uint64_t)((amount_buffer)[6])) << 8) +             \
+      (((uint64_t)((amount_buffer)[7])) << 0)))
+
+#define ttPAYMENT 0
+#define ttESCROW_CREATE 1
+#define ttESCROW_FINISH 2
+#define ttACCOUNT_SET 3
+#define ttESCROW_CANCEL 4
+#define ttREGULAR_KEY_SET 5
+#define ttOFFER_CREATE 7
+#define ttOFFER_CANCEL 8
+#define ttTICKET_CREATE 10
+#define ttSIGNER_LIST_SET 12
+#define ttPAYCHAN_CREATE 13
+#define ttPAYCHAN_FUND 14
+#define ttPAYCHAN_CLAIM 15
+#define ttCHECK_CREATE 16
+#define ttCHECK_CASH 17
+#define ttCHECK_CANCEL 18
+#define ttDEPOSIT_PREAUTH 19
+#define ttTRUST_SET 20
+#define ttACCOUNT_DELETE 21
+#define ttHOOK_SET 22
+#define ttURITOKEN_MINT 45
+#define ttURITOKEN_BURN 46
+#define ttURITOKEN_BUY 47
+#define ttURITOKEN_CREATE_SELL_OFFER 48
+#define ttURITOKEN_CANCEL_SELL_OFFER 49
+#define ttREMIT 95
+#define ttGENESIS_MINT 96
+#define ttIMPORT 97
+#define ttCLAIM_REWARD 98
+#define ttINVOKE 99
+#define ttAMENDMENT 100
+#define ttFEE 101
+#define ttUNL_MODIFY 102
+#define ttEMIT_FAILURE 103
+
+#define tfCANONICAL 0x80000000UL
+
+#define atACCOUNT 1U
+#define atOWNER 2U
+#define atDESTINATION 3U
+#define atISSUER 4U
+
+#define amAMOUNT 1U
+#define amBALANCE 2U
+#define amLIMITAMOUNT 3U
+#define amTAKERPAYS 4U
+#define amTAKERGETS 5U
+#define amLOWLIMIT 6U
+#define amHIGHLIMIT 7U
+#define amFEE 8U
+#define amSENDMAX 9U
+#define amDELIVERMIN 10U
+
+// ---------------------------------------------------------------
+// Field encoders. Each writes one serialized field at buf_out and
+// advances buf_out past it.
+// ---------------------------------------------------------------
+
+#define ENCODE_TT_SIZE 3
+#define ENCODE_TT(buf_out, tt)                              \
+    {                                                       \
+        uint8_t utt = tt;                                   \
+        buf_out[0] = 0x12U;                                 \
+        buf_out[1] = 0;                                     \
+        buf_out[2] = utt;                                   \
+        buf_out += ENCODE_TT_SIZE;                          \
+    }
+#define _01_02_ENCODE_TT(buf_out, tt) ENCODE_TT(buf_out, tt);
+
+#define ENCODE_UINT32_COMMON_SIZE 5U
+#define ENCODE_UINT32_COMMON(buf_out, i, field)             \
+    {                                                       \
+        uint32_t ui = i;                                    \
+        uint8_t uf = field;                                 \
+        buf_out[0] = 0x20U + (uf & 0x0FU);                  \
+        buf_out[1] = (ui >> 24) & 0xFFU;                    \
+        buf_out[2] = (ui >> 16) & 0xFFU;                    \
+        buf_out[3] = (ui >> 8) & 0xFFU;                     \
+        buf_out[4] = (ui >> 0) & 0xFFU;                     \
+        buf_out += ENCODE_UINT32_COMMON_SIZE;               \
+    }
+
+#define ENCODE_UINT32_UNCOMMON_SIZE 6U
+#define ENCODE_UINT32_UNCOMMON(buf_out, i, field)           \
+    {                                                       \
+        uint32_t ui = i;                                    \
+        uint8_t uf = field;                                 \
+        buf_out[0] = 0x20U;                                 \
+        buf_out[1] = uf;                                    \
+        buf_out[2] = (ui >> 24) & 0xFFU;                    \
+        buf_out[3] = (ui >> 16) & 0xFFU;                    \
+        buf_out[4] = (ui >> 8) & 0xFFU;                     \
+        buf_out[5] = (ui >> 0) & 0xFFU;                     \
+        buf_out += ENCODE_UINT32_UNCOMMON_SIZE;             \
+    }
+
+#define _02_02_ENCODE_FLAGS(buf_out, tag) ENCODE_UINT32_COMMON(buf_out, tag, 0x2U);
+#define _02_03_ENCODE_TAG_SRC(buf_out, tag) ENCODE_UINT32_COMMON(buf_out, tag, 0x3U);
+#define _02_04_ENCODE_SEQUENCE(buf_out, sequence) ENCODE_UINT32_COMMON(buf_out, sequence, 0x4U);
+#define _02_14_ENCODE_TAG_DST(buf_out, tag) ENCODE_UINT32_COMMON(buf_out, tag, 0xEU);
+#define _02_26_ENCODE_FLS(buf_out, fls) ENCODE_UINT32_UNCOMMON(buf_out, fls, 0x1AU);
+#define _02_27_ENCODE_LLS(buf_out, lls) ENCODE_UINT32_UNCOMMON(buf_out, lls, 0x1BU);
+
+#define ENCODE_DROPS_SIZE 9
+#define ENCODE_DROPS(buf_out, drops, amount_type)           \
+    {                                                       \
+        uint8_t uat = amount_type;                          \
+        uint64_t udrops = drops;                            \
+        buf_out[0] = 0x60U + (uat & 0x0FU);                 \
+        buf_out[1] = 0b01000000 + ((udrops >> 56) & 0b00111111); \
+        buf_out[2] = (udrops >> 48) & 0xFFU;                \
+        buf_out[3] = (udrops >> 40) & 0xFFU;                \
+        buf_out[4] = (udrops >> 32) & 0xFFU;                \
+        buf_out[5] = (udrops >> 24) & 0xFFU;                \
+        buf_out[6] = (udrops >> 16) & 0xFFU;                \
+        buf_out[7] = (udrops >> 8) & 0xFFU;                 \
+        buf_out[8] = (udrops >> 0) & 0xFFU;                 \
+        buf_out += ENCODE_DROPS_SIZE;                       \
+    }
+#define _06_01_ENCODE_DROPS_AMOUNT(buf_out, drops) ENCODE_DROPS(buf_out, drops, amAMOUNT);
+#define _06_08_ENCODE_DROPS_FEE(buf_out, drops) ENCODE_DROPS(buf_out, drops, amFEE);
+
+// tlamt is the 48 byte serialized IOU amount (value, currency, issuer)
+#define ENCODE_TL_SIZE 49
+#define ENCODE_TL(buf_out, tlamt, amount_type)              \
+    {                                                       \
+        uint8_t uat = amount_type;                          \
+        buf_out[0] = 0x60U + (uat & 0x0FU);                 \
+        *(uint64_t*)(buf_out + 1) = *(uint64_t*)(tlamt + 0);   \
+        *(uint64_t*)(buf_out + 9) = *(uint64_t*)(tlamt + 8);   \
+        *(uint64_t*)(buf_out + 17) = *(uint64_t*)(tlamt + 16); \
+        *(uint64_t*)(buf_out + 25) = *(uint64_t*)(tlamt + 24); \
+        *(uint64_t*)(buf_out + 33) = *(uint64_t*)(tlamt + 32); \
+        *(uint64_t*)(buf_out + 41) = *(uint64_t*)(tlamt + 40); \
+        buf_out += ENCODE_TL_SIZE;                          \
+    }
+#define _06_01_ENCODE_TL_AMOUNT(buf_out, tlamt) ENCODE_TL(buf_out, tlamt, amAMOUNT);
+
+#define ENCODE_SIGNING_PUBKEY_NULL_SIZE 35
+#define ENCODE_SIGNING_PUBKEY_NULL(buf_out)                 \
+    {                                                       \
+        buf_out[0] = 0x73U;                                 \
+        buf_out[1] = 0x21U;                                 \
+        *(uint64_t*)(buf_out + 2) = 0;                      \
+        *(uint64_t*)(buf_out + 10) = 0;                     \
+        *(uint64_t*)(buf_out + 18) = 0;                     \
+        *(uint64_t*)(buf_out + 26) = 0;                     \
+        buf_out[34] = 0;                                    \
+        buf_out += ENCODE_SIGNING_PUBKEY_NULL_SIZE;         \
+    }
+#define _07_03_ENCODE_SIGNING_PUBKEY_NULL(buf_out) ENCODE_SIGNING_PUBKEY_NULL(buf_out);
+
+#define ENCODE_ACCOUNT_SIZE 22
+#define ENCODE_ACCOUNT(buf_out, account_id, account_type)   \
+    {                                                       \
+        uint8_t uat = account_type;                         \
+        buf_out[0] = 0x80U + uat;                           \
+        buf_out[1] = 0x14U;                                 \
+        *(uint64_t*)(buf_out + 2) = *(uint64_t*)(account_id + 0);  \
+        *(uint64_t*)(buf_out + 10) = *(uint64_t*)(account_id + 8); \
+        *(uint32_t*)(buf_out + 18) = *(uint32_t*)(account_id + 16); \
+        buf_out += ENCODE_ACCOUNT_SIZE;                     \
+    }
+#define _08_01_ENCODE_ACCOUNT_SRC(buf_out, account_id) ENCODE_ACCOUNT(buf_out, account_id, atACCOUNT);
+#define _08_03_ENCODE_ACCOUNT_DST(buf_out, account_id) ENCODE_ACCOUNT(buf_out, account_id, atDESTINATION);
+
+// ---------------------------------------------------------------
+// Simple payment templates: tt, flags, tags, sequence, FLS/LLS,
+// amount, fee, null pubkey, accounts, then 116 bytes of emit details.
+// ---------------------------------------------------------------
+
+#define PREPARE_PAYMENT_SIMPLE_SIZE 248U
+#define PREPARE_PAYMENT_SIMPLE(buf_out_master, drops_amount_raw, to_address, dest_tag_raw, src_tag_raw) \
+    {                                                                                   \
+        uint8_t* buf_out = buf_out_master;                                              \
+        uint8_t acc[20];                                                                \
+        uint64_t drops_amount = (drops_amount_raw);                                     \
+        uint32_t dest_tag = (dest_tag_raw);                                             \
+        uint32_t src_tag = (src_tag_raw);                                               \
+        uint32_t cls = (uint32_t)ledger_seq();                                          \
+        hook_account(SBUF(acc));                                                        \
+        _01_02_ENCODE_TT(buf_out, ttPAYMENT);               /* uint16  | size   3 */    \
+        _02_02_ENCODE_FLAGS(buf_out, tfCANONICAL);          /* uint32  | size   5 */    \
+        _02_03_ENCODE_TAG_SRC(buf_out, src_tag);            /* uint32  | size   5 */    \
+        _02_04_ENCODE_SEQUENCE(buf_out, 0);                 /* uint32  | size   5 */    \
+        _02_14_ENCODE_TAG_DST(buf_out, dest_tag);           /* uint32  | size   5 */    \
+        _02_26_ENCODE_FLS(buf_out, cls + 1);                /* uint32  | size   6 */    \
+        _02_27_ENCODE_LLS(buf_out, cls + 5);                /* uint32  | size   6 */    \
+        _06_01_ENCODE_DROPS_AMOUNT(buf_out, drops_amount);  /* amount  | size   9 */    \
+        uint8_t* fee_ptr = buf_out;                                                     \
+        _06_08_ENCODE_DROPS_FEE(buf_out, 0);                /* amount  | size   9 */    \
+        _07_03_ENCODE_SIGNING_PUBKEY_NULL(buf_out);         /* pk      | size  35 */    \
+        _08_01_ENCODE_ACCOUNT_SRC(buf_out, acc);            /* account | size  22 */    \
+        _08_03_ENCODE_ACCOUNT_DST(buf_out, to_address);     /* account | size  22 */    \
+        etxn_details((uint32_t)buf_out, 116U);              /* emitdet | size 116 */    \
+        int64_t fee = etxn_fee_base((uint32_t)(buf_out_master), PREPARE_PAYMENT_SIMPLE_SIZE); \
+        _06_08_ENCODE_DROPS_FEE(fee_ptr, fee);                                          \
+    }
+
+#define PREPARE_PAYMENT_SIMPLE_TRUSTLINE_SIZE 288U
+#define PREPARE_PAYMENT_SIMPLE_TRUSTLINE(buf_out_master, tlamt, to_address, dest_tag_raw, src_tag_raw) \
+    {                                                                                   \
+        uint8_t* buf_out = buf_out_master;                                              \
+        uint8_t acc[20];                                                                \
+        uint32_t dest_tag = (dest_tag_raw);                                             \
+        uint32_t src_tag = (src_tag_raw);                                               \
+        uint32_t cls = (uint32_t)ledger_seq();                                          \
+        hook_account(SBUF(acc));                                                        \
+        _01_02_ENCODE_TT(buf_out, ttPAYMENT);               /* uint16  | size   3 */    \
+        _02_02_ENCODE_FLAGS(buf_out, tfCANONICAL);          /* uint32  | size   5 */    \
+        _02_03_ENCODE_TAG_SRC(buf_out, src_tag);            /* uint32  | size   5 */    \
+        _02_04_ENCODE_SEQUENCE(buf_out, 0);                 /* uint32  | size   5 */    \
+        _02_14_ENCODE_TAG_DST(buf_out, dest_tag);           /* uint32  | size   5 */    \
+        _02_26_ENCODE_FLS(buf_out, cls + 1);                /* uint32  | size   6 */    \
+        _02_27_ENCODE_LLS(buf_out, cls + 5);                /* uint32  | size   6 */    \
+        _06_01_ENCODE_TL_AMOUNT(buf_out, tlamt);            /* amount  | size  49 */    \
+        uint8_t* fee_ptr = buf_out;                                                     \
+        _06_08_ENCODE_DROPS_FEE(buf_out, 0);                /* amount  | size   9 */    \
+        _07_03_ENCODE_SIGNING_PUBKEY_NULL(buf_out);         /* pk      | size  35 */    \
+        _08_01_ENCODE_ACCOUNT_SRC(buf_out, acc);            /* account | size  22 */    \
+        _08_03_ENCODE_ACCOUNT_DST(buf_out, to_address);     /* account | size  22 */    \
+        etxn_details((uint32_t)buf_out, 116U);              /* emitdet | size 116 */    \
+        int64_t fee = etxn_fee_base((uint32_t)(buf_out_master), PREPARE_PAYMENT_SIMPLE_TRUSTLINE_SIZE); \
+        _06_08_ENCODE_DROPS_FEE(fee_ptr, fee);                                          \
+    }
+
+#endif
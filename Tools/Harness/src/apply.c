@@ -0,0 +1,570 @@
+//**************************************************************
+// HandyHooks native harness - transaction application
+//
+// Description:
+//   Serializes submitted transactions, runs the hook chains of the
+//   source and destination accounts, then either rejects the whole
+//   transaction (any rollback) or commits its state writes, applies
+//   the payment and queues everything the hooks emitted.
+//
+// Notes:
+//   - Hooks see the ledger as it was before the transaction applies.
+//   - The fee is charged whatever the outcome, as on-ledger.
+//   - Emitted transactions are applied by hh_ledger_close(), which
+//     runs the emitting hook's callback when it has one.
+//**************************************************************
+
+#include <stdlib.h>
+
+#include "internal.h"
+#include "../hookapi/error.h"
+#include "../hookapi/sfcodes.h"
+
+#define TT_PAYMENT 0
+#define TT_HOOK_SET 22
+#define TT_REMIT 95
+
+static hh_ctx ctx;
+static hh_mod mods[HH_MAX_MODS];
+static hh_exec cbak_exec;
+
+hh_ctx* hh_cur = &ctx;
+
+// ---------------------------------------------------------------
+// Results
+// ---------------------------------------------------------------
+
+void hh_result_init(hh_result* r)
+{
+    memset(r, 0, sizeof(*r));
+}
+
+static void drop_emitted(hh_result* r)
+{
+    for (int i = 0; i < r->emitted_count; ++i)
+        free(r->emitted[i].blob);
+    r->emitted_count = 0;
+}
+
+void hh_result_free(hh_result* r)
+{
+    drop_emitted(r);
+    free(r->emitted);
+    hh_result_init(r);
+}
+
+void hh_result_reset(hh_result* r)
+{
+    drop_emitted(r);
+    r->ter = HH_TES_SUCCESS;
+    memset(r->txid, 0, 32);
+    r->generation = 0;
+    r->exec_count = 0;
+    r->skipped_count = 0;
+}
+
+int hh_emit_push(hh_result* r, const uint8_t* blob, uint32_t len, const uint8_t hash[32])
+{
+    if (r->emitted_count == r->emitted_cap) {
+        int cap = r->emitted_cap ? r->emitted_cap * 2 : 8;
+        hh_emitted* e = realloc(r->emitted, sizeof(*e) * (size_t)cap);
+        if (!e)
+            return -1;
+        r->emitted = e;
+        r->emitted_cap = cap;
+    }
+    uint8_t* copy = malloc(len);
+    if (!copy)
+        return -1;
+    memcpy(copy, blob, len);
+    hh_emitted* e = &r->emitted[r->emitted_count++];
+    memcpy(e->hash, hash, 32);
+    e->len = len;
+    e->blob = copy;
+    return 0;
+}
+
+// ---------------------------------------------------------------
+// Fees
+// ---------------------------------------------------------------
+
+// Base fee of an emitted transaction: the network base scaled by the
+// burden its EmitDetails carry.
+int64_t hh_fee_for(const uint8_t* blob, uint32_t len)
+{
+    hh_txview v;
+    if (hh_txview_parse(&v, blob, len) != 0)
+        return INVALID_TXN;
+    uint64_t burden = v.burden ? v.burden : 1;
+    if (burden > (uint64_t)INT64_MAX / HH_FEE_BASE)
+        return FEE_TOO_LARGE;
+    return (int64_t)(HH_FEE_BASE * burden);
+}
+
+int hh_txn_inspect(const uint8_t* blob, uint32_t len, hh_txn_info* out)
+{
+    hh_txview* v = malloc(sizeof(*v));
+    if (!v)
+        return -1;
+    int r = hh_txview_parse(v, blob, len);
+    if (r == 0) {
+        memset(out, 0, sizeof(*out));
+        out->type = v->type;
+        out->len = len;
+        out->fee = v->fee;
+        out->burden = v->burden ? v->burden : 1;
+        out->generation = v->generation;
+        out->iou = v->amount_len == 48;
+        out->amount_count = v->amount_count;
+        for (int i = 0; i < v->amount_count; ++i)
+            out->iou_amounts += v->amounts_len[i] == 48;
+    }
+    free(v);
+    return r;
+}
+
+// ---------------------------------------------------------------
+// Hook execution
+// ---------------------------------------------------------------
+
+// Runs the hook (or callback) set up in c, which must not be nested.
+void hh_exec_hook(hh_ctx* c)
+{
+    uint8_t probe;
+    if ((uintptr_t)&probe > 0xFFFFFFFFULL) {
+        fprintf(stderr, "harness: hooks must run inside hh_run()\n");
+        abort();
+    }
+    memset(c->slots, 0, sizeof(c->slots));
+    memset(c->guard_ids, 0, sizeof(c->guard_ids));
+    memset(c->guard_hits, 0, sizeof(c->guard_hits));
+    c->arena_used = 0;
+    c->reserved = -1;
+    c->nonces = 0;
+    static uint64_t serial;
+    c->serial = ++serial;
+
+    hh_exec* e = c->exec;
+    e->exit = HH_EXIT_NONE;
+    if (setjmp(c->exit) == 0) {
+        hh_entry fn = c->callback ? c->hook->def->cbak : c->hook->def->hook;
+        fn(0);
+        static const char msg[] = "hook returned without accept or rollback";
+        e->exit = HH_EXIT_ROLLBACK;
+        e->exit_code = RC_ROLLBACK;
+        e->reason_len = sizeof(msg) - 1;
+        memcpy(e->reason, msg, sizeof(msg) - 1);
+    }
+}
+
+static int hook_fires(const hh_hook* h, uint16_t tt)
+{
+    if (tt > 255)
+        return 1;
+    int bit = (h->hookon[31 - tt / 8] >> (tt % 8)) & 1;
+    return !bit ^ (tt == TT_HOOK_SET);
+}
+
+static void note_skipped(hh_result* r, const hh_account* a, const hh_hook* h, int position, hh_skip_reason why)
+{
+    if (r->skipped_count == 2 * HH_MAX_CHAIN)
+        return;
+    hh_skipped* s = &r->skipped[r->skipped_count++];
+    s->def = h->def;
+    memcpy(s->account, a->id, 20);
+    s->position = position;
+    s->reason = why;
+}
+
+// Runs one account's chain. Returns 0 when every hook accepted.
+static int run_chain(hh_ledger* l, const hh_txview* v, hh_account* a, hh_result* r)
+{
+    uint8_t skip[HH_MAX_CHAIN] = {0};
+    for (int i = 0; i < HH_MAX_CHAIN; ++i) {
+        hh_hook* h = a->chain[i];
+        if (!h)
+            continue;
+        if (skip[i] || !hook_fires(h, v->type)) {
+            note_skipped(r, a, h, i, skip[i] ? HH_SKIP_HOOK_SKIP : HH_SKIP_HOOKON);
+            continue;
+        }
+        if (r->exec_count == 2 * HH_MAX_CHAIN)
+            return -1;
+        hh_exec* e = &r->execs[r->exec_count++];
+        memset(e, 0, sizeof(*e));
+        e->def = h->def;
+        memcpy(e->account, a->id, 20);
+        memcpy(e->hash, h->hash, 32);
+        e->position = i;
+
+        ctx.ledger = l;
+        ctx.otxn = v;
+        ctx.account = a;
+        ctx.hook = h;
+        ctx.exec = e;
+        ctx.callback = 0;
+        ctx.position = i;
+        ctx.skip = skip;
+        ctx.chain_len = HH_MAX_CHAIN;
+        ctx.result = r;
+        hh_exec_hook(&ctx);
+        l->totals.executions++;
+        if (e->exit != HH_EXIT_ACCEPT) {
+            for (int k = i + 1; k < HH_MAX_CHAIN; ++k)
+                if (a->chain[k])
+                    note_skipped(r, a, a->chain[k], k, HH_SKIP_UNREACHED);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void discard_mods(void)
+{
+    for (int i = 0; i < ctx.mod_count; ++i)
+        free(mods[i].val);
+    ctx.mod_count = 0;
+}
+
+static void commit_mods(hh_ledger* l)
+{
+    for (int i = 0; i < ctx.mod_count; ++i) {
+        hh_mod* m = &mods[i];
+        hh_account* a = hh_account_get(l, m->key);
+        hh_blob* old = hh_map_get(&l->state, m->key);
+        if (m->val)
+            hh_map_put(&l->state, m->key, m->val);
+        else if (old)
+            hh_map_del(&l->state, m->key);
+        if (!old && m->val)
+            a->owner_count += a->scale;
+        else if (old && !m->val)
+            a->owner_count -= a->scale;
+        free(old);
+        m->val = NULL;
+    }
+    ctx.mod_count = 0;
+}
+
+// ---------------------------------------------------------------
+// Payments
+// ---------------------------------------------------------------
+
+typedef struct amount_view {
+    int native;
+    uint64_t drops;
+    int64_t xfl;
+    const uint8_t* currency;
+    const uint8_t* issuer;
+} amount_view;
+
+static int read_amount(const uint8_t* p, uint32_t len, amount_view* out)
+{
+    if (len == 8) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v = (v << 8) | p[i];
+        if (!(v >> 62 & 1U))
+            return -1;
+        *out = (amount_view){.native = 1, .drops = v & ((1ULL << 62) - 1)};
+        return 0;
+    }
+    if (len != 48)
+        return -1;
+    *out = (amount_view){.native = 0, .xfl = hh_xfl_from_iou(p), .currency = p + 8, .issuer = p + 28};
+    return out->xfl < 0 ? -1 : 0;
+}
+
+// Checks that src can move amt to dst. create_line lets an issuer open
+// the destination's line, as Remit does.
+static hh_ter check_transfer(hh_ledger* l, hh_account* src, hh_account* dst, const amount_view* amt,
+                             uint64_t* native_out, int create_line)
+{
+    if (amt->native) {
+        *native_out += amt->drops;
+        return HH_TES_SUCCESS;
+    }
+    if (memcmp(src->id, amt->issuer, 20) != 0) {
+        hh_line* ln = hh_line_get(l, src->id, amt->issuer, amt->currency);
+        if (!ln || memcmp(ln->holder, src->id, 20) != 0)
+            return HH_TEC_NO_LINE;
+        if (hh_xfl_cmp(ln->balance, amt->xfl) < 0)
+            return HH_TEC_UNFUNDED;
+    }
+    if (memcmp(dst->id, amt->issuer, 20) != 0 && !hh_line_get(l, dst->id, amt->issuer, amt->currency)) {
+        if (!create_line || memcmp(src->id, amt->issuer, 20) != 0)
+            return HH_TEC_NO_LINE;
+        if (dst->balance < hh_reserve(dst, 1))
+            return HH_TEC_NO_LINE;
+    }
+    return HH_TES_SUCCESS;
+}
+
+static void move_amount(hh_ledger* l, hh_account* src, hh_account* dst, const amount_view* amt)
+{
+    if (amt->native) {
+        src->balance -= amt->drops;
+        dst->balance += amt->drops;
+        return;
+    }
+    if (memcmp(src->id, amt->issuer, 20) != 0) {
+        hh_line* ln = hh_line_get(l, src->id, amt->issuer, amt->currency);
+        ln->balance = hh_xfl_add(ln->balance, hh_xfl_neg(amt->xfl));
+    }
+    if (memcmp(dst->id, amt->issuer, 20) != 0) {
+        hh_line* ln = hh_line_get(l, dst->id, amt->issuer, amt->currency);
+        if (!ln) {
+            hh_trustline_set(l, dst->id, amt->issuer, amt->currency, 0);
+            ln = hh_line_get(l, dst->id, amt->issuer, amt->currency);
+        }
+        ln->balance = hh_xfl_add(ln->balance, amt->xfl);
+    }
+}
+
+// Everything the transaction moves, checked up front so a failed
+// payment never reaches the hooks.
+typedef struct transfer_plan {
+    int count;
+    amount_view amounts[1 + HH_MAX_AMOUNTS];
+} transfer_plan;
+
+static hh_ter preflight(hh_ledger* l, const hh_txview* v, hh_account* src, hh_account** dst,
+                        transfer_plan* plan)
+{
+    plan->count = 0;
+    *dst = v->destination ? hh_account_get(l, v->destination) : NULL;
+    if (src->balance < v->fee)
+        return HH_TEC_UNFUNDED;
+    if (v->type != TT_PAYMENT && v->type != TT_REMIT)
+        return HH_TES_SUCCESS;
+    if (!*dst)
+        return v->destination ? HH_TEC_NO_DST : HH_TEF_MALFORMED;
+
+    if (v->amount && read_amount(v->amount, v->amount_len, &plan->amounts[plan->count++]) != 0)
+        return HH_TEF_MALFORMED;
+    for (int i = 0; i < v->amount_count; ++i)
+        if (read_amount(v->amounts[i], v->amounts_len[i], &plan->amounts[plan->count++]) != 0)
+            return HH_TEF_MALFORMED;
+    if (v->type == TT_PAYMENT && plan->count != 1)
+        return HH_TEF_MALFORMED;
+
+    uint64_t native = 0;
+    for (int i = 0; i < plan->count; ++i) {
+        hh_ter t = check_transfer(l, src, *dst, &plan->amounts[i], &native, v->type == TT_REMIT);
+        if (t != HH_TES_SUCCESS)
+            return t;
+    }
+    if (native && src->balance < v->fee + native + hh_reserve(src, 0))
+        return HH_TEC_UNFUNDED;
+    return HH_TES_SUCCESS;
+}
+
+static void charge_fee(hh_ledger* l, hh_account* src, uint64_t fee)
+{
+    if (fee > src->balance)
+        fee = src->balance;
+    src->balance -= fee;
+    l->totals.fee_burned += fee;
+}
+
+static void queue_emitted(hh_ledger* l, hh_result* r)
+{
+    for (int i = 0; i < r->emitted_count; ++i) {
+        if (l->pending_count == l->pending_cap) {
+            size_t cap = l->pending_cap ? l->pending_cap * 2 : 64;
+            hh_pending* p = realloc(l->pending, sizeof(*p) * cap);
+            if (!p) {
+                fprintf(stderr, "harness: out of memory\n");
+                abort();
+            }
+            l->pending = p;
+            l->pending_cap = cap;
+        }
+        uint8_t* copy = malloc(r->emitted[i].len);
+        if (!copy) {
+            fprintf(stderr, "harness: out of memory\n");
+            abort();
+        }
+        memcpy(copy, r->emitted[i].blob, r->emitted[i].len);
+        l->pending[l->pending_count++] = (hh_pending){.len = r->emitted[i].len, .blob = copy};
+    }
+    l->totals.emitted += (uint64_t)r->emitted_count;
+}
+
+static int apply_blob(hh_ledger* l, const uint8_t* blob, uint32_t len, hh_result* r)
+{
+    static hh_txview v;
+    hh_result_reset(r);
+    if (hh_txview_parse(&v, blob, len) != 0) {
+        r->ter = HH_TEF_MALFORMED;
+        return r->ter;
+    }
+    memcpy(r->txid, v.id, 32);
+    r->generation = v.generation;
+    hh_account* src = hh_account_get(l, v.account);
+    if (!src) {
+        r->ter = HH_TEF_MALFORMED;
+        return r->ter;
+    }
+    l->totals.txns++;
+
+    hh_account* dst;
+    transfer_plan plan;
+    r->ter = preflight(l, &v, src, &dst, &plan);
+    if (r->ter == HH_TEF_MALFORMED)
+        return r->ter;
+    if (r->ter != HH_TES_SUCCESS) {
+        charge_fee(l, src, v.fee);
+        return r->ter;
+    }
+
+    ctx.mods = mods;
+    ctx.mod_count = 0;
+    int rejected = run_chain(l, &v, src, r);
+    if (!rejected && dst && dst != src)
+        rejected = run_chain(l, &v, dst, r);
+
+    if (rejected) {
+        discard_mods();
+        drop_emitted(r);
+        r->ter = HH_TEC_HOOK_REJECTED;
+    } else {
+        commit_mods(l);
+        for (int i = 0; i < plan.count; ++i)
+            move_amount(l, src, dst, &plan.amounts[i]);
+        queue_emitted(l, r);
+    }
+    charge_fee(l, src, v.fee);
+    return r->ter;
+}
+
+// Runs the callback of the hook that emitted v, if it asked for one.
+static void run_callback(hh_ledger* l, const uint8_t* blob, uint32_t len, hh_result* r)
+{
+    static hh_txview v;
+    if (hh_txview_parse(&v, blob, len) != 0)
+        return;
+    hh_field d, f;
+    if (hh_sto_find(v.blob, v.len, sfEmitDetails, &d) != 1 ||
+        hh_sto_find(d.payload, d.payload_len, sfEmitCallback, &f) != 1 || f.payload_len != 20)
+        return;
+    hh_field hf;
+    if (hh_sto_find(d.payload, d.payload_len, sfEmitHookHash, &hf) != 1)
+        return;
+    hh_account* a = hh_account_get(l, f.payload);
+    if (!a)
+        return;
+    for (int i = 0; i < HH_MAX_CHAIN; ++i) {
+        hh_hook* h = a->chain[i];
+        if (!h || !h->def->cbak || memcmp(h->hash, hf.payload, 32) != 0)
+            continue;
+        memset(&cbak_exec, 0, sizeof(cbak_exec));
+        cbak_exec.def = h->def;
+        memcpy(cbak_exec.account, a->id, 20);
+        memcpy(cbak_exec.hash, h->hash, 32);
+        cbak_exec.position = i;
+        uint8_t skip[HH_MAX_CHAIN] = {0};
+        ctx.ledger = l;
+        ctx.otxn = &v;
+        ctx.account = a;
+        ctx.hook = h;
+        ctx.exec = &cbak_exec;
+        ctx.callback = 1;
+        ctx.position = i;
+        ctx.skip = skip;
+        ctx.chain_len = HH_MAX_CHAIN;
+        ctx.result = r;
+        ctx.mods = mods;
+        ctx.mod_count = 0;
+        hh_exec_hook(&ctx);
+        l->totals.executions++;
+        // callbacks cannot emit; their state writes stick either way
+        drop_emitted(r);
+        commit_mods(l);
+        if (r->exec_count < 2 * HH_MAX_CHAIN)
+            r->execs[r->exec_count++] = cbak_exec;
+        return;
+    }
+}
+
+int hh_submit(hh_ledger* l, const hh_txn* txn, hh_result* r)
+{
+    static uint8_t buf[HH_MAX_PARAMS * (HH_MAX_PARAM_NAME + HH_MAX_PARAM_VALUE + 16) + 1024];
+    uint32_t len = hh_sto_serialize(txn, NULL, 0, buf, sizeof(buf));
+    if (!len) {
+        hh_result_reset(r);
+        r->ter = HH_TEF_MALFORMED;
+        return r->ter;
+    }
+    return apply_blob(l, buf, len, r);
+}
+
+int hh_ledger_close(hh_ledger* l, void (*cb)(void*, const hh_result*), void* cb_ctx)
+{
+    size_t count = l->pending_count;
+    hh_pending* batch = l->pending;
+    l->pending = NULL;
+    l->pending_count = 0;
+    l->pending_cap = 0;
+    l->seq++;
+    l->time += 4;
+
+    hh_result r;
+    hh_result_init(&r);
+    for (size_t i = 0; i < count; ++i) {
+        apply_blob(l, batch[i].blob, batch[i].len, &r);
+        run_callback(l, batch[i].blob, batch[i].len, &r);
+        if (cb)
+            cb(cb_ctx, &r);
+        free(batch[i].blob);
+    }
+    hh_result_free(&r);
+    free(batch);
+    return (int)count;
+}
+
+// ---------------------------------------------------------------
+// Builders
+// ---------------------------------------------------------------
+
+void hh_txn_init(hh_txn* t, uint16_t type, const uint8_t account[20])
+{
+    t->type = type;
+    t->flags = 0;
+    memcpy(t->account, account, 20);
+    t->has_destination = 0;
+    t->has_amount = 0;
+    t->amount_count = 0;
+    t->fee = HH_FEE_BASE;
+    t->param_count = 0;
+}
+
+int hh_txn_param(hh_txn* t, const char* name, const void* value, uint32_t len)
+{
+    size_t name_len = strlen(name);
+    if (t->param_count == HH_MAX_PARAMS)
+        return TOO_MANY_PARAMS;
+    if (name_len == 0 || name_len > HH_MAX_PARAM_NAME || len > HH_MAX_PARAM_VALUE)
+        return TOO_BIG;
+    hh_param* p = &t->params[t->param_count++];
+    memcpy(p->name, name, name_len);
+    p->name_len = (uint32_t)name_len;
+    memcpy(p->value, value, len);
+    p->value_len = len;
+    return 0;
+}
+
+void hh_amount_drops(hh_amount* a, uint64_t drops)
+{
+    memset(a, 0, sizeof(*a));
+    a->native = 1;
+    a->drops = drops;
+}
+
+void hh_amount_iou(hh_amount* a, int64_t xfl, const uint8_t currency[20], const uint8_t issuer[20])
+{
+    memset(a, 0, sizeof(*a));
+    a->xfl = xfl;
+    memcpy(a->currency, currency, 20);
+    memcpy(a->issuer, issuer, 20);
+}
@@ -0,0 +1,302 @@
+//**************************************************************
+// HandyHooks native harness - public API
+//
+// Description:
+//   Runs hook sources compiled natively against an in-memory ledger:
+//   accounts, trustlines, hook chains, namespaced hook state and the
+//   emitted-transaction queue. Every submitted transaction executes the
+//   hook chains it touches, captures each accept/rollback and keeps the
+//   emitted blobs, which are applied when the ledger is closed.
+//
+// Usage:
+//   - Call hh_run() once from main(); hooks cast pointers to uint32_t,
+//     so everything that executes them has to live on the low stack.
+//   - Build a ledger, fund accounts, install hooks, then hh_submit()
+//     transactions and hh_ledger_close() to apply emitted ones.
+//**************************************************************
+
+#ifndef HH_HARNESS_H
+#define HH_HARNESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HH_MAX_CHAIN 10        // hooks per account
+#define HH_MAX_PARAMS 16       // parameters per hook or transaction
+#define HH_MAX_PARAM_NAME 32
+#define HH_MAX_PARAM_VALUE 1024
+#define HH_MAX_AMOUNTS 8       // Remit Amounts entries
+#define HH_MAX_EMIT 255        // etxn_reserve upper bound
+#define HH_MAX_REASON 256      // bytes of accept/rollback message kept
+
+#define HH_STATE_MAX 256       // bytes per state entry at HookStateScale 1
+#define HH_FEE_BASE 10         // drops
+#define HH_RESERVE_BASE 1000000ULL
+#define HH_RESERVE_INC 200000ULL
+
+// Host functions the harness counts per execution.
+enum hh_api {
+    HH_API_GUARD,
+    HH_API_ACCEPT,
+    HH_API_ROLLBACK,
+    HH_API_UTIL,
+    HH_API_STO,
+    HH_API_ETXN_RESERVE,
+    HH_API_ETXN_DETAILS,
+    HH_API_ETXN_FEE_BASE,
+    HH_API_ETXN_OTHER,
+    HH_API_EMIT,
+    HH_API_FLOAT,
+    HH_API_LEDGER,
+    HH_API_HOOK_ACCOUNT,
+    HH_API_HOOK_PARAM,
+    HH_API_HOOK_SKIP,
+    HH_API_HOOK_OTHER,
+    HH_API_SLOT_SET,
+    HH_API_SLOT,
+    HH_API_STATE,
+    HH_API_STATE_SET,
+    HH_API_STATE_FOREIGN,
+    HH_API_STATE_FOREIGN_SET,
+    HH_API_TRACE,
+    HH_API_OTXN_FIELD,
+    HH_API_OTXN_PARAM,
+    HH_API_OTXN_OTHER,
+    HH_API_COUNT
+};
+
+extern const char* const hh_api_names[HH_API_COUNT];
+
+typedef int64_t (*hh_entry)(uint32_t);
+
+// One compiled hook, generated into the registry by CMake.
+typedef struct hh_hook_def {
+    const char* name;
+    const char* source;
+    hh_entry hook;
+    hh_entry cbak;
+} hh_hook_def;
+
+extern const hh_hook_def hh_hooks[];
+extern const size_t hh_hook_count;
+
+const hh_hook_def* hh_hook_find(const char* name);
+
+typedef struct hh_param {
+    uint8_t name[HH_MAX_PARAM_NAME];
+    uint32_t name_len;
+    uint8_t value[HH_MAX_PARAM_VALUE];
+    uint32_t value_len;
+} hh_param;
+
+// Native amounts use drops; IOU amounts carry an XFL value.
+typedef struct hh_amount {
+    int native;
+    uint64_t drops;
+    int64_t xfl;
+    uint8_t currency[20];
+    uint8_t issuer[20];
+} hh_amount;
+
+// Transaction fields the builder knows how to serialize.
+typedef struct hh_txn {
+    uint16_t type;
+    uint32_t flags;
+    uint8_t account[20];
+    int has_destination;
+    uint8_t destination[20];
+    int has_amount;
+    hh_amount amount;
+    int amount_count;
+    hh_amount amounts[HH_MAX_AMOUNTS];
+    uint64_t fee;
+    int param_count;
+    hh_param params[HH_MAX_PARAMS];
+} hh_txn;
+
+typedef struct hh_hook_opts {
+    const uint8_t* hash;       // 32 bytes, default sha512h("hook:" name)
+    const uint8_t* ns;         // 32 bytes, default zero
+    const uint8_t* hookon;     // 32 bytes, default fire on everything but SetHook
+    int param_count;
+    const hh_param* params;
+} hh_hook_opts;
+
+typedef enum hh_exit {
+    HH_EXIT_NONE,
+    HH_EXIT_ACCEPT,
+    HH_EXIT_ROLLBACK
+} hh_exit;
+
+// Outcome and counters of one hook execution.
+typedef struct hh_exec {
+    const hh_hook_def* def;
+    uint8_t account[20];
+    uint8_t hash[32];
+    int position;
+    hh_exit exit;
+    int64_t exit_code;
+    uint32_t reason_len;
+    char reason[HH_MAX_REASON];
+    uint64_t calls[HH_API_COUNT];
+    uint64_t guard_iterations;
+    uint64_t blocks;           // basic blocks of hook code run, see meter.c
+    uint32_t emitted;
+} hh_exec;
+
+typedef struct hh_emitted {
+    uint8_t hash[32];
+    uint32_t len;
+    uint8_t* blob;             // owned by the result that captured it
+} hh_emitted;
+
+typedef enum hh_ter {
+    HH_TES_SUCCESS = 0,
+    HH_TEC_HOOK_REJECTED = 153,
+    HH_TEC_UNFUNDED = 104,
+    HH_TEC_NO_LINE = 135,
+    HH_TEC_NO_DST = 124,
+    HH_TEF_MALFORMED = -100
+} hh_ter;
+
+// Why an installed hook did not run for a transaction.
+typedef enum hh_skip_reason {
+    HH_SKIP_HOOK_SKIP,         // an earlier hook in the chain called hook_skip
+    HH_SKIP_HOOKON,            // HookOn excludes the transaction type
+    HH_SKIP_UNREACHED          // an earlier hook rolled back
+} hh_skip_reason;
+
+typedef struct hh_skipped {
+    const hh_hook_def* def;
+    uint8_t account[20];
+    int position;
+    hh_skip_reason reason;
+} hh_skipped;
+
+typedef struct hh_result {
+    hh_ter ter;
+    uint8_t txid[32];
+    uint32_t generation;
+    int exec_count;
+    hh_exec execs[2 * HH_MAX_CHAIN];
+    int skipped_count;
+    hh_skipped skipped[2 * HH_MAX_CHAIN];
+    int emitted_count;
+    int emitted_cap;
+    hh_emitted* emitted;
+} hh_result;
+
+typedef struct hh_ledger hh_ledger;
+
+// One state, hook_param or otxn_param call, reported to the ledger's
+// access hook.
+typedef struct hh_access {
+    const hh_exec* exec;       // the execution making the call
+    uint64_t serial;           // numbers executions, unique per process
+    enum hh_api api;           // HH_API_STATE .. HH_API_STATE_FOREIGN_SET, HH_API_HOOK_PARAM or HH_API_OTXN_PARAM
+    const uint8_t* account;    // 20 bytes; NULL for hook_param or bad arguments
+    const uint8_t* ns;         // 32 bytes; NULL as above
+    const uint8_t* key;        // key or parameter name as the hook passed it
+    uint32_t key_len;
+    uint32_t size;             // buffer size for reads, bytes written for writes
+    int64_t result;
+    int unchanged;             // a write that stored the value already there
+} hh_access;
+
+typedef void (*hh_access_cb)(void* ctx, const hh_access* a);
+
+// Runs fn on a stack mapped below 4GB and returns its result.
+int hh_run(int (*fn)(int, char**), int argc, char** argv);
+
+hh_ledger* hh_ledger_new(uint32_t seq, uint32_t close_time);
+void hh_ledger_free(hh_ledger* l);
+uint32_t hh_ledger_seq(const hh_ledger* l);
+uint32_t hh_ledger_time(const hh_ledger* l);
+void hh_ledger_trace(hh_ledger* l, int enabled);
+// With 0, hook_skip still succeeds but the hook it names runs anyway,
+// which shows what the skip saves. On by default.
+void hh_ledger_hook_skip(hh_ledger* l, int enabled);
+// Reports every state/hook_param call to cb; NULL turns it off.
+void hh_ledger_on_access(hh_ledger* l, hh_access_cb cb, void* ctx);
+
+// Applies queued emitted transactions as the next ledger; each one is
+// reported through cb when given. Returns the number applied.
+int hh_ledger_close(hh_ledger* l, void (*cb)(void*, const hh_result*), void* ctx);
+size_t hh_ledger_pending(const hh_ledger* l);
+
+void hh_account_id(const char* name, uint8_t out[20]);
+int hh_account_create(hh_ledger* l, const uint8_t id[20], uint64_t drops);
+int hh_account_exists(const hh_ledger* l, const uint8_t id[20]);
+uint64_t hh_account_balance(const hh_ledger* l, const uint8_t id[20]);
+uint32_t hh_account_owner_count(const hh_ledger* l, const uint8_t id[20]);
+void hh_account_set_scale(hh_ledger* l, const uint8_t id[20], uint16_t scale);
+
+int hh_trustline_set(hh_ledger* l, const uint8_t holder[20], const uint8_t issuer[20],
+                     const uint8_t currency[20], int64_t limit_xfl);
+// Holder's balance as XFL, or DOESNT_EXIST.
+int64_t hh_trustline_balance(const hh_ledger* l, const uint8_t holder[20],
+                             const uint8_t issuer[20], const uint8_t currency[20]);
+
+int hh_hook_set(hh_ledger* l, const uint8_t account[20], int position,
+                const hh_hook_def* def, const hh_hook_opts* opts);
+void hh_grant(hh_ledger* l, const uint8_t grantor[20], const uint8_t hook_hash[32]);
+// Hash of the hook installed at position, 0 when there is one.
+int hh_hook_hash(const hh_ledger* l, const uint8_t account[20], int position, uint8_t out[32]);
+
+// Writes a state entry directly, as if a hook had set it earlier.
+int hh_state_set(hh_ledger* l, const uint8_t account[20], const uint8_t ns[32], const uint8_t* key,
+                 uint32_t key_len, const uint8_t* data, uint32_t len);
+int64_t hh_state_get(const hh_ledger* l, const uint8_t account[20], const uint8_t ns[32],
+                     const uint8_t* key, uint32_t key_len, uint8_t* out, uint32_t out_len);
+size_t hh_state_count(const hh_ledger* l);
+
+void hh_result_init(hh_result* r);
+void hh_result_free(hh_result* r);
+void hh_result_reset(hh_result* r);
+
+int hh_submit(hh_ledger* l, const hh_txn* txn, hh_result* r);
+
+// Totals since the ledger was created.
+typedef struct hh_totals {
+    uint64_t txns;
+    uint64_t emitted;
+    uint64_t executions;
+    uint64_t fee_burned;
+} hh_totals;
+
+const hh_totals* hh_ledger_totals(const hh_ledger* l);
+
+// The fee-relevant fields of a serialized transaction, e.g. an
+// emitted blob.
+typedef struct hh_txn_info {
+    uint16_t type;
+    uint32_t len;
+    uint64_t fee;              // drops
+    uint64_t burden;           // EmitBurden, 1 without EmitDetails
+    uint32_t generation;
+    int iou;                   // sfAmount is an IOU
+    int amount_count;          // Remit Amounts entries
+    int iou_amounts;           // of which IOUs
+} hh_txn_info;
+
+int hh_txn_inspect(const uint8_t* blob, uint32_t len, hh_txn_info* out);
+
+// While map is set, every hook execution also counts the edges between
+// the basic blocks it runs into map (1 << HH_COVERAGE_BITS counters,
+// wrapping). Needs HH_METER; NULL stops recording.
+#define HH_COVERAGE_BITS 16
+void hh_coverage(uint8_t* map);
+
+// Helpers shared by the tools.
+void hh_txn_init(hh_txn* t, uint16_t type, const uint8_t account[20]);
+int hh_txn_param(hh_txn* t, const char* name, const void* value, uint32_t len);
+void hh_amount_drops(hh_amount* a, uint64_t drops);
+void hh_amount_iou(hh_amount* a, int64_t xfl, const uint8_t currency[20], const uint8_t issuer[20]);
+int hh_currency(const char* code, uint8_t out[20]);
+int hh_hex(const char* hex, uint8_t* out, uint32_t max);
+void hh_sha512h(const void* data, size_t len, uint8_t out[32]);
+int64_t hh_xfl_parse(const char* decimal);
+void hh_xfl_format(int64_t xfl, char* out, size_t len);
+const char* hh_ter_name(hh_ter ter);
+
+#endif
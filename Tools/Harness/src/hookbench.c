@@ -0,0 +1,271 @@
+//**************************************************************
+// hookbench - HandyHooks execution cost table
+//
+// Description:
+//   Runs benchmark scenarios through the native harness and reports
+//   the cost of every labelled path (the scenario `path` command):
+//   basic blocks of hook code executed (src/meter.c), host calls,
+//   guard iterations and emitted transactions, averaged per result.
+//   The costs are compared against a stored baseline so a change to a
+//   hook shows up as a per-path delta.
+//
+//   Fee units approximate what Xahau charges per execution: one unit
+//   per block plus CALL_WEIGHT units per host call (guards excluded).
+//   Blocks stand in for WASM instructions, so the units are meant for
+//   comparing revisions of the same hook, not for quoting drops.
+//
+// Usage:
+//   hookbench [-v] [-u] [-b baseline.tsv] scenario.txt...
+//     -v  break every path down per hook
+//     -u  rewrite the baseline with this run
+//     -b  baseline file (default bench/baseline.tsv)
+//**************************************************************
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scenario.h"
+
+#define CALL_WEIGHT 20
+#define MAX_PATHS 256
+#define MAX_PATH_HOOKS 8
+
+#ifndef HH_BENCH_BASELINE
+#define HH_BENCH_BASELINE "bench/baseline.tsv"
+#endif
+
+typedef struct cost {
+    double blocks;
+    double calls;
+    double guards;
+    double emitted;
+} cost;
+
+typedef struct path_hook {
+    const hh_hook_def* def;
+    uint64_t runs;
+    cost total;
+} path_hook;
+
+typedef struct path_row {
+    char label[HH_MAX_PATH_LABEL];
+    uint64_t results;
+    cost total;
+    int hook_count;
+    path_hook hooks[MAX_PATH_HOOKS];
+    int in_baseline;
+    cost base;
+} path_row;
+
+static path_row rows[MAX_PATHS];
+static int row_count;
+
+static double units(const cost* c)
+{
+    return c->blocks + CALL_WEIGHT * c->calls;
+}
+
+static path_row* row_for(const char* label)
+{
+    for (int i = 0; i < row_count; ++i)
+        if (!strcmp(rows[i].label, label))
+            return &rows[i];
+    if (row_count == MAX_PATHS)
+        return NULL;
+    path_row* r = &rows[row_count++];
+    snprintf(r->label, sizeof(r->label), "%s", label);
+    return r;
+}
+
+static void add_exec(cost* c, const hh_exec* e)
+{
+    uint64_t calls = 0;
+    for (int a = 0; a < HH_API_COUNT; ++a)
+        if (a != HH_API_GUARD)
+            calls += e->calls[a];
+    c->blocks += (double)e->blocks;
+    c->calls += (double)calls;
+    c->guards += (double)e->guard_iterations;
+    c->emitted += e->emitted;
+}
+
+static void on_result(hh_scenario* s, const char* label, const hh_result* r)
+{
+    (void)s;
+    if (!label[0])
+        return;
+    path_row* row = row_for(label);
+    if (!row)
+        return;
+    row->results++;
+    for (int i = 0; i < r->exec_count; ++i) {
+        const hh_exec* e = &r->execs[i];
+        add_exec(&row->total, e);
+        path_hook* h = NULL;
+        for (int k = 0; k < row->hook_count && !h; ++k)
+            if (row->hooks[k].def == e->def)
+                h = &row->hooks[k];
+        if (!h && row->hook_count < MAX_PATH_HOOKS) {
+            h = &row->hooks[row->hook_count++];
+            h->def = e->def;
+        }
+        if (h) {
+            h->runs++;
+            add_exec(&h->total, e);
+        }
+    }
+}
+
+static cost average(const cost* c, uint64_t n)
+{
+    cost a = *c;
+    if (n) {
+        a.blocks /= (double)n;
+        a.calls /= (double)n;
+        a.guards /= (double)n;
+        a.emitted /= (double)n;
+    }
+    return a;
+}
+
+static void read_baseline(const char* file)
+{
+    FILE* f = fopen(file, "r");
+    if (!f)
+        return;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+        char label[HH_MAX_PATH_LABEL];
+        cost c;
+        if (sscanf(line, "%63s %lf %lf %lf %lf", label, &c.blocks, &c.calls, &c.guards, &c.emitted) != 5)
+            continue;
+        path_row* r = NULL;
+        for (int i = 0; i < row_count && !r; ++i)
+            if (!strcmp(rows[i].label, label))
+                r = &rows[i];
+        if (!r && row_count < MAX_PATHS) {
+            // a path the scenarios no longer reach
+            r = &rows[row_count++];
+            snprintf(r->label, sizeof(r->label), "%s", label);
+        }
+        if (r) {
+            r->in_baseline = 1;
+            r->base = c;
+        }
+    }
+    fclose(f);
+}
+
+static int write_baseline(const char* file)
+{
+    FILE* f = fopen(file, "w");
+    if (!f) {
+        perror(file);
+        return -1;
+    }
+    fprintf(f, "# hookbench baseline: per-result averages of each path\n");
+    fprintf(f, "# path\tblocks\tcalls\tguards\temitted\n");
+    for (int i = 0; i < row_count; ++i) {
+        if (!rows[i].results)
+            continue;
+        cost a = average(&rows[i].total, rows[i].results);
+        fprintf(f, "%s\t%.1f\t%.1f\t%.1f\t%.1f\n", rows[i].label, a.blocks, a.calls, a.guards, a.emitted);
+    }
+    fclose(f);
+    return 0;
+}
+
+static void print_cost(const char* label, double n, const cost* a)
+{
+    printf("%-36s %6.0f %9.1f %7.1f %7.1f %5.1f %10.1f", label, n, a->blocks, a->calls, a->guards,
+           a->emitted, units(a));
+}
+
+static void print_table(int per_hook)
+{
+    printf("%-36s %6s %9s %7s %7s %5s %10s  %s\n", "path", "runs", "blocks", "calls", "guards", "emit",
+           "fee units", "vs baseline");
+    double now_sum = 0, base_sum = 0;
+    for (int i = 0; i < row_count; ++i) {
+        path_row* r = &rows[i];
+        if (!r->results) {
+            printf("%-36s %6s %9s %7s %7s %5s %10s  gone (was %.1f)\n", r->label, "-", "-", "-", "-", "-", "-",
+                   units(&r->base));
+            continue;
+        }
+        cost a = average(&r->total, r->results);
+        print_cost(r->label, (double)r->results, &a);
+        if (r->in_baseline) {
+            double was = units(&r->base), d = units(&a) - was;
+            now_sum += units(&a);
+            base_sum += was;
+            if (fabs(d) < 0.05)
+                printf("  =\n");
+            else
+                printf("  %+.1f (%+.1f%%)\n", d, was > 0 ? 100.0 * d / was : 0.0);
+        } else
+            printf("  new\n");
+        for (int k = 0; per_hook && k < r->hook_count; ++k) {
+            cost h = average(&r->hooks[k].total, r->results);
+            char name[HH_MAX_PATH_LABEL];
+            snprintf(name, sizeof(name), "  %s", r->hooks[k].def->name);
+            print_cost(name, (double)r->hooks[k].runs, &h);
+            putchar('\n');
+        }
+    }
+    if (base_sum > 0)
+        printf("\ncompared paths: %.1f fee units, baseline %.1f (%+.1f%%)\n", now_sum, base_sum,
+               100.0 * (now_sum - base_sum) / base_sum);
+}
+
+static int run(int argc, char** argv)
+{
+    const char* baseline = HH_BENCH_BASELINE;
+    int update = 0, per_hook = 0, files = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-u"))
+            update = 1;
+        else if (!strcmp(argv[i], "-v"))
+            per_hook = 1;
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+            baseline = argv[++i];
+        else {
+            FILE* in = fopen(argv[i], "r");
+            if (!in) {
+                perror(argv[i]);
+                return 2;
+            }
+            hh_scenario s;
+            hh_scenario_init(&s);
+            s.verbose = 0;
+            s.on_result = on_result;
+            int failures = hh_scenario_run(&s, in, argv[i]);
+            fclose(in);
+            hh_scenario_free(&s);
+            if (failures)
+                return 1;
+            files++;
+        }
+    }
+    if (!files) {
+        fprintf(stderr, "usage: hookbench [-v] [-u] [-b baseline.tsv] scenario.txt...\n");
+        return 2;
+    }
+    read_baseline(baseline);
+    print_table(per_hook);
+    if (update) {
+        if (write_baseline(baseline) != 0)
+            return 1;
+        printf("baseline written to %s\n", baseline);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    return hh_run(run, argc, argv);
+}
@@ -0,0 +1,261 @@
+//**************************************************************
+// hookchain - HandyHooks hook chain profiler
+//
+// Description:
+//   Profiles whole hook chains per originating transaction, grouped
+//   by transaction class: direction, XAH/IOU payment, invoke or remit,
+//   and the first transaction parameter, e.g. "in XAH WP_LNK",
+//   "in invoke R_CLAIM", "out XAH". Emitted transactions applied by
+//   close form their own class.
+//
+//   Per class and hook it counts the runs, the times the hook was
+//   skipped by an earlier hook's hook_skip, excluded by HookOn or not
+//   reached after a rollback, and what each run cost in basic blocks
+//   and state operations. A run is idle when the hook accepted without
+//   writing state or emitting: the chain paid for it and got nothing.
+//
+//   The scenarios are then run again with hook_skip disabled, so every
+//   hook the router skips runs as well. The difference in blocks per
+//   transaction is what hook_skip saves for the class.
+//
+// Usage:
+//   hookchain scenario.txt...
+//**************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scenario.h"
+
+#define TT_PAYMENT 0
+#define TT_INVOKE 99
+#define TT_REMIT 95
+
+#define MAX_CLASSES 64
+#define MAX_HOOKS 16           // per class
+#define MAX_CLASS_LABEL 64
+
+typedef struct hook_row {
+    const hh_hook_def* def;
+    int position;
+    uint64_t runs;
+    uint64_t idle;
+    uint64_t skipped;
+    uint64_t hookon;
+    uint64_t unreached;
+    uint64_t blocks;
+    uint64_t state_ops;
+} hook_row;
+
+typedef struct class_row {
+    char label[MAX_CLASS_LABEL];
+    uint64_t txns[2];          // with hook_skip, without
+    uint64_t blocks[2];
+    uint64_t state_ops[2];
+    uint64_t rejected[2];
+    int hook_count;
+    hook_row hooks[MAX_HOOKS];
+} class_row;
+
+static class_row classes[MAX_CLASSES];
+static int class_count;
+static int pass;               // 0 = hook_skip applied, 1 = ignored
+static int unskipped_failures;
+
+static class_row* class_for(const char* label)
+{
+    for (int i = 0; i < class_count; ++i)
+        if (!strcmp(classes[i].label, label))
+            return &classes[i];
+    if (class_count == MAX_CLASSES)
+        return NULL;
+    class_row* c = &classes[class_count++];
+    snprintf(c->label, sizeof(c->label), "%s", label);
+    return c;
+}
+
+static hook_row* hook_for(class_row* c, const hh_hook_def* def, int position)
+{
+    for (int i = 0; i < c->hook_count; ++i)
+        if (c->hooks[i].def == def && c->hooks[i].position == position)
+            return &c->hooks[i];
+    if (c->hook_count == MAX_HOOKS)
+        return NULL;
+    hook_row* h = &c->hooks[c->hook_count++];
+    h->def = def;
+    h->position = position;
+    return h;
+}
+
+// The account whose chain the result describes.
+static const uint8_t* chain_account(const hh_result* r)
+{
+    if (r->exec_count)
+        return r->execs[0].account;
+    if (r->skipped_count)
+        return r->skipped[0].account;
+    return NULL;
+}
+
+static void classify(const hh_txn* t, const hh_result* r, char* out, size_t cap)
+{
+    if (!t) {
+        snprintf(out, cap, "emitted (gen %u)", r->generation);
+        return;
+    }
+    const uint8_t* acc = chain_account(r);
+    const char* dir = acc && !memcmp(acc, t->account, 20) ? "out" : "in";
+    const char* what;
+    char other[16];
+    if (t->type == TT_PAYMENT)
+        what = t->amount.native ? "XAH" : "IOU";
+    else if (t->type == TT_INVOKE)
+        what = "invoke";
+    else if (t->type == TT_REMIT)
+        what = "remit";
+    else {
+        snprintf(other, sizeof(other), "tt %u", t->type);
+        what = other;
+    }
+    if (t->param_count)
+        snprintf(out, cap, "%s %s %.*s", dir, what, (int)t->params[0].name_len, (const char*)t->params[0].name);
+    else
+        snprintf(out, cap, "%s %s", dir, what);
+}
+
+static uint64_t state_ops(const hh_exec* e)
+{
+    return e->calls[HH_API_STATE] + e->calls[HH_API_STATE_SET] + e->calls[HH_API_STATE_FOREIGN] +
+           e->calls[HH_API_STATE_FOREIGN_SET];
+}
+
+static void on_result(hh_scenario* s, const char* path, const hh_result* r)
+{
+    (void)path;
+    if (!r->exec_count && !r->skipped_count)
+        return;
+    char label[MAX_CLASS_LABEL];
+    classify(s->txn, r, label, sizeof(label));
+    class_row* c = class_for(label);
+    if (!c)
+        return;
+    c->txns[pass]++;
+    if (r->ter == HH_TEC_HOOK_REJECTED)
+        c->rejected[pass]++;
+    for (int i = 0; i < r->exec_count; ++i) {
+        const hh_exec* e = &r->execs[i];
+        c->blocks[pass] += e->blocks;
+        c->state_ops[pass] += state_ops(e);
+        hook_row* h = pass == 0 ? hook_for(c, e->def, e->position) : NULL;
+        if (!h)
+            continue;
+        h->runs++;
+        h->blocks += e->blocks;
+        h->state_ops += state_ops(e);
+        if (e->exit == HH_EXIT_ACCEPT && !e->emitted && !e->calls[HH_API_STATE_SET] &&
+            !e->calls[HH_API_STATE_FOREIGN_SET])
+            h->idle++;
+    }
+    for (int i = 0; pass == 0 && i < r->skipped_count; ++i) {
+        const hh_skipped* k = &r->skipped[i];
+        hook_row* h = hook_for(c, k->def, k->position);
+        if (!h)
+            continue;
+        if (k->reason == HH_SKIP_HOOK_SKIP)
+            h->skipped++;
+        else if (k->reason == HH_SKIP_HOOKON)
+            h->hookon++;
+        else
+            h->unreached++;
+    }
+}
+
+static int run_pass(int p, int argc, char** argv)
+{
+    pass = p;
+    for (int i = 1; i < argc; ++i) {
+        FILE* in = fopen(argv[i], "r");
+        if (!in) {
+            perror(argv[i]);
+            return -1;
+        }
+        hh_scenario s;
+        hh_scenario_init(&s);
+        s.verbose = 0;
+        s.no_skip = p;
+        s.keep_going = p;      // hooks the router skips may change what the script expects
+        s.on_result = on_result;
+        int failures = hh_scenario_run(&s, in, argv[i]);
+        hh_scenario_free(&s);
+        fclose(in);
+        if (failures && p == 0)
+            return -1;
+        unskipped_failures += failures;
+    }
+    return 0;
+}
+
+static double per(uint64_t n, uint64_t d)
+{
+    return d ? (double)n / (double)d : 0.0;
+}
+
+static void print_class(const class_row* c)
+{
+    double with = per(c->blocks[0], c->txns[0]), without = per(c->blocks[1], c->txns[1]);
+    printf("%s: %llu txns, %.1f blocks and %.1f state ops per txn\n", c->label, (unsigned long long)c->txns[0],
+           with, per(c->state_ops[0], c->txns[0]));
+    // a chain that rolls back early costs less, so only compare like with like
+    if (c->rejected[0] != c->rejected[1])
+        printf("  without hook_skip: %llu of %llu rejected instead of %llu\n", (unsigned long long)c->rejected[1],
+               (unsigned long long)c->txns[1], (unsigned long long)c->rejected[0]);
+    else if (c->txns[1] && without != with)
+        printf("  without hook_skip: %.1f blocks per txn, hook_skip saves %.1f%%\n", without,
+               without ? 100.0 * (without - with) / without : 0.0);
+    printf("  %-24s %3s %6s %6s %8s %7s %10s %11s %10s\n", "hook", "pos", "runs", "idle", "skipped", "hookon",
+           "unreached", "blocks/run", "state/run");
+    for (int i = 0; i < c->hook_count; ++i) {
+        const hook_row* h = &c->hooks[i];
+        printf("  %-24s %3d %6llu %6llu %8llu %7llu %10llu %11.1f %10.1f\n", h->def->name, h->position,
+               (unsigned long long)h->runs, (unsigned long long)h->idle, (unsigned long long)h->skipped,
+               (unsigned long long)h->hookon, (unsigned long long)h->unreached, per(h->blocks, h->runs),
+               per(h->state_ops, h->runs));
+    }
+    printf("\n");
+}
+
+static int run(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-') {
+        fprintf(stderr, "usage: hookchain scenario.txt...\n");
+        return 2;
+    }
+    if (run_pass(0, argc, argv) != 0)
+        return 1;
+    fprintf(stderr, "hookchain: running again without hook_skip\n");
+    if (run_pass(1, argc, argv) != 0)
+        return 1;
+
+    uint64_t blocks[2] = {0}, txns = 0;
+    for (int i = 0; i < class_count; ++i) {
+        print_class(&classes[i]);
+        blocks[0] += classes[i].blocks[0];
+        blocks[1] += classes[i].blocks[1];
+        txns += classes[i].txns[0];
+    }
+    printf("total: %llu txns, %llu blocks, %llu without hook_skip", (unsigned long long)txns,
+           (unsigned long long)blocks[0], (unsigned long long)blocks[1]);
+    if (blocks[1])
+        printf(", hook_skip saves %.1f%%", 100.0 * ((double)blocks[1] - (double)blocks[0]) / (double)blocks[1]);
+    printf("\n");
+    if (unskipped_failures)
+        printf("without hook_skip %d expectation(s) fail: the chain relies on the skips, not only for cost\n",
+               unskipped_failures);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    return hh_run(run, argc, argv);
+}
@@ -0,0 +1,227 @@
+//**************************************************************
+// hookcodes - HandyHooks result code table
+//
+// Description:
+//   Preprocesses every registered hook with HOOK_RESULT_CATALOG, which
+//   turns each RESULT_ACCEPT / RESULT_ROLLBACK (Common/ResultCode.h)
+//   into a marker carrying its hook id, source line and message, and
+//   writes one row per result:
+//
+//     code     exit code of a -DHOOK_RESULT_CODES build,
+//              (hook id << 16) | line
+//     hook     registry name
+//     line     source line of the result
+//     result   accept or rollback
+//     message  the string a default build returns
+//
+//   Two results on one source line would share a code; they are
+//   reported and the tool exits 1.
+//
+// Usage:
+//   hookcodes [-o result_codes.tsv] [HookName...]
+//**************************************************************
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+
+#ifndef HH_CC
+#define HH_CC "cc"
+#endif
+#ifndef HH_HOOKAPI_DIR
+#define HH_HOOKAPI_DIR "hookapi"
+#endif
+#ifndef HH_ROOT
+#define HH_ROOT "."
+#endif
+
+#define MARKER "__hook_result"
+#define KIND_ACCEPT 1 // RESULT_KIND_ACCEPT in Common/ResultCode.h
+
+typedef struct result_row {
+    long code;
+    const char* hook;
+    long line;
+    long kind;
+    char* message;
+} result_row;
+
+static result_row* rows;
+static int row_count;
+
+static char* preprocess(const char* path)
+{
+    char cmd[8192];
+    snprintf(cmd, sizeof(cmd), "\"%s\" -E -P -w -DHOOK_RESULT_CATALOG -I\"%s\" \"%s\"", HH_CC, HH_HOOKAPI_DIR,
+             path);
+    FILE* p = popen(cmd, "r");
+    if (!p)
+        return NULL;
+    size_t len = 0, cap = 1 << 16;
+    char* out = malloc(cap);
+    size_t n;
+    while ((n = fread(out + len, 1, cap - len - 1, p)) > 0) {
+        len += n;
+        if (cap - len < 4096)
+            out = realloc(out, cap *= 2);
+    }
+    out[len] = 0;
+    if (pclose(p) != 0) {
+        free(out);
+        return NULL;
+    }
+    return out;
+}
+
+static const char* skip_space(const char* p)
+{
+    while (isspace((unsigned char)*p))
+        ++p;
+    return p;
+}
+
+// "a" "b" concatenated, escapes kept as written. Anything else up to
+// the closing parenthesis is copied as is.
+static char* read_message(const char** pp)
+{
+    const char* p = skip_space(*pp);
+    size_t cap = 256, len = 0;
+    char* msg = malloc(cap);
+    while (*p == '"') {
+        for (++p; *p && *p != '"'; ++p) {
+            if (*p == '\\' && p[1])
+                msg[len++] = *p++;
+            msg[len++] = *p;
+            if (cap - len < 4)
+                msg = realloc(msg, cap *= 2);
+        }
+        if (*p == '"')
+            ++p;
+        p = skip_space(p);
+    }
+    int depth = 0;
+    while (*p && (depth || *p != ')')) {
+        depth += *p == '(';
+        depth -= *p == ')';
+        if (!isspace((unsigned char)*p) || (len && msg[len - 1] != ' '))
+            msg[len++] = isspace((unsigned char)*p) ? ' ' : *p;
+        if (cap - len < 4)
+            msg = realloc(msg, cap *= 2);
+        ++p;
+    }
+    msg[len] = 0;
+    *pp = p;
+    return msg;
+}
+
+static int scan_hook(const hh_hook_def* def)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", HH_ROOT, def->source);
+    char* src = preprocess(path);
+    if (!src) {
+        fprintf(stderr, "hookcodes: cannot preprocess %s\n", path);
+        return -1;
+    }
+    int found = 0;
+    for (const char* p = strstr(src, MARKER); p; p = strstr(p, MARKER)) {
+        p = skip_space(p + strlen(MARKER));
+        if (*p != '(')
+            continue;
+        char* end;
+        long kind = strtol(p + 1, &end, 0);
+        p = skip_space(end);
+        if (*p != ',')
+            continue;
+        long id = strtol(p + 1, &end, 0);
+        p = skip_space(end);
+        if (*p != ',')
+            continue;
+        long line = strtol(p + 1, &end, 0);
+        p = skip_space(end);
+        if (*p != ',')
+            continue;
+        ++p;
+        rows = realloc(rows, sizeof(result_row) * (size_t)(row_count + 1));
+        result_row* r = &rows[row_count++];
+        r->code = (id << 16) | line;
+        r->hook = def->name;
+        r->line = line;
+        r->kind = kind;
+        r->message = read_message(&p);
+        ++found;
+    }
+    free(src);
+    return found;
+}
+
+static int by_code(const void* a, const void* b)
+{
+    const result_row* x = a;
+    const result_row* y = b;
+    return (x->code > y->code) - (x->code < y->code);
+}
+
+static int wanted(const char* name, int argc, char** argv, int first)
+{
+    if (first >= argc)
+        return 1;
+    for (int i = first; i < argc; ++i)
+        if (!strcmp(argv[i], name))
+            return 1;
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    const char* out_path = NULL;
+    int first = 1;
+    if (argc > 2 && !strcmp(argv[1], "-o")) {
+        out_path = argv[2];
+        first = 3;
+    }
+
+    int status = 0;
+    for (size_t i = 0; i < hh_hook_count; ++i) {
+        if (!wanted(hh_hooks[i].name, argc, argv, first))
+            continue;
+        int n = scan_hook(&hh_hooks[i]);
+        if (n < 0)
+            status = 1;
+        else if (n == 0)
+            fprintf(stderr, "hookcodes: %s has no RESULT_ACCEPT/RESULT_ROLLBACK\n", hh_hooks[i].name);
+    }
+    qsort(rows, (size_t)row_count, sizeof(result_row), by_code);
+
+    // one code, one result: the same line used twice is ambiguous
+    for (int i = 1; i < row_count; ++i)
+        if (rows[i].code == rows[i - 1].code && strcmp(rows[i].message, rows[i - 1].message)) {
+            fprintf(stderr, "hookcodes: %s line %ld has more than one result\n", rows[i].hook, rows[i].line);
+            status = 1;
+        }
+
+    FILE* out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        perror(out_path);
+        return 1;
+    }
+    fprintf(out, "# code\thook\tline\tresult\tmessage\n");
+    for (int i = 0; i < row_count; ++i) {
+        if (i && rows[i].code == rows[i - 1].code && !strcmp(rows[i].message, rows[i - 1].message))
+            continue;
+        fprintf(out, "%ld\t%s\t%ld\t%s\t%s\n", rows[i].code, rows[i].hook, rows[i].line,
+                rows[i].kind == KIND_ACCEPT ? "accept" : "rollback", rows[i].message);
+    }
+    if (out_path) {
+        fclose(out);
+        printf("hookcodes: %d results written to %s\n", row_count, out_path);
+    }
+
+    for (int i = 0; i < row_count; ++i)
+        free(rows[i].message);
+    free(rows);
+    return status;
+}
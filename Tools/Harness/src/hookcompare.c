@@ -0,0 +1,306 @@
+//**************************************************************
+// hookcompare - HandyHooks variant comparison
+//
+// Description:
+//   Runs the same scenarios twice: once with the hooks they name (A)
+//   and once with every paired hook swapped for its variant (B), e.g.
+//   IDOMaster=IDOMulti. Per labelled path it reports basic blocks run,
+//   state operations and emitted bytes for both, then checks result by
+//   result that the variants agree: the same ter, every hook in the
+//   chain accepting or rolling back alike, and byte-identical emitted
+//   transactions. Results are paired by path, so a path only one side
+//   reached (a hook-specific scenario, or a run cut short) is listed as
+//   not run by the other and left out of the totals. Exits 1 when the
+//   paired results disagree or B fails expectations A passed.
+//
+// Usage:
+//   hookcompare [-v] -p A=B [-p A=B]... scenario.txt...
+//     -v  list every mismatching result, not only the first per path
+//**************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scenario.h"
+
+#define MAX_PATHS 256
+#define MAX_MISMATCH_SHOWN 1   // per path without -v
+
+typedef struct outcome {
+    char path[HH_MAX_PATH_LABEL];
+    hh_ter ter;
+    int exec_count;
+    int position[2 * HH_MAX_CHAIN];
+    hh_exit exit[2 * HH_MAX_CHAIN];
+    int emitted_count;
+    uint8_t emitted[HH_MAX_EMIT][32];   // sha512h of each blob
+} outcome;
+
+typedef struct side {
+    uint64_t results;
+    uint64_t blocks;
+    uint64_t state_ops;
+    uint64_t emitted;
+    uint64_t emitted_bytes;
+} side;
+
+typedef struct path_row {
+    char label[HH_MAX_PATH_LABEL];
+    side v[2];
+    uint64_t mismatches;
+} path_row;
+
+typedef struct run_log {
+    outcome* items;
+    size_t count;
+    size_t cap;
+    int failures;
+} run_log;
+
+static path_row rows[MAX_PATHS];
+static int row_count;
+static int variant;            // 0 = A, 1 = B
+static run_log logs[2];
+
+static path_row* row_for(const char* label)
+{
+    if (!label[0])
+        label = "(unlabelled)";
+    for (int i = 0; i < row_count; ++i)
+        if (!strcmp(rows[i].label, label))
+            return &rows[i];
+    if (row_count == MAX_PATHS)
+        return NULL;
+    path_row* r = &rows[row_count++];
+    snprintf(r->label, sizeof(r->label), "%s", label);
+    return r;
+}
+
+static void on_result(hh_scenario* s, const char* path, const hh_result* r)
+{
+    (void)s;
+    path_row* row = row_for(path);
+    if (row) {
+        side* v = &row->v[variant];
+        v->results++;
+        for (int i = 0; i < r->exec_count; ++i) {
+            const hh_exec* e = &r->execs[i];
+            v->blocks += e->blocks;
+            v->state_ops += e->calls[HH_API_STATE] + e->calls[HH_API_STATE_SET] + e->calls[HH_API_STATE_FOREIGN] +
+                            e->calls[HH_API_STATE_FOREIGN_SET];
+        }
+        v->emitted += (uint64_t)r->emitted_count;
+        for (int i = 0; i < r->emitted_count; ++i)
+            v->emitted_bytes += r->emitted[i].len;
+    }
+
+    run_log* log = &logs[variant];
+    if (log->count == log->cap) {
+        log->cap = log->cap ? log->cap * 2 : 256;
+        log->items = realloc(log->items, sizeof(outcome) * log->cap);
+    }
+    outcome* o = &log->items[log->count++];
+    snprintf(o->path, sizeof(o->path), "%s", path[0] ? path : "(unlabelled)");
+    o->ter = r->ter;
+    o->exec_count = r->exec_count;
+    for (int i = 0; i < r->exec_count; ++i) {
+        o->position[i] = r->execs[i].position;
+        o->exit[i] = r->execs[i].exit;
+    }
+    o->emitted_count = r->emitted_count < HH_MAX_EMIT ? r->emitted_count : HH_MAX_EMIT;
+    for (int i = 0; i < o->emitted_count; ++i)
+        hh_sha512h(r->emitted[i].blob, r->emitted[i].len, o->emitted[i]);
+}
+
+// Describes how a and b differ, or returns 0 when they agree.
+static int differs(const outcome* a, const outcome* b, char* why, size_t cap)
+{
+    if (a->ter != b->ter) {
+        snprintf(why, cap, "%s vs %s", hh_ter_name(a->ter), hh_ter_name(b->ter));
+        return 1;
+    }
+    if (a->exec_count != b->exec_count) {
+        snprintf(why, cap, "%d vs %d hook executions", a->exec_count, b->exec_count);
+        return 1;
+    }
+    for (int i = 0; i < a->exec_count; ++i)
+        if (a->position[i] != b->position[i] || a->exit[i] != b->exit[i]) {
+            snprintf(why, cap, "hook %d: %s vs %s", a->position[i], a->exit[i] == HH_EXIT_ACCEPT ? "accept" : "rollback",
+                     b->exit[i] == HH_EXIT_ACCEPT ? "accept" : "rollback");
+            return 1;
+        }
+    if (a->emitted_count != b->emitted_count) {
+        snprintf(why, cap, "%d vs %d emitted", a->emitted_count, b->emitted_count);
+        return 1;
+    }
+    for (int i = 0; i < a->emitted_count; ++i)
+        if (memcmp(a->emitted[i], b->emitted[i], 32) != 0) {
+            snprintf(why, cap, "emitted transaction %d differs", i);
+            return 1;
+        }
+    return 0;
+}
+
+static int run_variant(int v, char** scenarios, int count, char** from, char** to, int pair_count)
+{
+    variant = v;
+    int failures = 0;
+    for (int i = 0; i < count; ++i) {
+        FILE* in = fopen(scenarios[i], "r");
+        if (!in) {
+            perror(scenarios[i]);
+            return -1;
+        }
+        hh_scenario s;
+        hh_scenario_init(&s);
+        s.verbose = 0;
+        s.on_result = on_result;
+        for (int p = 0; v == 1 && p < pair_count; ++p)
+            hh_scenario_alias(&s, from[p], to[p]);
+        failures += hh_scenario_run(&s, in, scenarios[i]);
+        hh_scenario_free(&s);
+        fclose(in);
+    }
+    logs[v].failures = failures;
+    return 0;
+}
+
+// The next result of `path` in `log` from *at on, with *at left just
+// past it; NULL when there is none.
+static const outcome* next_in_path(const run_log* log, const char* path, size_t* at)
+{
+    while (*at < log->count) {
+        const outcome* o = &log->items[(*at)++];
+        if (!strcmp(o->path, path))
+            return o;
+    }
+    return NULL;
+}
+
+static void print_pct(uint64_t a, uint64_t b)
+{
+    if (a == b)
+        printf(" %7s", "=");
+    else if (!a)
+        printf(" %7s", "new");
+    else
+        printf(" %+6.1f%%", 100.0 * ((double)b - (double)a) / (double)a);
+}
+
+static int run(int argc, char** argv)
+{
+    char *from[HH_MAX_ALIASES], *to[HH_MAX_ALIASES];
+    char* scenarios[64];
+    int pair_count = 0, scenario_count = 0, verbose = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc && pair_count < HH_MAX_ALIASES) {
+            char* eq = strchr(argv[++i], '=');
+            if (!eq) {
+                fprintf(stderr, "hookcompare: bad pair %s\n", argv[i]);
+                return 2;
+            }
+            *eq = 0;
+            from[pair_count] = argv[i];
+            to[pair_count] = eq + 1;
+            if (!hh_hook_find(from[pair_count]) || !hh_hook_find(to[pair_count])) {
+                fprintf(stderr, "hookcompare: unknown hook in %s=%s\n", from[pair_count], to[pair_count]);
+                return 2;
+            }
+            pair_count++;
+        } else if (!strcmp(argv[i], "-v"))
+            verbose = 1;
+        else if (argv[i][0] != '-' && scenario_count < 64)
+            scenarios[scenario_count++] = argv[i];
+        else
+            pair_count = -1;
+    }
+    if (pair_count <= 0 || !scenario_count) {
+        fprintf(stderr, "usage: hookcompare [-v] -p A=B [-p A=B]... scenario.txt...\n");
+        return 2;
+    }
+
+    if (run_variant(0, scenarios, scenario_count, from, to, pair_count) != 0 ||
+        run_variant(1, scenarios, scenario_count, from, to, pair_count) != 0)
+        return 2;
+
+    printf("A:");
+    for (int p = 0; p < pair_count; ++p)
+        printf(" %s", from[p]);
+    printf("\nB:");
+    for (int p = 0; p < pair_count; ++p)
+        printf(" %s", to[p]);
+    printf("\n\n");
+
+    // outcomes path by path: the k-th result of a path in A against the
+    // k-th result of the same path in B
+    uint64_t mismatches = 0;
+    int missing[2] = {0, 0};
+    for (int r = 0; r < row_count; ++r) {
+        path_row* row = &rows[r];
+        if (!row->v[0].results || !row->v[1].results) {
+            missing[row->v[0].results ? 1 : 0]++;
+            continue;
+        }
+        size_t ia = 0, ib = 0;
+        const outcome *a, *b;
+        while ((a = next_in_path(&logs[0], row->label, &ia)) && (b = next_in_path(&logs[1], row->label, &ib))) {
+            char why[128];
+            if (!differs(a, b, why, sizeof(why)))
+                continue;
+            mismatches++;
+            if (verbose || row->mismatches < MAX_MISMATCH_SHOWN)
+                printf("mismatch %s (result %zu): %s\n", a->path, ia, why);
+            row->mismatches++;
+        }
+        if (row->v[0].results != row->v[1].results) {
+            printf("mismatch %s: A produced %llu results, B %llu\n", row->label,
+                   (unsigned long long)row->v[0].results, (unsigned long long)row->v[1].results);
+            mismatches++;
+            row->mismatches++;
+        }
+    }
+    if (logs[1].failures && !logs[0].failures)
+        printf("mismatch: B failed %d scenario expectation(s) that A passed\n", logs[1].failures);
+    if (mismatches || logs[1].failures)
+        printf("\n");
+
+    printf("%-32s %8s %8s %8s  %6s %6s  %7s %7s  %s\n", "path", "blocks A", "blocks B", "", "state A", "B",
+           "emit A", "emit B", "outcome");
+    side total[2] = {{0}};
+    for (int i = 0; i < row_count; ++i) {
+        const path_row* r = &rows[i];
+        if (!r->v[0].results || !r->v[1].results) {
+            printf("%-32s %8s %8s %8s  %6s %6s  %7s %7s  %s\n", r->label, "-", "-", "", "-", "-", "-", "-",
+                   r->v[0].results ? "not run by B" : "not run by A");
+            continue;
+        }
+        double ra = (double)r->v[0].results, rb = (double)r->v[1].results;
+        uint64_t ba = (uint64_t)(r->v[0].blocks / ra + 0.5), bb = (uint64_t)(r->v[1].blocks / rb + 0.5);
+        printf("%-32s %8llu %8llu", r->label, (unsigned long long)ba, (unsigned long long)bb);
+        print_pct(ba, bb);
+        printf("  %6.1f %6.1f  %7.1f %7.1f  %s\n", r->v[0].state_ops / ra, r->v[1].state_ops / rb,
+               r->v[0].emitted_bytes / ra, r->v[1].emitted_bytes / rb, r->mismatches ? "DIFFERS" : "same");
+        for (int v = 0; v < 2; ++v) {
+            total[v].blocks += r->v[v].blocks;
+            total[v].state_ops += r->v[v].state_ops;
+            total[v].emitted_bytes += r->v[v].emitted_bytes;
+        }
+    }
+    printf("%-32s %8llu %8llu", "total", (unsigned long long)total[0].blocks, (unsigned long long)total[1].blocks);
+    print_pct(total[0].blocks, total[1].blocks);
+    printf("  %6llu %6llu  %7llu %7llu\n", (unsigned long long)total[0].state_ops,
+           (unsigned long long)total[1].state_ops, (unsigned long long)total[0].emitted_bytes,
+           (unsigned long long)total[1].emitted_bytes);
+    if (missing[0] || missing[1])
+        printf("\n%d path(s) not run by B and %d not run by A, left out of the total\n", missing[1], missing[0]);
+
+    for (int v = 0; v < 2; ++v)
+        free(logs[v].items);
+    return mismatches || logs[1].failures > logs[0].failures ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    return hh_run(run, argc, argv);
+}
@@ -0,0 +1,243 @@
+//**************************************************************
+// hookfee - HandyHooks emitted-transaction fee model
+//
+// Description:
+//   Models what etxn_fee_base asks of the hand-built emit templates
+//   and what each user action burns in fees:
+//
+//     fee    = (HH_FEE_BASE + bytes * drops_per_byte) * burden
+//     burden = the emitting transaction's burden * etxn_reserve()
+//
+//   drops_per_byte is 0 on the harness, as in etxn_fee_base: the size
+//   of a template does not change its fee, the number of transactions
+//   reserved alongside it does. -b prices bytes too, to see what a
+//   size based schedule would make of a template.
+//
+//   The template table sizes the 278-byte IOU Payment (DailyRewards,
+//   BridgeReserve, AdminIssuance), PREPARE_PAYMENT_SIMPLE and the
+//   229-byte Remit plus its Amounts (IDOMaster, RewardsMaster). Then
+//   the scenarios are run, one labelled path per user action, and
+//   every emitted transaction's Fee is checked against the model. Per
+//   action it reports what was emitted and burned, and what the same
+//   action would burn with each Payment sent as a one-entry Remit
+//   and each Remit as one Payment per entry. Exits 1 when a Fee does
+//   not match the model.
+//
+// Usage:
+//   hookfee [-b drops_per_byte] scenario.txt...
+//**************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scenario.h"
+
+#define TT_PAYMENT 0
+#define TT_REMIT 95
+
+// Template sizes, as the hooks build them.
+#define PAYMENT_IOU_SIZE 278U  // Common/EmitTxn.h ETXN_PAYMENT_IOU_SIZE
+#define PAYMENT_XAH_SIZE 248U  // PREPARE_PAYMENT_SIMPLE_SIZE
+#define REMIT_BASE_SIZE 229U   // Common/EmitTxn.h ETXN_REMIT_BASE_SIZE
+#define REMIT_ARRAY_SIZE 3U    // sfAmounts header + end marker
+#define REMIT_IOU_ENTRY 52U    // sfAmountEntry, 49-byte IOU sfAmount, end marker
+#define REMIT_XAH_ENTRY 12U    // sfAmountEntry, 9-byte XAH sfAmount, end marker
+
+#define MAX_PATHS 256
+
+typedef struct template_row {
+    const char* name;
+    const char* type;
+    uint32_t bytes;
+    const char* used_by;
+} template_row;
+
+static const template_row templates[] = {
+    {"payment-iou", "Payment", PAYMENT_IOU_SIZE, "DailyRewards BridgeReserve AdminIssuance"},
+    {"payment-simple", "Payment", PAYMENT_XAH_SIZE, "PREPARE_PAYMENT_SIMPLE"},
+    {"remit-iou", "Remit", REMIT_BASE_SIZE + REMIT_ARRAY_SIZE + REMIT_IOU_ENTRY, "IDOMaster RewardsMaster"},
+    {"remit-2-iou", "Remit", REMIT_BASE_SIZE + REMIT_ARRAY_SIZE + 2 * REMIT_IOU_ENTRY, ""},
+    {"remit-xah", "Remit", REMIT_BASE_SIZE + REMIT_ARRAY_SIZE + REMIT_XAH_ENTRY, ""},
+};
+
+typedef struct path_row {
+    char label[HH_MAX_PATH_LABEL];
+    uint64_t results;
+    uint64_t origin_fee;
+    uint64_t emitted;
+    uint64_t bytes;
+    uint64_t burden;           // highest seen
+    uint64_t fee;              // Fee fields of the emitted transactions
+    uint64_t model;            // the model with -b
+    uint64_t alt_emitted;
+    uint64_t alt_model;
+    uint64_t mismatches;
+} path_row;
+
+static path_row rows[MAX_PATHS];
+static int row_count;
+static uint64_t per_byte;
+static int failed;
+
+static uint64_t model_fee(uint64_t bytes, uint64_t burden)
+{
+    return (HH_FEE_BASE + bytes * per_byte) * burden;
+}
+
+static path_row* row_for(const char* label)
+{
+    if (!label[0])
+        return NULL;
+    for (int i = 0; i < row_count; ++i)
+        if (!strcmp(rows[i].label, label))
+            return &rows[i];
+    if (row_count == MAX_PATHS)
+        return NULL;
+    path_row* r = &rows[row_count++];
+    snprintf(r->label, sizeof(r->label), "%s", label);
+    return r;
+}
+
+static const char* kind(const hh_txn_info* t)
+{
+    if (t->type == TT_REMIT)
+        return "Remit";
+    if (t->type == TT_PAYMENT)
+        return t->iou ? "IOU Payment" : "XAH Payment";
+    return "transaction";
+}
+
+static void on_result(hh_scenario* s, const char* path, const hh_result* r)
+{
+    (void)s;
+    path_row* row = row_for(path);
+    if (!row)
+        return;
+    row->results++;
+    if (r->generation == 0)
+        row->origin_fee += HH_FEE_BASE;
+
+    // the alternative templates for everything this result emitted
+    uint64_t alt_count = 0, alt_bytes = 0;
+    hh_txn_info* info = calloc((size_t)(r->emitted_count ? r->emitted_count : 1), sizeof(*info));
+    for (int i = 0; i < r->emitted_count; ++i) {
+        hh_txn_info* t = &info[i];
+        if (hh_txn_inspect(r->emitted[i].blob, r->emitted[i].len, t) != 0) {
+            printf("%s: emitted transaction %d does not parse\n", row->label, i);
+            row->mismatches++;
+            continue;
+        }
+        if (t->type == TT_REMIT) {
+            alt_count += (uint64_t)t->amount_count;
+            alt_bytes += (uint64_t)t->iou_amounts * PAYMENT_IOU_SIZE +
+                         (uint64_t)(t->amount_count - t->iou_amounts) * PAYMENT_XAH_SIZE;
+        } else {
+            alt_count++;
+            alt_bytes += REMIT_BASE_SIZE + REMIT_ARRAY_SIZE + (t->iou ? REMIT_IOU_ENTRY : REMIT_XAH_ENTRY);
+        }
+    }
+
+    for (int i = 0; i < r->emitted_count; ++i) {
+        const hh_txn_info* t = &info[i];
+        if (!t->len)
+            continue;
+        uint64_t expect = (uint64_t)HH_FEE_BASE * t->burden;
+        if (t->fee != expect) {
+            printf("%s: %s of %u bytes carries Fee %llu, etxn_fee_base model says %llu\n", row->label, kind(t),
+                   t->len, (unsigned long long)t->fee, (unsigned long long)expect);
+            row->mismatches++;
+        }
+        row->emitted++;
+        row->bytes += t->len;
+        row->fee += t->fee;
+        row->model += model_fee(t->len, t->burden);
+        if (t->burden > row->burden)
+            row->burden = t->burden;
+    }
+
+    // same etxn_reserve slack, one reservation per alternative emission
+    if (r->emitted_count && info[0].len) {
+        uint64_t n = (uint64_t)r->emitted_count;
+        uint64_t burden = info[0].burden * alt_count / n;
+        if (!burden)
+            burden = 1;
+        row->alt_emitted += alt_count;
+        row->alt_model += (HH_FEE_BASE * alt_count + alt_bytes * per_byte) * burden;
+    }
+    free(info);
+}
+
+static void print_templates(void)
+{
+    printf("fee = (%d + bytes * %llu) * burden, burden = parent burden * etxn_reserve\n\n", HH_FEE_BASE,
+           (unsigned long long)per_byte);
+    printf("%-16s %-8s %6s %9s %9s %9s  %s\n", "template", "type", "bytes", "burden 1", "burden 2", "burden 3",
+           "used by");
+    for (size_t i = 0; i < sizeof(templates) / sizeof(templates[0]); ++i) {
+        const template_row* t = &templates[i];
+        printf("%-16s %-8s %6u %9llu %9llu %9llu  %s\n", t->name, t->type, t->bytes,
+               (unsigned long long)model_fee(t->bytes, 1), (unsigned long long)model_fee(t->bytes, 2),
+               (unsigned long long)model_fee(t->bytes, 3), t->used_by);
+    }
+    printf("\n");
+}
+
+static void print_actions(void)
+{
+    printf("%-28s %5s %8s %9s %6s %8s %8s %8s %8s  %9s %8s\n", "action", "txns", "emit/txn", "bytes/txn", "burden",
+           "fee/txn", "origin", "burned", "model", "alt emit", "alt");
+    for (int i = 0; i < row_count; ++i) {
+        const path_row* r = &rows[i];
+        double n = r->results ? (double)r->results : 1.0;
+        printf("%-28s %5llu %8.1f %9.1f %6llu %8.1f %8.1f %8.1f %8.1f  %9.1f %8.1f%s\n", r->label,
+               (unsigned long long)r->results, r->emitted / n, r->bytes / n, (unsigned long long)r->burden,
+               r->fee / n, r->origin_fee / n, (r->fee + r->origin_fee) / n, r->model / n, r->alt_emitted / n,
+               r->alt_model / n, r->mismatches ? "  MISMATCH" : "");
+        if (r->mismatches)
+            failed = 1;
+    }
+}
+
+static int run(int argc, char** argv)
+{
+    int count = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-b") && i + 1 < argc)
+            per_byte = strtoull(argv[++i], NULL, 10);
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: hookfee [-b drops_per_byte] scenario.txt...\n");
+            return 2;
+        }
+    }
+
+    print_templates();
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-b")) {
+            ++i;
+            continue;
+        }
+        FILE* in = fopen(argv[i], "r");
+        if (!in) {
+            perror(argv[i]);
+            return 2;
+        }
+        hh_scenario s;
+        hh_scenario_init(&s);
+        s.verbose = 0;
+        s.on_result = on_result;
+        if (hh_scenario_run(&s, in, argv[i]) != 0)
+            failed = 1;
+        hh_scenario_free(&s);
+        fclose(in);
+        count++;
+    }
+    if (count)
+        print_actions();
+    return failed;
+}
+
+int main(int argc, char** argv)
+{
+    return hh_run(run, argc, argv);
+}
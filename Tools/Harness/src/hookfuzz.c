@@ -0,0 +1,842 @@
+//**************************************************************
+// hookfuzz - HandyHooks worst-case input search
+//
+// Description:
+//   Searches for the inputs that make a hook most expensive to run.
+//   Each input installs the hook on a fresh ledger with its own hook
+//   parameters and pre-existing state, then submits one transaction
+//   whose type (Payment, Invoke, Remit), direction, amount and
+//   parameters are mutated. Parameter values go up to 1024 bytes.
+//
+//   Inputs are scored by basic blocks run plus -w per state write, and
+//   kept when they reach new code (edge coverage from the meter, see
+//   hh_coverage) or raise the hook's best score. Parameter names, value
+//   sizes and state keys are learned from the hook's own hook_param,
+//   otxn_param and state calls, next to a seed list of the parameters
+//   the collection uses (WP_LNK, START, R_CLAIM, BA1, BP1, NOT, MSG...).
+//
+//   The ranked worst cases are written as scenarios, one file per hook
+//   (<out>/<Hook>.txt), which hookrun and hookbench replay as they are.
+//   A crash writes the input that caused it to <out>/<Hook>.crash.txt.
+//
+// Usage:
+//   hookfuzz [-n execs] [-k keep] [-w write_weight] [-s seed] [-o dir] [Hook...]
+//     -n  executions per hook (default 4000)
+//     -k  worst cases kept per hook (default 10)
+//     -w  blocks one state write counts as (default 100)
+//     Without hook names every registered hook is fuzzed.
+//**************************************************************
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "harness.h"
+
+#define TT_PAYMENT 0
+#define TT_REMIT 95
+#define TT_INVOKE 99
+
+#define MAX_STATE 16           // pre-existing state entries per input
+#define MAX_DICT 128           // learned names and keys per hook
+#define MAX_CORPUS 256
+#define MAX_KEEP 64
+#define MAX_PARAM_BYTES 3000   // per parameter list, so a scenario line stays under its limit
+#define COVERAGE_SIZE (1U << HH_COVERAGE_BITS)
+
+enum { ACC_HOOK, ACC_USER, ACC_ADMIN, ACC_OTHER, ACC_COUNT };
+static const char* const acc_names[ACC_COUNT] = {"hook", "user", "admin", "other"};
+static uint8_t acc_ids[ACC_COUNT][20];
+static uint8_t currency[20];
+
+// IOU values as the scenario prints them
+static const char* const iou_values[] = {"0.000001", "1", "20", "100", "1000", "2000", "1000000", "9999999999999999"};
+#define IOU_VALUES (sizeof(iou_values) / sizeof(iou_values[0]))
+
+static const char* const seed_params[] = {"WP_LNK", "START", "R_CLAIM", "BA1", "BP1", "NOT", "MSG",
+                                          "AMT", "DEST", "INT_RATE", "SET_INTERVAL", "REFUND"};
+#define SEED_PARAMS (sizeof(seed_params) / sizeof(seed_params[0]))
+
+typedef struct fstate {
+    uint8_t ns[32];
+    uint8_t key[32];
+    uint32_t key_len;
+    uint8_t value[HH_STATE_MAX];
+    uint32_t len;
+} fstate;
+
+typedef struct fcase {
+    uint32_t ledger_offset;
+    int hook_param_count;
+    hh_param hook_params[HH_MAX_PARAMS];
+    int state_count;
+    fstate state[MAX_STATE];
+    uint16_t type;
+    int from;
+    int to;
+    int amount;                // 0 none, 1 XAH, 2 IOU
+    uint64_t drops;
+    int iou_value;
+    int iou_issuer;            // ACC_HOOK or ACC_ADMIN
+    int param_count;
+    hh_param params[HH_MAX_PARAMS];
+} fcase;
+
+typedef struct fscore {
+    uint64_t score;
+    uint64_t blocks;
+    uint64_t writes;
+    uint64_t emitted;
+    hh_ter ter;
+} fscore;
+
+typedef struct entry {
+    fcase* c;
+    fscore s;
+} entry;
+
+enum { DICT_HOOK_PARAM, DICT_OTXN_PARAM, DICT_STATE };
+
+typedef struct dict_word {
+    int kind;
+    uint8_t name[32];
+    uint32_t name_len;
+    uint8_t ns[32];
+    uint32_t size;             // buffer the hook read it into
+} dict_word;
+
+static const hh_hook_def* target;
+static uint64_t rng;
+static uint64_t write_weight = 100;
+static dict_word dict[MAX_DICT];
+static int dict_count;
+static entry corpus[MAX_CORPUS];
+static int corpus_count;
+static entry keep[MAX_KEEP];
+static int keep_count, keep_max = 10;
+static uint8_t cov[COVERAGE_SIZE], virgin[COVERAGE_SIZE];
+static const char* out_dir = "build/fuzz";
+static const fcase* running;
+
+static uint64_t next(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static uint32_t below(uint32_t n)
+{
+    return n ? (uint32_t)(next() % n) : 0;
+}
+
+// ---------------------------------------------------------------
+// Dictionary
+// ---------------------------------------------------------------
+
+static int printable_name(const uint8_t* p, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+        if (p[i] <= ' ' || p[i] > '~' || p[i] == '=' || p[i] == '"' || p[i] == '#' || p[i] == ':')
+            return 0;
+    return n > 0;
+}
+
+static void learn(int kind, const uint8_t* name, uint32_t len, const uint8_t* ns, uint32_t size)
+{
+    if (kind != DICT_STATE && !printable_name(name, len))
+        return;
+    for (int i = 0; i < dict_count; ++i) {
+        dict_word* w = &dict[i];
+        if (w->kind == kind && w->name_len == len && !memcmp(w->name, name, len) &&
+            (kind != DICT_STATE || !memcmp(w->ns, ns, 32))) {
+            if (size > w->size)
+                w->size = size;
+            return;
+        }
+    }
+    if (dict_count == MAX_DICT)
+        return;
+    dict_word* w = &dict[dict_count++];
+    memset(w, 0, sizeof(*w));
+    w->kind = kind;
+    memcpy(w->name, name, len);
+    w->name_len = len;
+    if (ns)
+        memcpy(w->ns, ns, 32);
+    w->size = size;
+}
+
+static void on_access(void* ctx, const hh_access* a)
+{
+    (void)ctx;
+    static const uint8_t zero[32];
+    if (a->exec->def != target || !a->key)
+        return;
+    if (a->api == HH_API_HOOK_PARAM)
+        learn(DICT_HOOK_PARAM, a->key, a->key_len, NULL, a->size);
+    else if (a->api == HH_API_OTXN_PARAM)
+        learn(DICT_OTXN_PARAM, a->key, a->key_len, NULL, a->size);
+    else if ((a->api == HH_API_STATE || a->api == HH_API_STATE_FOREIGN) &&
+             (!a->account || !memcmp(a->account, acc_ids[ACC_HOOK], 20)))
+        learn(DICT_STATE, a->key, a->key_len, a->ns ? a->ns : zero, a->size);
+}
+
+// ---------------------------------------------------------------
+// Values
+// ---------------------------------------------------------------
+
+static void put_be(uint8_t* p, uint64_t v, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+        p[n - 1 - i] = (uint8_t)(v >> (8 * i));
+}
+
+// A value for a buffer of `size` bytes, biased towards what hooks
+// compare against: accounts, the currency, boundary integers and
+// buffers filled to the limit.
+static uint32_t make_value(uint8_t* out, uint32_t size, uint32_t max)
+{
+    if (size == 0 || size > max)
+        size = max;
+    switch (below(8)) {
+    case 0:
+        if (size >= 20) {
+            memcpy(out, acc_ids[below(ACC_COUNT)], 20);
+            return 20;
+        }
+        break;
+    case 1:
+        if (size >= 20) {
+            memcpy(out, currency, 20);
+            return 20;
+        }
+        break;
+    case 2: {
+        static const uint32_t widths[] = {1, 2, 4, 8};
+        uint32_t w = widths[below(4)];
+        if (w > size)
+            w = size;
+        static const uint64_t interesting[] = {0, 1, 2, 30, 100, 1000, 0x7FFFFFFF, 0xFFFFFFFF, UINT64_MAX};
+        put_be(out, below(2) ? interesting[below(9)] : next(), w);
+        return w;
+    }
+    case 3:
+        memset(out, 'A' + below(26), size);
+        return size;
+    case 4: {
+        uint32_t n = 1 + below(size);
+        for (uint32_t i = 0; i < n; ++i)
+            out[i] = (uint8_t)next();
+        return n;
+    }
+    default:
+        break;
+    }
+    // exactly the size the hook reads, random bytes
+    for (uint32_t i = 0; i < size; ++i)
+        out[i] = (uint8_t)next();
+    return size;
+}
+
+static uint32_t param_bytes(const hh_param* p, int n)
+{
+    uint32_t total = 0;
+    for (int i = 0; i < n; ++i)
+        total += p[i].value_len + p[i].name_len;
+    return total;
+}
+
+static hh_param* find_param(hh_param* p, int n, const uint8_t* name, uint32_t len)
+{
+    for (int i = 0; i < n; ++i)
+        if (p[i].name_len == len && !memcmp(p[i].name, name, len))
+            return &p[i];
+    return NULL;
+}
+
+// Adds or replaces a parameter, keeping the list inside its byte limit.
+static void set_param(hh_param* p, int* n, const uint8_t* name, uint32_t len, uint32_t size)
+{
+    hh_param* q = find_param(p, *n, name, len);
+    if (!q) {
+        if (*n == HH_MAX_PARAMS)
+            return;
+        q = &p[(*n)++];
+        memcpy(q->name, name, len);
+        q->name_len = len;
+    }
+    q->value_len = 0;
+    uint32_t room = MAX_PARAM_BYTES - param_bytes(p, *n);
+    if (room > HH_MAX_PARAM_VALUE)
+        room = HH_MAX_PARAM_VALUE;
+    if (room == 0) {
+        *q = p[--(*n)];
+        return;
+    }
+    // otxn parameters are read into fixed buffers; the longest value
+    // the transaction may carry still costs the hook to copy and hash
+    q->value_len = make_value(q->value, below(4) ? size : HH_MAX_PARAM_VALUE, room);
+}
+
+// ---------------------------------------------------------------
+// Mutation
+// ---------------------------------------------------------------
+
+static const dict_word* pick_word(int kind)
+{
+    int n = 0;
+    for (int i = 0; i < dict_count; ++i)
+        n += dict[i].kind == kind;
+    if (!n)
+        return NULL;
+    int k = (int)below((uint32_t)n);
+    for (int i = 0; i < dict_count; ++i)
+        if (dict[i].kind == kind && k-- == 0)
+            return &dict[i];
+    return NULL;
+}
+
+static void mutate_bytes(hh_param* p)
+{
+    if (!p->value_len)
+        return;
+    switch (below(3)) {
+    case 0:
+        p->value[below(p->value_len)] ^= (uint8_t)(1U << below(8));
+        break;
+    case 1:
+        p->value[below(p->value_len)] = (uint8_t)next();
+        break;
+    default:
+        p->value_len = 1 + below(p->value_len);
+        break;
+    }
+}
+
+static void mutate(fcase* c, const fcase* other)
+{
+    int rounds = 1 + (int)below(4);
+    for (int r = 0; r < rounds; ++r) {
+        switch (below(12)) {
+        case 0: {
+            static const uint16_t types[] = {TT_PAYMENT, TT_INVOKE, TT_REMIT};
+            c->type = types[below(3)];
+            break;
+        }
+        case 1:
+            c->from = (int)below(ACC_COUNT);
+            c->to = c->from == ACC_HOOK ? ACC_USER + (int)below(ACC_COUNT - 1) : ACC_HOOK;
+            break;
+        case 2:
+            c->amount = (int)below(3);
+            c->iou_value = (int)below(IOU_VALUES);
+            c->iou_issuer = below(2) ? ACC_HOOK : ACC_ADMIN;
+            c->drops = below(2) ? 1 + below(1000) * 1000000ULL : 1 + below(1000000);
+            break;
+        case 3:
+        case 4: {
+            const dict_word* w = pick_word(DICT_OTXN_PARAM);
+            if (w && below(3))
+                set_param(c->params, &c->param_count, w->name, w->name_len, w->size);
+            else {
+                const char* name = seed_params[below(SEED_PARAMS)];
+                set_param(c->params, &c->param_count, (const uint8_t*)name, (uint32_t)strlen(name), 0);
+            }
+            break;
+        }
+        case 5:
+            if (c->param_count)
+                mutate_bytes(&c->params[below((uint32_t)c->param_count)]);
+            else if (c->hook_param_count)
+                mutate_bytes(&c->hook_params[below((uint32_t)c->hook_param_count)]);
+            break;
+        case 6:
+            if (c->param_count && below(2)) {
+                uint32_t i = below((uint32_t)c->param_count);
+                c->params[i] = c->params[--c->param_count];
+            }
+            break;
+        case 7: {
+            const dict_word* w = pick_word(DICT_HOOK_PARAM);
+            if (w)
+                set_param(c->hook_params, &c->hook_param_count, w->name, w->name_len, w->size);
+            break;
+        }
+        case 8: {
+            // send back what the hook was installed with, e.g. WP_LNK
+            if (!c->hook_param_count)
+                break;
+            const hh_param* h = &c->hook_params[below((uint32_t)c->hook_param_count)];
+            hh_param* q = find_param(c->params, c->param_count, h->name, h->name_len);
+            if (!q && c->param_count < HH_MAX_PARAMS)
+                q = &c->params[c->param_count++];
+            if (q && param_bytes(c->params, c->param_count) - (q->name_len + q->value_len) + h->name_len +
+                             h->value_len <= MAX_PARAM_BYTES)
+                *q = *h;
+            break;
+        }
+        case 9: {
+            const dict_word* w = pick_word(DICT_STATE);
+            if (!w || w->name_len == 0 || w->name_len > 32)
+                break;
+            fstate* st = NULL;
+            for (int i = 0; i < c->state_count && !st; ++i)
+                if (c->state[i].key_len == w->name_len && !memcmp(c->state[i].key, w->name, w->name_len) &&
+                    !memcmp(c->state[i].ns, w->ns, 32))
+                    st = &c->state[i];
+            if (!st && c->state_count < MAX_STATE)
+                st = &c->state[c->state_count++];
+            if (!st)
+                break;
+            memcpy(st->ns, w->ns, 32);
+            memcpy(st->key, w->name, w->name_len);
+            st->key_len = w->name_len;
+            st->len = make_value(st->value, w->size, HH_STATE_MAX);
+            break;
+        }
+        case 10:
+            c->ledger_offset = below(4) ? below(200) : below(20000);
+            break;
+        default:
+            // splice the other input's transaction parameters in
+            if (other && other->param_count) {
+                const hh_param* p = &other->params[below((uint32_t)other->param_count)];
+                hh_param* q = find_param(c->params, c->param_count, p->name, p->name_len);
+                if (!q && c->param_count < HH_MAX_PARAMS)
+                    q = &c->params[c->param_count++];
+                if (q && param_bytes(c->params, c->param_count) - (q->name_len + q->value_len) + p->name_len +
+                                 p->value_len <= MAX_PARAM_BYTES)
+                    *q = *p;
+            }
+            break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------
+// Execution
+// ---------------------------------------------------------------
+
+static void build_txn(const fcase* c, hh_txn* t)
+{
+    hh_txn_init(t, c->type, acc_ids[c->from]);
+    memcpy(t->destination, acc_ids[c->to], 20);
+    t->has_destination = 1;
+    hh_amount a;
+    if (c->amount == 2)
+        hh_amount_iou(&a, hh_xfl_parse(iou_values[c->iou_value]), currency, acc_ids[c->iou_issuer]);
+    else
+        hh_amount_drops(&a, c->drops);
+    if (c->type == TT_PAYMENT) {
+        t->has_amount = 1;
+        t->amount = a;
+    } else if (c->type == TT_REMIT) {
+        t->amount_count = 1;
+        t->amounts[0] = a;
+    }
+    for (int i = 0; i < c->param_count; ++i)
+        t->params[t->param_count++] = c->params[i];
+}
+
+// The same ledger write_case() describes.
+static hh_ledger* setup(const fcase* c)
+{
+    hh_ledger* l = hh_ledger_new(1000 + c->ledger_offset, 750000000 + 4 * c->ledger_offset);
+    for (int i = 0; i < ACC_COUNT; ++i)
+        hh_account_create(l, acc_ids[i], 100000000000ULL);
+    hh_result r;
+    hh_result_init(&r);
+    for (int i = ACC_USER; i < ACC_COUNT; ++i)
+        for (int issuer = ACC_HOOK; issuer <= ACC_ADMIN; issuer += ACC_ADMIN) {
+            if (i == issuer)
+                continue;
+            hh_trustline_set(l, acc_ids[i], acc_ids[issuer], currency, hh_xfl_parse("1000000000000"));
+            hh_txn t;
+            hh_txn_init(&t, TT_PAYMENT, acc_ids[issuer]);
+            memcpy(t.destination, acc_ids[i], 20);
+            t.has_destination = 1;
+            t.has_amount = 1;
+            hh_amount_iou(&t.amount, hh_xfl_parse("1000000000"), currency, acc_ids[issuer]);
+            hh_submit(l, &t, &r);
+        }
+    hh_result_free(&r);
+    hh_hook_opts o = {0};
+    o.param_count = c->hook_param_count;
+    o.params = c->hook_params;
+    hh_hook_set(l, acc_ids[ACC_HOOK], 0, target, &o);
+    for (int i = 0; i < c->state_count; ++i)
+        hh_state_set(l, acc_ids[ACC_HOOK], c->state[i].ns, c->state[i].key, c->state[i].key_len, c->state[i].value,
+                     c->state[i].len);
+    return l;
+}
+
+static fscore execute(const fcase* c)
+{
+    fscore s = {0};
+    hh_ledger* l = setup(c);
+    hh_ledger_on_access(l, on_access, NULL);
+    static hh_txn t;
+    build_txn(c, &t);
+    hh_result r;
+    hh_result_init(&r);
+    memset(cov, 0, sizeof(cov));
+    running = c;
+    hh_coverage(cov);
+    hh_submit(l, &t, &r);
+    hh_coverage(NULL);
+    running = NULL;
+    s.ter = r.ter;
+    for (int i = 0; i < r.exec_count; ++i) {
+        const hh_exec* e = &r.execs[i];
+        if (e->def != target)
+            continue;
+        s.blocks += e->blocks;
+        s.writes += e->calls[HH_API_STATE_SET] + e->calls[HH_API_STATE_FOREIGN_SET];
+        s.emitted += e->emitted;
+    }
+    s.score = s.blocks + write_weight * s.writes;
+    hh_result_free(&r);
+    hh_ledger_free(l);
+    return s;
+}
+
+static int bucket(uint8_t n)
+{
+    if (n <= 3)
+        return n == 3 ? 4 : n;
+    if (n < 8)
+        return 8;
+    if (n < 16)
+        return 16;
+    if (n < 32)
+        return 32;
+    return n < 128 ? 64 : 128;
+}
+
+static int new_coverage(void)
+{
+    int found = 0;
+    for (uint32_t i = 0; i < COVERAGE_SIZE; ++i) {
+        if (!cov[i])
+            continue;
+        uint8_t b = (uint8_t)bucket(cov[i]);
+        if (!(virgin[i] & b)) {
+            virgin[i] |= b;
+            found = 1;
+        }
+    }
+    return found;
+}
+
+static uint32_t edges(void)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < COVERAGE_SIZE; ++i)
+        n += virgin[i] != 0;
+    return n;
+}
+
+// ---------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------
+
+static int account_of(const uint8_t* p, uint32_t len)
+{
+    if (len != 20)
+        return -1;
+    for (int i = 0; i < ACC_COUNT; ++i)
+        if (!memcmp(p, acc_ids[i], 20))
+            return i;
+    return -1;
+}
+
+static void write_value(FILE* f, const uint8_t* p, uint32_t len)
+{
+    int a = account_of(p, len);
+    if (a >= 0) {
+        fprintf(f, "acc:%s", acc_names[a]);
+        return;
+    }
+    if (len == 20 && !memcmp(p, currency, 20)) {
+        fprintf(f, "cur:TST");
+        return;
+    }
+    fprintf(f, "hex:");
+    for (uint32_t i = 0; i < len; ++i)
+        fprintf(f, "%02X", p[i]);
+}
+
+static void write_params(FILE* f, const hh_param* p, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        fprintf(f, " %.*s=", (int)p[i].name_len, (const char*)p[i].name);
+        write_value(f, p[i].value, p[i].value_len);
+    }
+}
+
+static void write_amount(FILE* f, const fcase* c)
+{
+    if (c->amount == 2)
+        fprintf(f, "%s/TST/%s", iou_values[c->iou_value], acc_names[c->iou_issuer]);
+    else
+        fprintf(f, "%llu.%06llu", (unsigned long long)(c->drops / 1000000), (unsigned long long)(c->drops % 1000000));
+}
+
+static void write_case(FILE* f, const fcase* c, int rank, const fscore* s)
+{
+    if (s)
+        fprintf(f, "# %s #%d: %llu blocks, %llu state writes, %llu emitted, score %llu\n", target->name, rank,
+                (unsigned long long)s->blocks, (unsigned long long)s->writes, (unsigned long long)s->emitted,
+                (unsigned long long)s->score);
+    fprintf(f, "ledger %u %u\n", 1000 + c->ledger_offset, 750000000 + 4 * c->ledger_offset);
+    for (int i = 0; i < ACC_COUNT; ++i)
+        fprintf(f, "account %s 100000\n", acc_names[i]);
+    for (int i = ACC_USER; i < ACC_COUNT; ++i)
+        for (int issuer = ACC_HOOK; issuer <= ACC_ADMIN; issuer += ACC_ADMIN)
+            if (i != issuer)
+                fprintf(f, "trust %s %s TST 1000000000000\npay %s %s 1000000000/TST/%s\n", acc_names[i],
+                        acc_names[issuer], acc_names[issuer], acc_names[i], acc_names[issuer]);
+    fprintf(f, "hook hook 0 %s", target->name);
+    write_params(f, c->hook_params, c->hook_param_count);
+    fprintf(f, "\n");
+    for (int i = 0; i < c->state_count; ++i) {
+        static const uint8_t zero[32];
+        const fstate* st = &c->state[i];
+        fprintf(f, "put hook ");
+        if (memcmp(st->ns, zero, 32) != 0)
+            for (int k = 0; k < 32; ++k)
+                fprintf(f, "%02X", st->ns[k]);
+        else
+            fprintf(f, "0");
+        fprintf(f, " ");
+        write_value(f, st->key, st->key_len);
+        fprintf(f, " ");
+        write_value(f, st->value, st->len);
+        fprintf(f, "\n");
+    }
+    fprintf(f, "path worst/%d\n", rank);
+    if (c->type == TT_PAYMENT) {
+        fprintf(f, "pay %s %s ", acc_names[c->from], acc_names[c->to]);
+        write_amount(f, c);
+    } else if (c->type == TT_REMIT) {
+        fprintf(f, "remit %s %s ", acc_names[c->from], acc_names[c->to]);
+        write_amount(f, c);
+    } else
+        fprintf(f, "invoke %s %s", acc_names[c->from], acc_names[c->to]);
+    write_params(f, c->params, c->param_count);
+    fprintf(f, "\n");
+    if (s)
+        fprintf(f, "expect %s emitted=%llu\n", hh_ter_name(s->ter), (unsigned long long)s->emitted);
+    fprintf(f, "path\n\n");
+}
+
+static void on_crash(int sig)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.crash.txt", out_dir, target ? target->name : "unknown");
+    FILE* f = running ? fopen(path, "w") : NULL;
+    if (f) {
+        fprintf(f, "# hookfuzz: signal %d\n", sig);
+        write_case(f, running, 0, NULL);
+        fclose(f);
+        fprintf(stderr, "hookfuzz: %s crashed (signal %d), input in %s\n", target->name, sig, path);
+    }
+    _exit(3);
+}
+
+// ---------------------------------------------------------------
+// Search
+// ---------------------------------------------------------------
+
+static void add_corpus(const fcase* c, fscore s)
+{
+    fcase* copy = malloc(sizeof(*copy));
+    *copy = *c;
+    if (corpus_count < MAX_CORPUS) {
+        corpus[corpus_count++] = (entry){copy, s};
+        return;
+    }
+    // replace the cheapest input
+    int low = 0;
+    for (int i = 1; i < corpus_count; ++i)
+        if (corpus[i].s.score < corpus[low].s.score)
+            low = i;
+    free(corpus[low].c);
+    corpus[low] = (entry){copy, s};
+}
+
+// Ranked worst cases, one per distinct cost.
+static void consider(const fcase* c, fscore s)
+{
+    if (!s.score)
+        return;
+    for (int i = 0; i < keep_count; ++i)
+        if (keep[i].s.blocks == s.blocks && keep[i].s.writes == s.writes && keep[i].s.emitted == s.emitted)
+            return;
+    if (keep_count == keep_max && s.score <= keep[keep_count - 1].s.score)
+        return;
+    if (keep_count == keep_max)
+        free(keep[--keep_count].c);
+    int at = keep_count++;
+    while (at > 0 && keep[at - 1].s.score < s.score) {
+        keep[at] = keep[at - 1];
+        --at;
+    }
+    fcase* copy = malloc(sizeof(*copy));
+    *copy = *c;
+    keep[at] = (entry){copy, s};
+}
+
+static const entry* pick(void)
+{
+    const entry* a = &corpus[below((uint32_t)corpus_count)];
+    const entry* b = &corpus[below((uint32_t)corpus_count)];
+    return a->s.score >= b->s.score ? a : b;
+}
+
+static void seed(void)
+{
+    static fcase c;
+    static const struct {
+        uint16_t type;
+        int from;
+        int amount;
+    } seeds[] = {
+        {TT_PAYMENT, ACC_USER, 1}, {TT_PAYMENT, ACC_USER, 2}, {TT_INVOKE, ACC_USER, 0},
+        {TT_INVOKE, ACC_ADMIN, 0}, {TT_PAYMENT, ACC_HOOK, 1}, {TT_REMIT, ACC_USER, 1},
+    };
+    for (size_t i = 0; i < sizeof(seeds) / sizeof(seeds[0]); ++i) {
+        memset(&c, 0, sizeof(c));
+        c.type = seeds[i].type;
+        c.from = seeds[i].from;
+        c.to = c.from == ACC_HOOK ? ACC_USER : ACC_HOOK;
+        c.amount = seeds[i].amount;
+        c.drops = 20000000;
+        c.iou_value = 3;
+        c.iou_issuer = ACC_HOOK;
+        fscore s = execute(&c);
+        new_coverage();
+        add_corpus(&c, s);
+        consider(&c, s);
+    }
+}
+
+static int fuzz(const hh_hook_def* def, uint64_t execs)
+{
+    target = def;
+    dict_count = 0;
+    corpus_count = 0;
+    keep_count = 0;
+    memset(virgin, 0, sizeof(virgin));
+
+    seed();
+    static fcase child;
+    uint64_t best = 0, max_writes = 0, max_emitted = 0;
+    for (uint64_t n = 0; n < execs; ++n) {
+        const entry* parent = pick();
+        const entry* other = pick();
+        child = *parent->c;
+        mutate(&child, other->c);
+        fscore s = execute(&child);
+        int fresh = new_coverage();
+        if (fresh || s.score > best || s.writes > max_writes || s.emitted > max_emitted)
+            add_corpus(&child, s);
+        consider(&child, s);
+        if (s.score > best)
+            best = s.score;
+        if (s.writes > max_writes)
+            max_writes = s.writes;
+        if (s.emitted > max_emitted)
+            max_emitted = s.emitted;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.txt", out_dir, def->name);
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "# hookfuzz: worst inputs found for %s in %llu executions, most expensive first.\n\n", def->name,
+            (unsigned long long)execs);
+    for (int i = 0; i < keep_count; ++i)
+        write_case(f, keep[i].c, i + 1, &keep[i].s);
+    fclose(f);
+
+    const fscore* w = keep_count ? &keep[0].s : NULL;
+    printf("%-28s %7llu %6d %6u %6d %8llu %7llu %7llu %9llu  %s\n", def->name, (unsigned long long)execs, corpus_count,
+           edges(), dict_count, w ? (unsigned long long)w->blocks : 0ULL, (unsigned long long)max_writes,
+           (unsigned long long)max_emitted, w ? (unsigned long long)w->score : 0ULL, path);
+
+    for (int i = 0; i < corpus_count; ++i)
+        free(corpus[i].c);
+    for (int i = 0; i < keep_count; ++i)
+        free(keep[i].c);
+    return 0;
+}
+
+static int run(int argc, char** argv)
+{
+    uint64_t execs = 4000;
+    rng = 0x2545F4914F6CDD1DULL;
+    const char* names[256];
+    int name_count = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            execs = strtoull(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-k") && i + 1 < argc)
+            keep_max = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            write_weight = strtoull(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            rng = strtoull(argv[++i], NULL, 0) | 1;
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            out_dir = argv[++i];
+        else if (argv[i][0] != '-' && name_count < 256)
+            names[name_count++] = argv[i];
+        else {
+            fprintf(stderr, "usage: hookfuzz [-n execs] [-k keep] [-w write_weight] [-s seed] [-o dir] [Hook...]\n");
+            return 2;
+        }
+    }
+    if (keep_max < 1 || keep_max > MAX_KEEP)
+        keep_max = keep_max < 1 ? 1 : MAX_KEEP;
+    for (int i = 0; i < ACC_COUNT; ++i)
+        hh_account_id(acc_names[i], acc_ids[i]);
+    hh_currency("TST", currency);
+    signal(SIGSEGV, on_crash);
+    signal(SIGBUS, on_crash);
+    signal(SIGFPE, on_crash);
+    signal(SIGABRT, on_crash);
+
+    char mk[600];
+    snprintf(mk, sizeof(mk), "mkdir -p '%s'", out_dir);
+    if (system(mk) != 0) {
+        fprintf(stderr, "hookfuzz: cannot create %s\n", out_dir);
+        return 2;
+    }
+
+    printf("%-28s %7s %6s %6s %6s %8s %7s %7s %9s  %s\n", "hook", "execs", "corpus", "edges", "dict", "blocks",
+           "writes", "emitted", "score", "worst cases");
+    if (!name_count)
+        for (size_t i = 0; i < hh_hook_count; ++i)
+            fuzz(&hh_hooks[i], execs);
+    for (int i = 0; i < name_count; ++i) {
+        const hh_hook_def* def = hh_hook_find(names[i]);
+        if (!def) {
+            fprintf(stderr, "hookfuzz: unknown hook %s\n", names[i]);
+            return 2;
+        }
+        fuzz(def, execs);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    return hh_run(run, argc, argv);
+}
@@ -0,0 +1,851 @@
+//**************************************************************
+// hookguard - HandyHooks static guard budget
+//
+// Description:
+//   Preprocesses every registered hook with the C compiler and walks
+//   its functions the way the Xahau guard checker walks WASM: every
+//   loop must call _g() in its header or body, and the guard's maxiter
+//   bounds how often that loop can run in one execution. From that it
+//   reports, per entry point (hook and cbak):
+//
+//     guard_iterations  sum of the maxiter of every guard reachable
+//     budget            worst-case cost: one unit per C token, loop
+//                       bodies times their guard bound, calls to
+//                       functions of the hook times the callee budget
+//
+//   Each guard is listed with the source line it came from. Loops with
+//   no guard, or a maxiter that is not a constant, are counted as
+//   unguarded; SetHook would reject them.
+//
+//   Tokens stand in for WASM instructions, so budgets compare
+//   revisions of one hook rather than predict its fee.
+//
+// Usage:
+//   hookguard [-o report.json] [-b baseline.json] [-u] [HookName...]
+//     -o  write the JSON report (default stdout when no baseline)
+//     -b  compare with a previous report and exit 1 when any bound grew
+//     -u  rewrite the baseline with this report
+//**************************************************************
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+
+#ifndef HH_CC
+#define HH_CC "cc"
+#endif
+#ifndef HH_HOOKAPI_DIR
+#define HH_HOOKAPI_DIR "Tools/Harness/hookapi"
+#endif
+#ifndef HH_ROOT
+#define HH_ROOT "."
+#endif
+
+#define MAX_DEPTH 64
+
+typedef enum tok_kind { T_IDENT, T_NUM, T_STR, T_PUNCT } tok_kind;
+
+typedef struct token {
+    tok_kind kind;
+    char* text;
+    int line;
+    int main_file;             // from the hook source rather than a header
+} token;
+
+typedef struct call {
+    int fn;
+    uint64_t count;
+} call;
+
+typedef struct guard {
+    int line;
+    int64_t maxiter;           // -1 when not a constant
+    int loop_line;             // 0 outside any loop
+} guard;
+
+typedef struct function {
+    char* name;
+    int body;                  // index of the opening brace
+    int body_end;
+    int main_file;
+    int analysed;
+    uint64_t own;              // cost of its own tokens
+    int call_count;
+    call* calls;
+    int guard_count;
+    guard* guards;
+    int unguarded;
+    int* unguarded_lines;
+    // filled by totals()
+    int visiting;
+    int done;
+    uint64_t budget;
+    uint64_t guard_iterations;
+    int total_unguarded;
+} function;
+
+typedef struct frame {
+    int line;
+    int64_t maxiter;           // 0 until a guard is seen, -1 unresolved
+    uint64_t own;              // multiplied by maxiter when the loop closes
+    uint64_t fixed;            // nested loops, already bounded
+    int call_count;
+    call* calls;               // own calls, multiplied like own
+    int fixed_count;
+    call* fixed_calls;
+} frame;
+
+static token* toks;
+static int tok_count, tok_cap;
+static function* fns;
+static int fn_count;
+static function* cur_fn;
+static frame frames[MAX_DEPTH];
+static int depth;
+
+// ---------------------------------------------------------------
+// Tokenizer for preprocessed output
+// ---------------------------------------------------------------
+
+static void push_token(tok_kind kind, const char* s, size_t n, int line, int main_file)
+{
+    if (tok_count == tok_cap) {
+        tok_cap = tok_cap ? tok_cap * 2 : 4096;
+        toks = realloc(toks, sizeof(token) * (size_t)tok_cap);
+    }
+    token* t = &toks[tok_count++];
+    t->kind = kind;
+    t->text = strndup(s, n);
+    t->line = line;
+    t->main_file = main_file;
+}
+
+static void tokenize(const char* src, const char* main_path)
+{
+    static const char* const puncts[] = {"<<=", ">>=", "...", "->", "++", "--", "<<", ">>", "<=", ">=", "==",
+                                         "!=", "&&", "||", "+=", "-=", "*=", "/=", "%=", "&=", "^=", "|=", "##"};
+    int line = 1, main_file = 1, bol = 1;
+    const char* p = src;
+    while (*p) {
+        if (*p == '\n') {
+            ++line;
+            ++p;
+            bol = 1;
+            continue;
+        }
+        if (isspace((unsigned char)*p)) {
+            ++p;
+            continue;
+        }
+        if (bol && *p == '#') {
+            // # <line> "<file>" flags
+            char file[4096];
+            int l;
+            if (sscanf(p, "# %d \"%4095[^\"]\"", &l, file) == 2) {
+                line = l - 1;
+                main_file = strcmp(file, main_path) == 0;
+            }
+            while (*p && *p != '\n')
+                ++p;
+            continue;
+        }
+        bol = 0;
+        const char* s = p;
+        if (isalpha((unsigned char)*p) || *p == '_') {
+            while (isalnum((unsigned char)*p) || *p == '_')
+                ++p;
+            push_token(T_IDENT, s, (size_t)(p - s), line, main_file);
+        } else if (isdigit((unsigned char)*p) || (*p == '.' && isdigit((unsigned char)p[1]))) {
+            while (isalnum((unsigned char)*p) || *p == '.' || *p == '_')
+                ++p;
+            push_token(T_NUM, s, (size_t)(p - s), line, main_file);
+        } else if (*p == '"' || *p == '\'') {
+            char q = *p++;
+            while (*p && *p != q) {
+                if (*p == '\\' && p[1])
+                    ++p;
+                ++p;
+            }
+            if (*p)
+                ++p;
+            push_token(T_STR, s, (size_t)(p - s), line, main_file);
+        } else {
+            size_t n = 1;
+            for (size_t i = 0; i < sizeof(puncts) / sizeof(puncts[0]); ++i) {
+                size_t l = strlen(puncts[i]);
+                if (!strncmp(p, puncts[i], l)) {
+                    n = l;
+                    break;
+                }
+            }
+            p += n;
+            push_token(T_PUNCT, s, n, line, main_file);
+        }
+    }
+}
+
+static int is(int i, const char* text)
+{
+    return i < tok_count && !strcmp(toks[i].text, text);
+}
+
+// Index of the bracket closing the one at i.
+static int matching(int i)
+{
+    const char* open = toks[i].text;
+    const char* close = !strcmp(open, "(") ? ")" : !strcmp(open, "[") ? "]" : "}";
+    int level = 0;
+    for (int j = i; j < tok_count; ++j) {
+        if (is(j, open))
+            level++;
+        else if (is(j, close) && --level == 0)
+            return j;
+    }
+    return tok_count - 1;
+}
+
+// Function definitions: `name ( ... ) {` at file scope.
+static void find_functions(void)
+{
+    for (int i = 0; i < tok_count; ++i) {
+        if (!is(i, "{"))
+            continue;
+        int end = matching(i);
+        if (i > 0 && is(i - 1, ")")) {
+            int level = 0, open = i - 1;
+            for (; open >= 0; --open) {
+                if (is(open, ")"))
+                    level++;
+                else if (is(open, "(") && --level == 0)
+                    break;
+            }
+            if (open > 0 && toks[open - 1].kind == T_IDENT) {
+                fns = realloc(fns, sizeof(function) * (size_t)(fn_count + 1));
+                function* f = &fns[fn_count++];
+                memset(f, 0, sizeof(*f));
+                f->name = toks[open - 1].text;
+                f->body = i;
+                f->body_end = end;
+                f->main_file = toks[i].main_file;
+            }
+        }
+        i = end;
+    }
+}
+
+static int find_function(const char* name)
+{
+    for (int i = 0; i < fn_count; ++i)
+        if (!strcmp(fns[i].name, name))
+            return i;
+    return -1;
+}
+
+// ---------------------------------------------------------------
+// Constant expressions in guard arguments
+// ---------------------------------------------------------------
+
+static int ex_pos, ex_end, ex_bad;
+
+static int64_t ex_or(void);
+
+static int64_t type_size(int i)
+{
+    static const struct { const char* name; int64_t size; } types[] = {
+        {"char", 1}, {"uint8_t", 1}, {"int8_t", 1}, {"uint16_t", 2}, {"int16_t", 2}, {"uint32_t", 4},
+        {"int32_t", 4}, {"int", 4}, {"uint64_t", 8}, {"int64_t", 8}, {"long", 8}};
+    for (size_t k = 0; k < sizeof(types) / sizeof(types[0]); ++k)
+        if (is(i, types[k].name))
+            return types[k].size;
+    return 0;
+}
+
+// sizeof of a type or of an array declared earlier in the function.
+static int64_t size_of(int i)
+{
+    int64_t t = type_size(i);
+    if (t)
+        return t;
+    for (int j = ex_pos; j > cur_fn->body; --j) {
+        if (strcmp(toks[j].text, toks[i].text) != 0 || !is(j + 1, "["))
+            continue;
+        int64_t elem = type_size(j - 1);
+        if (!elem && is(j - 1, "char"))
+            elem = 1;
+        int close = matching(j + 1);
+        int save_pos = ex_pos, save_end = ex_end;
+        ex_pos = j + 2;
+        ex_end = close;
+        int64_t n = ex_or();
+        ex_pos = save_pos;
+        ex_end = save_end;
+        if (elem && n > 0)
+            return elem * n;
+    }
+    ex_bad = 1;
+    return 0;
+}
+
+static int64_t ex_primary(void)
+{
+    if (ex_pos >= ex_end) {
+        ex_bad = 1;
+        return 0;
+    }
+    token* t = &toks[ex_pos];
+    if (is(ex_pos, "(")) {
+        int close = matching(ex_pos);
+        if (type_size(ex_pos + 1) && close == ex_pos + 2) {
+            ex_pos = close + 1;   // cast
+            return ex_primary();
+        }
+        ++ex_pos;
+        int64_t v = ex_or();
+        ex_pos = close + 1;
+        return v;
+    }
+    if (is(ex_pos, "-")) {
+        ++ex_pos;
+        return -ex_primary();
+    }
+    if (is(ex_pos, "sizeof") && is(ex_pos + 1, "(")) {
+        int close = matching(ex_pos + 1);
+        int64_t v = close == ex_pos + 3 ? size_of(ex_pos + 2) : (ex_bad = 1, 0);
+        ex_pos = close + 1;
+        return v;
+    }
+    if (t->kind == T_NUM) {
+        ++ex_pos;
+        return (int64_t)strtoull(t->text, NULL, 0);
+    }
+    ex_bad = 1;
+    ++ex_pos;
+    return 0;
+}
+
+static int64_t ex_mul(void)
+{
+    int64_t v = ex_primary();
+    while (ex_pos < ex_end && (is(ex_pos, "*") || is(ex_pos, "/") || is(ex_pos, "%"))) {
+        char op = toks[ex_pos++].text[0];
+        int64_t r = ex_primary();
+        if (op == '*')
+            v *= r;
+        else if (r == 0)
+            ex_bad = 1;
+        else
+            v = op == '/' ? v / r : v % r;
+    }
+    return v;
+}
+
+static int64_t ex_add(void)
+{
+    int64_t v = ex_mul();
+    while (ex_pos < ex_end && (is(ex_pos, "+") || is(ex_pos, "-"))) {
+        char op = toks[ex_pos++].text[0];
+        int64_t r = ex_mul();
+        v = op == '+' ? v + r : v - r;
+    }
+    return v;
+}
+
+static int64_t ex_shift(void)
+{
+    int64_t v = ex_add();
+    while (ex_pos < ex_end && (is(ex_pos, "<<") || is(ex_pos, ">>"))) {
+        int left = is(ex_pos++, "<<");
+        int64_t r = ex_add();
+        v = left ? (int64_t)((uint64_t)v << r) : v >> r;
+    }
+    return v;
+}
+
+static int64_t ex_or(void)
+{
+    int64_t v = ex_shift();
+    while (ex_pos < ex_end && (is(ex_pos, "|") || is(ex_pos, "&"))) {
+        int bit_or = is(ex_pos++, "|");
+        int64_t r = ex_shift();
+        v = bit_or ? v | r : v & r;
+    }
+    return v;
+}
+
+// Evaluates tokens [from, to); -1 when they are not a constant.
+static int64_t evaluate(int from, int to)
+{
+    ex_pos = from;
+    ex_end = to;
+    ex_bad = 0;
+    int64_t v = ex_or();
+    return ex_bad || ex_pos != to ? -1 : v;
+}
+
+// ---------------------------------------------------------------
+// Statement walk
+// ---------------------------------------------------------------
+
+static void add_call(call** list, int* count, int fn, uint64_t n)
+{
+    for (int i = 0; i < *count; ++i)
+        if ((*list)[i].fn == fn) {
+            (*list)[i].count += n;
+            return;
+        }
+    *list = realloc(*list, sizeof(call) * (size_t)(*count + 1));
+    (*list)[*count].fn = fn;
+    (*list)[*count].count = n;
+    (*count)++;
+}
+
+static void guard_at(int i)
+{
+    int close = matching(i + 1), comma = -1, level = 0;
+    for (int j = i + 2; j < close; ++j) {
+        if (is(j, "(") || is(j, "["))
+            level++;
+        else if (is(j, ")") || is(j, "]"))
+            level--;
+        else if (level == 0 && is(j, ",")) {
+            comma = j;
+            break;
+        }
+    }
+    int64_t maxiter = comma < 0 ? -1 : evaluate(comma + 1, close);
+    frame* f = &frames[depth - 1];
+    int in_loop = depth > 1;
+    if (in_loop && f->maxiter == 0)
+        f->maxiter = maxiter;
+    cur_fn->guards = realloc(cur_fn->guards, sizeof(guard) * (size_t)(cur_fn->guard_count + 1));
+    guard* g = &cur_fn->guards[cur_fn->guard_count++];
+    g->line = toks[i].line;
+    g->maxiter = maxiter;
+    g->loop_line = in_loop ? f->line : 0;
+}
+
+// Costs tokens [from, to) to the innermost frame.
+static void scan(int from, int to)
+{
+    frame* f = &frames[depth - 1];
+    for (int i = from; i < to; ++i) {
+        f->own++;
+        if (toks[i].kind != T_IDENT || !is(i + 1, "("))
+            continue;
+        if (!strcmp(toks[i].text, "_g"))
+            guard_at(i);
+        else {
+            int fn = find_function(toks[i].text);
+            if (fn >= 0 && &fns[fn] != cur_fn)
+                add_call(&f->calls, &f->call_count, fn, 1);
+        }
+    }
+}
+
+static void loop_open(int line)
+{
+    frame* f = &frames[depth++];
+    memset(f, 0, sizeof(*f));
+    f->line = line;
+}
+
+static void loop_close(void)
+{
+    frame* f = &frames[--depth];
+    frame* parent = &frames[depth - 1];
+    uint64_t bound = 1;
+    if (f->maxiter > 0)
+        bound = (uint64_t)f->maxiter;
+    else {
+        cur_fn->unguarded_lines = realloc(cur_fn->unguarded_lines, sizeof(int) * (size_t)(cur_fn->unguarded + 1));
+        cur_fn->unguarded_lines[cur_fn->unguarded++] = f->line;
+    }
+    parent->fixed += f->own * bound + f->fixed;
+    for (int i = 0; i < f->call_count; ++i)
+        add_call(&parent->fixed_calls, &parent->fixed_count, f->calls[i].fn, f->calls[i].count * bound);
+    for (int i = 0; i < f->fixed_count; ++i)
+        add_call(&parent->fixed_calls, &parent->fixed_count, f->fixed_calls[i].fn, f->fixed_calls[i].count);
+    free(f->calls);
+    free(f->fixed_calls);
+}
+
+// Walks one statement starting at i; returns the index after it.
+static int statement(int i, int end)
+{
+    if (i >= end)
+        return end;
+    if (is(i, "{")) {
+        int close = matching(i);
+        scan(i, i + 1);
+        for (int j = i + 1; j < close;)
+            j = statement(j, close);
+        return close + 1;
+    }
+    if ((is(i, "for") || is(i, "while")) && is(i + 1, "(")) {
+        int close = matching(i + 1);
+        loop_open(toks[i].line);
+        scan(i, close + 1);
+        int next = statement(close + 1, end);
+        loop_close();
+        return next;
+    }
+    if (is(i, "do")) {
+        loop_open(toks[i].line);
+        scan(i, i + 1);
+        int j = statement(i + 1, end);
+        if (is(j, "while") && is(j + 1, "(")) {
+            int close = matching(j + 1);
+            scan(j, close + 1);
+            j = close + 1;
+        }
+        loop_close();
+        return is(j, ";") ? j + 1 : j;
+    }
+    if ((is(i, "if") || is(i, "switch")) && is(i + 1, "(")) {
+        int close = matching(i + 1);
+        scan(i, close + 1);
+        int j = statement(close + 1, end);
+        if (is(j, "else")) {
+            scan(j, j + 1);
+            j = statement(j + 1, end);
+        }
+        return j;
+    }
+    if (is(i, "case") || is(i, "default")) {
+        int j = i;
+        while (j < end && !is(j, ":"))
+            ++j;
+        scan(i, j + 1);
+        return j + 1;
+    }
+    int j = i, level = 0;
+    while (j < end) {
+        if (is(j, "(") || is(j, "[") || is(j, "{"))
+            level++;
+        else if (is(j, ")") || is(j, "]") || is(j, "}"))
+            level--;
+        else if (level == 0 && is(j, ";"))
+            break;
+        ++j;
+    }
+    scan(i, j < end ? j + 1 : end);
+    return j + 1;
+}
+
+static void analyse(function* f)
+{
+    cur_fn = f;
+    depth = 1;
+    memset(&frames[0], 0, sizeof(frames[0]));
+    statement(f->body, f->body_end + 1);
+    frame* top = &frames[0];
+    f->own = top->own + top->fixed;
+    for (int i = 0; i < top->call_count; ++i)
+        add_call(&f->calls, &f->call_count, top->calls[i].fn, top->calls[i].count);
+    for (int i = 0; i < top->fixed_count; ++i)
+        add_call(&f->calls, &f->call_count, top->fixed_calls[i].fn, top->fixed_calls[i].count);
+    free(top->calls);
+    free(top->fixed_calls);
+    f->analysed = 1;
+}
+
+// Budget and guard iterations including callees; recursion adds nothing.
+static void totals(function* f)
+{
+    if (f->done || f->visiting)
+        return;
+    f->visiting = 1;
+    f->budget = f->own;
+    f->total_unguarded = f->unguarded;
+    for (int i = 0; i < f->guard_count; ++i)
+        f->guard_iterations += f->guards[i].maxiter > 0 ? (uint64_t)f->guards[i].maxiter : 0;
+    for (int i = 0; i < f->guard_count; ++i)
+        f->total_unguarded += f->guards[i].maxiter < 0;
+    for (int i = 0; i < f->call_count; ++i) {
+        function* c = &fns[f->calls[i].fn];
+        totals(c);
+        f->budget += f->calls[i].count * c->budget;
+        f->guard_iterations += c->guard_iterations;
+        f->total_unguarded += c->total_unguarded;
+    }
+    f->visiting = 0;
+    f->done = 1;
+}
+
+static void reset(void)
+{
+    for (int i = 0; i < tok_count; ++i)
+        free(toks[i].text);
+    for (int i = 0; i < fn_count; ++i) {
+        free(fns[i].calls);
+        free(fns[i].guards);
+        free(fns[i].unguarded_lines);
+    }
+    free(fns);
+    fns = NULL;
+    fn_count = 0;
+    tok_count = 0;
+}
+
+// ---------------------------------------------------------------
+// Report
+// ---------------------------------------------------------------
+
+typedef struct entry_result {
+    char hook[64];
+    char entry[8];
+    uint64_t guard_iterations;
+    uint64_t budget;
+    uint64_t unguarded;
+} entry_result;
+
+static entry_result* results;
+static int result_count;
+
+static char* preprocess(const char* path)
+{
+    char cmd[8192];
+    snprintf(cmd, sizeof(cmd), "\"%s\" -E -w -I\"%s\" \"%s\"", HH_CC, HH_HOOKAPI_DIR, path);
+    FILE* p = popen(cmd, "r");
+    if (!p)
+        return NULL;
+    size_t len = 0, cap = 1 << 16;
+    char* out = malloc(cap);
+    size_t n;
+    while ((n = fread(out + len, 1, cap - len - 1, p)) > 0) {
+        len += n;
+        if (cap - len < 4096)
+            out = realloc(out, cap *= 2);
+    }
+    out[len] = 0;
+    if (pclose(p) != 0) {
+        free(out);
+        return NULL;
+    }
+    return out;
+}
+
+static void write_guards(FILE* out, const function* f, int* first)
+{
+    for (int i = 0; i < f->guard_count; ++i) {
+        const guard* g = &f->guards[i];
+        fprintf(out, "%s{\"line\": %d, \"maxiter\": %lld, \"loop\": %d, \"function\": \"%s\"}", *first ? "" : ", ",
+                g->line, (long long)g->maxiter, g->loop_line, f->name);
+        *first = 0;
+    }
+}
+
+// Guards and unguarded loops of f and every function it reaches.
+static void mark_reached(const function* f, char* reached)
+{
+    int idx = (int)(f - fns);
+    if (reached[idx])
+        return;
+    reached[idx] = 1;
+    for (int i = 0; i < f->call_count; ++i)
+        mark_reached(&fns[f->calls[i].fn], reached);
+}
+
+static int analyse_hook(const hh_hook_def* def, FILE* out, int* first)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", HH_ROOT, def->source);
+    char* src = preprocess(path);
+    if (!src) {
+        fprintf(stderr, "hookguard: cannot preprocess %s\n", path);
+        return -1;
+    }
+    tokenize(src, path);
+    free(src);
+    find_functions();
+    for (int i = 0; i < fn_count; ++i)
+        analyse(&fns[i]);
+
+    static const char* const entries[] = {"hook", "cbak"};
+    for (size_t e = 0; e < 2; ++e) {
+        int idx = find_function(entries[e]);
+        if (idx < 0 || !fns[idx].main_file)
+            continue;
+        function* f = &fns[idx];
+        totals(f);
+        char* reached = calloc((size_t)fn_count, 1);
+        mark_reached(f, reached);
+        fprintf(out, "%s    {\"hook\": \"%s\", \"source\": \"%s\", \"entry\": \"%s\", \"guard_iterations\": %llu, "
+                     "\"budget\": %llu, \"unguarded_loops\": %d, \"guards\": [",
+                *first ? "" : ",\n", def->name, def->source, entries[e], (unsigned long long)f->guard_iterations,
+                (unsigned long long)f->budget, f->total_unguarded);
+        *first = 0;
+        int gfirst = 1;
+        for (int i = 0; i < fn_count; ++i)
+            if (reached[i])
+                write_guards(out, &fns[i], &gfirst);
+        fprintf(out, "], \"unguarded\": [");
+        int ufirst = 1;
+        for (int i = 0; i < fn_count; ++i) {
+            if (!reached[i])
+                continue;
+            for (int k = 0; k < fns[i].unguarded; ++k, ufirst = 0)
+                fprintf(out, "%s%d", ufirst ? "" : ", ", fns[i].unguarded_lines[k]);
+            for (int k = 0; k < fns[i].guard_count; ++k)
+                if (fns[i].guards[k].maxiter < 0) {
+                    fprintf(out, "%s%d", ufirst ? "" : ", ", fns[i].guards[k].line);
+                    ufirst = 0;
+                }
+        }
+        fprintf(out, "]}");
+        free(reached);
+
+        results = realloc(results, sizeof(entry_result) * (size_t)(result_count + 1));
+        entry_result* r = &results[result_count++];
+        snprintf(r->hook, sizeof(r->hook), "%s", def->name);
+        snprintf(r->entry, sizeof(r->entry), "%s", entries[e]);
+        r->guard_iterations = f->guard_iterations;
+        r->budget = f->budget;
+        r->unguarded = (uint64_t)f->total_unguarded;
+    }
+    reset();
+    return 0;
+}
+
+static int field(const char* line, const char* name, unsigned long long* v)
+{
+    char key[64];
+    snprintf(key, sizeof(key), "\"%s\": ", name);
+    const char* p = strstr(line, key);
+    return p && sscanf(p + strlen(key), "%llu", v) == 1;
+}
+
+static int text_field(const char* line, const char* name, char* out, size_t cap)
+{
+    char key[64];
+    snprintf(key, sizeof(key), "\"%s\": \"", name);
+    const char* p = strstr(line, key);
+    if (!p)
+        return 0;
+    p += strlen(key);
+    const char* e = strchr(p, '"');
+    if (!e || (size_t)(e - p) >= cap)
+        return 0;
+    memcpy(out, p, (size_t)(e - p));
+    out[e - p] = 0;
+    return 1;
+}
+
+// Returns the number of bounds that grew.
+static int compare(const char* baseline)
+{
+    FILE* f = fopen(baseline, "r");
+    if (!f) {
+        fprintf(stderr, "hookguard: no baseline at %s, nothing to compare\n", baseline);
+        return 0;
+    }
+    int grew = 0;
+    static char line[1 << 16];
+    printf("%-28s %-5s %10s %10s %10s  %s\n", "hook", "entry", "guards", "budget", "unguarded", "vs baseline");
+    int* seen = calloc((size_t)result_count + 1, sizeof(int));
+    while (fgets(line, sizeof(line), f)) {
+        char hook[64], entry[8];
+        unsigned long long gi, budget, ung;
+        if (!text_field(line, "hook", hook, sizeof(hook)) || !text_field(line, "entry", entry, sizeof(entry)) ||
+            !field(line, "guard_iterations", &gi) || !field(line, "budget", &budget) ||
+            !field(line, "unguarded_loops", &ung))
+            continue;
+        for (int i = 0; i < result_count; ++i) {
+            entry_result* r = &results[i];
+            if (strcmp(r->hook, hook) != 0 || strcmp(r->entry, entry) != 0)
+                continue;
+            seen[i] = 1;
+            int up = r->guard_iterations > gi || r->budget > budget || r->unguarded > ung;
+            printf("%-28s %-5s %10llu %10llu %10llu  ", r->hook, r->entry, (unsigned long long)r->guard_iterations,
+                   (unsigned long long)r->budget, (unsigned long long)r->unguarded);
+            if (r->guard_iterations == gi && r->budget == budget && r->unguarded == ung)
+                printf("=\n");
+            else
+                printf("guards %+lld, budget %+lld, unguarded %+lld%s\n",
+                       (long long)r->guard_iterations - (long long)gi, (long long)r->budget - (long long)budget,
+                       (long long)r->unguarded - (long long)ung, up ? "  INCREASED" : "");
+            grew += up;
+        }
+    }
+    for (int i = 0; i < result_count; ++i)
+        if (!seen[i])
+            printf("%-28s %-5s %10llu %10llu %10llu  new\n", results[i].hook, results[i].entry,
+                   (unsigned long long)results[i].guard_iterations, (unsigned long long)results[i].budget,
+                   (unsigned long long)results[i].unguarded);
+    free(seen);
+    fclose(f);
+    return grew;
+}
+
+int main(int argc, char** argv)
+{
+    const char *out_path = NULL, *baseline = NULL;
+    int update = 0, named = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            out_path = argv[++i];
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+            baseline = argv[++i];
+        else if (!strcmp(argv[i], "-u"))
+            update = 1;
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: hookguard [-o report.json] [-b baseline.json] [-u] [HookName...]\n");
+            return 2;
+        } else
+            named = 1;
+    }
+
+    char* report = NULL;
+    size_t report_len = 0;
+    FILE* out = open_memstream(&report, &report_len);
+    fprintf(out, "{\n  \"tool\": \"hookguard\",\n"
+                 "  \"budget_unit\": \"C tokens, loop bodies times their guard maxiter\",\n"
+                 "  \"entries\": [\n");
+    int first = 1, failed = 0;
+    for (size_t h = 0; h < hh_hook_count; ++h) {
+        const hh_hook_def* def = &hh_hooks[h];
+        int wanted = !named;
+        for (int i = 1; i < argc && !wanted; ++i)
+            wanted = !strcmp(argv[i], def->name);
+        if (wanted && analyse_hook(def, out, &first) != 0)
+            failed = 1;
+    }
+    fprintf(out, "\n  ]\n}\n");
+    fclose(out);
+    if (failed)
+        return 1;
+
+    if (out_path) {
+        FILE* f = fopen(out_path, "w");
+        if (!f) {
+            perror(out_path);
+            return 1;
+        }
+        fputs(report, f);
+        fclose(f);
+    } else if (!baseline)
+        fputs(report, stdout);
+
+    int grew = 0;
+    if (baseline && !update) {
+        grew = compare(baseline);
+        if (grew)
+            fprintf(stderr, "hookguard: %d worst-case bound(s) increased; run the guard-baseline target "
+                            "to accept them\n", grew);
+    }
+    if (baseline && update) {
+        FILE* f = fopen(baseline, "w");
+        if (!f) {
+            perror(baseline);
+            return 1;
+        }
+        fputs(report, f);
+        fclose(f);
+        printf("baseline written to %s\n", baseline);
+    }
+    free(report);
+    return grew ? 1 : 0;
+}
@@ -0,0 +1,522 @@
+//**************************************************************
+// hookload - HandyHooks ledger-scale load simulator
+//
+// Description:
+//   Installs the IssuanceHookset chain exactly as a SetHook
+//   transaction describes it (Docs/Transactions/Hookset.json: account,
+//   hook order, hashes, namespaces, HookOn and parameters), so the
+//   router's hook_skip calls address the real IDO and Rewards hashes.
+//   It then replays a synthetic sale:
+//
+//     phase1..4  every participant deposits once, spread evenly over
+//                the phases and over the ledgers of each phase
+//     phase5     the unwind share returns its IOU; if the soft cap was
+//                missed (refund mode) every participant does
+//     claims     the remaining participants invoke R_CLAIM, once per
+//                claim interval
+//
+//   Emitted transactions are applied by closing every ledger. For each
+//   phase it reports the transactions submitted and rejected, emitted
+//   transactions applied, state entries and the hook account's owner
+//   reserve at the end of the phase, and fees burned.
+//
+// Usage:
+//   hookload [-n participants] [-x xah] [-u unwind%] [-c claims]
+//            [-s soft_cap] [-H Router,IDO,Rewards] [Hookset.json]
+//     -n  participants (default 10000)
+//     -x  XAH each participant deposits (default 20)
+//     -u  share of participants that unwind in phase 5 (default 5)
+//     -c  claim rounds after the sale (default 1)
+//     -s  override the SOFT_CAP parameter, in XAH
+//     -H  registry hooks for the Hooks entries, in order
+//         (default RouterMaster,IDOMaster,RewardsMaster)
+//**************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "harness.h"
+
+#ifndef HH_HOOKSET_JSON
+#define HH_HOOKSET_JSON "IssuanceHookset/Docs/Transactions/Hookset.json"
+#endif
+
+#define MAX_PHASES 8
+#define PARTICIPANT_XAH 10000  // balance each participant is funded with
+#define SALE_RECORD_XAH 22     // XAH total in IDOMaster's IDO_SALE record, big-endian
+
+typedef struct install {
+    const hh_hook_def* def;
+    uint8_t hash[32];
+    uint8_t ns[32];
+    uint8_t hookon[32];
+    int param_count;
+    hh_param params[HH_MAX_PARAMS];
+} install;
+
+typedef struct phase_stats {
+    const char* name;
+    uint64_t txns;
+    uint64_t rejected;
+    uint64_t emitted;
+    uint64_t emitted_failed;
+    uint64_t fee_burned;
+    size_t state;
+    uint32_t owner_count;
+    double seconds;
+} phase_stats;
+
+typedef struct participant {
+    uint8_t id[20];
+    uint64_t iou;              // issued to this participant, 0 once unwound
+} participant;
+
+static hh_ledger* ledger;
+static uint8_t hook_acc[20];
+static install chain[HH_MAX_CHAIN];
+static int chain_len;
+static participant* people;
+static uint32_t people_count;
+static phase_stats phases[MAX_PHASES];
+static int phase_count;
+static phase_stats* cur;
+static hh_result result;
+static clock_t phase_started;
+static hh_totals phase_base;
+
+// ---------------------------------------------------------------
+// Hookset.json
+// ---------------------------------------------------------------
+
+// The string value of "key" between from and to, copied into out.
+static int json_string(const char* from, const char* to, const char* key, char* out, size_t cap)
+{
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+    const char* p = strstr(from, pattern);
+    if (!p || p >= to)
+        return -1;
+    p = strchr(p + strlen(pattern), '"');
+    if (!p || p >= to)
+        return -1;
+    const char* e = strchr(++p, '"');
+    if (!e || (size_t)(e - p) >= cap)
+        return -1;
+    memcpy(out, p, (size_t)(e - p));
+    out[e - p] = 0;
+    return (int)(e - p);
+}
+
+static const char* object_end(const char* open)
+{
+    int level = 0;
+    for (const char* p = open; *p; ++p) {
+        if (*p == '{')
+            level++;
+        else if (*p == '}' && --level == 0)
+            return p;
+    }
+    return NULL;
+}
+
+// Classic r-address to account id.
+static int decode_address(const char* addr, uint8_t out[20])
+{
+    static const char alphabet[] = "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+    uint8_t b[25] = {0};
+    for (const char* c = addr; *c; ++c) {
+        const char* at = strchr(alphabet, *c);
+        if (!at)
+            return -1;
+        unsigned carry = (unsigned)(at - alphabet);
+        for (int j = 24; j >= 0; --j) {
+            carry += 58U * b[j];
+            b[j] = (uint8_t)carry;
+            carry >>= 8;
+        }
+        if (carry)
+            return -1;
+    }
+    memcpy(out, b + 1, 20);
+    return 0;
+}
+
+static int load_hookset(const char* path, char* const* names, int name_count)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    static char json[1 << 20];
+    size_t len = fread(json, 1, sizeof(json) - 1, f);
+    fclose(f);
+    json[len] = 0;
+
+    char text[2 * HH_MAX_PARAM_VALUE + 1];
+    const char* end = json + len;
+    if (json_string(json, end, "Account", text, sizeof(text)) < 0 || decode_address(text, hook_acc) != 0) {
+        fprintf(stderr, "hookload: no Account in %s\n", path);
+        return -1;
+    }
+    const char* hooks = strstr(json, "\"Hooks\"");
+    for (const char* h = hooks ? strstr(hooks, "\"Hook\"") : NULL; h && chain_len < name_count;
+         h = strstr(h + 1, "\"Hook\"")) {
+        const char* open = strchr(h, '{');
+        const char* close = open ? object_end(open) : NULL;
+        if (!close)
+            break;
+        install* in = &chain[chain_len];
+        in->def = hh_hook_find(names[chain_len]);
+        if (!in->def) {
+            fprintf(stderr, "hookload: unknown hook %s\n", names[chain_len]);
+            return -1;
+        }
+        if (json_string(open, close, "HookHash", text, sizeof(text)) < 0 || hh_hex(text, in->hash, 32) != 32 ||
+            json_string(open, close, "HookNamespace", text, sizeof(text)) < 0 || hh_hex(text, in->ns, 32) != 32 ||
+            json_string(open, close, "HookOn", text, sizeof(text)) < 0 || hh_hex(text, in->hookon, 32) != 32) {
+            fprintf(stderr, "hookload: incomplete Hook %d in %s\n", chain_len, path);
+            return -1;
+        }
+        for (const char* p = strstr(open, "\"HookParameterName\""); p && p < close && in->param_count < HH_MAX_PARAMS;
+             p = strstr(p + 1, "\"HookParameterName\"")) {
+            hh_param* prm = &in->params[in->param_count];
+            int n = json_string(p, close, "HookParameterName", text, sizeof(text));
+            int name_len = n > 0 ? hh_hex(text, prm->name, HH_MAX_PARAM_NAME) : -1;
+            n = json_string(p, close, "HookParameterValue", text, sizeof(text));
+            int value_len = n >= 0 ? hh_hex(text, prm->value, HH_MAX_PARAM_VALUE) : -1;
+            if (name_len <= 0 || value_len < 0)
+                continue;
+            prm->name_len = (uint32_t)name_len;
+            prm->value_len = (uint32_t)value_len;
+            in->param_count++;
+        }
+        chain_len++;
+        h = close;
+    }
+    if (chain_len != name_count) {
+        fprintf(stderr, "hookload: %s installs %d hooks, %d named\n", path, chain_len, name_count);
+        return -1;
+    }
+    return 0;
+}
+
+// A parameter of the first installed hook that has it.
+static hh_param* find_param(const char* name)
+{
+    for (int i = 0; i < chain_len; ++i)
+        for (int k = 0; k < chain[i].param_count; ++k) {
+            hh_param* p = &chain[i].params[k];
+            if (p->name_len == strlen(name) && !memcmp(p->name, name, p->name_len))
+                return p;
+        }
+    return NULL;
+}
+
+static uint64_t param_uint(const char* name, uint64_t fallback)
+{
+    const hh_param* p = find_param(name);
+    if (!p || !p->value_len || p->value_len > 8)
+        return fallback;
+    uint64_t v = 0;
+    for (uint32_t i = 0; i < p->value_len; ++i)
+        v = (v << 8) | p->value[i];
+    return v;
+}
+
+// ---------------------------------------------------------------
+// Phases
+// ---------------------------------------------------------------
+
+static void phase_begin(const char* name)
+{
+    cur = &phases[phase_count++];
+    cur->name = name;
+    phase_base = *hh_ledger_totals(ledger);
+    phase_started = clock();
+}
+
+static void phase_end(void)
+{
+    const hh_totals* t = hh_ledger_totals(ledger);
+    cur->emitted = t->emitted - phase_base.emitted;
+    cur->fee_burned = t->fee_burned - phase_base.fee_burned;
+    cur->state = hh_state_count(ledger);
+    cur->owner_count = hh_account_owner_count(ledger, hook_acc);
+    cur->seconds = (double)(clock() - phase_started) / CLOCKS_PER_SEC;
+}
+
+static void on_emitted(void* ctx, const hh_result* r)
+{
+    (void)ctx;
+    if (r->ter != HH_TES_SUCCESS)
+        cur->emitted_failed++;
+}
+
+static void close_ledgers(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+        hh_ledger_close(ledger, on_emitted, NULL);
+}
+
+static void submit(const hh_txn* t)
+{
+    hh_submit(ledger, t, &result);
+    cur->txns++;
+    if (result.ter != HH_TES_SUCCESS)
+        cur->rejected++;
+}
+
+// Submits fn(i) for every i in [first, last) spread over `ledgers`
+// ledgers, closing each one.
+static void spread(uint32_t first, uint32_t last, uint32_t ledgers, void (*fn)(uint32_t))
+{
+    uint32_t n = last - first;
+    for (uint32_t l = 0; l < ledgers; ++l) {
+        uint32_t from = first + (uint32_t)((uint64_t)n * l / ledgers);
+        uint32_t to = first + (uint32_t)((uint64_t)n * (l + 1) / ledgers);
+        for (uint32_t i = from; i < to; ++i)
+            fn(i);
+        close_ledgers(1);
+    }
+}
+
+static uint64_t deposit_xah;
+static const hh_param* wp_lnk;
+static uint8_t currency[20];
+
+static uint64_t multiplier;
+
+static void deposit(uint32_t i)
+{
+    hh_txn t;
+    hh_txn_init(&t, 0, people[i].id);
+    memcpy(t.destination, hook_acc, 20);
+    t.has_destination = 1;
+    t.has_amount = 1;
+    hh_amount_drops(&t.amount, deposit_xah * 1000000ULL);
+    if (wp_lnk)
+        hh_txn_param(&t, "WP_LNK", wp_lnk->value, wp_lnk->value_len);
+    submit(&t);
+    if (result.ter == HH_TES_SUCCESS)
+        people[i].iou += deposit_xah * multiplier;
+}
+
+static void unwind(uint32_t i)
+{
+    if (!people[i].iou)
+        return;
+    char text[32];
+    snprintf(text, sizeof(text), "%llu", (unsigned long long)people[i].iou);
+    hh_txn t;
+    hh_txn_init(&t, 0, people[i].id);
+    memcpy(t.destination, hook_acc, 20);
+    t.has_destination = 1;
+    t.has_amount = 1;
+    hh_amount_iou(&t.amount, hh_xfl_parse(text), currency, hook_acc);
+    submit(&t);
+    if (result.ter == HH_TES_SUCCESS)
+        people[i].iou = 0;
+}
+
+static void claim(uint32_t i)
+{
+    if (!people[i].iou)
+        return;
+    hh_txn t;
+    hh_txn_init(&t, 99, people[i].id);
+    memcpy(t.destination, hook_acc, 20);
+    t.has_destination = 1;
+    hh_txn_param(&t, "R_CLAIM", people[i].id, 20);
+    submit(&t);
+}
+
+static uint32_t unwind_share;
+static uint8_t ido_ns[32];
+static int refund_mode;
+
+static void maybe_unwind(uint32_t i)
+{
+    if (refund_mode || i % 100 < unwind_share)
+        unwind(i);
+}
+
+// ---------------------------------------------------------------
+
+static void report(void)
+{
+    printf("%-8s %9s %9s %9s %8s %10s %12s %12s %7s\n", "phase", "txns", "rejected", "emitted", "failed",
+           "state", "reserve XAH", "fee burned", "secs");
+    uint64_t txns = 0, emitted = 0, fee = 0;
+    for (int i = 0; i < phase_count; ++i) {
+        const phase_stats* p = &phases[i];
+        uint64_t reserve = (uint64_t)p->owner_count * HH_RESERVE_INC;
+        printf("%-8s %9llu %9llu %9llu %8llu %10zu %12.1f %12llu %7.2f\n", p->name, (unsigned long long)p->txns,
+               (unsigned long long)p->rejected, (unsigned long long)p->emitted,
+               (unsigned long long)p->emitted_failed, p->state, (double)reserve / 1e6,
+               (unsigned long long)p->fee_burned, p->seconds);
+        txns += p->txns;
+        emitted += p->emitted;
+        fee += p->fee_burned;
+    }
+    const phase_stats* last = &phases[phase_count - 1];
+    printf("%-8s %9llu %9s %9llu %8s %10zu %12.1f %12llu\n", "total", (unsigned long long)txns, "",
+           (unsigned long long)emitted, "", last->state, (double)last->owner_count * HH_RESERVE_INC / 1e6,
+           (unsigned long long)fee);
+    printf("\n%u participants: %.2f state entries and %.3f XAH owner reserve each\n", people_count,
+           (double)last->state / people_count, (double)last->owner_count * HH_RESERVE_INC / 1e6 / people_count);
+}
+
+static int run(int argc, char** argv)
+{
+    const char* hookset = HH_HOOKSET_JSON;
+    char hooks_arg[256] = "RouterMaster,IDOMaster,RewardsMaster";
+    uint32_t claims = 1;
+    int64_t soft_cap = -1;
+    people_count = 10000;
+    deposit_xah = 20;
+    unwind_share = 5;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            people_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-x") && i + 1 < argc)
+            deposit_xah = strtoull(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-u") && i + 1 < argc)
+            unwind_share = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+            claims = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            soft_cap = strtoll(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-H") && i + 1 < argc)
+            snprintf(hooks_arg, sizeof(hooks_arg), "%s", argv[++i]);
+        else if (argv[i][0] != '-')
+            hookset = argv[i];
+        else {
+            fprintf(stderr, "usage: hookload [-n participants] [-x xah] [-u unwind%%] [-c claims] "
+                            "[-s soft_cap] [-H Router,IDO,Rewards] [Hookset.json]\n");
+            return 2;
+        }
+    }
+    if (!people_count || !deposit_xah || unwind_share > 100) {
+        fprintf(stderr, "hookload: need participants and a deposit, unwind share up to 100\n");
+        return 2;
+    }
+
+    char* names[HH_MAX_CHAIN];
+    int name_count = 0;
+    for (char* s = strtok(hooks_arg, ","); s && name_count < HH_MAX_CHAIN; s = strtok(NULL, ","))
+        names[name_count++] = s;
+    if (load_hookset(hookset, names, name_count) != 0)
+        return 1;
+
+    hh_param* cap = find_param("SOFT_CAP");
+    if (soft_cap >= 0 && cap) {
+        for (int i = 0; i < 8; ++i)
+            cap->value[i] = (uint8_t)((uint64_t)soft_cap >> (56 - 8 * i));
+        cap->value_len = 8;
+    }
+    uint64_t cap_xah = param_uint("SOFT_CAP", 0);
+    for (int i = 0; i < chain_len; ++i)
+        for (int k = 0; k < chain[i].param_count; ++k)
+            if (chain[i].params[k].name_len == 8 && !memcmp(chain[i].params[k].name, "SOFT_CAP", 8))
+                memcpy(ido_ns, chain[i].ns, 32);
+    uint32_t interval = (uint32_t)param_uint("INTERVAL", 30);
+    uint32_t claim_interval = (uint32_t)param_uint("SET_INTERVAL", interval);
+    wp_lnk = find_param("WP_LNK");
+    const hh_param* cur_param = find_param("CURRENCY");
+    if (cur_param && cur_param->value_len == 20)
+        memcpy(currency, cur_param->value, 20);
+    const hh_param* admin_param = find_param("ADMIN");
+    uint8_t admin[20];
+    if (!admin_param || admin_param->value_len != 20) {
+        fprintf(stderr, "hookload: no ADMIN parameter in %s\n", hookset);
+        return 1;
+    }
+    memcpy(admin, admin_param->value, 20);
+
+    printf("%s: %d hooks, %u participants x %llu XAH, soft cap %llu XAH, interval %u ledgers\n\n", hookset,
+           chain_len, people_count, (unsigned long long)deposit_xah, (unsigned long long)cap_xah, interval);
+
+    ledger = hh_ledger_new(1000, 750000000);
+    hh_result_init(&result);
+    phase_begin("setup");
+    // funded far beyond its reserve, which the report measures
+    hh_account_create(ledger, hook_acc, 100000000ULL * 1000000ULL);
+    hh_account_create(ledger, admin, 1000ULL * 1000000ULL);
+    for (int i = 0; i < chain_len; ++i) {
+        hh_hook_opts o = {chain[i].hash, chain[i].ns, chain[i].hookon, chain[i].param_count, chain[i].params};
+        if (hh_hook_set(ledger, hook_acc, i, chain[i].def, &o) != 0) {
+            fprintf(stderr, "hookload: cannot install %s\n", chain[i].def->name);
+            return 1;
+        }
+    }
+    people = calloc(people_count, sizeof(participant));
+    for (uint32_t i = 0; i < people_count; ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "participant%u", i);
+        hh_account_id(name, people[i].id);
+        hh_account_create(ledger, people[i].id, PARTICIPANT_XAH * 1000000ULL);
+    }
+
+    hh_txn t;
+    hh_txn_init(&t, 99, admin);
+    memcpy(t.destination, hook_acc, 20);
+    t.has_destination = 1;
+    uint8_t start[4] = {0, 0, 0, 1};
+    hh_txn_param(&t, "START", start, 4);
+    submit(&t);
+    if (result.ter != HH_TES_SUCCESS) {
+        fprintf(stderr, "hookload: START rejected: %.*s\n", (int)result.execs[result.exec_count - 1].reason_len,
+                result.execs[result.exec_count - 1].reason);
+        return 1;
+    }
+    close_ledgers(1);
+    phase_end();
+
+    // Participants are split into four contiguous blocks, one per
+    // deposit phase.
+    static const char* const deposit_phases[] = {"phase1", "phase2", "phase3", "phase4"};
+    for (uint32_t p = 0; p < 4; ++p) {
+        phase_begin(deposit_phases[p]);
+        multiplier = 100 - 25 * p;
+        spread((uint32_t)((uint64_t)people_count * p / 4), (uint32_t)((uint64_t)people_count * (p + 1) / 4), interval,
+               deposit);
+        phase_end();
+    }
+
+    // The first unwind after phase 4 makes IDOMaster compare what it
+    // raised with SOFT_CAP; below it every participant is refunded.
+    // IDOMaster keeps the total in its IDO_SALE record, IDOMulti under XAH.
+    uint8_t raised[8] = {0};
+    uint8_t sale[SALE_RECORD_XAH + 8];
+    if (hh_state_get(ledger, hook_acc, ido_ns, (const uint8_t*)"IDO_SALE", 8, sale, sizeof(sale)) >= (int64_t)sizeof(sale))
+        memcpy(raised, sale + SALE_RECORD_XAH, 8);
+    else
+        hh_state_get(ledger, hook_acc, ido_ns, (const uint8_t*)"XAH", 3, raised, 8);
+    uint64_t raised_xah = 0;
+    for (int i = 0; i < 8; ++i)
+        raised_xah = (raised_xah << 8) | raised[i];
+    refund_mode = raised_xah < cap_xah;
+    phase_begin(refund_mode ? "refund" : "phase5");
+    spread(0, people_count, interval, maybe_unwind);
+    phase_end();
+
+    for (uint32_t round = 0; round < claims; ++round) {
+        phase_begin("claims");
+        spread(0, people_count, claim_interval, claim);
+        phase_end();
+    }
+
+    report();
+    hh_result_free(&result);
+    hh_ledger_free(ledger);
+    free(people);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    return hh_run(run, argc, argv);
+}
@@ -0,0 +1,1345 @@
+//**************************************************************
+// hookon - HandyHooks minimal HookOn masks
+//
+// Description:
+//   Preprocesses every registered hook and walks hook() once per
+//   account transaction type, with otxn_type() fixed to that type and
+//   otxn_field() answering DOESNT_EXIST for the fields the type cannot
+//   carry. Conditions that do not depend on the type are followed both
+//   ways. A type is left out of the mask only when every path ends in
+//   accept() without anything else happening on the way:
+//
+//     work      a call that is not a plain read (state_set, emit,
+//               etxn_reserve, hook_skip...) or to a function that makes
+//               one
+//     rollback  rollback() or a return without accept(); HookOn would
+//               turn it into a success, so the hook must still fire
+//
+//   A type on which every path rolls back is reported as refused rather
+//   than firing, but stays in the mask for the same reason.
+//
+//   The hook is assumed installed as documented: hook_account() and
+//   otxn_field(sfAccount) return 20 bytes and every hook_param() fills
+//   its buffer. Everything else a hook reads is unknown.
+//
+//   Per hook it prints the types that fire or are refused, the first
+//   line that makes each one do so, and the mask. -m and -s check the HookOn of a
+//   hookstore manifest (matched by source_path) and of a SetHook
+//   transaction (hooks named in order, as for hookload) against it,
+//   and the exit status is 1 when one of them differs.
+//
+// Usage:
+//   hookon [-v] [-m manifest.json] [-s Hookset.json] [-H A,B,C] [HookName...]
+//     -v  print every type, the passing ones too
+//**************************************************************
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+#include "../hookapi/error.h"
+#include "../hookapi/sfcodes.h"
+
+#ifndef HH_CC
+#define HH_CC "cc"
+#endif
+#ifndef HH_HOOKAPI_DIR
+#define HH_HOOKAPI_DIR "Tools/Harness/hookapi"
+#endif
+#ifndef HH_ROOT
+#define HH_ROOT "."
+#endif
+
+#define TT_HOOK_SET 22
+#define MAX_VARS 96
+
+// Fields the walk knows the presence of
+#define F_AMOUNT 1
+#define F_DESTINATION 2
+
+typedef struct tx_type {
+    int tt;
+    const char* name;          // as in hookstore manifests
+    int has;                   // always present
+    int may;                   // optional
+} tx_type;
+
+static const tx_type tx_types[] = {
+    {0, "PAYMENT", F_AMOUNT | F_DESTINATION, 0},
+    {1, "ESCROW_CREATE", F_AMOUNT | F_DESTINATION, 0},
+    {2, "ESCROW_FINISH", 0, 0},
+    {3, "ACCOUNT_SET", 0, 0},
+    {4, "ESCROW_CANCEL", 0, 0},
+    {5, "REGULAR_KEY_SET", 0, 0},
+    {7, "OFFER_CREATE", 0, 0},
+    {8, "OFFER_CANCEL", 0, 0},
+    {10, "TICKET_CREATE", 0, 0},
+    {12, "SIGNER_LIST_SET", 0, 0},
+    {13, "PAYCHAN_CREATE", F_AMOUNT | F_DESTINATION, 0},
+    {14, "PAYCHAN_FUND", F_AMOUNT, 0},
+    {15, "PAYCHAN_CLAIM", 0, F_AMOUNT},
+    {16, "CHECK_CREATE", F_DESTINATION, 0},
+    {17, "CHECK_CASH", 0, F_AMOUNT},
+    {18, "CHECK_CANCEL", 0, 0},
+    {19, "DEPOSIT_PREAUTH", 0, 0},
+    {20, "TRUST_SET", 0, 0},
+    {21, "ACCOUNT_DELETE", F_DESTINATION, 0},
+    {22, "HOOK_SET", 0, 0},
+    {45, "URITOKEN_MINT", 0, F_AMOUNT | F_DESTINATION},
+    {46, "URITOKEN_BURN", 0, 0},
+    {47, "URITOKEN_BUY", F_AMOUNT, 0},
+    {48, "URITOKEN_CREATE_SELL_OFFER", F_AMOUNT, F_DESTINATION},
+    {49, "URITOKEN_CANCEL_SELL_OFFER", 0, 0},
+    {95, "REMIT", F_DESTINATION, 0},
+    {96, "GENESIS_MINT", 0, 0},
+    {97, "IMPORT", 0, 0},
+    {98, "CLAIM_REWARD", 0, 0},
+    {99, "INVOKE", 0, F_DESTINATION},
+};
+#define TX_TYPE_COUNT ((int)(sizeof(tx_types) / sizeof(tx_types[0])))
+
+// Calls that only read; their result is unknown unless modelled below
+static const char* const reads[] = {
+    "_g", "otxn_param", "otxn_id", "otxn_slot", "otxn_burden", "otxn_generation", "state", "state_foreign",
+    "ledger_seq", "ledger_last_time", "ledger_last_hash", "ledger_keylet", "ledger_nonce", "fee_base", "hook_hash",
+    "hook_pos", "slot", "slot_set", "slot_subfield", "slot_subarray", "slot_count", "slot_type", "slot_float",
+    "slot_size", "slot_id", "meta_slot", "etxn_fee_base", "etxn_details", "etxn_burden", "etxn_generation",
+    "etxn_nonce", "trace", "trace_num", "trace_float", "util_keylet", "util_accid", "util_raddr", "util_sha512h",
+    "util_verify", "sto_subfield", "sto_subarray", "sto_emplace", "sto_erase", "sto_validate", "float_set",
+    "float_multiply", "float_mulratio", "float_negate", "float_compare", "float_sum", "float_sto", "float_sto_set",
+    "float_invert", "float_divide", "float_one", "float_mantissa", "float_sign", "float_int", "float_log",
+    "float_root", "hook_param", "hook_account", "otxn_field", "otxn_type",
+};
+
+typedef enum tok_kind { T_IDENT, T_NUM, T_STR, T_PUNCT } tok_kind;
+
+typedef struct token {
+    tok_kind kind;
+    char* text;
+    int line;
+    int main_file;
+} token;
+
+typedef struct function {
+    char* name;
+    int body;
+    int body_end;
+    int purity;                // 0 unknown, 1 pure, -1 impure, 2 being checked
+} function;
+
+typedef struct value {
+    int known;
+    int64_t v;
+} value;
+
+typedef struct var {
+    const char* name;
+    value val;
+} var;
+
+typedef struct env {
+    int count;
+    var vars[MAX_VARS];
+} env;
+
+// Walk flags
+#define W_FALL 1
+#define W_PASS 2
+#define W_BREAK 4
+#define W_STOP 8               // does work: the walk is over
+#define W_REJECT 16
+
+static token* toks;
+static int tok_count, tok_cap;
+static function* fns;
+static int fn_count;
+static int fn_body, fn_end;    // hook() being walked
+
+static const tx_type* cur_type;
+static int fire_line;
+static char fire_why[96];
+static int reject_line;
+
+// ---------------------------------------------------------------
+// Preprocessing and tokens
+// ---------------------------------------------------------------
+
+static char* preprocess(const char* path)
+{
+    char cmd[8192];
+    snprintf(cmd, sizeof(cmd), "\"%s\" -E -w -I\"%s\" \"%s\"", HH_CC, HH_HOOKAPI_DIR, path);
+    FILE* p = popen(cmd, "r");
+    if (!p)
+        return NULL;
+    size_t len = 0, cap = 1 << 16;
+    char* out = malloc(cap);
+    size_t n;
+    while ((n = fread(out + len, 1, cap - len - 1, p)) > 0) {
+        len += n;
+        if (cap - len < 4096)
+            out = realloc(out, cap *= 2);
+    }
+    out[len] = 0;
+    if (pclose(p) != 0) {
+        free(out);
+        return NULL;
+    }
+    return out;
+}
+
+static void push_token(tok_kind kind, const char* s, size_t n, int line, int main_file)
+{
+    if (tok_count == tok_cap) {
+        tok_cap = tok_cap ? tok_cap * 2 : 4096;
+        toks = realloc(toks, sizeof(token) * (size_t)tok_cap);
+    }
+    token* t = &toks[tok_count++];
+    t->kind = kind;
+    t->text = strndup(s, n);
+    t->line = line;
+    t->main_file = main_file;
+}
+
+static void tokenize(const char* src, const char* main_path)
+{
+    static const char* const puncts[] = {"<<=", ">>=", "...", "->", "++", "--", "<<", ">>", "<=", ">=", "==",
+                                         "!=", "&&", "||", "+=", "-=", "*=", "/=", "%=", "&=", "^=", "|=", "##"};
+    int line = 1, main_file = 1, bol = 1;
+    const char* p = src;
+    while (*p) {
+        if (*p == '\n') {
+            ++line;
+            ++p;
+            bol = 1;
+            continue;
+        }
+        if (isspace((unsigned char)*p)) {
+            ++p;
+            continue;
+        }
+        if (bol && *p == '#') {
+            char file[4096];
+            int l;
+            if (sscanf(p, "# %d \"%4095[^\"]\"", &l, file) == 2) {
+                line = l - 1;
+                main_file = strcmp(file, main_path) == 0;
+            }
+            while (*p && *p != '\n')
+                ++p;
+            continue;
+        }
+        bol = 0;
+        const char* s = p;
+        if (isalpha((unsigned char)*p) || *p == '_') {
+            while (isalnum((unsigned char)*p) || *p == '_')
+                ++p;
+            push_token(T_IDENT, s, (size_t)(p - s), line, main_file);
+        } else if (isdigit((unsigned char)*p)) {
+            while (isalnum((unsigned char)*p) || *p == '.' || *p == '_')
+                ++p;
+            push_token(T_NUM, s, (size_t)(p - s), line, main_file);
+        } else if (*p == '"' || *p == '\'') {
+            char q = *p++;
+            while (*p && *p != q) {
+                if (*p == '\\' && p[1])
+                    ++p;
+                ++p;
+            }
+            if (*p)
+                ++p;
+            push_token(T_STR, s, (size_t)(p - s), line, main_file);
+        } else {
+            size_t n = 1;
+            for (size_t i = 0; i < sizeof(puncts) / sizeof(puncts[0]); ++i) {
+                size_t l = strlen(puncts[i]);
+                if (!strncmp(p, puncts[i], l)) {
+                    n = l;
+                    break;
+                }
+            }
+            p += n;
+            push_token(T_PUNCT, s, n, line, main_file);
+        }
+    }
+}
+
+static void reset(void)
+{
+    for (int i = 0; i < tok_count; ++i)
+        free(toks[i].text);
+    tok_count = 0;
+    free(fns);
+    fns = NULL;
+    fn_count = 0;
+}
+
+static int is(int i, const char* text)
+{
+    return i < tok_count && !strcmp(toks[i].text, text);
+}
+
+static int matching(int i)
+{
+    const char* open = toks[i].text;
+    const char* close = !strcmp(open, "(") ? ")" : !strcmp(open, "[") ? "]" : "}";
+    int level = 0;
+    for (int j = i; j < tok_count; ++j) {
+        if (is(j, open))
+            level++;
+        else if (is(j, close) && --level == 0)
+            return j;
+    }
+    return tok_count - 1;
+}
+
+static void find_functions(void)
+{
+    for (int i = 0; i < tok_count; ++i) {
+        if (!is(i, "{"))
+            continue;
+        int end = matching(i);
+        if (i > 0 && is(i - 1, ")")) {
+            int level = 0, open = i - 1;
+            for (; open >= 0; --open) {
+                if (is(open, ")"))
+                    level++;
+                else if (is(open, "(") && --level == 0)
+                    break;
+            }
+            if (open > 0 && toks[open - 1].kind == T_IDENT) {
+                fns = realloc(fns, sizeof(function) * (size_t)(fn_count + 1));
+                function* f = &fns[fn_count++];
+                f->name = toks[open - 1].text;
+                f->body = i;
+                f->body_end = end;
+                f->purity = 0;
+            }
+        }
+        i = end;
+    }
+}
+
+static function* find_function(const char* name)
+{
+    for (int i = 0; i < fn_count; ++i)
+        if (!strcmp(fns[i].name, name))
+            return &fns[i];
+    return NULL;
+}
+
+static int is_read(const char* name)
+{
+    for (size_t i = 0; i < sizeof(reads) / sizeof(reads[0]); ++i)
+        if (!strcmp(reads[i], name))
+            return 1;
+    return 0;
+}
+
+// A function of the hook source is pure when every call it makes is.
+static int pure_function(function* f)
+{
+    if (f->purity)
+        return f->purity == 1 || f->purity == 2;
+    f->purity = 2;
+    int pure = 1;
+    for (int i = f->body + 1; i < f->body_end && pure; ++i) {
+        if (toks[i].kind != T_IDENT || !is(i + 1, "("))
+            continue;
+        function* g = find_function(toks[i].text);
+        if (g)
+            pure = pure_function(g);
+        else if (!is_read(toks[i].text) && strcmp(toks[i].text, "sizeof") != 0)
+            pure = 0;
+    }
+    f->purity = pure ? 1 : -1;
+    return pure;
+}
+
+static int is_type_word(int i)
+{
+    static const char* const words[] = {"char", "int", "long", "short", "unsigned", "signed", "const", "static",
+                                        "volatile", "void", "struct", "register", "float", "double"};
+    if (i >= tok_count || toks[i].kind != T_IDENT)
+        return 0;
+    for (size_t k = 0; k < sizeof(words) / sizeof(words[0]); ++k)
+        if (!strcmp(toks[i].text, words[k]))
+            return 1;
+    size_t n = strlen(toks[i].text);
+    return n > 2 && !strcmp(toks[i].text + n - 2, "_t");
+}
+
+static int64_t type_size(int i)
+{
+    static const struct { const char* name; int64_t size; } types[] = {
+        {"char", 1}, {"uint8_t", 1}, {"int8_t", 1}, {"uint16_t", 2}, {"int16_t", 2}, {"uint32_t", 4},
+        {"int32_t", 4}, {"int", 4}, {"uint64_t", 8}, {"int64_t", 8}, {"long", 8}};
+    for (size_t k = 0; k < sizeof(types) / sizeof(types[0]); ++k)
+        if (is(i, types[k].name))
+            return types[k].size;
+    return 0;
+}
+
+// ---------------------------------------------------------------
+// Expressions: three-valued, with calls checked as they are met
+// ---------------------------------------------------------------
+
+static const value unknown = {0, 0};
+
+static int ex_pos, ex_end;
+static env* ex_env;
+static int ex_effect;          // 1 work, 2 accept, 3 rollback
+static int ex_effect_line;
+static const char* ex_effect_name;
+
+static value ex_assign(void);
+static value ex_ternary(void);
+static value ex_unary(void);
+
+static value known(int64_t v)
+{
+    value r = {1, v};
+    return r;
+}
+
+static var* lookup(env* e, const char* name)
+{
+    for (int i = e->count - 1; i >= 0; --i)
+        if (!strcmp(e->vars[i].name, name))
+            return &e->vars[i];
+    return NULL;
+}
+
+static void set_var(env* e, const char* name, value v)
+{
+    var* x = lookup(e, name);
+    if (!x && e->count < MAX_VARS) {
+        x = &e->vars[e->count++];
+        x->name = name;
+    }
+    if (x)
+        x->val = v;
+}
+
+static void effect(int kind, int at)
+{
+    if (kind > ex_effect) {
+        ex_effect = kind;
+        ex_effect_line = toks[at].line;
+        ex_effect_name = toks[at].text;
+    }
+}
+
+// sizeof an array declared earlier in hook().
+static value size_of(int i)
+{
+    int64_t t = type_size(i);
+    if (t)
+        return known(t);
+    for (int j = i - 1; j > fn_body; --j) {
+        if (strcmp(toks[j].text, toks[i].text) != 0 || !is(j + 1, "[") || !type_size(j - 1))
+            continue;
+        int close = matching(j + 1);
+        if (close == j + 3 && toks[j + 2].kind == T_NUM)
+            return known(type_size(j - 1) * (int64_t)strtoull(toks[j + 2].text, NULL, 0));
+        return unknown;
+    }
+    return unknown;
+}
+
+static int field_bit(int64_t field)
+{
+    return field == sfAmount ? F_AMOUNT : field == sfDestination ? F_DESTINATION : 0;
+}
+
+// Splits call arguments at top-level commas; returns how many.
+static int arguments(int open, int close, int* starts, int* ends, int max)
+{
+    int n = 0, level = 0, s = open + 1;
+    for (int j = open + 1; j <= close && n < max; ++j) {
+        if (is(j, "(") || is(j, "[") || is(j, "{"))
+            level++;
+        else if ((is(j, ")") || is(j, "]") || is(j, "}")) && j != close)
+            level--;
+        if ((level == 0 && is(j, ",")) || j == close) {
+            if (j > s) {
+                starts[n] = s;
+                ends[n] = j;
+                n++;
+            }
+            s = j + 1;
+        }
+    }
+    return n;
+}
+
+static value evaluate(int from, int to)
+{
+    int save_pos = ex_pos, save_end = ex_end;
+    ex_pos = from;
+    ex_end = to;
+    value v = ex_assign();
+    while (ex_pos < ex_end && is(ex_pos, ",")) {
+        ++ex_pos;
+        v = ex_assign();
+    }
+    ex_pos = save_pos;
+    ex_end = save_end;
+    return v;
+}
+
+static value call(int name, int open)
+{
+    int close = matching(open);
+    int s[8], e[8];
+    int argc = arguments(open, close, s, e, 8);
+    value args[8];
+    for (int k = 0; k < argc; ++k)
+        args[k] = evaluate(s[k], e[k]);
+    ex_pos = close + 1;
+
+    const char* fn = toks[name].text;
+    if (!strcmp(fn, "accept")) {
+        effect(2, name);
+        return unknown;
+    }
+    if (!strcmp(fn, "rollback")) {
+        effect(3, name);
+        return unknown;
+    }
+    if (!strcmp(fn, "otxn_type"))
+        return known(cur_type->tt);
+    if (!strcmp(fn, "hook_account"))
+        return known(20);
+    if (!strcmp(fn, "hook_param") && argc >= 2)
+        return args[1];
+    if (!strcmp(fn, "otxn_field") && argc == 3 && args[2].known) {
+        if (args[2].v == sfAccount)
+            return known(20);
+        int bit = field_bit(args[2].v);
+        if (bit && !(cur_type->has & bit) && !(cur_type->may & bit))
+            return known(DOESNT_EXIST);
+        return unknown;
+    }
+    function* f = find_function(fn);
+    if (f ? !pure_function(f) : !is_read(fn))
+        effect(1, name);
+    return unknown;
+}
+
+static value ex_primary(void)
+{
+    if (ex_pos >= ex_end)
+        return unknown;
+    int i = ex_pos;
+    token* t = &toks[i];
+    if (is(i, "(")) {
+        int close = matching(i);
+        int cast = is_type_word(i + 1);
+        for (int j = i + 1; cast && j < close; ++j)
+            cast = is_type_word(j) || is(j, "*");
+        ex_pos = i + 1;
+        if (cast) {
+            ex_pos = close + 1;
+            return ex_unary();
+        }
+        value v = evaluate(i + 1, close);
+        ex_pos = close + 1;
+        return v;
+    }
+    if (is(i, "sizeof")) {
+        if (is(i + 1, "(")) {
+            int close = matching(i + 1);
+            ex_pos = close + 1;
+            return close == i + 3 ? size_of(i + 2) : unknown;
+        }
+        ex_pos = i + 1;
+        ex_unary();
+        return unknown;
+    }
+    if (t->kind == T_NUM) {
+        ++ex_pos;
+        return known((int64_t)strtoull(t->text, NULL, 0));
+    }
+    if (t->kind == T_STR) {
+        ++ex_pos;
+        while (ex_pos < ex_end && toks[ex_pos].kind == T_STR)
+            ++ex_pos;
+        if (t->text[0] == '\'' && t->text[1] != '\\')
+            return known((unsigned char)t->text[1]);
+        return unknown;
+    }
+    if (t->kind == T_IDENT) {
+        ++ex_pos;
+        if (is(ex_pos, "("))
+            return call(i, ex_pos);
+        var* x = lookup(ex_env, t->text);
+        return x ? x->val : unknown;
+    }
+    if (is(i, "{")) {
+        int close = matching(i);
+        evaluate(i + 1, close);
+        ex_pos = close + 1;
+        return unknown;
+    }
+    ++ex_pos;
+    return unknown;
+}
+
+static value ex_postfix(void)
+{
+    int start = ex_pos;
+    value v = ex_primary();
+    for (;;) {
+        if (is(ex_pos, "[") && ex_pos < ex_end) {
+            int close = matching(ex_pos);
+            evaluate(ex_pos + 1, close);
+            ex_pos = close + 1;
+            v = unknown;
+        } else if ((is(ex_pos, ".") || is(ex_pos, "->")) && ex_pos < ex_end) {
+            ex_pos += 2;
+            v = unknown;
+        } else if ((is(ex_pos, "++") || is(ex_pos, "--")) && ex_pos < ex_end) {
+            if (ex_pos == start + 1 && toks[start].kind == T_IDENT)
+                set_var(ex_env, toks[start].text, unknown);
+            ++ex_pos;
+            v = unknown;
+        } else if (is(ex_pos, "(") && ex_pos < ex_end) {
+            call(ex_pos - 1, ex_pos);
+            v = unknown;
+        } else
+            return v;
+    }
+}
+
+static value ex_unary(void)
+{
+    if (ex_pos >= ex_end)
+        return unknown;
+    if (is(ex_pos, "!") || is(ex_pos, "-") || is(ex_pos, "~") || is(ex_pos, "+")) {
+        char op = toks[ex_pos++].text[0];
+        value v = ex_unary();
+        if (!v.known)
+            return unknown;
+        return known(op == '!' ? !v.v : op == '-' ? -v.v : op == '~' ? ~v.v : v.v);
+    }
+    if (is(ex_pos, "++") || is(ex_pos, "--")) {
+        ++ex_pos;
+        if (ex_pos < ex_end && toks[ex_pos].kind == T_IDENT)
+            set_var(ex_env, toks[ex_pos].text, unknown);
+        ex_unary();
+        return unknown;
+    }
+    if (is(ex_pos, "*") || is(ex_pos, "&")) {
+        ++ex_pos;
+        ex_unary();
+        return unknown;
+    }
+    return ex_postfix();
+}
+
+typedef struct binop {
+    const char* op;
+    int prec;
+} binop;
+
+static const binop binops[] = {
+    {"||", 1}, {"&&", 2}, {"|", 3}, {"^", 4}, {"&", 5}, {"==", 6}, {"!=", 6}, {"<", 7}, {">", 7},
+    {"<=", 7}, {">=", 7}, {"<<", 8}, {">>", 8}, {"+", 9}, {"-", 9}, {"*", 10}, {"/", 10}, {"%", 10},
+};
+
+static int binop_prec(int i, const char** op)
+{
+    if (i >= ex_end)
+        return 0;
+    for (size_t k = 0; k < sizeof(binops) / sizeof(binops[0]); ++k)
+        if (is(i, binops[k].op)) {
+            *op = binops[k].op;
+            return binops[k].prec;
+        }
+    return 0;
+}
+
+static value apply(const char* op, value a, value b)
+{
+    if (!strcmp(op, "&&")) {
+        if ((a.known && !a.v) || (b.known && !b.v))
+            return known(0);
+        return a.known && b.known ? known(1) : unknown;
+    }
+    if (!strcmp(op, "||")) {
+        if ((a.known && a.v) || (b.known && b.v))
+            return known(1);
+        return a.known && b.known ? known(0) : unknown;
+    }
+    if (!a.known || !b.known)
+        return unknown;
+    int64_t x = a.v, y = b.v;
+    switch (op[0]) {
+    case '|': return known(x | y);
+    case '^': return known(x ^ y);
+    case '&': return known(x & y);
+    case '=': return known(x == y);
+    case '!': return known(x != y);
+    case '<': return known(op[1] == '<' ? (int64_t)((uint64_t)x << y) : op[1] == '=' ? x <= y : x < y);
+    case '>': return known(op[1] == '>' ? x >> y : op[1] == '=' ? x >= y : x > y);
+    case '+': return known(x + y);
+    case '-': return known(x - y);
+    case '*': return known(x * y);
+    case '/': return y ? known(x / y) : unknown;
+    case '%': return y ? known(x % y) : unknown;
+    }
+    return unknown;
+}
+
+static value ex_binary(int min_prec)
+{
+    value v = ex_unary();
+    const char* op;
+    int prec;
+    while ((prec = binop_prec(ex_pos, &op)) >= min_prec && prec > 0) {
+        ++ex_pos;
+        value r = ex_binary(prec + 1);
+        v = apply(op, v, r);
+    }
+    return v;
+}
+
+static value ex_ternary(void)
+{
+    value c = ex_binary(1);
+    if (ex_pos < ex_end && is(ex_pos, "?")) {
+        ++ex_pos;
+        value a = ex_assign();
+        if (is(ex_pos, ":"))
+            ++ex_pos;
+        value b = ex_assign();
+        if (c.known)
+            return c.v ? a : b;
+        return a.known && b.known && a.v == b.v ? a : unknown;
+    }
+    return c;
+}
+
+static value ex_assign(void)
+{
+    int start = ex_pos;
+    if (ex_pos + 1 < ex_end && toks[ex_pos].kind == T_IDENT) {
+        int op = ex_pos + 1;
+        static const char* const ops[] = {"=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<=", ">>="};
+        for (size_t k = 0; k < sizeof(ops) / sizeof(ops[0]); ++k) {
+            if (!is(op, ops[k]))
+                continue;
+            ex_pos = op + 1;
+            value v = ex_assign();
+            set_var(ex_env, toks[start].text, k == 0 ? v : unknown);
+            return v;
+        }
+    }
+    value v = ex_ternary();
+    if (ex_pos < ex_end && toks[ex_pos].kind == T_PUNCT && strchr(toks[ex_pos].text, '=') &&
+        strcmp(toks[ex_pos].text, "==") != 0) {
+        // element or pointer target: the value is not tracked
+        ++ex_pos;
+        ex_assign();
+        return unknown;
+    }
+    return v;
+}
+
+// ---------------------------------------------------------------
+// Statement walk
+// ---------------------------------------------------------------
+
+static int walk_stmt(int i, int* next, env* e);
+
+static int reject(int line)
+{
+    if (!reject_line)
+        reject_line = line;
+    return W_REJECT;
+}
+
+static int fire(int line, const char* why)
+{
+    if (!fire_line) {
+        fire_line = line;
+        snprintf(fire_why, sizeof(fire_why), "%s", why);
+    }
+    return W_STOP;
+}
+
+// Evaluates [from, to) for its calls: W_STOP on work, W_PASS or
+// W_REJECT when it accepts or rolls back, W_FALL otherwise.
+static int expression(int from, int to, env* e, value* out)
+{
+    ex_env = e;
+    ex_effect = 0;
+    value v = evaluate(from, to);
+    if (out)
+        *out = v;
+    if (ex_effect == 1) {
+        char why[96];
+        snprintf(why, sizeof(why), "calls %s", ex_effect_name);
+        return fire(ex_effect_line, why);
+    }
+    if (ex_effect == 3)
+        return reject(ex_effect_line);
+    if (ex_effect == 2)
+        return W_PASS;
+    return W_FALL;
+}
+
+// Variables assigned anywhere in [from, to) no longer hold one value.
+static void forget_assigned(int from, int to, env* e)
+{
+    for (int j = from; j < to; ++j) {
+        if (toks[j].kind != T_IDENT)
+            continue;
+        int op = j + 1;
+        if ((op < to && toks[op].kind == T_PUNCT && strchr(toks[op].text, '=') && strcmp(toks[op].text, "==")) ||
+            is(op, "++") || is(op, "--") || (j > from && (is(j - 1, "++") || is(j - 1, "--"))))
+            if (lookup(e, toks[j].text))
+                set_var(e, toks[j].text, unknown);
+    }
+}
+
+static void merge(env* into, const env* other)
+{
+    for (int i = 0; i < into->count; ++i) {
+        var* x = &into->vars[i];
+        var* y = lookup((env*)other, x->name);
+        if (!y || !y->val.known || !x->val.known || y->val.v != x->val.v)
+            x->val = unknown;
+    }
+}
+
+static int walk_list(int i, int end, env* e)
+{
+    int flags = 0;
+    while (i < end) {
+        int next;
+        int r = walk_stmt(i, &next, e);
+        if (r & W_STOP)
+            return W_STOP;
+        flags |= r & (W_PASS | W_REJECT | W_BREAK);
+        if (!(r & W_FALL))
+            return flags;
+        i = next;
+    }
+    return flags | W_FALL;
+}
+
+// Both arms of a branch, or the one a known condition takes; e
+// becomes what holds after it.
+static int branch(int then_at, int else_at, value cond, env* e)
+{
+    env a = *e, b = *e;
+    int ra = 0, rb = 0, after;
+    if (!cond.known || cond.v)
+        ra = walk_stmt(then_at, &after, &a);
+    if (!cond.known || !cond.v)
+        rb = else_at >= 0 ? walk_stmt(else_at, &after, &b) : W_FALL;
+    if ((ra | rb) & W_STOP)
+        return W_STOP;
+    if ((ra & W_FALL) && (rb & W_FALL)) {
+        *e = a;
+        merge(e, &b);
+    } else if (ra & W_FALL)
+        *e = a;
+    else if (rb & W_FALL)
+        *e = b;
+    return ra | rb;
+}
+
+// End of the statement at i, without walking it.
+static int stmt_end(int i)
+{
+    if (is(i, "{"))
+        return matching(i) + 1;
+    if (is(i, "if") || is(i, "while") || is(i, "for") || is(i, "switch")) {
+        int after = stmt_end(matching(i + 1) + 1);
+        if (is(i, "if") && is(after, "else"))
+            after = stmt_end(after + 1);
+        return after;
+    }
+    if (is(i, "do")) {
+        int after = stmt_end(i + 1);
+        return stmt_end(after);
+    }
+    int level = 0;
+    for (int j = i; j < fn_end; ++j) {
+        if (is(j, "(") || is(j, "[") || is(j, "{"))
+            level++;
+        else if (is(j, ")") || is(j, "]") || is(j, "}"))
+            level--;
+        else if (level == 0 && is(j, ";"))
+            return j + 1;
+    }
+    return fn_end;
+}
+
+static int walk_loop(int cond_from, int cond_to, int body, int* next, env* e)
+{
+    forget_assigned(cond_from, stmt_end(body), e);
+    int r = expression(cond_from, cond_to, e, NULL);
+    if (r & W_STOP)
+        return r;
+    env inner = *e;
+    int rb = walk_stmt(body, next, &inner);
+    if (rb & W_STOP)
+        return W_STOP;
+    merge(e, &inner);
+    return (rb & (W_PASS | W_REJECT)) | W_FALL;
+}
+
+static int walk_stmt(int i, int* next, env* e)
+{
+    if (i >= fn_end) {
+        *next = fn_end;
+        return W_FALL;
+    }
+    if (is(i, "{")) {
+        int close = matching(i);
+        *next = close + 1;
+        return walk_list(i + 1, close, e);
+    }
+    if (is(i, ";")) {
+        *next = i + 1;
+        return W_FALL;
+    }
+    if (is(i, "if")) {
+        int close = matching(i + 1);
+        value cond;
+        int r = expression(i + 2, close, e, &cond);
+        if (r & W_STOP)
+            return r;
+        int then_at = close + 1, else_at = -1;
+        int after = stmt_end(then_at);
+        if (is(after, "else"))
+            else_at = after + 1;
+        int flags = branch(then_at, else_at, cond, e);
+        *next = else_at >= 0 ? stmt_end(else_at) : after;
+        return flags;
+    }
+    if (is(i, "while")) {
+        int close = matching(i + 1);
+        int r = walk_loop(i + 2, close, close + 1, next, e);
+        *next = stmt_end(i);
+        return r;
+    }
+    if (is(i, "for")) {
+        int close = matching(i + 1);
+        int semi1 = i + 2, semi2;
+        while (semi1 < close && !is(semi1, ";"))
+            ++semi1;
+        semi2 = semi1 + 1;
+        while (semi2 < close && !is(semi2, ";"))
+            ++semi2;
+        int r = expression(i + 2, semi1, e, NULL);
+        if (r & W_STOP)
+            return r;
+        r = walk_loop(semi1 + 1, close, close + 1, next, e);
+        *next = stmt_end(i);
+        return r;
+    }
+    if (is(i, "do")) {
+        int body_end = stmt_end(i + 1);
+        int r = walk_loop(body_end + 2, matching(body_end + 1), i + 1, next, e);
+        *next = stmt_end(i);
+        return r;
+    }
+    if (is(i, "switch")) {
+        int close = matching(i + 1);
+        int r = expression(i + 2, close, e, NULL);
+        if (r & W_STOP)
+            return r;
+        int body = close + 1, body_close = matching(body);
+        int flags = W_FALL;    // no case may match
+        for (int j = body + 1; j < body_close; ++j) {
+            if (!is(j, "case") && !is(j, "default"))
+                continue;
+            while (j < body_close && !is(j, ":"))
+                ++j;
+            env c = *e;
+            int rc = walk_list(j + 1, body_close, &c);
+            if (rc & W_STOP)
+                return W_STOP;
+            flags |= rc & (W_PASS | W_REJECT);
+            if (rc & (W_FALL | W_BREAK)) {
+                flags |= W_FALL;
+                merge(e, &c);
+            }
+        }
+        *next = body_close + 1;
+        return flags;
+    }
+    if (is(i, "break") || is(i, "continue")) {
+        *next = i + 2;
+        return W_BREAK;
+    }
+    if (is(i, "return")) {
+        *next = stmt_end(i);
+        int r = expression(i + 1, *next - 1, e, NULL);
+        return r & (W_STOP | W_PASS | W_REJECT) ? r : reject(toks[i].line);
+    }
+    if (is(i, "goto")) {
+        *next = stmt_end(i);
+        return fire(toks[i].line, "goto");
+    }
+    if (toks[i].kind == T_IDENT && is(i + 1, ":") && !is(i, "default")) {
+        *next = i + 2;
+        return W_FALL;
+    }
+
+    // Declaration or expression statement
+    int end = stmt_end(i);
+    *next = end;
+    int from = i;
+    if (is_type_word(i)) {
+        while (from < end && (is_type_word(from) || is(from, "*")))
+            ++from;
+        // declarators: name [dims] [= init], ...
+        int s[16], t[16];
+        int n = arguments(from - 1, end - 1, s, t, 16);
+        int flags = W_FALL;
+        for (int k = 0; k < n; ++k) {
+            int d = s[k];
+            while (d < t[k] && is(d, "*"))
+                ++d;
+            int eq = d;
+            while (eq < t[k] && !is(eq, "="))
+                ++eq;
+            if (eq >= t[k])
+                continue;
+            value v;
+            int r = expression(eq + 1, t[k], e, &v);
+            if (r & W_STOP)
+                return r;
+            if (r & (W_PASS | W_REJECT))
+                return r & (W_PASS | W_REJECT);
+            if (toks[d].kind == T_IDENT)
+                set_var(e, toks[d].text, is(d + 1, "[") ? unknown : v);
+        }
+        return flags;
+    }
+    int r = expression(from, end - 1, e, NULL);
+    return r & (W_STOP | W_PASS | W_REJECT) ? r : W_FALL;
+}
+
+// ---------------------------------------------------------------
+// Per hook
+// ---------------------------------------------------------------
+
+typedef enum verdict { V_PASSES, V_FIRES, V_REFUSED } verdict;
+
+typedef struct hook_mask {
+    char name[64];
+    char source[256];
+    uint8_t mask[32];
+    verdict verdict[TX_TYPE_COUNT];
+    int line[TX_TYPE_COUNT];
+    char why[TX_TYPE_COUNT][96];
+} hook_mask;
+
+static hook_mask* masks;
+static int mask_count;
+
+static void mask_fire(uint8_t* mask, int tt, int fires)
+{
+    uint8_t bit = (uint8_t)(1U << (tt % 8));
+    // a clear bit fires, except for SetHook where a set bit does
+    if (fires == (tt != TT_HOOK_SET))
+        mask[31 - tt / 8] &= (uint8_t)~bit;
+    else
+        mask[31 - tt / 8] |= bit;
+}
+
+static int mask_fires(const uint8_t* mask, int tt)
+{
+    int bit = (mask[31 - tt / 8] >> (tt % 8)) & 1;
+    return !bit ^ (tt == TT_HOOK_SET);
+}
+
+static void hex(const uint8_t* mask, char* out)
+{
+    for (int i = 0; i < 32; ++i)
+        sprintf(out + 2 * i, "%02X", mask[i]);
+}
+
+static int analyse_hook(const hh_hook_def* def)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", HH_ROOT, def->source);
+    char* src = preprocess(path);
+    if (!src) {
+        fprintf(stderr, "hookon: cannot preprocess %s\n", path);
+        return -1;
+    }
+    tokenize(src, path);
+    free(src);
+    find_functions();
+    function* f = find_function("hook");
+    if (!f) {
+        fprintf(stderr, "hookon: no hook() in %s\n", path);
+        reset();
+        return -1;
+    }
+
+    masks = realloc(masks, sizeof(hook_mask) * (size_t)(mask_count + 1));
+    hook_mask* m = &masks[mask_count++];
+    memset(m, 0, sizeof(*m));
+    snprintf(m->name, sizeof(m->name), "%s", def->name);
+    snprintf(m->source, sizeof(m->source), "%s", def->source);
+    memset(m->mask, 0xFF, sizeof(m->mask));
+    mask_fire(m->mask, TT_HOOK_SET, 0);
+
+    fn_body = f->body;
+    fn_end = f->body_end;
+    for (int k = 0; k < TX_TYPE_COUNT; ++k) {
+        cur_type = &tx_types[k];
+        fire_line = reject_line = 0;
+        env e = {0};
+        int r = walk_list(f->body + 1, f->body_end, &e);
+        if (r & W_FALL)
+            r |= reject(toks[f->body_end].line);
+        if (r & W_STOP)
+            m->verdict[k] = V_FIRES;
+        else if ((r & W_REJECT) && (r & W_PASS)) {
+            // accepts some transactions of the type and rolls back others
+            m->verdict[k] = V_FIRES;
+            fire(reject_line, "rollback");
+        } else if (r & W_REJECT) {
+            m->verdict[k] = V_REFUSED;
+            fire_line = reject_line;
+            snprintf(fire_why, sizeof(fire_why), "every path rolls back");
+        }
+        m->line[k] = fire_line;
+        snprintf(m->why[k], sizeof(m->why[k]), "%s", fire_line ? fire_why : "");
+        // a refused type stays in the mask: left out, the refusal would pass
+        mask_fire(m->mask, cur_type->tt, m->verdict[k] != V_PASSES);
+    }
+    reset();
+    return 0;
+}
+
+static void print_hook(const hook_mask* m, int verbose)
+{
+    char text[65];
+    hex(m->mask, text);
+    printf("%-28s %s\n", m->name, text);
+    for (int k = 0; k < TX_TYPE_COUNT; ++k) {
+        if (m->verdict[k] == V_FIRES)
+            printf("    %-28s fires    line %d: %s\n", tx_types[k].name, m->line[k], m->why[k]);
+        else if (m->verdict[k] == V_REFUSED)
+            printf("    %-28s refused  line %d: %s\n", tx_types[k].name, m->line[k], m->why[k]);
+        else if (verbose)
+            printf("    %-28s passes\n", tx_types[k].name);
+    }
+}
+
+// ---------------------------------------------------------------
+// Checking configured masks
+// ---------------------------------------------------------------
+
+static char* read_text(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* buf = malloc(n > 0 ? (size_t)n + 1 : 1);
+    size_t len = n > 0 ? fread(buf, 1, (size_t)n, f) : 0;
+    buf[len] = 0;
+    fclose(f);
+    return buf;
+}
+
+static const hook_mask* mask_for(const char* name)
+{
+    for (int i = 0; i < mask_count; ++i)
+        if (!strcmp(masks[i].name, name))
+            return &masks[i];
+    return NULL;
+}
+
+// Reports how a configured mask differs; returns 1 when it does.
+static int compare_mask(const char* where, const hook_mask* m, const uint8_t* configured)
+{
+    int differs = 0;
+    for (int k = 0; k < TX_TYPE_COUNT; ++k) {
+        int tt = tx_types[k].tt;
+        int want = m->verdict[k] != V_PASSES, have = mask_fires(configured, tt);
+        if (want == have)
+            continue;
+        if (!differs)
+            printf("%s: %s\n", where, m->name);
+        differs = 1;
+        if (want)
+            printf("    %-28s missing, %sline %d: %s\n", tx_types[k].name,
+                   m->verdict[k] == V_REFUSED ? "refused, " : "", m->line[k], m->why[k]);
+        else
+            printf("    %-28s passes through, not needed\n", tx_types[k].name);
+    }
+    for (int tt = 0; tt < 256; ++tt) {
+        int listed = 0;
+        for (int k = 0; k < TX_TYPE_COUNT && !listed; ++k)
+            listed = tx_types[k].tt == tt;
+        if (!listed && mask_fires(configured, tt) && tt != TT_HOOK_SET) {
+            if (!differs)
+                printf("%s: %s\n", where, m->name);
+            differs = 1;
+            printf("    type %-23d fires, not an account transaction\n", tt);
+        }
+    }
+    if (differs) {
+        char text[65];
+        hex(m->mask, text);
+        printf("    minimal HookOn %s\n", text);
+    }
+    return differs;
+}
+
+// "HookOn": [ "PAYMENT", ... ] of each hook in a hookstore manifest.
+static int check_manifest(const char* path)
+{
+    char* json = read_text(path);
+    if (!json) {
+        fprintf(stderr, "hookon: cannot read %s\n", path);
+        return 1;
+    }
+    int differs = 0;
+    for (char* p = strstr(json, "\"source_path\""); p; p = strstr(p + 1, "\"source_path\"")) {
+        char* v = strchr(p + 13, '"');
+        char* ve = v ? strchr(v + 1, '"') : NULL;
+        char* on = ve ? strstr(ve, "\"HookOn\"") : NULL;
+        char* open = on ? strchr(on, '[') : NULL;
+        char* close = open ? strchr(open, ']') : NULL;
+        if (!close)
+            break;
+        char source[256];
+        snprintf(source, sizeof(source), "%.*s", (int)(ve - v - 1), v + 1);
+        const hook_mask* m = NULL;
+        for (int i = 0; i < mask_count && !m; ++i)
+            if (!strcmp(masks[i].source, source[0] == '/' ? source + 1 : source))
+                m = &masks[i];
+        if (!m)
+            continue;
+        uint8_t configured[32];
+        memset(configured, 0xFF, sizeof(configured));
+        mask_fire(configured, TT_HOOK_SET, 0);
+        for (char* s = strchr(open, '"'); s && s < close; s = strchr(s + 1, '"')) {
+            char* e = strchr(s + 1, '"');
+            for (int k = 0; k < TX_TYPE_COUNT; ++k)
+                if ((size_t)(e - s - 1) == strlen(tx_types[k].name) && !strncmp(s + 1, tx_types[k].name, (size_t)(e - s - 1)))
+                    mask_fire(configured, tx_types[k].tt, 1);
+            s = e;
+        }
+        differs |= compare_mask(path, m, configured);
+    }
+    free(json);
+    return differs;
+}
+
+// Every "HookOn" next to a "HookHash" in a SetHook transaction; hashes
+// are matched to hooks by their order in the Hooks array.
+static int check_hookset(const char* path, char* const* names, int name_count)
+{
+    char* json = read_text(path);
+    if (!json) {
+        fprintf(stderr, "hookon: cannot read %s\n", path);
+        return 1;
+    }
+    char hashes[16][65];
+    int hash_count = 0;
+    int differs = 0;
+    for (char* p = strstr(json, "\"HookOn\""); p; p = strstr(p + 1, "\"HookOn\"")) {
+        char* obj = p;
+        while (obj > json && *obj != '{')
+            --obj;
+        char* h = strstr(obj, "\"HookHash\"");
+        char* v = strchr(p + 8, '"');
+        if (!h || h > p + 512 || !v)
+            continue;
+        char hash[65] = {0};
+        char* hv = strchr(h + 10, '"');
+        if (!hv)
+            continue;
+        snprintf(hash, sizeof(hash), "%.64s", hv + 1);
+        int idx = -1;
+        for (int i = 0; i < hash_count && idx < 0; ++i)
+            if (!strcmp(hashes[i], hash))
+                idx = i;
+        if (idx < 0 && hash_count < 16) {
+            idx = hash_count;
+            snprintf(hashes[hash_count++], 65, "%s", hash);
+        }
+        if (idx < 0 || idx >= name_count)
+            continue;
+        const hook_mask* m = mask_for(names[idx]);
+        char text[65];
+        uint8_t configured[32];
+        snprintf(text, sizeof(text), "%.64s", v + 1);
+        if (!m || hh_hex(text, configured, 32) != 32)
+            continue;
+        char where[512];
+        int line = 1;
+        for (char* c = json; c < p; ++c)
+            line += *c == '\n';
+        snprintf(where, sizeof(where), "%s:%d", path, line);
+        differs |= compare_mask(where, m, configured);
+    }
+    free(json);
+    return differs;
+}
+
+int main(int argc, char** argv)
+{
+    const char *manifest = NULL, *hookset = NULL;
+    char hooks_arg[256] = "RouterMaster,IDOMaster,RewardsMaster";
+    int verbose = 0, named = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-m") && i + 1 < argc)
+            manifest = argv[++i];
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            hookset = argv[++i];
+        else if (!strcmp(argv[i], "-H") && i + 1 < argc)
+            snprintf(hooks_arg, sizeof(hooks_arg), "%s", argv[++i]);
+        else if (!strcmp(argv[i], "-v"))
+            verbose = 1;
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: hookon [-v] [-m manifest.json] [-s Hookset.json] [-H A,B,C] [HookName...]\n");
+            return 2;
+        } else
+            named = 1;
+    }
+
+    int status = 0;
+    for (size_t h = 0; h < hh_hook_count; ++h) {
+        int wanted = !named;
+        for (int i = 1; i < argc && !wanted; ++i)
+            wanted = !strcmp(argv[i], hh_hooks[h].name);
+        if (wanted && analyse_hook(&hh_hooks[h]) != 0)
+            status = 1;
+    }
+    for (int i = 0; i < mask_count; ++i)
+        print_hook(&masks[i], verbose);
+
+    if (manifest || hookset)
+        printf("\n");
+    if (manifest && check_manifest(manifest))
+        status = 1;
+    if (hookset) {
+        char* names[HH_MAX_CHAIN];
+        int name_count = 0;
+        for (char* s = strtok(hooks_arg, ","); s && name_count < HH_MAX_CHAIN; s = strtok(NULL, ","))
+            names[name_count++] = s;
+        if (check_hookset(hookset, names, name_count))
+            status = 1;
+    }
+    free(masks);
+    return status;
+}
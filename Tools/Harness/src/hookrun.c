@@ -0,0 +1,58 @@
+//**************************************************************
+// hookrun - HandyHooks scenario runner
+//
+// Description:
+//   Reads a line based scenario, builds the ledger it describes and
+//   submits its transactions through the native harness, printing the
+//   result of every hook execution. The commands are listed in
+//   scenario.c.
+//
+// Usage:
+//   hookrun [-q] [-t] [-s] scenario.txt      (or the scenario on stdin)
+//     -q  only print failed expectations and stats output
+//     -t  print hook trace output
+//     -s  log every state and hook_param call, then report repeated
+//         reads and writes per path (statetrace.h)
+//**************************************************************
+
+#include <stdio.h>
+#include <string.h>
+
+#include "statetrace.h"
+
+static int run(int argc, char** argv)
+{
+    hh_scenario s;
+    hh_scenario_init(&s);
+    const char* path = NULL;
+    int state_io = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-q"))
+            s.verbose = 0;
+        else if (!strcmp(argv[i], "-t"))
+            s.trace = 1;
+        else if (!strcmp(argv[i], "-s"))
+            state_io = 1;
+        else
+            path = argv[i];
+    }
+    FILE* in = path ? fopen(path, "r") : stdin;
+    if (!in) {
+        perror(path);
+        return 2;
+    }
+    if (state_io)
+        hh_statetrace_attach(&s, stdout);
+    int failures = hh_scenario_run(&s, in, path ? path : "-");
+    if (in != stdin)
+        fclose(in);
+    if (state_io)
+        hh_statetrace_report(stdout);
+    hh_scenario_free(&s);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    return hh_run(run, argc, argv);
+}
@@ -0,0 +1,313 @@
+//**************************************************************
+// hooksize - HandyHooks size and SetHook fee report
+//
+// Description:
+//   Measures the size-optimised artifact of every hook (a WASM module
+//   from the HH_WASM pipeline, or an -Os native object without it) and
+//   prints per hook:
+//
+//     bytes    what SetHook would upload: the module size, or code
+//              plus data for a native object
+//     code     the code section / executable sections
+//     data     data segments / read-only and initialised data
+//     strings  bytes of that data held in string literals, mostly
+//              trace and rollback messages
+//     fee      HH_SETHOOK_BASE_FEE + bytes * HH_SETHOOK_DROPS_PER_BYTE
+//
+//   The previous report is read first, so every build shows what
+//   changed per hook, then overwritten. -d also sizes the CreateCode
+//   of a SetHook transaction (e.g. Docs/Transactions/Hookset.json),
+//   i.e. the WASM that is actually deployed.
+//
+// Usage:
+//   hooksize [-p report.tsv] [-d Hookset.json] Name=artifact...
+//**************************************************************
+
+#include <elf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef HH_SETHOOK_BASE_FEE
+#define HH_SETHOOK_BASE_FEE 10
+#endif
+#ifndef HH_SETHOOK_DROPS_PER_BYTE
+#define HH_SETHOOK_DROPS_PER_BYTE 1
+#endif
+
+#define MIN_STRING 4           // shorter printable runs are not counted as text
+
+typedef struct size_row {
+    char name[64];
+    const char* format;
+    uint64_t bytes;
+    uint64_t code;
+    uint64_t data;
+    uint64_t strings;
+} size_row;
+
+typedef struct prev_row {
+    char name[64];
+    unsigned long long bytes, code, data, strings;
+} prev_row;
+
+static uint64_t fee(uint64_t bytes)
+{
+    return HH_SETHOOK_BASE_FEE + bytes * HH_SETHOOK_DROPS_PER_BYTE;
+}
+
+static uint8_t* read_file(const char* path, size_t* len)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = malloc(n > 0 ? (size_t)n + 1 : 1);
+    *len = n > 0 ? fread(buf, 1, (size_t)n, f) : 0;
+    buf[*len] = 0;
+    fclose(f);
+    return buf;
+}
+
+// NUL terminated printable runs in a data blob.
+static uint64_t string_bytes(const uint8_t* p, uint64_t len)
+{
+    uint64_t total = 0, run = 0;
+    for (uint64_t i = 0; i < len; ++i) {
+        if (p[i] >= 0x20 && p[i] < 0x7F)
+            run++;
+        else {
+            if (p[i] == 0 && run >= MIN_STRING)
+                total += run + 1;
+            run = 0;
+        }
+    }
+    return total;
+}
+
+static int leb(const uint8_t* p, size_t len, size_t* pos, uint64_t* out)
+{
+    uint64_t v = 0;
+    for (int shift = 0; *pos < len && shift < 64; shift += 7) {
+        uint8_t b = p[(*pos)++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int measure_wasm(const uint8_t* p, size_t len, size_row* r)
+{
+    r->format = "wasm";
+    r->bytes = len;
+    size_t pos = 8;
+    while (pos < len) {
+        uint8_t id = p[pos++];
+        uint64_t size;
+        if (leb(p, len, &pos, &size) != 0 || pos + size > len)
+            return -1;
+        if (id == 10)
+            r->code += size;
+        else if (id == 11) {
+            r->data += size;
+            r->strings += string_bytes(p + pos, size);
+        }
+        pos += size;
+    }
+    return 0;
+}
+
+static int measure_elf(const uint8_t* p, size_t len, size_row* r)
+{
+    const Elf64_Ehdr* eh = (const Elf64_Ehdr*)p;
+    if (len < sizeof(*eh) || eh->e_ident[EI_CLASS] != ELFCLASS64 ||
+        eh->e_shoff + (uint64_t)eh->e_shnum * sizeof(Elf64_Shdr) > len)
+        return -1;
+    r->format = "native";
+    const Elf64_Shdr* sh = (const Elf64_Shdr*)(p + eh->e_shoff);
+    for (int i = 0; i < eh->e_shnum; ++i) {
+        if (!(sh[i].sh_flags & SHF_ALLOC) || sh[i].sh_type == SHT_NOBITS)
+            continue;
+        if (sh[i].sh_flags & SHF_EXECINSTR)
+            r->code += sh[i].sh_size;
+        else {
+            r->data += sh[i].sh_size;
+            if (sh[i].sh_flags & SHF_STRINGS)
+                r->strings += sh[i].sh_size;
+        }
+    }
+    r->bytes = r->code + r->data;
+    return 0;
+}
+
+static int measure(const uint8_t* p, size_t len, size_row* r)
+{
+    if (len >= 8 && !memcmp(p, "\0asm", 4))
+        return measure_wasm(p, len, r);
+    if (len >= 4 && !memcmp(p, ELFMAG, SELFMAG))
+        return measure_elf(p, len, r);
+    return -1;
+}
+
+static int read_previous(const char* path, prev_row** rows)
+{
+    FILE* f = fopen(path, "r");
+    if (!f)
+        return 0;
+    char line[512];
+    int n = 0;
+    while (fgets(line, sizeof(line), f)) {
+        prev_row p;
+        char format[16];
+        if (line[0] == '#' ||
+            sscanf(line, "%63s %15s %llu %llu %llu %llu", p.name, format, &p.bytes, &p.code, &p.data, &p.strings) != 6)
+            continue;
+        *rows = realloc(*rows, sizeof(prev_row) * (size_t)(n + 1));
+        (*rows)[n++] = p;
+    }
+    fclose(f);
+    return n;
+}
+
+static void delta(long long now, long long before)
+{
+    if (now == before)
+        printf("  %8s", "=");
+    else
+        printf("  %+8lld", now - before);
+}
+
+static void print_row(const size_row* r)
+{
+    printf("%-28s %-6s %8llu %8llu %8llu %8llu %8llu", r->name, r->format, (unsigned long long)r->bytes,
+           (unsigned long long)r->code, (unsigned long long)r->data, (unsigned long long)r->strings,
+           (unsigned long long)fee(r->bytes));
+}
+
+// Every CreateCode blob in a transaction, labelled with the HookHash
+// that shares its object.
+static void deployed(const char* path)
+{
+    size_t len;
+    char* json = (char*)read_file(path, &len);
+    if (!json) {
+        fprintf(stderr, "hooksize: cannot read %s\n", path);
+        return;
+    }
+    printf("\ndeployed CreateCode in %s\n", path);
+    for (char* p = strstr(json, "\"CreateCode\""); p; p = strstr(p + 1, "\"CreateCode\"")) {
+        char* hex = strchr(p + 12, '"');
+        if (!hex)
+            break;
+        ++hex;
+        size_t n = strspn(hex, "0123456789ABCDEFabcdef") / 2;
+        uint8_t* wasm = malloc(n ? n : 1);
+        for (size_t i = 0; i < n; ++i)
+            sscanf(hex + 2 * i, "%2hhx", &wasm[i]);
+
+        // HookHash sits in the same FinalFields/NewFields object
+        size_row r = {0};
+        snprintf(r.name, sizeof(r.name), "(unknown hash)");
+        char* obj = p;
+        while (obj > json && *obj != '{')
+            --obj;
+        char* end = strchr(hex + 2 * n, '}');
+        char* h = strstr(obj, "\"HookHash\"");
+        if (h && end && h < end && (h = strchr(h + 10, '"')))
+            snprintf(r.name, sizeof(r.name), "%.16s...", h + 1);
+        if (measure(wasm, n, &r) == 0) {
+            print_row(&r);
+            printf("\n");
+        }
+        free(wasm);
+    }
+    free(json);
+}
+
+int main(int argc, char** argv)
+{
+    const char *report = NULL, *tx = NULL;
+    size_row* rows = NULL;
+    int count = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc)
+            report = argv[++i];
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+            tx = argv[++i];
+        else if (strchr(argv[i], '=')) {
+            char* eq = strchr(argv[i], '=');
+            size_row r = {0};
+            snprintf(r.name, sizeof(r.name), "%.*s", (int)(eq - argv[i]), argv[i]);
+            size_t len;
+            uint8_t* buf = read_file(eq + 1, &len);
+            if (!buf || measure(buf, len, &r) != 0) {
+                fprintf(stderr, "hooksize: %s is not a WASM module or ELF object\n", eq + 1);
+                free(buf);
+                return 1;
+            }
+            free(buf);
+            rows = realloc(rows, sizeof(size_row) * (size_t)(count + 1));
+            rows[count++] = r;
+        } else {
+            fprintf(stderr, "usage: hooksize [-p report.tsv] [-d Hookset.json] Name=artifact...\n");
+            return 2;
+        }
+    }
+
+    prev_row* prev = NULL;
+    int prev_count = report ? read_previous(report, &prev) : 0;
+
+    printf("%-28s %-6s %8s %8s %8s %8s %8s", "hook", "format", "bytes", "code", "data", "strings", "fee");
+    if (prev_count)
+        printf("  %8s  %8s  %8s", "bytes", "data", "strings");
+    printf("\n");
+    uint64_t total = 0, before = 0;
+    for (int i = 0; i < count; ++i) {
+        const size_row* r = &rows[i];
+        print_row(r);
+        total += r->bytes;
+        const prev_row* p = NULL;
+        for (int k = 0; k < prev_count && !p; ++k)
+            if (!strcmp(prev[k].name, r->name))
+                p = &prev[k];
+        if (p) {
+            delta((long long)r->bytes, (long long)p->bytes);
+            delta((long long)r->data, (long long)p->data);
+            delta((long long)r->strings, (long long)p->strings);
+            before += p->bytes;
+        } else if (prev_count)
+            printf("  %8s", "new");
+        printf("\n");
+    }
+    printf("%-28s %-6s %8llu %36llu", "total", "", (unsigned long long)total,
+           (unsigned long long)(fee(0) * (uint64_t)count + total * HH_SETHOOK_DROPS_PER_BYTE));
+    if (prev_count)
+        delta((long long)total, (long long)before);
+    printf("\n");
+
+    if (tx)
+        deployed(tx);
+
+    if (report) {
+        FILE* f = fopen(report, "w");
+        if (!f) {
+            perror(report);
+            return 1;
+        }
+        fprintf(f, "# hook\tformat\tbytes\tcode\tdata\tstrings\n");
+        for (int i = 0; i < count; ++i)
+            fprintf(f, "%s\t%s\t%llu\t%llu\t%llu\t%llu\n", rows[i].name, rows[i].format,
+                    (unsigned long long)rows[i].bytes, (unsigned long long)rows[i].code,
+                    (unsigned long long)rows[i].data, (unsigned long long)rows[i].strings);
+        fclose(f);
+    }
+    free(prev);
+    free(rows);
+    return 0;
+}
@@ -0,0 +1,1167 @@
+//**************************************************************
+// HandyHooks native harness - hook API host functions
+//
+// Everything a hook imports except the float_* family (xfl.c).
+// Pointers arrive as uint32_t offsets into the low stack or the
+// binary's data, so HH_MEM() turns them back into addresses. All
+// calls act on hh_cur, the execution apply.c has set up.
+//**************************************************************
+
+#include <stdlib.h>
+
+#include "internal.h"
+#include "../hookapi/hookapi.h"
+
+#define COUNT(api) (hh_cur->exec->calls[api]++)
+
+const char* const hh_api_names[HH_API_COUNT] = {
+    "_g",
+    "accept",
+    "rollback",
+    "util_*",
+    "sto_*",
+    "etxn_reserve",
+    "etxn_details",
+    "etxn_fee_base",
+    "etxn_other",
+    "emit",
+    "float_*",
+    "ledger_*",
+    "hook_account",
+    "hook_param",
+    "hook_skip",
+    "hook_other",
+    "slot_set",
+    "slot_*",
+    "state",
+    "state_set",
+    "state_foreign",
+    "state_foreign_set",
+    "trace*",
+    "otxn_field",
+    "otxn_param",
+    "otxn_other",
+};
+
+static int64_t put_u64(uint8_t* p, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        p[i] = (uint8_t)(v >> (56 - 8 * i));
+    return 8;
+}
+
+static uint64_t get_u64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static int64_t write_out(uint32_t write_ptr, uint32_t write_len, const uint8_t* data, uint32_t len)
+{
+    if (write_len < len)
+        return TOO_SMALL;
+    memcpy(HH_MEM(write_ptr), data, len);
+    return len;
+}
+
+// Hands a state, hook_param or otxn_param call to the ledger's access
+// hook.
+static void report_access(const hh_ctx* c, enum hh_api api, const uint8_t* acc, const uint8_t* ns,
+                          uint32_t kread_ptr, uint32_t kread_len, uint32_t size, int64_t result, int unchanged)
+{
+    if (!c->ledger->on_access)
+        return;
+    hh_access a = {
+        .exec = c->exec,
+        .serial = c->serial,
+        .api = api,
+        .account = acc,
+        .ns = ns,
+        .key = kread_len ? HH_MEM(kread_ptr) : NULL,
+        .key_len = kread_len > 32 ? 32 : kread_len,
+        .size = size,
+        .result = result,
+        .unchanged = unchanged,
+    };
+    c->ledger->on_access(c->ledger->access_ctx, &a);
+}
+
+// ---------------------------------------------------------------
+// Control
+// ---------------------------------------------------------------
+
+int32_t _g(uint32_t id, uint32_t maxiter)
+{
+    hh_ctx* c = hh_cur;
+    c->exec->calls[HH_API_GUARD]++;
+    c->exec->guard_iterations++;
+    for (int i = 0; i < HH_GUARDS; ++i) {
+        if (c->guard_ids[i] == 0)
+            c->guard_ids[i] = id;
+        else if (c->guard_ids[i] != id)
+            continue;
+        if (++c->guard_hits[i] > maxiter) {
+            static const char msg[] = "guard violation";
+            c->exec->exit = HH_EXIT_ROLLBACK;
+            c->exec->exit_code = GUARD_VIOLATION;
+            c->exec->reason_len = sizeof(msg) - 1;
+            memcpy(c->exec->reason, msg, sizeof(msg) - 1);
+            longjmp(c->exit, 1);
+        }
+        return 1;
+    }
+    return 1;
+}
+
+static int64_t finish(hh_exit how, uint32_t read_ptr, uint32_t read_len, int64_t code)
+{
+    hh_ctx* c = hh_cur;
+    uint32_t n = read_len < HH_MAX_REASON ? read_len : HH_MAX_REASON;
+    if (read_ptr && n)
+        memcpy(c->exec->reason, HH_MEM(read_ptr), n);
+    else
+        n = 0;
+    c->exec->reason_len = n;
+    c->exec->exit = how;
+    c->exec->exit_code = code;
+    longjmp(c->exit, 1);
+}
+
+int64_t accept(uint32_t read_ptr, uint32_t read_len, int64_t error_code)
+{
+    COUNT(HH_API_ACCEPT);
+    return finish(HH_EXIT_ACCEPT, read_ptr, read_len, error_code);
+}
+
+int64_t rollback(uint32_t read_ptr, uint32_t read_len, int64_t error_code)
+{
+    COUNT(HH_API_ROLLBACK);
+    return finish(HH_EXIT_ROLLBACK, read_ptr, read_len, error_code);
+}
+
+// ---------------------------------------------------------------
+// Util
+// ---------------------------------------------------------------
+
+static const char b58_alphabet[] = "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+
+int64_t util_raddr(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    COUNT(HH_API_UTIL);
+    (void)write_ptr, (void)write_len, (void)read_ptr, (void)read_len;
+    return NOT_IMPLEMENTED;
+}
+
+// r-address to account id. The checksum is not verified.
+int64_t util_accid(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    COUNT(HH_API_UTIL);
+    if (write_len < 20)
+        return TOO_SMALL;
+    if (read_len < 25 || read_len > 49)
+        return INVALID_ARGUMENT;
+    const char* s = (const char*)HH_MEM(read_ptr);
+    uint8_t out[32] = {0};
+    for (uint32_t i = 0; i < read_len && s[i]; ++i) {
+        const char* at = strchr(b58_alphabet, s[i]);
+        if (!at)
+            return INVALID_ARGUMENT;
+        uint32_t carry = (uint32_t)(at - b58_alphabet);
+        for (int j = 31; j >= 0; --j) {
+            carry += 58U * out[j];
+            out[j] = (uint8_t)carry;
+            carry >>= 8;
+        }
+        if (carry)
+            return INVALID_ARGUMENT;
+    }
+    // version byte 0, 20 byte id, 4 byte checksum right aligned
+    memcpy(HH_MEM(write_ptr), out + 32 - 24, 20);
+    return 20;
+}
+
+int64_t util_verify(uint32_t dread_ptr, uint32_t dread_len, uint32_t sread_ptr, uint32_t sread_len,
+                    uint32_t kread_ptr, uint32_t kread_len)
+{
+    COUNT(HH_API_UTIL);
+    (void)dread_ptr, (void)dread_len, (void)sread_ptr, (void)sread_len, (void)kread_ptr, (void)kread_len;
+    return NOT_IMPLEMENTED;
+}
+
+int64_t util_sha512h(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    COUNT(HH_API_UTIL);
+    if (write_len < 32)
+        return TOO_SMALL;
+    hh_sha512h(HH_MEM(read_ptr), read_len, HH_MEM(write_ptr));
+    return 32;
+}
+
+int64_t util_keylet(uint32_t write_ptr, uint32_t write_len, uint32_t keylet_type, uint32_t a,
+                    uint32_t b, uint32_t c, uint32_t d, uint32_t e, uint32_t f)
+{
+    COUNT(HH_API_UTIL);
+    if (write_len < 34)
+        return TOO_SMALL;
+    uint8_t* out = HH_MEM(write_ptr);
+    switch (keylet_type) {
+    case KEYLET_ACCOUNT:
+        if (b != 20)
+            return INVALID_ARGUMENT;
+        out[0] = 0x00;
+        out[1] = 0x61;
+        hh_keylet_account(HH_MEM(a), out + 2);
+        return 34;
+    case KEYLET_LINE: {
+        if (b != 20 || d != 20 || (f != 20 && f != 3))
+            return INVALID_ARGUMENT;
+        uint8_t cur[20] = {0};
+        if (f == 3)
+            memcpy(cur + 12, HH_MEM(e), 3);
+        else
+            memcpy(cur, HH_MEM(e), 20);
+        out[0] = 0x00;
+        out[1] = 0x72;
+        hh_keylet_line(HH_MEM(a), HH_MEM(c), cur, out + 2);
+        return 34;
+    }
+    case KEYLET_HOOK_STATE: {
+        if (b != 20 || d != 32 || f != 32)
+            return INVALID_ARGUMENT;
+        uint8_t buf[86] = {0x00, 0x76};
+        memcpy(buf + 2, HH_MEM(a), 20);
+        memcpy(buf + 22, HH_MEM(c), 32);
+        memcpy(buf + 54, HH_MEM(e), 32);
+        out[0] = 0x00;
+        out[1] = 0x76;
+        hh_sha512h(buf, sizeof(buf), out + 2);
+        return 34;
+    }
+    default:
+        return NOT_IMPLEMENTED;
+    }
+}
+
+// ---------------------------------------------------------------
+// STO
+// ---------------------------------------------------------------
+
+int64_t sto_subfield(uint32_t read_ptr, uint32_t read_len, uint32_t field_id)
+{
+    COUNT(HH_API_STO);
+    const uint8_t* p = HH_MEM(read_ptr);
+    hh_field f;
+    int r = hh_sto_find(p, read_len, field_id, &f);
+    if (r < 0)
+        return PARSE_ERROR;
+    if (r == 0)
+        return DOESNT_EXIST;
+    return ((int64_t)(f.payload - p) << 32) | f.payload_len;
+}
+
+int64_t sto_subarray(uint32_t read_ptr, uint32_t read_len, uint32_t array_id)
+{
+    COUNT(HH_API_STO);
+    const uint8_t* p = HH_MEM(read_ptr);
+    hh_field f;
+    int r = hh_sto_index(p, read_len, array_id, &f);
+    if (r < 0)
+        return PARSE_ERROR;
+    if (r == 0)
+        return DOESNT_EXIST;
+    return ((int64_t)(f.start - p) << 32) | (uint32_t)(f.next - f.start);
+}
+
+int64_t sto_validate(uint32_t tread_ptr, uint32_t tread_len)
+{
+    COUNT(HH_API_STO);
+    if (tread_len < 2)
+        return TOO_SMALL;
+    return hh_sto_count(HH_MEM(tread_ptr), tread_len) > 0;
+}
+
+static int canonical_before(uint32_t a, uint32_t b)
+{
+    uint32_t ta = a >> 16, tb = b >> 16;
+    return ta != tb ? ta < tb : (a & 0xFFFFU) < (b & 0xFFFFU);
+}
+
+// Copies src into out with field_id removed and, when fld is given,
+// inserted in canonical position.
+static int64_t rebuild(uint32_t write_ptr, uint32_t write_len, const uint8_t* src, uint32_t src_len,
+                       const uint8_t* fld, uint32_t fld_len, uint32_t field_id, int must_exist)
+{
+    uint8_t tmp[4096];
+    if (src_len + fld_len > sizeof(tmp))
+        return TOO_BIG;
+    uint8_t* o = tmp;
+    const uint8_t* p = src;
+    const uint8_t* end = src + src_len;
+    int placed = fld == NULL, found = 0;
+    hh_field f;
+    while (p < end) {
+        if (!hh_sto_field(p, end, &f))
+            return PARSE_ERROR;
+        if (!placed && canonical_before(field_id, f.id)) {
+            memcpy(o, fld, fld_len);
+            o += fld_len;
+            placed = 1;
+        }
+        if (f.id == field_id) {
+            found = 1;
+            if (!placed) {
+                memcpy(o, fld, fld_len);
+                o += fld_len;
+                placed = 1;
+            }
+        } else {
+            memcpy(o, f.start, (size_t)(f.next - f.start));
+            o += f.next - f.start;
+        }
+        p = f.next;
+    }
+    if (!placed) {
+        memcpy(o, fld, fld_len);
+        o += fld_len;
+    }
+    if (must_exist && !found)
+        return DOESNT_EXIST;
+    return write_out(write_ptr, write_len, tmp, (uint32_t)(o - tmp));
+}
+
+int64_t sto_emplace(uint32_t write_ptr, uint32_t write_len, uint32_t sread_ptr, uint32_t sread_len,
+                    uint32_t fread_ptr, uint32_t fread_len, uint32_t field_id)
+{
+    COUNT(HH_API_STO);
+    if (fread_len == 0)
+        return rebuild(write_ptr, write_len, HH_MEM(sread_ptr), sread_len, NULL, 0, field_id, 1);
+    hh_field f;
+    const uint8_t* fld = HH_MEM(fread_ptr);
+    if (!hh_sto_field(fld, fld + fread_len, &f) || f.id != field_id || f.next != fld + fread_len)
+        return PARSE_ERROR;
+    return rebuild(write_ptr, write_len, HH_MEM(sread_ptr), sread_len, fld, fread_len, field_id, 0);
+}
+
+int64_t sto_erase(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len,
+                  uint32_t field_id)
+{
+    COUNT(HH_API_STO);
+    return rebuild(write_ptr, write_len, HH_MEM(read_ptr), read_len, NULL, 0, field_id, 1);
+}
+
+// ---------------------------------------------------------------
+// Emitted transactions
+// ---------------------------------------------------------------
+
+int64_t etxn_reserve(uint32_t count)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_ETXN_RESERVE);
+    if (c->reserved >= 0)
+        return ALREADY_SET;
+    if (count < 1 || count > HH_MAX_EMIT)
+        return TOO_BIG;
+    c->reserved = count;
+    return count;
+}
+
+int64_t etxn_burden(void)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_ETXN_OTHER);
+    if (c->reserved < 0)
+        return PREREQUISITE_NOT_MET;
+    return (int64_t)(c->otxn->burden * (uint64_t)c->reserved);
+}
+
+int64_t etxn_generation(void)
+{
+    COUNT(HH_API_ETXN_OTHER);
+    return hh_cur->otxn->generation + 1;
+}
+
+static void make_nonce(hh_ctx* c, uint8_t out[32])
+{
+    uint8_t buf[68];
+    memcpy(buf, c->otxn->id, 32);
+    memcpy(buf + 32, c->hook->hash, 32);
+    uint32_t n = c->nonces++;
+    memcpy(buf + 64, &n, 4);
+    hh_sha512h(buf, sizeof(buf), out);
+}
+
+int64_t etxn_nonce(uint32_t write_ptr, uint32_t write_len)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_ETXN_OTHER);
+    if (write_len < 32)
+        return TOO_SMALL;
+    if (c->nonces >= 256)
+        return TOO_MANY_NONCES;
+    make_nonce(c, HH_MEM(write_ptr));
+    return 32;
+}
+
+static uint32_t details_size(const hh_ctx* c)
+{
+    return c->hook->def->cbak ? 138 : 116;
+}
+
+int64_t etxn_details(uint32_t write_ptr, uint32_t write_len)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_ETXN_DETAILS);
+    uint32_t size = details_size(c);
+    if (write_len < size)
+        return TOO_SMALL;
+    if (c->reserved < 0)
+        return PREREQUISITE_NOT_MET;
+    if (c->nonces >= 256)
+        return TOO_MANY_NONCES;
+
+    uint8_t* p = HH_MEM(write_ptr);
+    p = hh_sto_put_header(p, sfEmitDetails);
+    p = hh_sto_put_header(p, sfEmitGeneration);
+    uint32_t gen = c->otxn->generation + 1;
+    for (int i = 0; i < 4; ++i)
+        *p++ = (uint8_t)(gen >> (24 - 8 * i));
+    p = hh_sto_put_header(p, sfEmitBurden);
+    p += put_u64(p, c->otxn->burden * (uint64_t)c->reserved);
+    p = hh_sto_put_header(p, sfEmitParentTxnID);
+    memcpy(p, c->otxn->id, 32);
+    p += 32;
+    p = hh_sto_put_header(p, sfEmitNonce);
+    make_nonce(c, p);
+    p += 32;
+    p = hh_sto_put_header(p, sfEmitHookHash);
+    memcpy(p, c->hook->hash, 32);
+    p += 32;
+    if (c->hook->def->cbak) {
+        p = hh_sto_put_header(p, sfEmitCallback);
+        p = hh_sto_put_vl(p, c->account->id, 20);
+    }
+    *p = HH_END_OBJECT;
+    return size;
+}
+
+int64_t etxn_fee_base(uint32_t read_ptr, uint32_t read_len)
+{
+    COUNT(HH_API_ETXN_FEE_BASE);
+    if (hh_cur->reserved < 0)
+        return PREREQUISITE_NOT_MET;
+    return hh_fee_for(HH_MEM(read_ptr), read_len);
+}
+
+// Rejects anything a node would refuse to emit: wrong account,
+// details that do not belong to this execution, bad ledger window
+// or a fee below the computed base.
+static int64_t check_emit(hh_ctx* c, const hh_txview* v)
+{
+    if (memcmp(v->account, c->account->id, 20) != 0)
+        return EMISSION_FAILURE;
+    hh_field d, f;
+    if (hh_sto_find(v->blob, v->len, sfEmitDetails, &d) != 1)
+        return EMISSION_FAILURE;
+    if (v->generation != c->otxn->generation + 1)
+        return EMISSION_FAILURE;
+    if (v->burden != c->otxn->burden * (uint64_t)c->reserved)
+        return EMISSION_FAILURE;
+    if (hh_sto_find(d.payload, d.payload_len, sfEmitParentTxnID, &f) != 1 ||
+        memcmp(f.payload, c->otxn->id, 32) != 0)
+        return EMISSION_FAILURE;
+    if (hh_sto_find(d.payload, d.payload_len, sfEmitHookHash, &f) != 1 ||
+        memcmp(f.payload, c->hook->hash, 32) != 0)
+        return EMISSION_FAILURE;
+    if (hh_sto_find(d.payload, d.payload_len, sfEmitNonce, &f) != 1)
+        return EMISSION_FAILURE;
+    int has_cbak = hh_sto_find(d.payload, d.payload_len, sfEmitCallback, &f) == 1;
+    if (has_cbak != (c->hook->def->cbak != NULL))
+        return EMISSION_FAILURE;
+
+    uint32_t seq = c->ledger->seq;
+    if (hh_sto_find(v->blob, v->len, sfFirstLedgerSequence, &f) != 1)
+        return EMISSION_FAILURE;
+    uint32_t fls = (uint32_t)(f.payload[0] << 24 | f.payload[1] << 16 | f.payload[2] << 8 | f.payload[3]);
+    if (hh_sto_find(v->blob, v->len, sfLastLedgerSequence, &f) != 1)
+        return EMISSION_FAILURE;
+    uint32_t lls = (uint32_t)(f.payload[0] << 24 | f.payload[1] << 16 | f.payload[2] << 8 | f.payload[3]);
+    if (fls > seq + 1 || lls <= seq)
+        return EMISSION_FAILURE;
+
+    int64_t fee = hh_fee_for(v->blob, v->len);
+    if (fee < 0 || v->fee < (uint64_t)fee)
+        return EMISSION_FAILURE;
+    return 0;
+}
+
+int64_t emit(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_EMIT);
+    if (c->reserved < 0)
+        return PREREQUISITE_NOT_MET;
+    if (write_len < 32)
+        return TOO_SMALL;
+    if ((int64_t)c->exec->emitted >= c->reserved)
+        return TOO_MANY_EMITTED_TXN;
+
+    hh_txview* v = malloc(sizeof(*v));
+    if (!v)
+        return INTERNAL_ERROR;
+    int64_t r = hh_txview_parse(v, HH_MEM(read_ptr), read_len) == 0 ? check_emit(c, v) : EMISSION_FAILURE;
+    if (r == 0 && hh_emit_push(c->result, v->blob, v->len, v->id) != 0)
+        r = INTERNAL_ERROR;
+    if (r == 0) {
+        memcpy(HH_MEM(write_ptr), v->id, 32);
+        c->exec->emitted++;
+        r = 32;
+    }
+    free(v);
+    return r;
+}
+
+// ---------------------------------------------------------------
+// Ledger
+// ---------------------------------------------------------------
+
+int64_t fee_base(void)
+{
+    COUNT(HH_API_LEDGER);
+    return HH_FEE_BASE;
+}
+
+int64_t ledger_seq(void)
+{
+    COUNT(HH_API_LEDGER);
+    return hh_cur->ledger->seq;
+}
+
+int64_t ledger_last_time(void)
+{
+    COUNT(HH_API_LEDGER);
+    return hh_cur->ledger->time;
+}
+
+int64_t ledger_last_hash(uint32_t write_ptr, uint32_t write_len)
+{
+    COUNT(HH_API_LEDGER);
+    if (write_len < 32)
+        return TOO_SMALL;
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "ledger:%u", hh_cur->ledger->seq - 1);
+    hh_sha512h(buf, (size_t)n, HH_MEM(write_ptr));
+    return 32;
+}
+
+int64_t ledger_nonce(uint32_t write_ptr, uint32_t write_len)
+{
+    COUNT(HH_API_LEDGER);
+    if (write_len < 32)
+        return TOO_SMALL;
+    hh_ctx* c = hh_cur;
+    if (c->nonces >= 256)
+        return TOO_MANY_NONCES;
+    uint8_t buf[36];
+    memcpy(buf, c->otxn->id, 32);
+    uint32_t n = c->nonces++ | 0x80000000U;
+    memcpy(buf + 32, &n, 4);
+    hh_sha512h(buf, sizeof(buf), HH_MEM(write_ptr));
+    return 32;
+}
+
+// ---------------------------------------------------------------
+// Hook
+// ---------------------------------------------------------------
+
+int64_t hook_account(uint32_t write_ptr, uint32_t write_len)
+{
+    COUNT(HH_API_HOOK_ACCOUNT);
+    return write_out(write_ptr, write_len, hh_cur->account->id, 20);
+}
+
+int64_t hook_hash(uint32_t write_ptr, uint32_t write_len, int32_t hook_no)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_HOOK_OTHER);
+    if (hook_no == -1)
+        return write_out(write_ptr, write_len, c->hook->hash, 32);
+    if (hook_no < 0 || hook_no >= HH_MAX_CHAIN || !c->account->chain[hook_no])
+        return DOESNT_EXIST;
+    return write_out(write_ptr, write_len, c->account->chain[hook_no]->hash, 32);
+}
+
+int64_t hook_param_set(uint32_t read_ptr, uint32_t read_len, uint32_t kread_ptr, uint32_t kread_len,
+                       uint32_t hread_ptr, uint32_t hread_len)
+{
+    COUNT(HH_API_HOOK_OTHER);
+    (void)read_ptr, (void)read_len, (void)kread_ptr, (void)kread_len, (void)hread_ptr, (void)hread_len;
+    return NOT_IMPLEMENTED;
+}
+
+int64_t hook_param(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_HOOK_PARAM);
+    int64_t r = DOESNT_EXIST;
+    if (read_len < 1)
+        r = TOO_SMALL;
+    else if (read_len > HH_MAX_PARAM_NAME)
+        r = TOO_BIG;
+    else {
+        const uint8_t* name = HH_MEM(read_ptr);
+        for (int i = 0; i < c->hook->param_count; ++i) {
+            const hh_param* p = &c->hook->params[i];
+            if (p->name_len == read_len && memcmp(p->name, name, read_len) == 0) {
+                r = write_out(write_ptr, write_len, p->value, p->value_len);
+                break;
+            }
+        }
+    }
+    report_access(c, HH_API_HOOK_PARAM, NULL, NULL, read_ptr, read_len, write_len, r, 0);
+    return r;
+}
+
+int64_t hook_again(void)
+{
+    COUNT(HH_API_HOOK_OTHER);
+    return NOT_IMPLEMENTED;
+}
+
+int64_t hook_skip(uint32_t read_ptr, uint32_t read_len, uint32_t flags)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_HOOK_SKIP);
+    if (read_len != 32)
+        return INVALID_ARGUMENT;
+    if (flags > 1)
+        return INVALID_ARGUMENT;
+    const uint8_t* hash = HH_MEM(read_ptr);
+    for (int i = 0; i < c->chain_len; ++i) {
+        hh_hook* h = c->account->chain[i];
+        if (h && memcmp(h->hash, hash, 32) == 0) {
+            if (!c->ledger->no_skip)
+                c->skip[i] = flags == 0;
+            return 1;
+        }
+    }
+    return DOESNT_EXIST;
+}
+
+int64_t hook_pos(void)
+{
+    COUNT(HH_API_HOOK_OTHER);
+    return hh_cur->position;
+}
+
+// ---------------------------------------------------------------
+// Slots
+// ---------------------------------------------------------------
+
+static uint8_t* arena_alloc(hh_ctx* c, uint32_t len)
+{
+    if (c->arena_used + len > HH_ARENA)
+        return NULL;
+    uint8_t* p = c->arena + c->arena_used;
+    c->arena_used += len;
+    return p;
+}
+
+static int64_t slot_alloc(hh_ctx* c, uint32_t want)
+{
+    if (want > HH_SLOTS)
+        return INVALID_ARGUMENT;
+    if (want)
+        return want;
+    for (uint32_t i = 1; i <= HH_SLOTS; ++i)
+        if (!c->slots[i].data)
+            return i;
+    return NO_FREE_SLOTS;
+}
+
+static hh_slot* slot_get(hh_ctx* c, uint32_t n)
+{
+    if (n == 0 || n > HH_SLOTS || !c->slots[n].data)
+        return NULL;
+    return &c->slots[n];
+}
+
+int64_t slot_set(uint32_t read_ptr, uint32_t read_len, uint32_t slot_no)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_SLOT_SET);
+    if (read_len != 34 && read_len != 32)
+        return INVALID_ARGUMENT;
+    if (read_len == 32)
+        return DOESNT_EXIST;    // no transaction history in the harness
+    int64_t n = slot_alloc(c, slot_no);
+    if (n < 0)
+        return n;
+
+    const uint8_t* k = HH_MEM(read_ptr);
+    uint16_t type = (uint16_t)(k[0] << 8 | k[1]);
+    uint8_t* out = arena_alloc(c, 256);
+    if (!out)
+        return NO_FREE_SLOTS;
+    uint32_t len;
+    if (type == 0x0061) {
+        hh_account* a = hh_map_get(&c->ledger->account_keylets, k + 2);
+        if (!a)
+            return DOESNT_EXIST;
+        len = hh_account_serialize(a, out);
+    } else if (type == 0x0072) {
+        hh_line* ln = hh_map_get(&c->ledger->lines, k + 2);
+        if (!ln)
+            return DOESNT_EXIST;
+        len = hh_line_serialize(ln, out);
+    } else
+        return DOESNT_EXIST;
+    c->slots[n] = (hh_slot){.id = 0, .kind = HH_STO_OBJECT, .data = out, .len = len};
+    return n;
+}
+
+int64_t slot(uint32_t write_ptr, uint32_t write_len, uint32_t slot_no)
+{
+    COUNT(HH_API_SLOT);
+    hh_slot* s = slot_get(hh_cur, slot_no);
+    if (!s)
+        return DOESNT_EXIST;
+    if (write_ptr == 0 && write_len == 0) {
+        if (s->len > 8)
+            return TOO_BIG;
+        int64_t v = 0;
+        for (uint32_t i = 0; i < s->len; ++i)
+            v = (v << 8) | s->data[i];
+        return v;
+    }
+    return write_out(write_ptr, write_len, s->data, s->len);
+}
+
+int64_t slot_clear(uint32_t slot_no)
+{
+    COUNT(HH_API_SLOT);
+    hh_slot* s = slot_get(hh_cur, slot_no);
+    if (!s)
+        return DOESNT_EXIST;
+    memset(s, 0, sizeof(*s));
+    return 1;
+}
+
+int64_t slot_count(uint32_t slot_no)
+{
+    COUNT(HH_API_SLOT);
+    hh_slot* s = slot_get(hh_cur, slot_no);
+    if (!s)
+        return DOESNT_EXIST;
+    if (s->kind != HH_STO_ARRAY)
+        return NOT_AN_ARRAY;
+    return hh_sto_count(s->data, s->len);
+}
+
+int64_t slot_size(uint32_t slot_no)
+{
+    COUNT(HH_API_SLOT);
+    hh_slot* s = slot_get(hh_cur, slot_no);
+    return s ? (int64_t)s->len : DOESNT_EXIST;
+}
+
+int64_t slot_subfield(uint32_t parent_slot, uint32_t field_id, uint32_t new_slot)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_SLOT);
+    hh_slot* s = slot_get(c, parent_slot);
+    if (!s)
+        return DOESNT_EXIST;
+    if (s->kind != HH_STO_OBJECT)
+        return NOT_AN_OBJECT;
+    hh_field f;
+    int r = hh_sto_find(s->data, s->len, field_id, &f);
+    if (r <= 0)
+        return r < 0 ? INTERNAL_ERROR : DOESNT_EXIST;
+    int64_t n = slot_alloc(c, new_slot);
+    if (n < 0)
+        return n;
+    c->slots[n] = (hh_slot){.id = f.id, .kind = f.id >> 16, .data = f.payload, .len = f.payload_len};
+    return n;
+}
+
+int64_t slot_subarray(uint32_t parent_slot, uint32_t array_id, uint32_t new_slot)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_SLOT);
+    hh_slot* s = slot_get(c, parent_slot);
+    if (!s)
+        return DOESNT_EXIST;
+    if (s->kind != HH_STO_ARRAY)
+        return NOT_AN_ARRAY;
+    hh_field f;
+    int r = hh_sto_index(s->data, s->len, array_id, &f);
+    if (r <= 0)
+        return r < 0 ? INTERNAL_ERROR : DOESNT_EXIST;
+    int64_t n = slot_alloc(c, new_slot);
+    if (n < 0)
+        return n;
+    c->slots[n] = (hh_slot){.id = f.id, .kind = f.id >> 16, .data = f.payload, .len = f.payload_len};
+    return n;
+}
+
+int64_t slot_type(uint32_t slot_no, uint32_t flags)
+{
+    COUNT(HH_API_SLOT);
+    hh_slot* s = slot_get(hh_cur, slot_no);
+    if (!s)
+        return DOESNT_EXIST;
+    if (flags == 0)
+        return s->id;
+    if (s->kind != 6)
+        return NOT_AN_AMOUNT;
+    return !(s->data[0] & 0x80U);
+}
+
+int64_t slot_float(uint32_t slot_no)
+{
+    COUNT(HH_API_SLOT);
+    hh_slot* s = slot_get(hh_cur, slot_no);
+    if (!s)
+        return DOESNT_EXIST;
+    if (s->kind != 6)
+        return NOT_AN_AMOUNT;
+    if (s->data[0] & 0x80U)
+        return hh_xfl_from_iou(s->data);
+    uint64_t v = get_u64(s->data);
+    int64_t drops = (int64_t)(v & ((1ULL << 62) - 1));
+    return hh_xfl_make((v >> 62) & 1U ? drops : -drops, -6);
+}
+
+// ---------------------------------------------------------------
+// State
+// ---------------------------------------------------------------
+
+static hh_mod* mod_find(hh_ctx* c, const uint8_t key[84])
+{
+    for (int i = c->mod_count - 1; i >= 0; --i)
+        if (memcmp(c->mods[i].key, key, 84) == 0)
+            return &c->mods[i];
+    return NULL;
+}
+
+static int full_key(const uint8_t* acc, const uint8_t* ns, uint32_t kread_ptr, uint32_t kread_len,
+                    uint8_t out[84])
+{
+    if (kread_len < 1 || kread_len > 32)
+        return kread_len ? TOO_BIG : TOO_SMALL;
+    uint8_t k[32] = {0};
+    memcpy(k + 32 - kread_len, HH_MEM(kread_ptr), kread_len);
+    hh_state_key(acc, ns, k, out);
+    return 0;
+}
+
+static int64_t state_read(uint32_t write_ptr, uint32_t write_len, const uint8_t key[84])
+{
+    hh_ctx* c = hh_cur;
+    const uint8_t* data;
+    uint32_t len;
+    hh_mod* m = mod_find(c, key);
+    hh_blob* b = m ? m->val : hh_map_get(&c->ledger->state, key);
+    if (!b)
+        return DOESNT_EXIST;
+    data = b->data;
+    len = b->len;
+    if (write_ptr == 0 && write_len == 0) {
+        if (len > 8)
+            return TOO_BIG;
+        int64_t v = 0;
+        for (uint32_t i = 0; i < len; ++i)
+            v = (v << 8) | data[i];
+        return v;
+    }
+    return write_out(write_ptr, write_len, data, len);
+}
+
+// Resolves the optional namespace and account arguments.
+static int foreign_args(uint32_t nread_ptr, uint32_t nread_len, uint32_t aread_ptr, uint32_t aread_len,
+                        const uint8_t** ns, const uint8_t** acc)
+{
+    hh_ctx* c = hh_cur;
+    if (nread_len == 0 && nread_ptr == 0)
+        *ns = c->hook->ns;
+    else if (nread_len != 32)
+        return INVALID_ARGUMENT;
+    else
+        *ns = HH_MEM(nread_ptr);
+    if (aread_len == 0 && aread_ptr == 0)
+        *acc = c->account->id;
+    else if (aread_len != 20)
+        return INVALID_ARGUMENT;
+    else
+        *acc = HH_MEM(aread_ptr);
+    return 0;
+}
+
+int64_t state(uint32_t write_ptr, uint32_t write_len, uint32_t kread_ptr, uint32_t kread_len)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_STATE);
+    uint8_t key[84];
+    int64_t r = full_key(c->account->id, c->hook->ns, kread_ptr, kread_len, key);
+    if (r == 0)
+        r = state_read(write_ptr, write_len, key);
+    report_access(c, HH_API_STATE, c->account->id, c->hook->ns, kread_ptr, kread_len, write_len, r, 0);
+    return r;
+}
+
+int64_t state_foreign(uint32_t write_ptr, uint32_t write_len, uint32_t kread_ptr, uint32_t kread_len,
+                      uint32_t nread_ptr, uint32_t nread_len, uint32_t aread_ptr, uint32_t aread_len)
+{
+    COUNT(HH_API_STATE_FOREIGN);
+    const uint8_t *ns = NULL, *acc = NULL;
+    int64_t r = foreign_args(nread_ptr, nread_len, aread_ptr, aread_len, &ns, &acc);
+    uint8_t key[84];
+    if (r == 0)
+        r = full_key(acc, ns, kread_ptr, kread_len, key);
+    if (r == 0)
+        r = state_read(write_ptr, write_len, key);
+    report_access(hh_cur, HH_API_STATE_FOREIGN, acc, ns, kread_ptr, kread_len, write_len, r, 0);
+    return r;
+}
+
+static int granted(const hh_account* a, const uint8_t hash[32])
+{
+    for (int i = 0; i < a->grant_count; ++i)
+        if (memcmp(a->grants[i], hash, 32) == 0)
+            return 1;
+    return 0;
+}
+
+// Owner items the pending modifications add to an account.
+static uint32_t pending_entries(const hh_ctx* c, const uint8_t acc[20])
+{
+    uint32_t n = 0;
+    for (int i = 0; i < c->mod_count; ++i) {
+        const hh_mod* m = &c->mods[i];
+        if (memcmp(m->key, acc, 20) != 0)
+            continue;
+        if (!m->existed && m->val)
+            n++;
+        else if (m->existed && !m->val)
+            n--;
+    }
+    return n;
+}
+
+// Stages one write. *unchanged is set when it stores what is already there.
+static int64_t state_write(const uint8_t* acc, const uint8_t* ns, uint32_t kread_ptr, uint32_t kread_len,
+                           uint32_t read_ptr, uint32_t read_len, int* unchanged)
+{
+    hh_ctx* c = hh_cur;
+    uint8_t key[84];
+    int r = full_key(acc, ns, kread_ptr, kread_len, key);
+    if (r < 0)
+        return r;
+    hh_account* a = hh_account_get(c->ledger, acc);
+    if (!a)
+        return DOESNT_EXIST;
+    if (a != c->account && !granted(a, c->hook->hash))
+        return NOT_AUTHORIZED;
+    if (read_len > HH_STATE_MAX * (uint32_t)a->scale)
+        return TOO_BIG;
+
+    int erase = read_len == 0;
+    hh_mod* m = mod_find(c, key);
+    hh_blob* stored = hh_map_get(&c->ledger->state, key);
+    int existed = m ? m->existed : stored != NULL;
+    hh_blob* now = m ? m->val : stored;
+    int exists_now = now != NULL;
+    *unchanged = erase ? !now : now && now->len == read_len && memcmp(now->data, HH_MEM(read_ptr), read_len) == 0;
+    if (!exists_now && !erase) {
+        uint32_t extra = (pending_entries(c, acc) + 1) * a->scale;
+        if (a->balance < hh_reserve(a, extra))
+            return RESERVE_INSUFFICIENT;
+    }
+    if (!m) {
+        if (c->mod_count == HH_MAX_MODS)
+            return TOO_MANY_STATE_MODIFICATIONS;
+        m = &c->mods[c->mod_count++];
+        memcpy(m->key, key, 84);
+        m->existed = existed;
+        m->val = NULL;
+    }
+    free(m->val);
+    m->val = NULL;
+    if (!erase) {
+        m->val = malloc(sizeof(hh_blob) + read_len);
+        if (!m->val)
+            return INTERNAL_ERROR;
+        m->val->len = read_len;
+        memcpy(m->val->data, HH_MEM(read_ptr), read_len);
+    }
+    return read_len;
+}
+
+int64_t state_set(uint32_t read_ptr, uint32_t read_len, uint32_t kread_ptr, uint32_t kread_len)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_STATE_SET);
+    int unchanged = 0;
+    int64_t r = state_write(c->account->id, c->hook->ns, kread_ptr, kread_len, read_ptr, read_len, &unchanged);
+    report_access(c, HH_API_STATE_SET, c->account->id, c->hook->ns, kread_ptr, kread_len, read_len, r, unchanged);
+    return r;
+}
+
+int64_t state_foreign_set(uint32_t read_ptr, uint32_t read_len, uint32_t kread_ptr, uint32_t kread_len,
+                          uint32_t nread_ptr, uint32_t nread_len, uint32_t aread_ptr, uint32_t aread_len)
+{
+    COUNT(HH_API_STATE_FOREIGN_SET);
+    const uint8_t *ns = NULL, *acc = NULL;
+    int unchanged = 0;
+    int64_t r = foreign_args(nread_ptr, nread_len, aread_ptr, aread_len, &ns, &acc);
+    if (r == 0)
+        r = state_write(acc, ns, kread_ptr, kread_len, read_ptr, read_len, &unchanged);
+    report_access(hh_cur, HH_API_STATE_FOREIGN_SET, acc, ns, kread_ptr, kread_len, read_len, r, unchanged);
+    return r;
+}
+
+// ---------------------------------------------------------------
+// Trace
+// ---------------------------------------------------------------
+
+static void trace_head(const hh_ctx* c, uint32_t mread_ptr, uint32_t mread_len)
+{
+    fprintf(stderr, "HookTrace[%s]: %.*s", c->hook->def->name, (int)mread_len,
+            mread_len ? (const char*)HH_MEM(mread_ptr) : "");
+}
+
+int64_t trace(uint32_t mread_ptr, uint32_t mread_len, uint32_t dread_ptr, uint32_t dread_len,
+              uint32_t as_hex)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_TRACE);
+    if (!c->ledger->trace)
+        return 0;
+    trace_head(c, mread_ptr, mread_len);
+    const uint8_t* d = HH_MEM(dread_ptr);
+    fputc(' ', stderr);
+    if (as_hex)
+        for (uint32_t i = 0; i < dread_len; ++i)
+            fprintf(stderr, "%02X", d[i]);
+    else
+        fprintf(stderr, "%.*s", (int)dread_len, (const char*)d);
+    fputc('\n', stderr);
+    return 0;
+}
+
+int64_t trace_num(uint32_t read_ptr, uint32_t read_len, int64_t number)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_TRACE);
+    if (!c->ledger->trace)
+        return 0;
+    trace_head(c, read_ptr, read_len);
+    fprintf(stderr, " %lld\n", (long long)number);
+    return 0;
+}
+
+int64_t trace_float(uint32_t read_ptr, uint32_t read_len, int64_t float1)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_TRACE);
+    if (!c->ledger->trace)
+        return 0;
+    trace_head(c, read_ptr, read_len);
+    uint64_t m;
+    int32_t e;
+    int neg;
+    if (hh_xfl_parts(float1, &m, &e, &neg) < 0)
+        fprintf(stderr, " <invalid float>\n");
+    else
+        fprintf(stderr, " Float %s%llu*10^(%d)\n", neg ? "-" : "", (unsigned long long)m, e);
+    return 0;
+}
+
+// ---------------------------------------------------------------
+// Originating transaction
+// ---------------------------------------------------------------
+
+int64_t otxn_burden(void)
+{
+    COUNT(HH_API_OTXN_OTHER);
+    return (int64_t)hh_cur->otxn->burden;
+}
+
+int64_t otxn_generation(void)
+{
+    COUNT(HH_API_OTXN_OTHER);
+    return hh_cur->otxn->generation;
+}
+
+int64_t otxn_type(void)
+{
+    COUNT(HH_API_OTXN_OTHER);
+    return hh_cur->otxn->type;
+}
+
+int64_t otxn_id(uint32_t write_ptr, uint32_t write_len, uint32_t flags)
+{
+    COUNT(HH_API_OTXN_OTHER);
+    (void)flags;
+    return write_out(write_ptr, write_len, hh_cur->otxn->id, 32);
+}
+
+int64_t otxn_field(uint32_t write_ptr, uint32_t write_len, uint32_t field_id)
+{
+    const hh_txview* v = hh_cur->otxn;
+    COUNT(HH_API_OTXN_FIELD);
+    for (int i = 0; i < v->field_count; ++i) {
+        const hh_field* f = &v->fields[i];
+        if (f->id != field_id)
+            continue;
+        if (write_ptr == 0 && write_len == 0) {
+            if (f->payload_len > 8)
+                return TOO_BIG;
+            int64_t r = 0;
+            for (uint32_t j = 0; j < f->payload_len; ++j)
+                r = (r << 8) | f->payload[j];
+            return r;
+        }
+        return write_out(write_ptr, write_len, f->payload, f->payload_len);
+    }
+    return DOESNT_EXIST;
+}
+
+int64_t otxn_param(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    const hh_txview* v = hh_cur->otxn;
+    COUNT(HH_API_OTXN_PARAM);
+    if (read_len < 1)
+        return TOO_SMALL;
+    if (read_len > HH_MAX_PARAM_NAME)
+        return TOO_BIG;
+    const uint8_t* name = HH_MEM(read_ptr);
+    int64_t r = DOESNT_EXIST;
+    for (int i = 0; i < v->param_count; ++i)
+        if (v->params[i].name_len == read_len && memcmp(v->params[i].name, name, read_len) == 0) {
+            r = write_out(write_ptr, write_len, v->params[i].value, v->params[i].value_len);
+            break;
+        }
+    report_access(hh_cur, HH_API_OTXN_PARAM, NULL, NULL, read_ptr, read_len, write_len, r, 0);
+    return r;
+}
+
+int64_t otxn_slot(uint32_t slot_no)
+{
+    hh_ctx* c = hh_cur;
+    COUNT(HH_API_OTXN_OTHER);
+    int64_t n = slot_alloc(c, slot_no);
+    if (n < 0)
+        return n;
+    c->slots[n] = (hh_slot){.id = 0, .kind = HH_STO_OBJECT, .data = c->otxn->blob, .len = c->otxn->len};
+    return n;
+}
+
+int64_t meta_slot(uint32_t slot_no)
+{
+    COUNT(HH_API_OTXN_OTHER);
+    (void)slot_no;
+    return PREREQUISITE_NOT_MET;
+}
@@ -0,0 +1,222 @@
+//**************************************************************
+// HandyHooks native harness - internals shared by the library files
+//**************************************************************
+
+#ifndef HH_INTERNAL_H
+#define HH_INTERNAL_H
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "harness.h"
+
+#define HH_MEM(p) ((uint8_t*)(uintptr_t)(p))
+
+#define HH_SLOTS 255
+#define HH_ARENA 65536
+#define HH_GUARDS 64
+#define HH_MAX_FIELDS 40
+#define HH_MAX_MODS 512
+
+// ---------------------------------------------------------------
+// Fixed-key hash map (open addressing, backward-shift deletion)
+// ---------------------------------------------------------------
+
+typedef struct hh_map {
+    uint32_t key_len;
+    size_t cap;
+    size_t count;
+    uint8_t* keys;
+    void** vals;
+} hh_map;
+
+void hh_map_init(hh_map* m, uint32_t key_len);
+void hh_map_free(hh_map* m);
+void* hh_map_get(const hh_map* m, const uint8_t* key);
+void hh_map_put(hh_map* m, const uint8_t* key, void* val);
+void* hh_map_del(hh_map* m, const uint8_t* key);
+
+// ---------------------------------------------------------------
+// Serialized objects
+// ---------------------------------------------------------------
+
+typedef struct hh_field {
+    uint32_t id;               // (type << 16) + field
+    const uint8_t* start;      // field header
+    const uint8_t* payload;    // after header and length prefix
+    uint32_t payload_len;      // object and array payloads exclude the end marker
+    const uint8_t* next;       // first byte after the field
+} hh_field;
+
+#define HH_STO_OBJECT 14U
+#define HH_STO_ARRAY 15U
+#define HH_END_OBJECT 0xE1U
+#define HH_END_ARRAY 0xF1U
+
+int hh_sto_field(const uint8_t* p, const uint8_t* end, hh_field* f);
+int hh_sto_find(const uint8_t* p, uint32_t len, uint32_t id, hh_field* f);
+int hh_sto_index(const uint8_t* p, uint32_t len, uint32_t idx, hh_field* f);
+int hh_sto_count(const uint8_t* p, uint32_t len);
+uint8_t* hh_sto_put_header(uint8_t* out, uint32_t id);
+uint8_t* hh_sto_put_vl(uint8_t* out, const uint8_t* data, uint32_t len);
+uint8_t* hh_sto_put_amount(uint8_t* out, uint32_t id, const hh_amount* a);
+uint32_t hh_sto_serialize(const hh_txn* t, const uint8_t* emit_details, uint32_t emit_len,
+                          uint8_t* out, uint32_t cap);
+
+// XFL helpers used outside the float_* API
+int64_t hh_xfl_make(int64_t mantissa, int32_t exponent);
+int hh_xfl_parts(int64_t xfl, uint64_t* mantissa, int32_t* exponent, int* neg);
+int64_t hh_xfl_from_iou(const uint8_t* b);
+void hh_xfl_to_iou(int64_t xfl, uint8_t* out);
+int64_t hh_xfl_add(int64_t a, int64_t b);
+int64_t hh_xfl_neg(int64_t a);
+int hh_xfl_cmp(int64_t a, int64_t b);
+
+// ---------------------------------------------------------------
+// Ledger
+// ---------------------------------------------------------------
+
+typedef struct hh_hook {
+    const hh_hook_def* def;
+    uint8_t hash[32];
+    uint8_t ns[32];
+    uint8_t hookon[32];
+    int param_count;
+    hh_param* params;
+} hh_hook;
+
+typedef struct hh_account {
+    uint8_t id[20];
+    uint8_t keylet[32];
+    uint64_t balance;
+    uint32_t owner_count;
+    uint32_t sequence;
+    uint16_t scale;
+    int hook_count;
+    hh_hook* chain[HH_MAX_CHAIN];
+    int grant_count;
+    uint8_t (*grants)[32];
+} hh_account;
+
+typedef struct hh_line {
+    uint8_t holder[20];
+    uint8_t issuer[20];
+    uint8_t currency[20];
+    int64_t balance;           // holder's balance, XFL
+    int64_t limit;
+} hh_line;
+
+typedef struct hh_blob {
+    uint32_t len;
+    uint8_t data[];
+} hh_blob;
+
+typedef struct hh_pending {
+    uint32_t len;
+    uint8_t* blob;
+} hh_pending;
+
+struct hh_ledger {
+    uint32_t seq;
+    uint32_t time;
+    int trace;
+    int no_skip;               // hook_skip is recorded but not applied
+    hh_access_cb on_access;
+    void* access_ctx;
+    hh_map accounts;           // account id -> hh_account
+    hh_map account_keylets;    // keylet key -> hh_account
+    hh_map lines;              // keylet key -> hh_line
+    hh_map state;              // account|ns|key -> hh_blob
+    size_t pending_count;
+    size_t pending_cap;
+    hh_pending* pending;
+    hh_totals totals;
+};
+
+hh_account* hh_account_get(const hh_ledger* l, const uint8_t id[20]);
+uint64_t hh_reserve(const hh_account* a, uint32_t extra);
+void hh_keylet_account(const uint8_t id[20], uint8_t out[32]);
+void hh_keylet_line(const uint8_t a[20], const uint8_t b[20], const uint8_t currency[20], uint8_t out[32]);
+hh_line* hh_line_get(const hh_ledger* l, const uint8_t a[20], const uint8_t b[20], const uint8_t currency[20]);
+uint32_t hh_account_serialize(const hh_account* a, uint8_t* out);
+uint32_t hh_line_serialize(const hh_line* ln, uint8_t* out);
+void hh_state_key(const uint8_t account[20], const uint8_t ns[32], const uint8_t key[32], uint8_t out[84]);
+
+// ---------------------------------------------------------------
+// Transactions and execution
+// ---------------------------------------------------------------
+
+typedef struct hh_txview {
+    const uint8_t* blob;
+    uint32_t len;
+    uint8_t id[32];
+    uint16_t type;
+    const uint8_t* account;
+    const uint8_t* destination;
+    const uint8_t* amount;     // 8 or 48 bytes
+    uint32_t amount_len;
+    uint64_t fee;
+    uint32_t generation;
+    uint64_t burden;
+    int field_count;
+    hh_field fields[HH_MAX_FIELDS];
+    int param_count;
+    struct {
+        const uint8_t* name;
+        uint32_t name_len;
+        const uint8_t* value;
+        uint32_t value_len;
+    } params[HH_MAX_PARAMS];
+    int amount_count;
+    const uint8_t* amounts[HH_MAX_AMOUNTS];
+    uint32_t amounts_len[HH_MAX_AMOUNTS];
+} hh_txview;
+
+int hh_txview_parse(hh_txview* v, const uint8_t* blob, uint32_t len);
+
+typedef struct hh_mod {
+    uint8_t key[84];
+    hh_blob* val;              // NULL deletes
+    int existed;
+} hh_mod;
+
+typedef struct hh_slot {
+    uint32_t id;               // field id of the slotted item, 0 for a ledger object
+    uint32_t kind;             // HH_STO_OBJECT, HH_STO_ARRAY or the field type
+    const uint8_t* data;
+    uint32_t len;
+} hh_slot;
+
+typedef struct hh_ctx {
+    hh_ledger* ledger;
+    const hh_txview* otxn;
+    hh_account* account;
+    hh_hook* hook;
+    hh_exec* exec;
+    uint64_t serial;
+    int position;
+    int callback;              // run the hook's cbak instead of hook
+    uint8_t* skip;             // chain skip flags, owned by the runner
+    int chain_len;
+    int64_t reserved;          // etxn_reserve count, -1 until called
+    uint32_t nonces;
+    hh_result* result;
+    // state writes of the whole transaction, committed on success
+    int mod_count;
+    hh_mod* mods;
+    hh_slot slots[HH_SLOTS + 1];
+    uint32_t arena_used;
+    uint8_t arena[HH_ARENA];
+    uint32_t guard_ids[HH_GUARDS];
+    uint32_t guard_hits[HH_GUARDS];
+    jmp_buf exit;
+} hh_ctx;
+
+extern hh_ctx* hh_cur;
+
+void hh_exec_hook(hh_ctx* c);
+int hh_emit_push(hh_result* r, const uint8_t* blob, uint32_t len, const uint8_t hash[32]);
+int64_t hh_fee_for(const uint8_t* blob, uint32_t len);
+
+#endif
@@ -0,0 +1,381 @@
+//**************************************************************
+// HandyHooks native harness - in-memory ledger
+//
+// Accounts, trustlines, installed hook chains and hook state, keyed
+// the way a node keys them: keylets are SHA512-Half of the space code
+// and identifiers, state is addressed by account, namespace and a
+// 32 byte key (shorter keys are left padded with zeros).
+//**************************************************************
+
+#include <stdlib.h>
+
+#include "internal.h"
+#include "../hookapi/error.h"
+#include "../hookapi/sfcodes.h"
+
+hh_ledger* hh_ledger_new(uint32_t seq, uint32_t close_time)
+{
+    hh_ledger* l = calloc(1, sizeof(*l));
+    if (!l)
+        return NULL;
+    l->seq = seq;
+    l->time = close_time;
+    hh_map_init(&l->accounts, 20);
+    hh_map_init(&l->account_keylets, 32);
+    hh_map_init(&l->lines, 32);
+    hh_map_init(&l->state, 84);
+    return l;
+}
+
+static void free_values(hh_map* m, void (*fn)(void*))
+{
+    for (size_t i = 0; i < m->cap; ++i)
+        if (m->vals[i])
+            fn(m->vals[i]);
+}
+
+static void free_account(void* p)
+{
+    hh_account* a = p;
+    for (int i = 0; i < HH_MAX_CHAIN; ++i)
+        if (a->chain[i]) {
+            free(a->chain[i]->params);
+            free(a->chain[i]);
+        }
+    free(a->grants);
+    free(a);
+}
+
+void hh_ledger_free(hh_ledger* l)
+{
+    if (!l)
+        return;
+    free_values(&l->accounts, free_account);
+    free_values(&l->lines, free);
+    free_values(&l->state, free);
+    hh_map_free(&l->accounts);
+    hh_map_free(&l->account_keylets);
+    hh_map_free(&l->lines);
+    hh_map_free(&l->state);
+    for (size_t i = 0; i < l->pending_count; ++i)
+        free(l->pending[i].blob);
+    free(l->pending);
+    free(l);
+}
+
+uint32_t hh_ledger_seq(const hh_ledger* l) { return l->seq; }
+uint32_t hh_ledger_time(const hh_ledger* l) { return l->time; }
+void hh_ledger_trace(hh_ledger* l, int enabled) { l->trace = enabled; }
+void hh_ledger_hook_skip(hh_ledger* l, int enabled) { l->no_skip = !enabled; }
+void hh_ledger_on_access(hh_ledger* l, hh_access_cb cb, void* ctx)
+{
+    l->on_access = cb;
+    l->access_ctx = ctx;
+}
+size_t hh_ledger_pending(const hh_ledger* l) { return l->pending_count; }
+const hh_totals* hh_ledger_totals(const hh_ledger* l) { return &l->totals; }
+size_t hh_state_count(const hh_ledger* l) { return l->state.count; }
+
+// ---------------------------------------------------------------
+// Keylets
+// ---------------------------------------------------------------
+
+void hh_keylet_account(const uint8_t id[20], uint8_t out[32])
+{
+    uint8_t buf[22] = {0x00, 0x61};
+    memcpy(buf + 2, id, 20);
+    hh_sha512h(buf, sizeof(buf), out);
+}
+
+void hh_keylet_line(const uint8_t a[20], const uint8_t b[20], const uint8_t currency[20], uint8_t out[32])
+{
+    int a_low = memcmp(a, b, 20) < 0;
+    uint8_t buf[62] = {0x00, 0x72};
+    memcpy(buf + 2, a_low ? a : b, 20);
+    memcpy(buf + 22, a_low ? b : a, 20);
+    memcpy(buf + 42, currency, 20);
+    hh_sha512h(buf, sizeof(buf), out);
+}
+
+// ---------------------------------------------------------------
+// Accounts
+// ---------------------------------------------------------------
+
+hh_account* hh_account_get(const hh_ledger* l, const uint8_t id[20])
+{
+    return hh_map_get(&l->accounts, id);
+}
+
+int hh_account_create(hh_ledger* l, const uint8_t id[20], uint64_t drops)
+{
+    hh_account* a = hh_account_get(l, id);
+    if (a) {
+        a->balance = drops;
+        return 0;
+    }
+    a = calloc(1, sizeof(*a));
+    if (!a)
+        return INTERNAL_ERROR;
+    memcpy(a->id, id, 20);
+    hh_keylet_account(id, a->keylet);
+    a->balance = drops;
+    a->sequence = 1;
+    a->scale = 1;
+    hh_map_put(&l->accounts, a->id, a);
+    hh_map_put(&l->account_keylets, a->keylet, a);
+    return 0;
+}
+
+int hh_account_exists(const hh_ledger* l, const uint8_t id[20])
+{
+    return hh_account_get(l, id) != NULL;
+}
+
+uint64_t hh_account_balance(const hh_ledger* l, const uint8_t id[20])
+{
+    hh_account* a = hh_account_get(l, id);
+    return a ? a->balance : 0;
+}
+
+uint32_t hh_account_owner_count(const hh_ledger* l, const uint8_t id[20])
+{
+    hh_account* a = hh_account_get(l, id);
+    return a ? a->owner_count : 0;
+}
+
+void hh_account_set_scale(hh_ledger* l, const uint8_t id[20], uint16_t scale)
+{
+    hh_account* a = hh_account_get(l, id);
+    if (a && scale >= 1 && scale <= 16)
+        a->scale = scale;
+}
+
+uint64_t hh_reserve(const hh_account* a, uint32_t extra)
+{
+    return HH_RESERVE_BASE + (uint64_t)(a->owner_count + extra) * HH_RESERVE_INC;
+}
+
+static uint8_t* put_u32(uint8_t* p, uint32_t id, uint32_t v)
+{
+    p = hh_sto_put_header(p, id);
+    for (int i = 0; i < 4; ++i)
+        *p++ = (uint8_t)(v >> (24 - 8 * i));
+    return p;
+}
+
+// AccountRoot fields, without the object header.
+uint32_t hh_account_serialize(const hh_account* a, uint8_t* out)
+{
+    uint8_t* p = hh_sto_put_header(out, sfLedgerEntryType);
+    *p++ = 0x00;
+    *p++ = 0x61;
+    p = hh_sto_put_header(p, sfHookStateScale);
+    *p++ = (uint8_t)(a->scale >> 8);
+    *p++ = (uint8_t)a->scale;
+    p = put_u32(p, sfFlags, 0);
+    p = put_u32(p, sfSequence, a->sequence);
+    p = put_u32(p, sfOwnerCount, a->owner_count);
+    hh_amount bal = {.native = 1, .drops = a->balance};
+    p = hh_sto_put_amount(p, sfBalance, &bal);
+    p = hh_sto_put_header(p, sfAccount);
+    p = hh_sto_put_vl(p, a->id, 20);
+    return (uint32_t)(p - out);
+}
+
+// ---------------------------------------------------------------
+// Trustlines
+// ---------------------------------------------------------------
+
+hh_line* hh_line_get(const hh_ledger* l, const uint8_t a[20], const uint8_t b[20], const uint8_t currency[20])
+{
+    uint8_t key[32];
+    hh_keylet_line(a, b, currency, key);
+    return hh_map_get(&l->lines, key);
+}
+
+int hh_trustline_set(hh_ledger* l, const uint8_t holder[20], const uint8_t issuer[20],
+                     const uint8_t currency[20], int64_t limit_xfl)
+{
+    hh_account* h = hh_account_get(l, holder);
+    if (!h || !hh_account_get(l, issuer))
+        return DOESNT_EXIST;
+    uint8_t key[32];
+    hh_keylet_line(holder, issuer, currency, key);
+    hh_line* ln = hh_map_get(&l->lines, key);
+    if (!ln) {
+        ln = calloc(1, sizeof(*ln));
+        if (!ln)
+            return INTERNAL_ERROR;
+        memcpy(ln->holder, holder, 20);
+        memcpy(ln->issuer, issuer, 20);
+        memcpy(ln->currency, currency, 20);
+        hh_map_put(&l->lines, key, ln);
+        h->owner_count++;
+    }
+    ln->limit = limit_xfl;
+    return 0;
+}
+
+int64_t hh_trustline_balance(const hh_ledger* l, const uint8_t holder[20],
+                             const uint8_t issuer[20], const uint8_t currency[20])
+{
+    hh_line* ln = hh_line_get(l, holder, issuer, currency);
+    if (!ln || memcmp(ln->holder, holder, 20) != 0)
+        return DOESNT_EXIST;
+    return ln->balance;
+}
+
+static uint8_t* put_iou(uint8_t* p, uint32_t id, int64_t xfl, const uint8_t* currency, const uint8_t* issuer)
+{
+    hh_amount a = {.native = 0, .xfl = xfl};
+    memcpy(a.currency, currency, 20);
+    memcpy(a.issuer, issuer, 20);
+    return hh_sto_put_amount(p, id, &a);
+}
+
+// RippleState fields. Balance is positive when the low account holds.
+uint32_t hh_line_serialize(const hh_line* ln, uint8_t* out)
+{
+    static const uint8_t account_one[20] = {[19] = 1};
+    int holder_low = memcmp(ln->holder, ln->issuer, 20) < 0;
+    const uint8_t* low = holder_low ? ln->holder : ln->issuer;
+    const uint8_t* high = holder_low ? ln->issuer : ln->holder;
+    int64_t bal = ln->balance;
+    if (!holder_low && bal)
+        bal = (int64_t)((uint64_t)bal ^ (1ULL << 62));
+
+    uint8_t* p = hh_sto_put_header(out, sfLedgerEntryType);
+    *p++ = 0x00;
+    *p++ = 0x72;
+    p = put_u32(p, sfFlags, 0);
+    p = put_iou(p, sfBalance, bal, ln->currency, account_one);
+    p = put_iou(p, sfLowLimit, holder_low ? ln->limit : 0, ln->currency, low);
+    p = put_iou(p, sfHighLimit, holder_low ? 0 : ln->limit, ln->currency, high);
+    return (uint32_t)(p - out);
+}
+
+// ---------------------------------------------------------------
+// Hooks
+// ---------------------------------------------------------------
+
+int hh_hook_set(hh_ledger* l, const uint8_t account[20], int position,
+                const hh_hook_def* def, const hh_hook_opts* opts)
+{
+    hh_account* a = hh_account_get(l, account);
+    if (!a)
+        return DOESNT_EXIST;
+    if (position < 0 || position >= HH_MAX_CHAIN)
+        return INVALID_ARGUMENT;
+    hh_hook* h = a->chain[position];
+    if (h) {
+        free(h->params);
+        free(h);
+        a->chain[position] = NULL;
+        a->hook_count--;
+    }
+    if (!def)
+        return 0;
+
+    h = calloc(1, sizeof(*h));
+    if (!h)
+        return INTERNAL_ERROR;
+    h->def = def;
+    if (opts && opts->hash)
+        memcpy(h->hash, opts->hash, 32);
+    else {
+        char buf[128];
+        int n = snprintf(buf, sizeof(buf), "hook:%s", def->name);
+        hh_sha512h(buf, (size_t)n, h->hash);
+    }
+    if (opts && opts->ns)
+        memcpy(h->ns, opts->ns, 32);
+    if (opts && opts->hookon)
+        memcpy(h->hookon, opts->hookon, 32);
+    if (opts && opts->param_count > 0) {
+        if (opts->param_count > HH_MAX_PARAMS) {
+            free(h);
+            return TOO_MANY_PARAMS;
+        }
+        h->params = malloc(sizeof(hh_param) * (size_t)opts->param_count);
+        if (!h->params) {
+            free(h);
+            return INTERNAL_ERROR;
+        }
+        memcpy(h->params, opts->params, sizeof(hh_param) * (size_t)opts->param_count);
+        h->param_count = opts->param_count;
+    }
+    a->chain[position] = h;
+    a->hook_count++;
+    return 0;
+}
+
+int hh_hook_hash(const hh_ledger* l, const uint8_t account[20], int position, uint8_t out[32])
+{
+    hh_account* a = hh_account_get(l, account);
+    if (!a || position < 0 || position >= HH_MAX_CHAIN || !a->chain[position])
+        return DOESNT_EXIST;
+    memcpy(out, a->chain[position]->hash, 32);
+    return 0;
+}
+
+void hh_grant(hh_ledger* l, const uint8_t grantor[20], const uint8_t hook_hash[32])
+{
+    hh_account* a = hh_account_get(l, grantor);
+    if (!a)
+        return;
+    uint8_t (*g)[32] = realloc(a->grants, sizeof(*g) * (size_t)(a->grant_count + 1));
+    if (!g)
+        return;
+    a->grants = g;
+    memcpy(a->grants[a->grant_count++], hook_hash, 32);
+}
+
+// ---------------------------------------------------------------
+// State
+// ---------------------------------------------------------------
+
+void hh_state_key(const uint8_t account[20], const uint8_t ns[32], const uint8_t key[32], uint8_t out[84])
+{
+    memcpy(out, account, 20);
+    memcpy(out + 20, ns, 32);
+    memcpy(out + 52, key, 32);
+}
+
+int hh_state_set(hh_ledger* l, const uint8_t account[20], const uint8_t ns[32], const uint8_t* key,
+                 uint32_t key_len, const uint8_t* data, uint32_t len)
+{
+    hh_account* a = hh_account_get(l, account);
+    if (!a || key_len == 0 || key_len > 32 || len > HH_STATE_MAX * (uint32_t)a->scale)
+        return -1;
+    uint8_t k[32] = {0};
+    memcpy(k + 32 - key_len, key, key_len);
+    uint8_t full[84];
+    hh_state_key(account, ns, k, full);
+    hh_blob* b = malloc(sizeof(*b) + len);
+    if (!b)
+        return -1;
+    b->len = len;
+    memcpy(b->data, data, len);
+    hh_blob* old = hh_map_get(&l->state, full);
+    hh_map_put(&l->state, full, b);
+    if (!old)
+        a->owner_count += a->scale;
+    free(old);
+    return 0;
+}
+
+int64_t hh_state_get(const hh_ledger* l, const uint8_t account[20], const uint8_t ns[32],
+                     const uint8_t* key, uint32_t key_len, uint8_t* out, uint32_t out_len)
+{
+    if (key_len == 0 || key_len > 32)
+        return INVALID_ARGUMENT;
+    uint8_t k[32] = {0};
+    memcpy(k + 32 - key_len, key, key_len);
+    uint8_t full[84];
+    hh_state_key(account, ns, k, full);
+    hh_blob* b = hh_map_get(&l->state, full);
+    if (!b)
+        return DOESNT_EXIST;
+    memcpy(out, b->data, b->len < out_len ? b->len : out_len);
+    return b->len;
+}
@@ -0,0 +1,36 @@
+//**************************************************************
+// HandyHooks native harness - instruction meter
+//
+// Xahau charges a hook execution by the WASM instructions it runs.
+// The hooks here run natively, so the closest stable measure is the
+// number of basic blocks executed: every hook object is compiled with
+// -fsanitize-coverage=trace-pc, which calls the function below on
+// entry to each block. The harness itself is not instrumented, so only
+// hook code is counted.
+//
+// The same callback feeds the coverage map of hh_coverage(): each
+// pair of consecutive blocks is hashed into a hit counter, so a tool
+// can tell when an input reached code no earlier input did.
+//**************************************************************
+
+#include "internal.h"
+
+static uint8_t* coverage;
+static uintptr_t prev_pc;
+
+void hh_coverage(uint8_t* map)
+{
+    coverage = map;
+    prev_pc = 0;
+}
+
+void __sanitizer_cov_trace_pc(void)
+{
+    hh_cur->exec->blocks++;
+    if (coverage) {
+        uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+        uint64_t edge = ((uint64_t)pc ^ ((uint64_t)prev_pc >> 1)) * 0x9E3779B97F4A7C15ULL;
+        coverage[edge >> (64 - HH_COVERAGE_BITS)]++;
+        prev_pc = pc;
+    }
+}
@@ -0,0 +1,566 @@
+//**************************************************************
+// HandyHooks native harness - scenario scripts
+//
+// Scenario commands (one per line, # starts a comment):
+//   ledger <seq> <close_time>
+//   account <name> <xah>                  fund or create an account
+//   scale <name> <HookStateScale>
+//   trust <holder> <issuer> <CUR> <limit>
+//   hook <account> <pos> <HookName> [hash=HEX] [ns=HEX] [hookon=HEX] [NAME=value]...
+//   unhook <account> <pos>
+//   grant <grantor> <hook_account> <pos>
+//   pay <from> <to> <amount> [NAME=value]...
+//   invoke <from> [to] [NAME=value]...
+//   remit <from> <to> [amount[,amount]...] [NAME=value]...
+//   close [count]                         apply emitted transactions
+//   expect <ter> [emitted=N]              check the last result
+//   state <account> <ns HEX|0> <key>      print a state entry
+//   put <account> <ns HEX|0> <key> <value>  write a state entry directly
+//   balance <account> [CUR/issuer]
+//   path [label]                          label the results that follow
+//   repeat <n> <command>                  %d in the command is the index
+//   trace on|off, verbose on|off, stats
+//
+// Values: hex:..., acc:<name>, u8: u16: u32: u64: (big endian),
+// str:<text>, cur:<CUR>; bare values are hex. Amounts are XAH
+// ("12.5") or IOU ("100/TST/issuer").
+//**************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scenario.h"
+
+#define MAX_TOKENS 40
+#define MAX_LINE 8192
+
+// The scenario being run; the commands below act on it.
+static hh_scenario* sc;
+
+static void fail(const char* fmt, const char* arg)
+{
+    fprintf(stderr, "%s:%d: ", sc->name, sc->lineno);
+    fprintf(stderr, fmt, arg);
+    fputc('\n', stderr);
+    sc->failures++;
+}
+
+static int tokenize(char* line, char** tok)
+{
+    int n = 0;
+    char* p = line;
+    while (*p && n < MAX_TOKENS) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+            ++p;
+        if (!*p || *p == '#')
+            break;
+        char* start = p;
+        char* out = p;
+        int quoted = 0;
+        while (*p && (quoted || (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\n'))) {
+            if (*p == '"')
+                quoted = !quoted;
+            else
+                *out++ = *p;
+            ++p;
+        }
+        if (*p)
+            ++p;
+        *out = 0;
+        tok[n++] = start;
+    }
+    return n;
+}
+
+static void account(const char* name, uint8_t out[20])
+{
+    hh_account_id(name, out);
+}
+
+static int put_be(uint8_t* out, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        out[i] = (uint8_t)(v >> (8 * (bytes - 1 - i)));
+    return bytes;
+}
+
+// Parses a typed value into out. Returns its length or -1.
+static int parse_value(const char* spec, uint8_t* out, uint32_t max)
+{
+    const char* colon = strchr(spec, ':');
+    if (!colon)
+        return hh_hex(spec, out, max);
+    size_t tl = (size_t)(colon - spec);
+    const char* v = colon + 1;
+    if (tl == 3 && !strncmp(spec, "hex", 3))
+        return hh_hex(v, out, max);
+    if (tl == 3 && !strncmp(spec, "acc", 3)) {
+        if (max < 20)
+            return -1;
+        account(v, out);
+        return 20;
+    }
+    if (tl == 3 && !strncmp(spec, "str", 3)) {
+        size_t n = strlen(v);
+        if (n > max)
+            return -1;
+        memcpy(out, v, n);
+        return (int)n;
+    }
+    if (tl == 3 && !strncmp(spec, "cur", 3))
+        return max >= 20 && hh_currency(v, out) == 0 ? 20 : -1;
+    if (spec[0] == 'u') {
+        int bits = atoi(spec + 1);
+        if ((bits != 8 && bits != 16 && bits != 32 && bits != 64) || (uint32_t)bits / 8 > max)
+            return -1;
+        return put_be(out, strtoull(v, NULL, 0), bits / 8);
+    }
+    return -1;
+}
+
+static int parse_amount(const char* s, hh_amount* a)
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s", s);
+    char* cur = strchr(buf, '/');
+    if (!cur) {
+        char* end;
+        long double xah = strtold(buf, &end);
+        if (*end || end == buf || xah < 0)
+            return -1;
+        hh_amount_drops(a, (uint64_t)(xah * 1000000.0L + 0.5L));
+        return 0;
+    }
+    *cur++ = 0;
+    char* issuer = strchr(cur, '/');
+    if (!issuer)
+        return -1;
+    *issuer++ = 0;
+    uint8_t c[20], iss[20];
+    int64_t x = hh_xfl_parse(buf);
+    if (x < 0 || hh_currency(cur, c) != 0)
+        return -1;
+    account(issuer, iss);
+    hh_amount_iou(a, x, c, iss);
+    return 0;
+}
+
+// NAME=value tokens as transaction or hook parameters.
+static int parse_param(const char* tok, hh_param* p)
+{
+    const char* eq = strchr(tok, '=');
+    if (!eq || eq == tok || (size_t)(eq - tok) > HH_MAX_PARAM_NAME)
+        return -1;
+    p->name_len = (uint32_t)(eq - tok);
+    memcpy(p->name, tok, p->name_len);
+    int n = parse_value(eq + 1, p->value, HH_MAX_PARAM_VALUE);
+    if (n < 0)
+        return -1;
+    p->value_len = (uint32_t)n;
+    return 0;
+}
+
+static int add_params(hh_txn* t, char** tok, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        if (t->param_count == HH_MAX_PARAMS) {
+            fail("too many parameters at %s", tok[i]);
+            return -1;
+        }
+        if (parse_param(tok[i], &t->params[t->param_count]) != 0) {
+            fail("bad parameter %s", tok[i]);
+            return -1;
+        }
+        t->param_count++;
+    }
+    return 0;
+}
+
+static void print_hex(const uint8_t* p, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+        printf("%02X", p[i]);
+}
+
+static void print_result(const char* what, const hh_result* r)
+{
+    if (r->ter == HH_TEC_HOOK_REJECTED)
+        sc->hook_rejections++;
+    if (sc->on_result)
+        sc->on_result(sc, sc->path, r);
+    if (!sc->verbose)
+        return;
+    printf("%s: %s", what, hh_ter_name(r->ter));
+    if (r->emitted_count)
+        printf(" emitted=%d", r->emitted_count);
+    putchar('\n');
+    for (int i = 0; i < r->exec_count; ++i) {
+        const hh_exec* e = &r->execs[i];
+        printf("  %s[%d] %s(%lld) \"%.*s\"", e->def->name, e->position,
+               e->exit == HH_EXIT_ACCEPT ? "accept" : "rollback", (long long)e->exit_code,
+               (int)e->reason_len, e->reason);
+        if (e->emitted)
+            printf(" emitted=%u", e->emitted);
+        putchar('\n');
+    }
+}
+
+static void on_close(void* ctx, const hh_result* r)
+{
+    (void)ctx;
+    char what[80];
+    snprintf(what, sizeof(what), "emitted %02X%02X%02X%02X (gen %u)", r->txid[0], r->txid[1],
+             r->txid[2], r->txid[3], r->generation);
+    print_result(what, r);
+}
+
+static void submit(hh_txn* t, char** tok, int n)
+{
+    hh_submit(sc->ledger, t, &sc->last);
+    sc->txn = t;
+    char what[256];
+    snprintf(what, sizeof(what), "%s", tok[0]);
+    for (int i = 1; i < n && i < 4; ++i) {
+        strncat(what, " ", sizeof(what) - strlen(what) - 1);
+        strncat(what, tok[i], sizeof(what) - strlen(what) - 1);
+    }
+    print_result(what, &sc->last);
+    sc->txn = NULL;
+}
+
+static int dispatch(char** tok, int n);
+
+static void cmd_repeat(char** tok, int n)
+{
+    long count = strtol(tok[1], NULL, 10);
+    char line[MAX_LINE], expanded[MAX_LINE];
+    line[0] = 0;
+    for (int i = 2; i < n; ++i) {
+        strncat(line, tok[i], sizeof(line) - strlen(line) - 2);
+        strcat(line, " ");
+    }
+    for (long i = 0; i < count && (!sc->failures || sc->keep_going); ++i) {
+        char* o = expanded;
+        for (const char* p = line; *p && o < expanded + sizeof(expanded) - 24; ++p) {
+            if (p[0] == '%' && p[1] == 'd') {
+                o += sprintf(o, "%ld", i);
+                ++p;
+            } else
+                *o++ = *p;
+        }
+        *o = 0;
+        char* sub[MAX_TOKENS];
+        int m = tokenize(expanded, sub);
+        if (m)
+            dispatch(sub, m);
+    }
+}
+
+static void cmd_hook(char** tok, int n)
+{
+    uint8_t acc[20], hash[32], ns[32], hookon[32];
+    static hh_param params[HH_MAX_PARAMS];
+    hh_hook_opts o = {0};
+    account(tok[1], acc);
+    const char* name = tok[3];
+    for (int i = 0; i < sc->alias_count; ++i)
+        if (!strcmp(name, sc->alias_from[i]))
+            name = sc->alias_to[i];
+    const hh_hook_def* def = hh_hook_find(name);
+    if (!def) {
+        fail("unknown hook %s", name);
+        return;
+    }
+    for (int i = 4; i < n; ++i) {
+        if (!strncmp(tok[i], "hash=", 5) && hh_hex(tok[i] + 5, hash, 32) == 32)
+            o.hash = hash;
+        else if (!strncmp(tok[i], "ns=", 3) && hh_hex(tok[i] + 3, ns, 32) == 32)
+            o.ns = ns;
+        else if (!strncmp(tok[i], "hookon=", 7) && hh_hex(tok[i] + 7, hookon, 32) == 32)
+            o.hookon = hookon;
+        else if (o.param_count < HH_MAX_PARAMS && parse_param(tok[i], &params[o.param_count]) == 0)
+            o.param_count++;
+        else {
+            fail("bad hook option %s", tok[i]);
+            return;
+        }
+    }
+    o.params = params;
+    if (!o.hash && name != tok[3]) {
+        // an aliased hook keeps the default hash of the name in the
+        // script, so emitted transactions carry the same EmitHookHash
+        char label[64];
+        snprintf(label, sizeof(label), "hook:%s", tok[3]);
+        hh_sha512h(label, strlen(label), hash);
+        o.hash = hash;
+    }
+    if (hh_hook_set(sc->ledger, acc, atoi(tok[2]), def, &o) != 0)
+        fail("cannot install %s", tok[3]);
+}
+
+// A namespace argument: 0, 64 hex digits, or acc:<name> for the
+// account's own namespace { account ID:20, zero:12 } (UserRecord.h).
+static int parse_ns(const char* spec, uint8_t ns[32])
+{
+    if (!strcmp(spec, "0"))
+        return 1;
+    if (!strncmp(spec, "acc:", 4)) {
+        account(spec + 4, ns);
+        return 1;
+    }
+    return hh_hex(spec, ns, 32) == 32;
+}
+
+static void cmd_state(char** tok)
+{
+    uint8_t acc[20], ns[32] = {0}, key[32], val[HH_STATE_MAX * 16];
+    account(tok[1], acc);
+    if (!parse_ns(tok[2], ns)) {
+        fail("bad namespace %s", tok[2]);
+        return;
+    }
+    int kl = parse_value(tok[3], key, 32);
+    if (kl <= 0) {
+        fail("bad key %s", tok[3]);
+        return;
+    }
+    int64_t r = hh_state_get(sc->ledger, acc, ns, key, (uint32_t)kl, val, sizeof(val));
+    printf("state %s %s: ", tok[1], tok[3]);
+    if (r < 0)
+        printf("(none)\n");
+    else {
+        print_hex(val, (uint32_t)r);
+        putchar('\n');
+    }
+}
+
+static void cmd_put(char** tok)
+{
+    uint8_t acc[20], ns[32] = {0}, key[32];
+    static uint8_t val[HH_STATE_MAX * 16];
+    account(tok[1], acc);
+    if (!parse_ns(tok[2], ns)) {
+        fail("bad namespace %s", tok[2]);
+        return;
+    }
+    int kl = parse_value(tok[3], key, 32);
+    int vl = parse_value(tok[4], val, sizeof(val));
+    if (kl <= 0 || vl < 0 || hh_state_set(sc->ledger, acc, ns, key, (uint32_t)kl, val, (uint32_t)vl) != 0)
+        fail("cannot put state %s", tok[3]);
+}
+
+static void cmd_balance(char** tok, int n)
+{
+    uint8_t acc[20];
+    account(tok[1], acc);
+    if (n < 3) {
+        uint64_t d = hh_account_balance(sc->ledger, acc);
+        printf("balance %s: %llu.%06llu XAH (owner count %u)\n", tok[1], (unsigned long long)(d / 1000000),
+               (unsigned long long)(d % 1000000), hh_account_owner_count(sc->ledger, acc));
+        return;
+    }
+    hh_amount a;
+    char spec[128];
+    snprintf(spec, sizeof(spec), "0/%s", tok[2]);
+    if (parse_amount(spec, &a) != 0) {
+        fail("bad currency %s", tok[2]);
+        return;
+    }
+    int64_t b = hh_trustline_balance(sc->ledger, acc, a.issuer, a.currency);
+    char txt[64];
+    hh_xfl_format(b < 0 ? 0 : b, txt, sizeof(txt));
+    printf("balance %s %s: %s%s\n", tok[1], tok[2], txt, b < 0 ? " (no line)" : "");
+}
+
+static void cmd_expect(char** tok, int n)
+{
+    if (strcmp(hh_ter_name(sc->last.ter), tok[1]) != 0) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "expected %s, got %s", tok[1], hh_ter_name(sc->last.ter));
+        fail("%s", msg);
+    }
+    for (int i = 2; i < n; ++i)
+        if (!strncmp(tok[i], "emitted=", 8) && atoi(tok[i] + 8) != sc->last.emitted_count)
+            fail("emitted count differs from %s", tok[i]);
+}
+
+static void cmd_stats(void)
+{
+    const hh_totals* t = hh_ledger_totals(sc->ledger);
+    double secs = (double)(clock() - sc->started) / CLOCKS_PER_SEC;
+    printf("stats: txns=%llu executions=%llu emitted=%llu rejected=%llu fee_burned=%llu state=%zu "
+           "ledger=%u %.2fs (%.0f txn/s)\n",
+           (unsigned long long)t->txns, (unsigned long long)t->executions, (unsigned long long)t->emitted,
+           (unsigned long long)sc->hook_rejections, (unsigned long long)t->fee_burned, hh_state_count(sc->ledger),
+           hh_ledger_seq(sc->ledger), secs, secs > 0 ? (double)t->txns / secs : 0.0);
+}
+
+static int need(int n, int min, const char* cmd)
+{
+    if (n >= min)
+        return 1;
+    fail("missing arguments to %s", cmd);
+    return 0;
+}
+
+static int dispatch(char** tok, int n)
+{
+    const char* c = tok[0];
+    uint8_t a[20], b[20];
+    static hh_txn t;
+
+    if (!strcmp(c, "ledger") && need(n, 3, c)) {
+        hh_ledger_free(sc->ledger);
+        sc->ledger = hh_ledger_new((uint32_t)strtoul(tok[1], NULL, 0), (uint32_t)strtoul(tok[2], NULL, 0));
+        hh_ledger_trace(sc->ledger, sc->trace);
+        hh_ledger_hook_skip(sc->ledger, !sc->no_skip);
+        hh_ledger_on_access(sc->ledger, sc->on_access, sc);
+    } else if (!strcmp(c, "account") && need(n, 3, c)) {
+        hh_amount amt;
+        account(tok[1], a);
+        if (parse_amount(tok[2], &amt) != 0 || !amt.native)
+            fail("bad XAH amount %s", tok[2]);
+        else
+            hh_account_create(sc->ledger, a, amt.drops);
+    } else if (!strcmp(c, "scale") && need(n, 3, c)) {
+        account(tok[1], a);
+        hh_account_set_scale(sc->ledger, a, (uint16_t)atoi(tok[2]));
+    } else if (!strcmp(c, "trust") && need(n, 5, c)) {
+        uint8_t cur[20];
+        account(tok[1], a);
+        account(tok[2], b);
+        if (hh_currency(tok[3], cur) != 0 || hh_trustline_set(sc->ledger, a, b, cur, hh_xfl_parse(tok[4])) != 0)
+            fail("cannot set trustline for %s", tok[1]);
+    } else if (!strcmp(c, "hook") && need(n, 4, c)) {
+        cmd_hook(tok, n);
+    } else if (!strcmp(c, "unhook") && need(n, 3, c)) {
+        account(tok[1], a);
+        hh_hook_set(sc->ledger, a, atoi(tok[2]), NULL, NULL);
+    } else if (!strcmp(c, "grant") && need(n, 4, c)) {
+        uint8_t hash[32];
+        account(tok[1], a);
+        account(tok[2], b);
+        if (hh_hook_hash(sc->ledger, b, atoi(tok[3]), hash) != 0)
+            fail("no hook on %s", tok[2]);
+        else
+            hh_grant(sc->ledger, a, hash);
+    } else if (!strcmp(c, "pay") && need(n, 4, c)) {
+        account(tok[1], a);
+        hh_txn_init(&t, 0, a);
+        account(tok[2], t.destination);
+        t.has_destination = 1;
+        t.has_amount = 1;
+        if (parse_amount(tok[3], &t.amount) != 0)
+            fail("bad amount %s", tok[3]);
+        else if (add_params(&t, tok + 4, n - 4) == 0)
+            submit(&t, tok, n);
+    } else if (!strcmp(c, "invoke") && need(n, 2, c)) {
+        account(tok[1], a);
+        hh_txn_init(&t, 99, a);
+        int first = 2;
+        if (n > 2 && !strchr(tok[2], '=')) {
+            account(tok[2], t.destination);
+            t.has_destination = 1;
+            first = 3;
+        }
+        if (add_params(&t, tok + first, n - first) == 0)
+            submit(&t, tok, n);
+    } else if (!strcmp(c, "remit") && need(n, 3, c)) {
+        account(tok[1], a);
+        hh_txn_init(&t, 95, a);
+        account(tok[2], t.destination);
+        t.has_destination = 1;
+        int first = 3;
+        if (n > 3 && !strchr(tok[3], '=')) {
+            char list[512];
+            snprintf(list, sizeof(list), "%s", tok[3]);
+            for (char* s = strtok(list, ","); s; s = strtok(NULL, ",")) {
+                if (t.amount_count == HH_MAX_AMOUNTS || parse_amount(s, &t.amounts[t.amount_count]) != 0) {
+                    fail("bad amount %s", s);
+                    return -1;
+                }
+                t.amount_count++;
+            }
+            first = 4;
+        }
+        if (add_params(&t, tok + first, n - first) == 0)
+            submit(&t, tok, n);
+    } else if (!strcmp(c, "close")) {
+        int count = n > 1 ? atoi(tok[1]) : 1;
+        for (int i = 0; i < count; ++i)
+            hh_ledger_close(sc->ledger, on_close, NULL);
+    } else if (!strcmp(c, "expect") && need(n, 2, c)) {
+        cmd_expect(tok, n);
+    } else if (!strcmp(c, "state") && need(n, 4, c)) {
+        cmd_state(tok);
+    } else if (!strcmp(c, "put") && need(n, 5, c)) {
+        cmd_put(tok);
+    } else if (!strcmp(c, "balance") && need(n, 2, c)) {
+        cmd_balance(tok, n);
+    } else if (!strcmp(c, "path")) {
+        snprintf(sc->path, sizeof(sc->path), "%s", n > 1 ? tok[1] : "");
+    } else if (!strcmp(c, "repeat") && need(n, 3, c)) {
+        cmd_repeat(tok, n);
+    } else if (!strcmp(c, "trace") && need(n, 2, c)) {
+        sc->trace = !strcmp(tok[1], "on");
+        hh_ledger_trace(sc->ledger, sc->trace);
+    } else if (!strcmp(c, "verbose") && need(n, 2, c)) {
+        sc->verbose = !strcmp(tok[1], "on");
+    } else if (!strcmp(c, "stats")) {
+        cmd_stats();
+    } else if (n) {
+        fail("unknown command %s", c);
+    }
+    return 0;
+}
+
+void hh_scenario_init(hh_scenario* s)
+{
+    memset(s, 0, sizeof(*s));
+    s->verbose = 1;
+    s->name = "-";
+    s->started = clock();
+    hh_result_init(&s->last);
+}
+
+void hh_scenario_free(hh_scenario* s)
+{
+    hh_result_free(&s->last);
+    hh_ledger_free(s->ledger);
+    s->ledger = NULL;
+}
+
+int hh_scenario_alias(hh_scenario* s, const char* from, const char* to)
+{
+    if (s->alias_count == HH_MAX_ALIASES)
+        return -1;
+    s->alias_from[s->alias_count] = from;
+    s->alias_to[s->alias_count] = to;
+    s->alias_count++;
+    return 0;
+}
+
+int hh_scenario_run(hh_scenario* s, FILE* in, const char* name)
+{
+    sc = s;
+    s->name = name;
+    s->lineno = 0;
+    if (!s->ledger)
+        s->ledger = hh_ledger_new(1000, 750000000);
+    hh_ledger_trace(s->ledger, s->trace);
+    hh_ledger_hook_skip(s->ledger, !s->no_skip);
+    hh_ledger_on_access(s->ledger, s->on_access, s);
+
+    static char line[MAX_LINE];
+    while (fgets(line, sizeof(line), in) && (!s->failures || s->keep_going)) {
+        ++s->lineno;
+        char* tok[MAX_TOKENS];
+        int n = tokenize(line, tok);
+        if (n)
+            dispatch(tok, n);
+    }
+    sc = NULL;
+    return s->failures;
+}
@@ -0,0 +1,68 @@
+//**************************************************************
+// HandyHooks native harness - scenario scripts
+//
+// Description:
+//   The line based scenario language shared by hookrun and the tools
+//   built on it. A scenario builds a ledger, installs hooks and submits
+//   transactions; every result is printed (when verbose) and handed to
+//   the on_result callback together with the current path label.
+//
+// Usage:
+//   hh_scenario s;
+//   hh_scenario_init(&s);
+//   s.on_result = my_callback;
+//   hh_scenario_run(&s, file, "name.txt");
+//   hh_scenario_free(&s);
+//**************************************************************
+
+#ifndef HH_SCENARIO_H
+#define HH_SCENARIO_H
+
+#include <stdio.h>
+#include <time.h>
+
+#include "harness.h"
+
+#define HH_MAX_PATH_LABEL 64
+#define HH_MAX_ALIASES 8
+
+typedef struct hh_scenario hh_scenario;
+
+// Called for every submitted transaction and every emitted one applied
+// by close. path is the label set by the last `path` command, or "".
+typedef void (*hh_scenario_cb)(hh_scenario* s, const char* path, const hh_result* r);
+
+struct hh_scenario {
+    hh_ledger* ledger;
+    hh_result last;
+    int verbose;
+    int trace;
+    int failures;
+    int lineno;
+    const char* name;
+    char path[HH_MAX_PATH_LABEL];
+    uint64_t hook_rejections;
+    clock_t started;
+    hh_scenario_cb on_result;
+    hh_access_cb on_access;    // attached to every ledger, called with the scenario
+    int no_skip;               // every ledger runs the hooks hook_skip names
+    int keep_going;            // run on after a failed expectation
+    const hh_txn* txn;         // during on_result: the submitted transaction, NULL for emitted ones
+    int alias_count;           // hooks the `hook` command installs under another name
+    const char* alias_from[HH_MAX_ALIASES];
+    const char* alias_to[HH_MAX_ALIASES];
+    void* user;
+};
+
+void hh_scenario_init(hh_scenario* s);
+void hh_scenario_free(hh_scenario* s);
+
+// Makes `hook ... <from> ...` install the registry hook <to> instead,
+// so one script can drive two variants of a hook. Returns -1 when full.
+int hh_scenario_alias(hh_scenario* s, const char* from, const char* to);
+
+// Runs every line of in. Returns the number of failed expectations and
+// errors; the run stops at the first one. Must be called inside hh_run().
+int hh_scenario_run(hh_scenario* s, FILE* in, const char* name);
+
+#endif
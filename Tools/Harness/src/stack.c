@@ -0,0 +1,53 @@
+//**************************************************************
+// HandyHooks native harness - low stack
+//
+// Hooks hand the API their stack buffers as uint32_t. Running the
+// program on a stack mapped below 4GB (and linking without PIE, so
+// the hooks' static data sits low as well) keeps those casts exact.
+//**************************************************************
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#include "harness.h"
+
+#define HH_STACK_SIZE (64U << 20)
+
+static ucontext_t main_ctx, low_ctx;
+static int (*entry)(int, char**);
+static int entry_argc;
+static char** entry_argv;
+static int entry_rc;
+
+static void trampoline(void)
+{
+    entry_rc = entry(entry_argc, entry_argv);
+}
+
+int hh_run(int (*fn)(int, char**), int argc, char** argv)
+{
+    if ((uintptr_t)&hh_run > 0xFFFFFFFFULL) {
+        fprintf(stderr, "harness: link with -no-pie so hook data stays below 4GB\n");
+        return 1;
+    }
+    void* stack = mmap(NULL, HH_STACK_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT | MAP_NORESERVE, -1, 0);
+    if (stack == MAP_FAILED || (uintptr_t)stack + HH_STACK_SIZE > 0x100000000ULL) {
+        fprintf(stderr, "harness: cannot map a stack below 4GB\n");
+        return 1;
+    }
+    entry = fn;
+    entry_argc = argc;
+    entry_argv = argv;
+    getcontext(&low_ctx);
+    low_ctx.uc_stack.ss_sp = stack;
+    low_ctx.uc_stack.ss_size = HH_STACK_SIZE;
+    low_ctx.uc_link = &main_ctx;
+    makecontext(&low_ctx, trampoline, 0);
+    swapcontext(&main_ctx, &low_ctx);
+    munmap(stack, HH_STACK_SIZE);
+    return entry_rc;
+}
@@ -0,0 +1,245 @@
+//**************************************************************
+// HandyHooks native harness - state I/O tracer
+//
+// Accesses are grouped per execution (hh_access.serial). When the
+// next execution starts, the finished one is folded into the stats
+// of the path that was current when it began.
+//**************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "statetrace.h"
+
+#define MAX_KEYS 128           // distinct keys tracked per execution
+#define MAX_PATHS 256
+#define MAX_HOTSPOTS 32        // repeated keys listed per path
+
+typedef struct key_use {
+    int param;                 // hook_param name rather than a state key
+    uint8_t account[20];
+    uint8_t ns[32];
+    uint8_t key[32];
+    uint32_t key_len;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t unchanged;
+} key_use;
+
+typedef struct hotspot {
+    const hh_hook_def* def;
+    int param;
+    char key[72];
+    uint64_t rereads;
+    uint64_t rewrites;
+    uint64_t unchanged;
+} hotspot;
+
+typedef struct path_io {
+    char label[HH_MAX_PATH_LABEL];
+    uint64_t executions;
+    uint64_t reads, rereads;
+    uint64_t writes, rewrites, unchanged;
+    uint64_t params, param_rereads;
+    int hotspot_count;
+    hotspot hotspots[MAX_HOTSPOTS];
+} path_io;
+
+static FILE* log_out;
+static path_io paths[MAX_PATHS];
+static int path_count;
+
+// the execution being collected
+static uint64_t cur_serial;
+static const hh_hook_def* cur_def;
+static char cur_path[HH_MAX_PATH_LABEL];
+static int key_count;
+static key_use keys[MAX_KEYS];
+
+static void key_text(const uint8_t* k, uint32_t len, char* out, size_t cap)
+{
+    uint32_t n = len;
+    while (n && !k[n - 1])
+        --n;
+    int printable = n > 0;
+    for (uint32_t i = 0; i < n && printable; ++i)
+        printable = k[i] >= 0x20 && k[i] < 0x7F;
+    if (printable) {
+        snprintf(out, cap, "%.*s", (int)n, (const char*)k);
+        return;
+    }
+    size_t o = 0;
+    for (uint32_t i = 0; i < len && o + 3 < cap; ++i)
+        o += (size_t)snprintf(out + o, cap - o, "%02X", k[i]);
+    if (!len)
+        snprintf(out, cap, "(none)");
+}
+
+static path_io* path_for(const char* label)
+{
+    if (!label[0])
+        label = "(unlabelled)";
+    for (int i = 0; i < path_count; ++i)
+        if (!strcmp(paths[i].label, label))
+            return &paths[i];
+    if (path_count == MAX_PATHS)
+        return NULL;
+    path_io* p = &paths[path_count++];
+    snprintf(p->label, sizeof(p->label), "%s", label);
+    return p;
+}
+
+static hotspot* hotspot_for(path_io* p, const key_use* k)
+{
+    char text[72];
+    key_text(k->key, k->key_len, text, sizeof(text));
+    for (int i = 0; i < p->hotspot_count; ++i) {
+        hotspot* h = &p->hotspots[i];
+        if (h->def == cur_def && h->param == k->param && !strcmp(h->key, text))
+            return h;
+    }
+    if (p->hotspot_count == MAX_HOTSPOTS)
+        return NULL;
+    hotspot* h = &p->hotspots[p->hotspot_count++];
+    h->def = cur_def;
+    h->param = k->param;
+    memcpy(h->key, text, sizeof(text));
+    return h;
+}
+
+static void flush(void)
+{
+    if (!cur_serial)
+        return;
+    path_io* p = path_for(cur_path);
+    if (p) {
+        p->executions++;
+        for (int i = 0; i < key_count; ++i) {
+            const key_use* k = &keys[i];
+            uint64_t extra_reads = k->reads > 1 ? k->reads - 1 : 0;
+            uint64_t extra_writes = k->writes > 1 ? k->writes - 1 : 0;
+            if (k->param) {
+                p->params += k->reads;
+                p->param_rereads += extra_reads;
+            } else {
+                p->reads += k->reads;
+                p->rereads += extra_reads;
+                p->writes += k->writes;
+                p->rewrites += extra_writes;
+                p->unchanged += k->unchanged;
+            }
+            if (!extra_reads && !extra_writes && !k->unchanged)
+                continue;
+            hotspot* h = hotspot_for(p, k);
+            if (h) {
+                h->rereads += extra_reads;
+                h->rewrites += extra_writes;
+                h->unchanged += k->unchanged;
+            }
+        }
+    }
+    cur_serial = 0;
+    key_count = 0;
+}
+
+static key_use* key_for(const hh_access* a)
+{
+    static const uint8_t none[32];
+    int param = a->api == HH_API_HOOK_PARAM;
+    const uint8_t* acc = a->account ? a->account : none;
+    const uint8_t* ns = a->ns ? a->ns : none;
+    for (int i = 0; i < key_count; ++i) {
+        key_use* k = &keys[i];
+        if (k->param == param && k->key_len == a->key_len && !memcmp(k->key, a->key, a->key_len) &&
+            !memcmp(k->account, acc, 20) && !memcmp(k->ns, ns, 32))
+            return k;
+    }
+    if (key_count == MAX_KEYS)
+        return NULL;
+    key_use* k = &keys[key_count++];
+    memset(k, 0, sizeof(*k));
+    k->param = param;
+    memcpy(k->account, acc, 20);
+    memcpy(k->ns, ns, 32);
+    memcpy(k->key, a->key, a->key_len);
+    k->key_len = a->key_len;
+    return k;
+}
+
+static void log_access(const hh_access* a, const key_use* k)
+{
+    char text[72];
+    key_text(a->key, a->key_len, text, sizeof(text));
+    const hh_exec* e = a->exec;
+    fprintf(log_out, "  io %s[%d] %-17s %-12s", e->def->name, e->position, hh_api_names[a->api], text);
+    if (a->ns)
+        fprintf(log_out, " ns=%02X%02X%02X%02X", a->ns[0], a->ns[1], a->ns[2], a->ns[3]);
+    if (a->account && memcmp(a->account, e->account, 20) != 0)
+        fprintf(log_out, " acc=%02X%02X%02X%02X", a->account[0], a->account[1], a->account[2], a->account[3]);
+    fprintf(log_out, " size=%u -> %lld", a->size, (long long)a->result);
+    int write = a->api == HH_API_STATE_SET || a->api == HH_API_STATE_FOREIGN_SET;
+    if (k && !write && k->reads > 1)
+        fprintf(log_out, "  [read %ux]", k->reads);
+    if (k && write && k->writes > 1)
+        fprintf(log_out, "  [written %ux]", k->writes);
+    if (write && a->unchanged)
+        fprintf(log_out, "  [unchanged]");
+    fputc('\n', log_out);
+}
+
+static void on_access(void* ctx, const hh_access* a)
+{
+    hh_scenario* s = ctx;
+    if (a->api == HH_API_OTXN_PARAM)
+        return;
+    if (a->serial != cur_serial) {
+        flush();
+        cur_serial = a->serial;
+        cur_def = a->exec->def;
+        snprintf(cur_path, sizeof(cur_path), "%s", s->path);
+    }
+    key_use* k = key_for(a);
+    if (k) {
+        if (a->api == HH_API_STATE_SET || a->api == HH_API_STATE_FOREIGN_SET) {
+            k->writes++;
+            k->unchanged += a->unchanged && a->result >= 0;
+        } else
+            k->reads++;
+    }
+    if (log_out && s->verbose)
+        log_access(a, k);
+}
+
+void hh_statetrace_attach(hh_scenario* s, FILE* log)
+{
+    log_out = log;
+    s->on_access = on_access;
+    if (s->ledger)
+        hh_ledger_on_access(s->ledger, on_access, s);
+}
+
+void hh_statetrace_report(FILE* out)
+{
+    flush();
+    fprintf(out, "\nstate I/O per path (extra = beyond the first access in one execution)\n");
+    fprintf(out, "%-32s %6s %6s %6s %7s %6s %9s %7s %6s\n", "path", "execs", "reads", "extra", "writes", "extra",
+            "unchanged", "params", "extra");
+    for (int i = 0; i < path_count; ++i) {
+        const path_io* p = &paths[i];
+        fprintf(out, "%-32s %6llu %6llu %6llu %7llu %6llu %9llu %7llu %6llu\n", p->label,
+                (unsigned long long)p->executions, (unsigned long long)p->reads, (unsigned long long)p->rereads,
+                (unsigned long long)p->writes, (unsigned long long)p->rewrites, (unsigned long long)p->unchanged,
+                (unsigned long long)p->params, (unsigned long long)p->param_rereads);
+        for (int h = 0; h < p->hotspot_count; ++h) {
+            const hotspot* x = &p->hotspots[h];
+            fprintf(out, "    %s %s %s:", x->def->name, x->param ? "hook_param" : "state", x->key);
+            if (x->rereads)
+                fprintf(out, " +%llu reads", (unsigned long long)x->rereads);
+            if (x->rewrites)
+                fprintf(out, " +%llu writes", (unsigned long long)x->rewrites);
+            if (x->unchanged)
+                fprintf(out, " %llu unchanged writes", (unsigned long long)x->unchanged);
+            fputc('\n', out);
+        }
+    }
+}
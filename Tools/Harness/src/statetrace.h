@@ -0,0 +1,29 @@
+//**************************************************************
+// HandyHooks native harness - state I/O tracer
+//
+// Description:
+//   Watches every state, state_set, state_foreign, state_foreign_set
+//   and hook_param call of a scenario run. Each call can be logged with
+//   its key, namespace, size and result; keys read more than once in
+//   one execution, keys written twice and writes that store the value
+//   already there are counted per scenario path, so the report shows
+//   where a hook repeats ledger I/O.
+//
+// Usage:
+//   hh_statetrace_attach(&scenario, stdout);   // before hh_scenario_run
+//   ...
+//   hh_statetrace_report(stdout);
+//**************************************************************
+
+#ifndef HH_STATETRACE_H
+#define HH_STATETRACE_H
+
+#include <stdio.h>
+
+#include "scenario.h"
+
+// Traces the scenario's ledgers; log may be NULL to only collect.
+void hh_statetrace_attach(hh_scenario* s, FILE* log);
+void hh_statetrace_report(FILE* out);
+
+#endif
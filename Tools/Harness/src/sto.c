@@ -0,0 +1,399 @@
+//**************************************************************
+// HandyHooks native harness - serialized object reader and writer
+//
+// Covers the field types hooks and their emitted transactions use.
+// Anything else fails to parse, which the host functions report the
+// same way a node does: the blob is rejected.
+//**************************************************************
+
+#include <stdlib.h>
+
+#include "internal.h"
+#include "../hookapi/sfcodes.h"
+
+static int header(const uint8_t* p, const uint8_t* end, uint32_t* type, uint32_t* field)
+{
+    if (p >= end)
+        return 0;
+    uint32_t t = p[0] >> 4U, f = p[0] & 0x0FU;
+    int n = 1;
+    if (t == 0) {
+        if (p + 1 >= end)
+            return 0;
+        t = p[n++];
+    }
+    if (f == 0) {
+        if (p + n >= end)
+            return 0;
+        f = p[n++];
+    }
+    *type = t;
+    *field = f;
+    return n;
+}
+
+static int vl_length(const uint8_t* p, const uint8_t* end, uint32_t* len)
+{
+    if (p >= end)
+        return 0;
+    uint32_t b0 = p[0];
+    if (b0 <= 192) {
+        *len = b0;
+        return 1;
+    }
+    if (b0 <= 240) {
+        if (p + 1 >= end)
+            return 0;
+        *len = 193 + (b0 - 193) * 256 + p[1];
+        return 2;
+    }
+    if (b0 <= 254) {
+        if (p + 2 >= end)
+            return 0;
+        *len = 12481 + (b0 - 241) * 65536 + p[1] * 256 + p[2];
+        return 3;
+    }
+    return 0;
+}
+
+// Parses the field at p; 1 on success, 0 on malformed input.
+int hh_sto_field(const uint8_t* p, const uint8_t* end, hh_field* f)
+{
+    uint32_t type, field;
+    int hl = header(p, end, &type, &field);
+    if (!hl)
+        return 0;
+    f->id = (type << 16U) + field;
+    f->start = p;
+    const uint8_t* q = p + hl;
+    uint32_t len;
+    switch (type) {
+    case 1: len = 2; break;
+    case 2: len = 4; break;
+    case 3: len = 8; break;
+    case 4: len = 16; break;
+    case 5: len = 32; break;
+    case 6:
+        if (q >= end)
+            return 0;
+        len = (q[0] & 0x80U) ? 48 : 8;
+        break;
+    case 7:
+    case 8:
+    case 19: {
+        int vl = vl_length(q, end, &len);
+        if (!vl)
+            return 0;
+        q += vl;
+        break;
+    }
+    case 16: len = 1; break;
+    case 17: len = 20; break;
+    case 21: len = 24; break;
+    case 22: len = 48; break;
+    case 23: len = 64; break;
+    case HH_STO_OBJECT:
+    case HH_STO_ARRAY: {
+        uint8_t marker = type == HH_STO_OBJECT ? HH_END_OBJECT : HH_END_ARRAY;
+        const uint8_t* r = q;
+        hh_field inner;
+        while (r < end && *r != marker) {
+            if (!hh_sto_field(r, end, &inner))
+                return 0;
+            r = inner.next;
+        }
+        if (r >= end)
+            return 0;
+        f->payload = q;
+        f->payload_len = (uint32_t)(r - q);
+        f->next = r + 1;
+        return 1;
+    }
+    default:
+        return 0;
+    }
+    if (q + len > end)
+        return 0;
+    f->payload = q;
+    f->payload_len = len;
+    f->next = q + len;
+    return 1;
+}
+
+// 1 when found, 0 when absent, -1 when the object does not parse.
+int hh_sto_find(const uint8_t* p, uint32_t len, uint32_t id, hh_field* f)
+{
+    const uint8_t* end = p + len;
+    while (p < end) {
+        if (!hh_sto_field(p, end, f))
+            return -1;
+        if (f->id == id)
+            return 1;
+        p = f->next;
+    }
+    return 0;
+}
+
+int hh_sto_index(const uint8_t* p, uint32_t len, uint32_t idx, hh_field* f)
+{
+    const uint8_t* end = p + len;
+    for (uint32_t i = 0; p < end; ++i) {
+        if (!hh_sto_field(p, end, f))
+            return -1;
+        if (i == idx)
+            return 1;
+        p = f->next;
+    }
+    return 0;
+}
+
+int hh_sto_count(const uint8_t* p, uint32_t len)
+{
+    const uint8_t* end = p + len;
+    int n = 0;
+    hh_field f;
+    while (p < end) {
+        if (!hh_sto_field(p, end, &f))
+            return -1;
+        p = f.next;
+        ++n;
+    }
+    return n;
+}
+
+uint8_t* hh_sto_put_header(uint8_t* out, uint32_t id)
+{
+    uint32_t type = id >> 16U, field = id & 0xFFFFU;
+    if (type < 16 && field < 16)
+        *out++ = (uint8_t)(type << 4U | field);
+    else if (type < 16) {
+        *out++ = (uint8_t)(type << 4U);
+        *out++ = (uint8_t)field;
+    } else if (field < 16) {
+        *out++ = (uint8_t)field;
+        *out++ = (uint8_t)type;
+    } else {
+        *out++ = 0;
+        *out++ = (uint8_t)type;
+        *out++ = (uint8_t)field;
+    }
+    return out;
+}
+
+uint8_t* hh_sto_put_vl(uint8_t* out, const uint8_t* data, uint32_t len)
+{
+    if (len <= 192)
+        *out++ = (uint8_t)len;
+    else if (len <= 12480) {
+        uint32_t v = len - 193;
+        *out++ = (uint8_t)(193 + (v >> 8));
+        *out++ = (uint8_t)(v & 0xFF);
+    } else {
+        uint32_t v = len - 12481;
+        *out++ = (uint8_t)(241 + (v >> 16));
+        *out++ = (uint8_t)((v >> 8) & 0xFF);
+        *out++ = (uint8_t)(v & 0xFF);
+    }
+    memcpy(out, data, len);
+    return out + len;
+}
+
+static uint8_t* put_u32(uint8_t* out, uint32_t id, uint32_t v)
+{
+    out = hh_sto_put_header(out, id);
+    for (int i = 0; i < 4; ++i)
+        *out++ = (uint8_t)(v >> (24 - 8 * i));
+    return out;
+}
+
+uint8_t* hh_sto_put_amount(uint8_t* out, uint32_t id, const hh_amount* a)
+{
+    out = hh_sto_put_header(out, id);
+    if (a->native) {
+        uint64_t v = a->drops | (1ULL << 62);
+        for (int i = 0; i < 8; ++i)
+            *out++ = (uint8_t)(v >> (56 - 8 * i));
+        return out;
+    }
+    hh_xfl_to_iou(a->xfl, out);
+    memcpy(out + 8, a->currency, 20);
+    memcpy(out + 28, a->issuer, 20);
+    return out + 48;
+}
+
+static uint8_t* put_account(uint8_t* out, uint32_t id, const uint8_t acc[20])
+{
+    out = hh_sto_put_header(out, id);
+    return hh_sto_put_vl(out, acc, 20);
+}
+
+// Writes the transaction in canonical field order. Returns the size,
+// or 0 when cap is too small.
+uint32_t hh_sto_serialize(const hh_txn* t, const uint8_t* emit_details, uint32_t emit_len,
+                          uint8_t* out, uint32_t cap)
+{
+    uint32_t need = 128 + emit_len + t->amount_count * 56;
+    for (int i = 0; i < t->param_count; ++i)
+        need += 16 + t->params[i].name_len + t->params[i].value_len;
+    if (need > cap)
+        return 0;
+
+    static const uint8_t pubkey[33] = {0x02};
+    uint8_t* p = out;
+    p = hh_sto_put_header(p, sfTransactionType);
+    *p++ = (uint8_t)(t->type >> 8);
+    *p++ = (uint8_t)t->type;
+    p = put_u32(p, sfFlags, t->flags);
+    p = put_u32(p, sfSequence, 0);
+    if (t->has_amount)
+        p = hh_sto_put_amount(p, sfAmount, &t->amount);
+    hh_amount fee = {.native = 1, .drops = t->fee};
+    p = hh_sto_put_amount(p, sfFee, &fee);
+    p = hh_sto_put_header(p, sfSigningPubKey);
+    p = hh_sto_put_vl(p, pubkey, 33);
+    p = put_account(p, sfAccount, t->account);
+    if (t->has_destination)
+        p = put_account(p, sfDestination, t->destination);
+    if (emit_details) {
+        memcpy(p, emit_details, emit_len);
+        p += emit_len;
+    }
+    if (t->param_count) {
+        p = hh_sto_put_header(p, sfHookParameters);
+        for (int i = 0; i < t->param_count; ++i) {
+            p = hh_sto_put_header(p, sfHookParameter);
+            p = hh_sto_put_header(p, sfHookParameterName);
+            p = hh_sto_put_vl(p, t->params[i].name, t->params[i].name_len);
+            p = hh_sto_put_header(p, sfHookParameterValue);
+            p = hh_sto_put_vl(p, t->params[i].value, t->params[i].value_len);
+            *p++ = HH_END_OBJECT;
+        }
+        *p++ = HH_END_ARRAY;
+    }
+    if (t->amount_count) {
+        p = hh_sto_put_header(p, sfAmounts);
+        for (int i = 0; i < t->amount_count; ++i) {
+            p = hh_sto_put_header(p, sfAmountEntry);
+            p = hh_sto_put_amount(p, sfAmount, &t->amounts[i]);
+            *p++ = HH_END_OBJECT;
+        }
+        *p++ = HH_END_ARRAY;
+    }
+    return (uint32_t)(p - out);
+}
+
+// Indexes the top level fields of a transaction blob. 0 on success.
+int hh_txview_parse(hh_txview* v, const uint8_t* blob, uint32_t len)
+{
+    memset(v, 0, offsetof(hh_txview, fields));
+    v->param_count = 0;
+    v->amount_count = 0;
+    v->blob = blob;
+    v->len = len;
+    v->burden = 1;
+    v->type = 0xFFFF;
+
+    const uint8_t* p = blob;
+    const uint8_t* end = blob + len;
+    while (p < end) {
+        if (v->field_count == HH_MAX_FIELDS)
+            return -1;
+        hh_field* f = &v->fields[v->field_count++];
+        if (!hh_sto_field(p, end, f))
+            return -1;
+        p = f->next;
+        switch (f->id) {
+        case sfTransactionType:
+            v->type = (uint16_t)(f->payload[0] << 8 | f->payload[1]);
+            break;
+        case sfAccount:
+            if (f->payload_len != 20)
+                return -1;
+            v->account = f->payload;
+            break;
+        case sfDestination:
+            if (f->payload_len != 20)
+                return -1;
+            v->destination = f->payload;
+            break;
+        case sfAmount:
+            v->amount = f->payload;
+            v->amount_len = f->payload_len;
+            break;
+        case sfFee: {
+            if (f->payload_len != 8 || (f->payload[0] & 0x80U))
+                return -1;
+            uint64_t fee = 0;
+            for (int i = 0; i < 8; ++i)
+                fee = (fee << 8) | f->payload[i];
+            v->fee = fee & ((1ULL << 62) - 1);
+            break;
+        }
+        case sfEmitDetails: {
+            hh_field g;
+            if (hh_sto_find(f->payload, f->payload_len, sfEmitGeneration, &g) == 1)
+                v->generation = (uint32_t)(g.payload[0] << 24 | g.payload[1] << 16 |
+                                           g.payload[2] << 8 | g.payload[3]);
+            if (hh_sto_find(f->payload, f->payload_len, sfEmitBurden, &g) == 1) {
+                uint64_t b = 0;
+                for (int i = 0; i < 8; ++i)
+                    b = (b << 8) | g.payload[i];
+                v->burden = b;
+            }
+            break;
+        }
+        case sfHookParameters: {
+            const uint8_t* q = f->payload;
+            const uint8_t* qend = f->payload + f->payload_len;
+            hh_field e, nf, vf;
+            while (q < qend) {
+                if (!hh_sto_field(q, qend, &e) || e.id != sfHookParameter)
+                    return -1;
+                q = e.next;
+                if (v->param_count == HH_MAX_PARAMS)
+                    return -1;
+                if (hh_sto_find(e.payload, e.payload_len, sfHookParameterName, &nf) != 1)
+                    return -1;
+                int has_value = hh_sto_find(e.payload, e.payload_len, sfHookParameterValue, &vf) == 1;
+                v->params[v->param_count].name = nf.payload;
+                v->params[v->param_count].name_len = nf.payload_len;
+                v->params[v->param_count].value = has_value ? vf.payload : NULL;
+                v->params[v->param_count].value_len = has_value ? vf.payload_len : 0;
+                v->param_count++;
+            }
+            break;
+        }
+        case sfAmounts: {
+            const uint8_t* q = f->payload;
+            const uint8_t* qend = f->payload + f->payload_len;
+            hh_field e, a;
+            while (q < qend) {
+                if (!hh_sto_field(q, qend, &e) || e.id != sfAmountEntry)
+                    return -1;
+                q = e.next;
+                if (v->amount_count == HH_MAX_AMOUNTS)
+                    return -1;
+                if (hh_sto_find(e.payload, e.payload_len, sfAmount, &a) != 1)
+                    return -1;
+                v->amounts[v->amount_count] = a.payload;
+                v->amounts_len[v->amount_count] = a.payload_len;
+                v->amount_count++;
+            }
+            break;
+        }
+        }
+    }
+    if (v->type == 0xFFFF || !v->account)
+        return -1;
+
+    uint8_t small[4 + 4096];
+    uint8_t* buf = len <= 4096 ? small : malloc(len + 4);
+    if (!buf)
+        return -1;
+    memcpy(buf, "TXN", 4);
+    memcpy(buf + 4, blob, len);
+    hh_sha512h(buf, len + 4, v->id);
+    if (buf != small)
+        free(buf);
+    return 0;
+}
@@ -0,0 +1,280 @@
+//**************************************************************
+// HandyHooks native harness - hashing, hash map and small helpers
+//**************************************************************
+
+#include <stdlib.h>
+
+#include "internal.h"
+
+// ---------------------------------------------------------------
+// SHA-512, used for SHA512-Half keylets, transaction ids and nonces
+// ---------------------------------------------------------------
+
+static const uint64_t K512[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL};
+
+#define ROR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+static void sha512_block(uint64_t h[8], const uint8_t* p)
+{
+    uint64_t w[80];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = 0;
+        for (int j = 0; j < 8; ++j)
+            w[i] = (w[i] << 8) | p[i * 8 + j];
+    }
+    for (int i = 16; i < 80; ++i) {
+        uint64_t s0 = ROR64(w[i - 15], 1) ^ ROR64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+        uint64_t s1 = ROR64(w[i - 2], 19) ^ ROR64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint64_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 80; ++i) {
+        uint64_t t1 = k + (ROR64(e, 14) ^ ROR64(e, 18) ^ ROR64(e, 41)) + ((e & f) ^ (~e & g)) + K512[i] + w[i];
+        uint64_t t2 = (ROR64(a, 28) ^ ROR64(a, 34) ^ ROR64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += k;
+}
+
+void hh_sha512h(const void* data, size_t len, uint8_t out[32])
+{
+    uint64_t h[8] = {0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL,
+                     0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+                     0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL};
+    const uint8_t* p = data;
+    size_t left = len;
+    while (left >= 128) {
+        sha512_block(h, p);
+        p += 128;
+        left -= 128;
+    }
+    uint8_t tail[256] = {0};
+    memcpy(tail, p, left);
+    tail[left] = 0x80;
+    size_t tail_len = left < 112 ? 128 : 256;
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; ++i)
+        tail[tail_len - 1 - i] = (uint8_t)(bits >> (8 * i));
+    sha512_block(h, tail);
+    if (tail_len == 256)
+        sha512_block(h, tail + 128);
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 8; ++j)
+            out[i * 8 + j] = (uint8_t)(h[i] >> (56 - 8 * j));
+}
+
+// ---------------------------------------------------------------
+// Hash map
+// ---------------------------------------------------------------
+
+static uint64_t map_hash(const uint8_t* key, uint32_t len)
+{
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, key + i, 8);
+        h = (h ^ w) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+    for (; i < len; ++i)
+        h = (h ^ key[i]) * 0x94D049BB133111EBULL;
+    h ^= h >> 29;
+    return h;
+}
+
+void hh_map_init(hh_map* m, uint32_t key_len)
+{
+    m->key_len = key_len;
+    m->cap = 0;
+    m->count = 0;
+    m->keys = NULL;
+    m->vals = NULL;
+}
+
+void hh_map_free(hh_map* m)
+{
+    free(m->keys);
+    free(m->vals);
+    hh_map_init(m, m->key_len);
+}
+
+static void map_grow(hh_map* m)
+{
+    size_t old_cap = m->cap;
+    uint8_t* old_keys = m->keys;
+    void** old_vals = m->vals;
+    m->cap = old_cap ? old_cap * 2 : 64;
+    m->keys = malloc(m->cap * m->key_len);
+    m->vals = calloc(m->cap, sizeof(void*));
+    m->count = 0;
+    if (!m->keys || !m->vals) {
+        fprintf(stderr, "harness: out of memory\n");
+        abort();
+    }
+    for (size_t i = 0; i < old_cap; ++i)
+        if (old_vals[i])
+            hh_map_put(m, old_keys + i * m->key_len, old_vals[i]);
+    free(old_keys);
+    free(old_vals);
+}
+
+void* hh_map_get(const hh_map* m, const uint8_t* key)
+{
+    if (!m->cap)
+        return NULL;
+    size_t mask = m->cap - 1;
+    for (size_t i = map_hash(key, m->key_len) & mask;; i = (i + 1) & mask) {
+        if (!m->vals[i])
+            return NULL;
+        if (memcmp(m->keys + i * m->key_len, key, m->key_len) == 0)
+            return m->vals[i];
+    }
+}
+
+void hh_map_put(hh_map* m, const uint8_t* key, void* val)
+{
+    if ((m->count + 1) * 4 > m->cap * 3)
+        map_grow(m);
+    size_t mask = m->cap - 1;
+    for (size_t i = map_hash(key, m->key_len) & mask;; i = (i + 1) & mask) {
+        if (!m->vals[i]) {
+            memcpy(m->keys + i * m->key_len, key, m->key_len);
+            m->vals[i] = val;
+            m->count++;
+            return;
+        }
+        if (memcmp(m->keys + i * m->key_len, key, m->key_len) == 0) {
+            m->vals[i] = val;
+            return;
+        }
+    }
+}
+
+void* hh_map_del(hh_map* m, const uint8_t* key)
+{
+    if (!m->cap)
+        return NULL;
+    size_t mask = m->cap - 1;
+    size_t i = map_hash(key, m->key_len) & mask;
+    for (;; i = (i + 1) & mask) {
+        if (!m->vals[i])
+            return NULL;
+        if (memcmp(m->keys + i * m->key_len, key, m->key_len) == 0)
+            break;
+    }
+    void* val = m->vals[i];
+    m->vals[i] = NULL;
+    m->count--;
+    // shift the rest of the probe run back so lookups never stop early
+    for (size_t j = (i + 1) & mask; m->vals[j]; j = (j + 1) & mask) {
+        size_t home = map_hash(m->keys + j * m->key_len, m->key_len) & mask;
+        if ((j > i && (home <= i || home > j)) || (j < i && (home <= i && home > j))) {
+            memcpy(m->keys + i * m->key_len, m->keys + j * m->key_len, m->key_len);
+            m->vals[i] = m->vals[j];
+            m->vals[j] = NULL;
+            i = j;
+        }
+    }
+    return val;
+}
+
+// ---------------------------------------------------------------
+// Text helpers
+// ---------------------------------------------------------------
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// Decodes hex into out; returns the byte count or -1.
+int hh_hex(const char* hex, uint8_t* out, uint32_t max)
+{
+    size_t n = strlen(hex);
+    if (n % 2 || n / 2 > max)
+        return -1;
+    for (size_t i = 0; i < n / 2; ++i) {
+        int hi = hex_nibble(hex[2 * i]);
+        int lo = hex_nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return -1;
+        out[i] = (uint8_t)(hi << 4 | lo);
+    }
+    return (int)(n / 2);
+}
+
+// Three letter codes go in bytes 12..14; 40 hex digits are taken as is.
+int hh_currency(const char* code, uint8_t out[20])
+{
+    memset(out, 0, 20);
+    size_t n = strlen(code);
+    if (n == 3) {
+        memcpy(out + 12, code, 3);
+        return 0;
+    }
+    return hh_hex(code, out, 20) == 20 ? 0 : -1;
+}
+
+// Deterministic account id for a harness account name.
+void hh_account_id(const char* name, uint8_t out[20])
+{
+    uint8_t h[32];
+    char buf[128];
+    int n = snprintf(buf, sizeof(buf), "account:%s", name);
+    hh_sha512h(buf, (size_t)n, h);
+    memcpy(out, h, 20);
+}
+
+const char* hh_ter_name(hh_ter ter)
+{
+    switch (ter) {
+    case HH_TES_SUCCESS: return "tesSUCCESS";
+    case HH_TEC_HOOK_REJECTED: return "tecHOOK_REJECTED";
+    case HH_TEC_UNFUNDED: return "tecUNFUNDED_PAYMENT";
+    case HH_TEC_NO_LINE: return "tecNO_LINE";
+    case HH_TEC_NO_DST: return "tecNO_DST";
+    case HH_TEF_MALFORMED: return "temMALFORMED";
+    }
+    return "unknown";
+}
@@ -0,0 +1,446 @@
+//**************************************************************
+// HandyHooks native harness - XFL floating point host functions
+//
+// XFL layout: bit 62 is the sign (set = positive), bits 54..61 the
+// exponent biased by 97, bits 0..53 a mantissa normalised into
+// [10^15, 10^16). Zero is 0. Native amounts convert at 10^-6, so a
+// native balance of 1 XAH reads back as 1e0, as it does on-ledger.
+//**************************************************************
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "internal.h"
+#include "../hookapi/error.h"
+
+#define XFL_MIN_MANTISSA 1000000000000000ULL
+#define XFL_MAX_MANTISSA 9999999999999999ULL
+#define XFL_MIN_EXPONENT -96
+#define XFL_MAX_EXPONENT 80
+
+#define COUNT() (hh_cur->exec->calls[HH_API_FLOAT]++)
+
+typedef unsigned __int128 u128;
+
+static int64_t normalize(u128 m, int32_t e, int neg)
+{
+    if (m == 0)
+        return 0;
+    while (m > XFL_MAX_MANTISSA) {
+        m /= 10;
+        ++e;
+    }
+    while (m < XFL_MIN_MANTISSA) {
+        m *= 10;
+        --e;
+    }
+    if (e > XFL_MAX_EXPONENT)
+        return XFL_OVERFLOW;
+    if (e < XFL_MIN_EXPONENT)
+        return 0;
+    return (int64_t)((neg ? 0 : (1ULL << 62)) | ((uint64_t)(e + 97) << 54) | (uint64_t)m);
+}
+
+int64_t hh_xfl_make(int64_t mantissa, int32_t exponent)
+{
+    if (mantissa == 0)
+        return 0;
+    int neg = mantissa < 0;
+    uint64_t m = neg ? (uint64_t)(-(mantissa + 1)) + 1 : (uint64_t)mantissa;
+    return normalize(m, exponent, neg);
+}
+
+// 0 on success, INVALID_FLOAT for a negative int64.
+int hh_xfl_parts(int64_t xfl, uint64_t* mantissa, int32_t* exponent, int* neg)
+{
+    if (xfl < 0)
+        return INVALID_FLOAT;
+    if (xfl == 0) {
+        *mantissa = 0;
+        *exponent = 0;
+        *neg = 0;
+        return 0;
+    }
+    *mantissa = (uint64_t)xfl & ((1ULL << 54) - 1);
+    *exponent = (int32_t)(((uint64_t)xfl >> 54) & 0xFFU) - 97;
+    *neg = !(((uint64_t)xfl >> 62) & 1U);
+    return 0;
+}
+
+int64_t hh_xfl_from_iou(const uint8_t* b)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i)
+        v = (v << 8) | b[i];
+    if ((v & ((1ULL << 54) - 1)) == 0)
+        return 0;
+    return (int64_t)(v & ~(1ULL << 63));
+}
+
+void hh_xfl_to_iou(int64_t xfl, uint8_t* out)
+{
+    uint64_t v = xfl == 0 ? (1ULL << 63) : ((uint64_t)xfl | (1ULL << 63));
+    for (int i = 0; i < 8; ++i)
+        out[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+static int64_t from_double(long double v)
+{
+    if (v == 0 || !isfinite(v))
+        return v == 0 ? 0 : INVALID_FLOAT;
+    int neg = v < 0;
+    if (neg)
+        v = -v;
+    int32_t e = (int32_t)floorl(log10l(v)) - 15;
+    u128 m = (u128)llroundl(v / powl(10.0L, e));
+    return normalize(m, e, neg);
+}
+
+static long double to_double(uint64_t m, int32_t e, int neg)
+{
+    long double v = (long double)m * powl(10.0L, e);
+    return neg ? -v : v;
+}
+
+#define PARTS(x, m, e, n)                                  \
+    uint64_t m;                                            \
+    int32_t e;                                             \
+    int n;                                                 \
+    if (hh_xfl_parts(x, &m, &e, &n) < 0)                   \
+        return INVALID_FLOAT;
+
+int64_t float_set(int32_t exponent, int64_t mantissa)
+{
+    COUNT();
+    return hh_xfl_make(mantissa, exponent);
+}
+
+int64_t float_one(void)
+{
+    COUNT();
+    return hh_xfl_make(1, 0);
+}
+
+int64_t float_negate(int64_t float1)
+{
+    COUNT();
+    if (float1 == 0)
+        return 0;
+    if (float1 < 0)
+        return INVALID_FLOAT;
+    return (int64_t)((uint64_t)float1 ^ (1ULL << 62));
+}
+
+int64_t float_multiply(int64_t float1, int64_t float2)
+{
+    COUNT();
+    PARTS(float1, m1, e1, n1);
+    PARTS(float2, m2, e2, n2);
+    if (!m1 || !m2)
+        return 0;
+    return normalize((u128)m1 * m2, e1 + e2, n1 ^ n2);
+}
+
+int64_t float_mulratio(int64_t float1, uint32_t round_up, uint32_t numerator, uint32_t denominator)
+{
+    COUNT();
+    if (denominator == 0)
+        return DIVISION_BY_ZERO;
+    PARTS(float1, m, e, n);
+    if (!m || !numerator)
+        return 0;
+    u128 p = (u128)m * numerator * 10000000000ULL;
+    u128 q = p / denominator;
+    if (round_up && q * denominator != p)
+        ++q;
+    return normalize(q, e - 10, n);
+}
+
+int64_t float_divide(int64_t float1, int64_t float2)
+{
+    COUNT();
+    PARTS(float1, m1, e1, n1);
+    PARTS(float2, m2, e2, n2);
+    if (!m2)
+        return DIVISION_BY_ZERO;
+    if (!m1)
+        return 0;
+    u128 q = ((u128)m1 * 10000000000000000000ULL) / m2;
+    return normalize(q, e1 - e2 - 19, n1 ^ n2);
+}
+
+int64_t float_invert(int64_t float1)
+{
+    COUNT();
+    PARTS(float1, m, e, n);
+    if (!m)
+        return DIVISION_BY_ZERO;
+    u128 q = ((u128)XFL_MIN_MANTISSA * 10000000000000000000ULL) / m;
+    return normalize(q, -15 - e - 19, n);
+}
+
+static int64_t sum(int64_t float1, int64_t float2)
+{
+    PARTS(float1, m1, e1, n1);
+    PARTS(float2, m2, e2, n2);
+    if (!m1)
+        return float2;
+    if (!m2)
+        return float1;
+    if (e1 < e2) {
+        uint64_t tm = m1;
+        int32_t te = e1;
+        int tn = n1;
+        m1 = m2, e1 = e2, n1 = n2;
+        m2 = tm, e2 = te, n2 = tn;
+    }
+    u128 a = m1, b = m2;
+    while (e1 > e2 && a < ((u128)1 << 100)) {
+        a *= 10;
+        --e1;
+    }
+    while (e2 < e1) {
+        b /= 10;
+        ++e2;
+    }
+    if (n1 == n2)
+        return normalize(a + b, e1, n1);
+    if (a >= b)
+        return normalize(a - b, e1, n1);
+    return normalize(b - a, e1, n2);
+}
+
+int64_t float_sum(int64_t float1, int64_t float2)
+{
+    COUNT();
+    return sum(float1, float2);
+}
+
+static int compare(int64_t f1, int64_t f2)
+{
+    uint64_t m1 = 0, m2 = 0;
+    int32_t e1 = 0, e2 = 0;
+    int n1 = 0, n2 = 0;
+    hh_xfl_parts(f1, &m1, &e1, &n1);
+    hh_xfl_parts(f2, &m2, &e2, &n2);
+    if (!m1 && !m2)
+        return 0;
+    int s1 = !m1 ? 0 : (n1 ? -1 : 1);
+    int s2 = !m2 ? 0 : (n2 ? -1 : 1);
+    if (s1 != s2)
+        return s1 < s2 ? -1 : 1;
+    int mag = e1 != e2 ? (e1 < e2 ? -1 : 1) : (m1 != m2 ? (m1 < m2 ? -1 : 1) : 0);
+    return s1 < 0 ? -mag : mag;
+}
+
+int64_t float_compare(int64_t float1, int64_t float2, uint32_t mode)
+{
+    COUNT();
+    if (mode == 0 || mode >= 7)
+        return INVALID_ARGUMENT;
+    if (float1 < 0 || float2 < 0)
+        return INVALID_FLOAT;
+    int c = compare(float1, float2);
+    return ((mode & 1U) && c == 0) || ((mode & 2U) && c < 0) || ((mode & 4U) && c > 0);
+}
+
+static int64_t to_int(int64_t float1, uint32_t decimal_places, uint32_t abs)
+{
+    if (decimal_places > 15)
+        return INVALID_ARGUMENT;
+    PARTS(float1, m, e, n);
+    if (!m)
+        return 0;
+    if (n && !abs)
+        return CANT_RETURN_NEGATIVE;
+    int32_t shift = e + (int32_t)decimal_places;
+    u128 v = m;
+    for (; shift > 0; --shift) {
+        v *= 10;
+        if (v > INT64_MAX)
+            return TOO_BIG;
+    }
+    for (; shift < 0 && v; ++shift)
+        v /= 10;
+    return (int64_t)v;
+}
+
+int64_t float_int(int64_t float1, uint32_t decimal_places, uint32_t abs)
+{
+    COUNT();
+    return to_int(float1, decimal_places, abs);
+}
+
+int64_t float_mantissa(int64_t float1)
+{
+    COUNT();
+    PARTS(float1, m, e, n);
+    (void)e;
+    (void)n;
+    return (int64_t)m;
+}
+
+int64_t float_sign(int64_t float1)
+{
+    COUNT();
+    PARTS(float1, m, e, n);
+    (void)e;
+    return m ? n : 0;
+}
+
+int64_t float_log(int64_t float1)
+{
+    COUNT();
+    PARTS(float1, m, e, n);
+    if (!m || n)
+        return COMPLEX_NOT_SUPPORTED;
+    return from_double(log10l(to_double(m, e, 0)));
+}
+
+int64_t float_root(int64_t float1, uint32_t n)
+{
+    COUNT();
+    if (n < 2)
+        return INVALID_ARGUMENT;
+    PARTS(float1, m, e, neg);
+    if (!m)
+        return 0;
+    if (neg)
+        return COMPLEX_NOT_SUPPORTED;
+    return from_double(powl(to_double(m, e, 0), 1.0L / n));
+}
+
+int64_t float_sto(uint32_t write_ptr, uint32_t write_len, uint32_t cread_ptr, uint32_t cread_len,
+                  uint32_t iread_ptr, uint32_t iread_len, int64_t float1, uint32_t field_code)
+{
+    COUNT();
+    if (float1 < 0)
+        return INVALID_FLOAT;
+    int is_short = field_code == 0xFFFFFFFFU;
+    int is_native = field_code == 0 || (cread_len == 0 && iread_len == 0);
+    if (!is_short && !is_native && (cread_len != 20 && cread_len != 3))
+        return INVALID_ARGUMENT;
+    if (!is_short && !is_native && iread_len != 20)
+        return INVALID_ARGUMENT;
+
+    uint8_t out[64];
+    uint8_t* p = out;
+    if (!is_short && field_code != 0)
+        p = hh_sto_put_header(p, field_code);
+
+    if (is_native) {
+        int64_t drops = to_int(float1, 6, 1);
+        if (drops < 0)
+            return drops;
+        int neg = float1 != 0 && !(((uint64_t)float1 >> 62) & 1U);
+        uint64_t v = (uint64_t)drops | (neg ? 0 : (1ULL << 62));
+        for (int i = 0; i < 8; ++i)
+            *p++ = (uint8_t)(v >> (56 - 8 * i));
+    } else {
+        hh_xfl_to_iou(float1, p);
+        p += 8;
+        if (!is_short) {
+            if (cread_len == 3) {
+                memset(p, 0, 20);
+                memcpy(p + 12, HH_MEM(cread_ptr), 3);
+            } else
+                memcpy(p, HH_MEM(cread_ptr), 20);
+            memcpy(p + 20, HH_MEM(iread_ptr), 20);
+            p += 40;
+        }
+    }
+
+    uint32_t n = (uint32_t)(p - out);
+    if (write_len < n)
+        return TOO_SMALL;
+    memcpy(HH_MEM(write_ptr), out, n);
+    return n;
+}
+
+int64_t float_sto_set(uint32_t read_ptr, uint32_t read_len)
+{
+    COUNT();
+    const uint8_t* p = HH_MEM(read_ptr);
+    if (read_len < 8)
+        return NOT_AN_OBJECT;
+    if (read_len > 8) {
+        hh_field f;
+        if (!hh_sto_field(p, p + read_len, &f) || (f.id >> 16) != 6U)
+            return NOT_AN_OBJECT;
+        p = f.payload;
+    }
+    if (!(p[0] & 0x80U)) {
+        uint64_t drops = 0;
+        for (int i = 0; i < 8; ++i)
+            drops = (drops << 8) | p[i];
+        int neg = !(drops & (1ULL << 62));
+        drops &= (1ULL << 62) - 1;
+        return hh_xfl_make(neg ? -(int64_t)drops : (int64_t)drops, -6);
+    }
+    return hh_xfl_from_iou(p);
+}
+
+// ---------------------------------------------------------------
+// Ledger-side arithmetic, not metered as hook calls
+// ---------------------------------------------------------------
+
+int64_t hh_xfl_add(int64_t a, int64_t b)
+{
+    return sum(a, b);
+}
+
+int64_t hh_xfl_neg(int64_t a)
+{
+    return a == 0 ? 0 : (int64_t)((uint64_t)a ^ (1ULL << 62));
+}
+
+int hh_xfl_cmp(int64_t a, int64_t b)
+{
+    return compare(a, b);
+}
+
+// Decimal text ("12.5", "-3e4") to XFL, INVALID_FLOAT when malformed.
+int64_t hh_xfl_parse(const char* s)
+{
+    int neg = *s == '-';
+    if (*s == '-' || *s == '+')
+        ++s;
+    u128 m = 0;
+    int32_t e = 0;
+    int digits = 0, seen_dot = 0;
+    for (; *s && *s != 'e' && *s != 'E'; ++s) {
+        if (*s == '.' && !seen_dot) {
+            seen_dot = 1;
+            continue;
+        }
+        if (*s < '0' || *s > '9')
+            return INVALID_FLOAT;
+        if (m <= XFL_MAX_MANTISSA * 10ULL) {
+            m = m * 10 + (u128)(*s - '0');
+            e -= seen_dot;
+        } else
+            e += !seen_dot;
+        ++digits;
+    }
+    if (!digits)
+        return INVALID_FLOAT;
+    if (*s) {
+        char* end;
+        long x = strtol(s + 1, &end, 10);
+        if (*end || end == s + 1)
+            return INVALID_FLOAT;
+        e += (int32_t)x;
+    }
+    return normalize(m, e, neg);
+}
+
+void hh_xfl_format(int64_t xfl, char* out, size_t len)
+{
+    uint64_t m;
+    int32_t e;
+    int neg;
+    if (hh_xfl_parts(xfl, &m, &e, &neg) < 0)
+        snprintf(out, len, "<invalid>");
+    else
+        snprintf(out, len, "%.15Lg", to_double(m, e, neg));
+}
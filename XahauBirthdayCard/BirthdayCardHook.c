@@ -16,10 +16,15 @@
 //
 //**************************************************************
 #include "hookapi.h"
+#include "../Common/BuildProfile.h"
 #include <stdint.h>
+#include "../Common/UserRecord.h"
+#include "../Common/StateKey.h"
+#include "../Common/ResultCode.h"
 
-#define DONE(x) accept(SBUF(x), __LINE__)
-#define NOPE(x) rollback(SBUF(x), __LINE__)
+#define HOOK_RESULT_ID RC_BIRTHDAYCARDHOOK
+#define DONE(x) RESULT_ACCEPT(x)
+#define NOPE(x) RESULT_ROLLBACK(x)
 
 #define GUARD(maxiter) _g(__LINE__, (maxiter)+1)
 
@@ -43,25 +48,20 @@ int64_t hook(uint32_t reserved) {
 
     // Get parameters
     uint8_t msg_buf[1024];
-    uint8_t msg_key[3] = {'M', 'S', 'G'};
-    int64_t msg_len = otxn_param(SBUF(msg_buf), SBUF(msg_key));
+    int64_t msg_len = otxn_param(SBUF(msg_buf), SKEY("MSG"));
 
     uint8_t del_buf[20];
-    uint8_t del_key[3] = {'D', 'E', 'L'};
-    int64_t del_len = otxn_param(SBUF(del_buf), SBUF(del_key));
+    int64_t del_len = otxn_param(SBUF(del_buf), SKEY("DEL"));
 
     // Anyone can add a message
     if (msg_len > 0) {
         // Namespace: first 20 bytes = sender, rest zero
-        uint8_t ns[32];
-        int i = 0;
-        for (; i < 20; ++i) ns[i] = otx_acc[i];
-        for (; i < 32; ++i) ns[i] = 0;
+        uint8_t ns[USER_NS_SIZE];
+        USER_NAMESPACE(ns, otx_acc);
 
         uint8_t msg_key_data[32] = "BIRTHDAY_MSG";
-        for (int k = 12; k < 32; ++k) msg_key_data[k] = 0;
 
-        if (state_foreign_set(msg_buf, msg_len, msg_key_data, 32, ns, 32, hook_acct, 20) < 0) {
+        if (USER_FLUSH(msg_buf, msg_len, msg_key_data, 32, ns, hook_acct, 1) < 0) {
             NOPE("Error: Could not add message to birthday card");
         }
 
@@ -75,15 +75,12 @@ int64_t hook(uint32_t reserved) {
         }
 
         // Namespace: first 20 bytes = account ID, rest zero
-        uint8_t ns[32];
-        int i = 0;
-        for (; i < 20; ++i) ns[i] = del_buf[i];
-        for (; i < 32; ++i) ns[i] = 0;
+        uint8_t ns[USER_NS_SIZE];
+        USER_NAMESPACE(ns, del_buf);
 
         uint8_t msg_key_data[32] = "BIRTHDAY_MSG";
-        for (int k = 12; k < 32; ++k) msg_key_data[k] = 0;
 
-        if (state_foreign_set(0, 0, msg_key_data, 32, ns, 32, hook_acct, 20) < 0) {
+        if (USER_FLUSH(msg_buf, 0, msg_key_data, 32, ns, hook_acct, 1) < 0) {
             NOPE("Error: Could not delete message from birthday card");
         }
 